@@ -0,0 +1,71 @@
+/***********************************************************************
+Benchmark - Base class for micro-benchmarks measuring the performance of
+a single operation of the Vrui core libraries.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include "Benchmark.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <Misc/StringPrintf.h>
+
+/**************************
+Methods of class Benchmark:
+**************************/
+
+void Benchmark::addMetric(const char* metricName,double value,const char* unit)
+	{
+	Metric m;
+	m.name=metricName;
+	m.value=value;
+	m.unit=unit;
+	metrics.push_back(m);
+	}
+
+std::string Benchmark::getTempFileName(const char* suffix)
+	{
+	/* Create a file name in the temporary directory that is unique between processes and between calls: */
+	static unsigned int nextIndex=0;
+	const char* tempDir=getenv("TMPDIR");
+	if(tempDir==0||tempDir[0]=='\0')
+		tempDir="/tmp";
+	std::string result=Misc::stringPrintf("%s/VruiBenchmark-%d-%u%s",tempDir,int(getpid()),nextIndex,suffix);
+	++nextIndex;
+	return result;
+	}
+
+Benchmark::Benchmark(const char* sSuite,const char* sName,const std::string& sParameters)
+	:suite(sSuite),name(sName),parameters(sParameters),
+	 numOperations(1.0),numBytes(0.0),sink(0)
+	{
+	}
+
+Benchmark::~Benchmark(void)
+	{
+	}
+
+void Benchmark::setup(void)
+	{
+	}
+
+void Benchmark::teardown(void)
+	{
+	}
@@ -0,0 +1,104 @@
+/***********************************************************************
+Benchmark - Base class for micro-benchmarks measuring the performance of
+a single operation of the Vrui core libraries.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef BENCHMARK_INCLUDED
+#define BENCHMARK_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class Benchmark
+	{
+	/* Embedded classes: */
+	public:
+	struct Metric // Structure for additional results reported by a benchmark
+		{
+		/* Elements: */
+		public:
+		std::string name; // Name of the metric
+		double value; // Measured value
+		std::string unit; // Unit of the measured value
+		};
+	
+	/* Elements: */
+	private:
+	std::string suite; // Name of the library or component containing the measured operation
+	std::string name; // Name of the benchmark
+	std::string parameters; // Parameters distinguishing variants of the same benchmark, as comma-separated name=value pairs
+	protected:
+	double numOperations; // Number of operations performed by one iteration of the benchmark
+	double numBytes; // Number of bytes processed by one iteration of the benchmark, or zero if throughput is not meaningful
+	volatile size_t sink; // Variable receiving results of measured operations to prevent the compiler from optimizing them away
+	private:
+	std::vector<Metric> metrics; // Additional results reported by the last timed run
+	
+	/* Protected methods: */
+	protected:
+	void addMetric(const char* metricName,double value,const char* unit); // Reports an additional result of the benchmark
+	static std::string getTempFileName(const char* suffix); // Returns a unique name for a temporary file with the given suffix
+	
+	/* Constructors and destructors: */
+	public:
+	Benchmark(const char* sSuite,const char* sName,const std::string& sParameters =std::string()); // Creates a benchmark of the given suite, name, and parameters performing one operation per iteration
+	private:
+	Benchmark(const Benchmark& source); // Prohibit copy constructor
+	Benchmark& operator=(const Benchmark& source); // Prohibit assignment operator
+	public:
+	virtual ~Benchmark(void);
+	
+	/* Methods: */
+	const std::string& getSuite(void) const // Returns the benchmark's suite name
+		{
+		return suite;
+		}
+	const std::string& getName(void) const // Returns the benchmark's name
+		{
+		return name;
+		}
+	const std::string& getParameters(void) const // Returns the benchmark's parameters
+		{
+		return parameters;
+		}
+	double getNumOperations(void) const // Returns the number of operations per iteration
+		{
+		return numOperations;
+		}
+	double getNumBytes(void) const // Returns the number of bytes processed per iteration
+		{
+		return numBytes;
+		}
+	const std::vector<Metric>& getMetrics(void) const // Returns the additional results reported by the benchmark
+		{
+		return metrics;
+		}
+	void clearMetrics(void) // Clears all additional results
+		{
+		metrics.clear();
+		}
+	virtual void setup(void); // Prepares the benchmark's state before the first run; default does nothing
+	virtual void run(size_t numIterations) =0; // Runs the given number of iterations of the benchmark
+	virtual void teardown(void); // Releases the benchmark's state after the last run, and reports additional results; default does nothing
+	};
+
+#endif
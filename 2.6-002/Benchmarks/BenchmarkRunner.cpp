@@ -0,0 +1,343 @@
+/***********************************************************************
+BenchmarkRunner - Class to select, calibrate, and run a set of
+micro-benchmarks, and to write their results in a tab-separated format
+that can be compared between Vrui releases built on the same machine.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include "BenchmarkRunner.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#include <algorithm>
+#include <stdexcept>
+#include <Threads/Config.h>
+
+#include "Benchmark.h"
+
+#ifndef BENCHMARKS_VRUIVERSION
+#define BENCHMARKS_VRUIVERSION 0
+#endif
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+std::string getCpuModel(void) // Returns the model name of the host's CPUs, or an empty string if unknown
+	{
+	std::string result;
+	FILE* cpuInfo=fopen("/proc/cpuinfo","rt");
+	if(cpuInfo!=0)
+		{
+		char line[1024];
+		while(fgets(line,sizeof(line),cpuInfo)!=0)
+			{
+			if(strncmp(line,"model name",10)==0)
+				{
+				/* Extract the value after the colon and strip leading and trailing whitespace: */
+				char* valuePtr=strchr(line,':');
+				if(valuePtr!=0)
+					{
+					for(++valuePtr;*valuePtr==' '||*valuePtr=='\t';++valuePtr)
+						;
+					char* endPtr=valuePtr+strlen(valuePtr);
+					while(endPtr!=valuePtr&&(endPtr[-1]=='\n'||endPtr[-1]==' '||endPtr[-1]=='\t'))
+						--endPtr;
+					result=std::string(valuePtr,endPtr);
+					}
+				break;
+				}
+			}
+		fclose(cpuInfo);
+		}
+	return result;
+	}
+
+void writeResult(FILE* file,const Benchmark* benchmark,const char* metric,double value,const char* unit) // Writes a single result line
+	{
+	fprintf(file,"%s\t%s\t%s\t%s\t%.6g\t%s\n",benchmark->getSuite().c_str(),benchmark->getName().c_str(),benchmark->getParameters().empty()?"-":benchmark->getParameters().c_str(),metric,value,unit);
+	}
+
+}
+
+/********************************
+Methods of class BenchmarkRunner:
+********************************/
+
+bool BenchmarkRunner::isSelected(const Benchmark* benchmark) const
+	{
+	if(filters.empty())
+		return true;
+	
+	/* Match the filters against the benchmark's full name suite/name/parameters: */
+	std::string fullName=benchmark->getSuite();
+	fullName.push_back('/');
+	fullName.append(benchmark->getName());
+	if(!benchmark->getParameters().empty())
+		{
+		fullName.push_back('/');
+		fullName.append(benchmark->getParameters());
+		}
+	for(std::vector<std::string>::const_iterator fIt=filters.begin();fIt!=filters.end();++fIt)
+		if(fullName.find(*fIt)!=std::string::npos)
+			return true;
+	return false;
+	}
+
+void BenchmarkRunner::writeHeader(FILE* file) const
+	{
+	/* Identify the result format and the benchmark program: */
+	fprintf(file,"# Vrui benchmark results\n");
+	fprintf(file,"# format\t1\n");
+	fprintf(file,"# program\t%s\n",programName.c_str());
+	int vruiVersion=BENCHMARKS_VRUIVERSION;
+	fprintf(file,"# vruiVersion\t%d.%d-%03d\n",vruiVersion/1000000,(vruiVersion/1000)%1000,vruiVersion%1000);
+	
+	/* Describe the host: */
+	struct utsname hostInfo;
+	if(uname(&hostInfo)==0)
+		{
+		fprintf(file,"# host\t%s\n",hostInfo.nodename);
+		fprintf(file,"# system\t%s %s %s\n",hostInfo.sysname,hostInfo.release,hostInfo.machine);
+		}
+	std::string cpuModel=getCpuModel();
+	if(!cpuModel.empty())
+		fprintf(file,"# cpuModel\t%s\n",cpuModel.c_str());
+	fprintf(file,"# numCpus\t%ld\n",sysconf(_SC_NPROCESSORS_ONLN));
+	
+	/* Describe the build: */
+	#ifdef __VERSION__
+	fprintf(file,"# compiler\t%s\n",__VERSION__);
+	#endif
+	fprintf(file,"# lockProfiling\t%d\n",THREADS_CONFIG_PROFILE_LOCKS);
+	
+	/* Describe the run: */
+	time_t now=time(0);
+	char dateString[64];
+	strftime(dateString,sizeof(dateString),"%Y-%m-%dT%H:%M:%SZ",gmtime(&now));
+	fprintf(file,"# date\t%s\n",dateString);
+	fprintf(file,"# minTime\t%g\n",minTime);
+	fprintf(file,"# numRuns\t%u\n",numRuns);
+	
+	/* Write the column names: */
+	fprintf(file,"suite\tbenchmark\tparameters\tmetric\tvalue\tunit\n");
+	}
+
+void BenchmarkRunner::runBenchmark(Benchmark* benchmark,FILE* file)
+	{
+	if(verbose)
+		fprintf(stderr,"Running %s/%s %s...",benchmark->getSuite().c_str(),benchmark->getName().c_str(),benchmark->getParameters().c_str());
+	
+	benchmark->setup();
+	
+	/* Find a number of iterations that takes at least the minimum run time; the calibration runs double as warm-up: */
+	size_t numIterations=1;
+	while(true)
+		{
+		benchmark->clearMetrics();
+		double start=getTime();
+		benchmark->run(numIterations);
+		double elapsed=getTime()-start;
+		if(elapsed>=minTime)
+			break;
+		
+		/* Extrapolate the number of iterations from the elapsed time, with some safety margin: */
+		size_t newNumIterations=numIterations*100;
+		if(elapsed>minTime*0.01)
+			newNumIterations=size_t(double(numIterations)*minTime*1.2/elapsed)+1;
+		if(newNumIterations<=numIterations)
+			newNumIterations=numIterations+1;
+		numIterations=newNumIterations;
+		}
+	
+	/* Time the requested number of runs: */
+	std::vector<double> times;
+	times.reserve(numRuns);
+	for(unsigned int run=0;run<numRuns;++run)
+		{
+		benchmark->clearMetrics();
+		double start=getTime();
+		benchmark->run(numIterations);
+		times.push_back(getTime()-start);
+		}
+	
+	benchmark->teardown();
+	
+	/* Calculate the median and minimum time per operation: */
+	std::sort(times.begin(),times.end());
+	double median=times[times.size()/2];
+	if(times.size()%2==0)
+		median=(median+times[times.size()/2-1])*0.5;
+	double numOperations=double(numIterations)*benchmark->getNumOperations();
+	
+	/* Write the results: */
+	writeResult(file,benchmark,"median",median*1.0e9/numOperations,"ns/op");
+	writeResult(file,benchmark,"min",times.front()*1.0e9/numOperations,"ns/op");
+	if(benchmark->getNumBytes()>0.0)
+		writeResult(file,benchmark,"throughput",double(numIterations)*benchmark->getNumBytes()/(median*1024.0*1024.0),"MB/s");
+	const std::vector<Benchmark::Metric>& metrics=benchmark->getMetrics();
+	for(std::vector<Benchmark::Metric>::const_iterator mIt=metrics.begin();mIt!=metrics.end();++mIt)
+		writeResult(file,benchmark,mIt->name.c_str(),mIt->value,mIt->unit.c_str());
+	fflush(file);
+	
+	if(verbose)
+		fprintf(stderr," %.6g ns/op\n",median*1.0e9/numOperations);
+	}
+
+BenchmarkRunner::BenchmarkRunner(const char* sProgramName)
+	:programName(sProgramName),
+	 minTime(0.2),numRuns(5),
+	 appendOutput(false),listOnly(false),verbose(true)
+	{
+	/* Strip the directory from the program name: */
+	std::string::size_type slashPos=programName.rfind('/');
+	if(slashPos!=std::string::npos)
+		programName.erase(0,slashPos+1);
+	}
+
+BenchmarkRunner::~BenchmarkRunner(void)
+	{
+	for(std::vector<Benchmark*>::iterator bIt=benchmarks.begin();bIt!=benchmarks.end();++bIt)
+		delete *bIt;
+	}
+
+double BenchmarkRunner::getTime(void)
+	{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return double(now.tv_sec)+double(now.tv_nsec)*1.0e-9;
+	}
+
+bool BenchmarkRunner::parseCommandLine(int argc,char* argv[])
+	{
+	bool printUsage=false;
+	for(int i=1;i<argc&&!printUsage;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i],"-filter")==0&&i+1<argc)
+				{
+				++i;
+				filters.push_back(argv[i]);
+				}
+			else if(strcasecmp(argv[i],"-minTime")==0&&i+1<argc)
+				{
+				++i;
+				minTime=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i],"-runs")==0&&i+1<argc)
+				{
+				++i;
+				numRuns=atoi(argv[i]);
+				if(numRuns<1)
+					numRuns=1;
+				}
+			else if(strcasecmp(argv[i],"-output")==0&&i+1<argc)
+				{
+				++i;
+				outputFileName=argv[i];
+				}
+			else if(strcasecmp(argv[i],"-append")==0)
+				appendOutput=true;
+			else if(strcasecmp(argv[i],"-list")==0)
+				listOnly=true;
+			else if(strcasecmp(argv[i],"-quiet")==0)
+				verbose=false;
+			else
+				printUsage=true;
+			}
+		else
+			filters.push_back(argv[i]);
+		}
+	
+	if(printUsage)
+		{
+		fprintf(stderr,"Usage: %s [-filter <substring>] [-minTime <seconds>] [-runs <numRuns>] [-output <file name>] [-append] [-list] [-quiet] [<substring> ...]\n",programName.c_str());
+		fprintf(stderr,"  Runs all benchmarks whose suite/benchmark/parameters name contains any of the given substrings, or all benchmarks if none are given\n");
+		return false;
+		}
+	
+	return true;
+	}
+
+void BenchmarkRunner::addBenchmark(Benchmark* newBenchmark)
+	{
+	benchmarks.push_back(newBenchmark);
+	}
+
+int BenchmarkRunner::run(void)
+	{
+	if(listOnly)
+		{
+		/* Print the names of all selected benchmarks: */
+		for(std::vector<Benchmark*>::iterator bIt=benchmarks.begin();bIt!=benchmarks.end();++bIt)
+			if(isSelected(*bIt))
+				printf("%s\t%s\t%s\n",(*bIt)->getSuite().c_str(),(*bIt)->getName().c_str(),(*bIt)->getParameters().empty()?"-":(*bIt)->getParameters().c_str());
+		return 0;
+		}
+	
+	/* Open the output file: */
+	FILE* file=stdout;
+	bool writeFileHeader=true;
+	if(!outputFileName.empty())
+		{
+		if(appendOutput)
+			{
+			/* Only write a header if the file is new or empty: */
+			file=fopen(outputFileName.c_str(),"at");
+			writeFileHeader=file!=0&&ftell(file)==0;
+			}
+		else
+			file=fopen(outputFileName.c_str(),"wt");
+		if(file==0)
+			{
+			fprintf(stderr,"%s: Unable to open output file %s\n",programName.c_str(),outputFileName.c_str());
+			return 1;
+			}
+		}
+	if(writeFileHeader)
+		writeHeader(file);
+	
+	/* Run all selected benchmarks, and skip benchmarks that fail: */
+	int result=0;
+	for(std::vector<Benchmark*>::iterator bIt=benchmarks.begin();bIt!=benchmarks.end();++bIt)
+		if(isSelected(*bIt))
+			{
+			try
+				{
+				runBenchmark(*bIt,file);
+				}
+			catch(std::runtime_error err)
+				{
+				fprintf(stderr,"\n%s: Benchmark %s/%s %s failed due to exception %s\n",programName.c_str(),(*bIt)->getSuite().c_str(),(*bIt)->getName().c_str(),(*bIt)->getParameters().c_str(),err.what());
+				result=1;
+				}
+			}
+	
+	if(file!=stdout)
+		fclose(file);
+	
+	return result;
+	}
@@ -0,0 +1,70 @@
+/***********************************************************************
+BenchmarkRunner - Class to select, calibrate, and run a set of
+micro-benchmarks, and to write their results in a tab-separated format
+that can be compared between Vrui releases built on the same machine.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef BENCHMARKRUNNER_INCLUDED
+#define BENCHMARKRUNNER_INCLUDED
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/* Forward declarations: */
+class Benchmark;
+
+class BenchmarkRunner
+	{
+	/* Elements: */
+	private:
+	std::string programName; // Name of the benchmark program
+	std::vector<Benchmark*> benchmarks; // List of registered benchmarks
+	std::vector<std::string> filters; // List of substrings of which benchmark names have to contain at least one to be run; runs all benchmarks if empty
+	double minTime; // Minimum duration of a timed run in seconds
+	unsigned int numRuns; // Number of timed runs of each benchmark
+	std::string outputFileName; // Name of file to which to write results; writes to stdout if empty
+	bool appendOutput; // Flag whether to append results to an existing output file
+	bool listOnly; // Flag whether to list the selected benchmarks instead of running them
+	bool verbose; // Flag whether to print progress messages to stderr
+	
+	/* Private methods: */
+	bool isSelected(const Benchmark* benchmark) const; // Returns true if the given benchmark passes the benchmark filters
+	void writeHeader(FILE* file) const; // Writes a header describing the benchmark host and build
+	void runBenchmark(Benchmark* benchmark,FILE* file); // Calibrates and runs the given benchmark and writes its results
+	
+	/* Constructors and destructors: */
+	public:
+	BenchmarkRunner(const char* sProgramName); // Creates a benchmark runner for the benchmark program of the given name
+	private:
+	BenchmarkRunner(const BenchmarkRunner& source); // Prohibit copy constructor
+	BenchmarkRunner& operator=(const BenchmarkRunner& source); // Prohibit assignment operator
+	public:
+	~BenchmarkRunner(void); // Destroys the runner and all registered benchmarks
+	
+	/* Methods: */
+	static double getTime(void); // Returns the current time on a monotonic clock in seconds
+	bool parseCommandLine(int argc,char* argv[]); // Reads runner options from the given command line; prints usage and returns false on errors or if help was requested
+	void addBenchmark(Benchmark* newBenchmark); // Registers a benchmark; runner inherits the benchmark object
+	int run(void); // Runs all selected benchmarks; returns the program's exit code
+	};
+
+#endif
@@ -0,0 +1,243 @@
+/***********************************************************************
+CompareBenchmarks - Utility to compare two benchmark result files
+written by the Vrui benchmark programs, e.g., results of two Vrui
+releases measured on the same machine, and to flag regressions.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+struct ResultFile // Structure holding the contents of a benchmark result file
+	{
+	/* Embedded classes: */
+	public:
+	struct Result // Structure for a single measured value
+		{
+		/* Elements: */
+		public:
+		double value; // Measured value
+		std::string unit; // Unit of measured value
+		};
+	
+	typedef std::map<std::string,Result> ResultMap; // Map from result keys to measured values
+	
+	/* Elements: */
+	std::map<std::string,std::string> properties; // Header properties, such as Vrui version, host, and CPU model
+	std::vector<std::string> keys; // Result keys in file order
+	ResultMap results; // Map of results
+	};
+
+bool splitLine(char* line,char* fields[],int numFields) // Splits a tab-separated line into the given number of fields; returns false if the line has too few fields
+	{
+	/* Strip the line terminator: */
+	size_t len=strlen(line);
+	while(len>0&&(line[len-1]=='\n'||line[len-1]=='\r'))
+		line[--len]='\0';
+	
+	/* Split the line at tabs: */
+	char* fPtr=line;
+	for(int i=0;i<numFields;++i)
+		{
+		fields[i]=fPtr;
+		if(i<numFields-1)
+			{
+			char* tab=strchr(fPtr,'\t');
+			if(tab==0)
+				return false;
+			*tab='\0';
+			fPtr=tab+1;
+			}
+		}
+	return true;
+	}
+
+bool readResultFile(const char* fileName,ResultFile& resultFile) // Reads a benchmark result file; returns false if the file could not be read
+	{
+	FILE* file=fopen(fileName,"rt");
+	if(file==0)
+		{
+		fprintf(stderr,"CompareBenchmarks: Unable to open result file %s\n",fileName);
+		return false;
+		}
+	
+	char line[4096];
+	while(fgets(line,sizeof(line),file)!=0)
+		{
+		if(line[0]=='#')
+			{
+			/* Parse a header property: */
+			char* fields[2];
+			if(splitLine(line+2,fields,2))
+				resultFile.properties[fields[0]]=fields[1];
+			}
+		else
+			{
+			/* Parse a result line, skipping column headers repeated by appended runs: */
+			char* fields[6];
+			if(splitLine(line,fields,6)&&strcmp(fields[0],"suite")!=0)
+				{
+				std::string key=std::string(fields[0])+'\t'+fields[1]+'\t'+fields[2]+'\t'+fields[3];
+				if(resultFile.results.find(key)==resultFile.results.end())
+					resultFile.keys.push_back(key);
+				ResultFile::Result& result=resultFile.results[key];
+				result.value=atof(fields[4]);
+				result.unit=fields[5];
+				}
+			}
+		}
+	
+	fclose(file);
+	return true;
+	}
+
+bool isHigherBetter(const std::string& unit) // Returns true if larger values of the given unit indicate better performance
+	{
+	/* Rates, ratios, and percentages are better when larger; times and counts are better when smaller: */
+	return (unit.size()>=2&&unit.compare(unit.size()-2,2,"/s")==0)||unit=="x"||unit=="%";
+	}
+
+std::string getProperty(const ResultFile& resultFile,const char* name) // Returns a header property of a result file
+	{
+	std::map<std::string,std::string>::const_iterator pIt=resultFile.properties.find(name);
+	return pIt!=resultFile.properties.end()?pIt->second:std::string("unknown");
+	}
+
+void printUsage(void)
+	{
+	fprintf(stderr,"Usage: CompareBenchmarks [-threshold <percent>] [-metric <metric name>] [-all] <baseline result file> <current result file>\n");
+	fprintf(stderr,"  -threshold <percent>  Relative change beyond which a result is flagged; default 5\n");
+	fprintf(stderr,"  -metric <metric name> Only compares results of the given metric; default median and all non-timing metrics\n");
+	fprintf(stderr,"  -all                  Compares all metrics, including minimum times\n");
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	double threshold=5.0;
+	const char* metricName=0;
+	bool allMetrics=false;
+	const char* fileNames[2]={0,0};
+	int numFileNames=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"threshold")==0&&i+1<argc)
+				threshold=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"metric")==0&&i+1<argc)
+				metricName=argv[++i];
+			else if(strcasecmp(argv[i]+1,"all")==0)
+				allMetrics=true;
+			else
+				{
+				printUsage();
+				return 1;
+				}
+			}
+		else if(numFileNames<2)
+			fileNames[numFileNames++]=argv[i];
+		else
+			{
+			printUsage();
+			return 1;
+			}
+		}
+	if(numFileNames<2)
+		{
+		printUsage();
+		return 1;
+		}
+	
+	/* Read both result files: */
+	ResultFile files[2];
+	for(int i=0;i<2;++i)
+		if(!readResultFile(fileNames[i],files[i]))
+			return 1;
+	
+	/* Warn if the results were not measured on comparable machines: */
+	printf("# baseline\t%s\tVrui %s\t%s\n",fileNames[0],getProperty(files[0],"vruiVersion").c_str(),getProperty(files[0],"host").c_str());
+	printf("# current\t%s\tVrui %s\t%s\n",fileNames[1],getProperty(files[1],"vruiVersion").c_str(),getProperty(files[1],"host").c_str());
+	static const char* machineProperties[]={"host","cpuModel","numCpus","lockProfiling"};
+	for(int i=0;i<4;++i)
+		if(getProperty(files[0],machineProperties[i])!=getProperty(files[1],machineProperties[i]))
+			fprintf(stderr,"CompareBenchmarks: Warning: results differ in %s; comparison may not be meaningful\n",machineProperties[i]);
+	
+	/* Compare all results present in both files: */
+	printf("suite\tbenchmark\tparameters\tmetric\tbaseline\tcurrent\tunit\tchange\tstatus\n");
+	unsigned int numCompared=0;
+	unsigned int numRegressions=0;
+	unsigned int numImprovements=0;
+	unsigned int numUnmatched=0;
+	for(std::vector<std::string>::const_iterator kIt=files[1].keys.begin();kIt!=files[1].keys.end();++kIt)
+		{
+		/* Check if the result's metric is selected: */
+		std::string metric=kIt->substr(kIt->rfind('\t')+1);
+		if(metricName!=0)
+			{
+			if(metric!=metricName)
+				continue;
+			}
+		else if(!allMetrics&&metric=="min")
+			continue;
+		
+		/* Find the matching baseline result: */
+		ResultFile::ResultMap::const_iterator bIt=files[0].results.find(*kIt);
+		if(bIt==files[0].results.end())
+			{
+			++numUnmatched;
+			continue;
+			}
+		const ResultFile::Result& baseline=bIt->second;
+		const ResultFile::Result& current=files[1].results.find(*kIt)->second;
+		
+		/* Calculate the relative change, positive meaning better: */
+		double change=0.0;
+		if(baseline.value!=0.0)
+			{
+			if(isHigherBetter(current.unit))
+				change=(current.value-baseline.value)*100.0/baseline.value;
+			else
+				change=(baseline.value-current.value)*100.0/baseline.value;
+			}
+		const char* status="ok";
+		if(change<-threshold)
+			{
+			status="REGRESSION";
+			++numRegressions;
+			}
+		else if(change>threshold)
+			{
+			status="improved";
+			++numImprovements;
+			}
+		++numCompared;
+		
+		printf("%s\t%g\t%g\t%s\t%+.1f%%\t%s\n",kIt->c_str(),baseline.value,current.value,current.unit.c_str(),change,status);
+		}
+	
+	fprintf(stderr,"CompareBenchmarks: %u results compared, %u regressions, %u improvements beyond %g%%; %u results without baseline\n",numCompared,numRegressions,numImprovements,threshold,numUnmatched);
+	
+	return numRegressions>0?2:0;
+	}
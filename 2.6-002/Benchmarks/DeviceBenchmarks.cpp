@@ -0,0 +1,514 @@
+/***********************************************************************
+DeviceBenchmarks - Micro-benchmarks for the per-sample tracker filters
+and calibrators and the DTrack message parser of the VR device driver
+daemon.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <Misc/StringPrintf.h>
+#include <Misc/ConfigurationFile.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <VRDeviceDaemon/VRFilter.h>
+#include <VRDeviceDaemon/VRCalibrator.h>
+#include <VRDeviceDaemon/VRDevices/ArtDTrackParser.h>
+
+#include "Benchmark.h"
+#include "BenchmarkRunner.h"
+
+/* Forward declarations: */
+template <class BaseClassParam>
+class VRFactory;
+template <class BaseClassParam>
+class VRFactoryManager;
+
+/*******************************************************************
+Object creation/destruction functions of the statically linked
+filter and calibrator plug-ins:
+*******************************************************************/
+
+extern "C" VRFilter* createObjectOneEuroFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectOneEuroFilter(VRFilter* filter,VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager);
+extern "C" VRFilter* createObjectKalmanFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectKalmanFilter(VRFilter* filter,VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager);
+extern "C" VRFilter* createObjectDoubleExponentialFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectDoubleExponentialFilter(VRFilter* filter,VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager);
+extern "C" VRCalibrator* createObjectGridCalibrator(VRFactory<VRCalibrator>* factory,VRFactoryManager<VRCalibrator>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectGridCalibrator(VRCalibrator* calibrator,VRFactory<VRCalibrator>* factory,VRFactoryManager<VRCalibrator>* factoryManager);
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef Vrui::VRDeviceState::TrackerState TrackerState;
+typedef TrackerState::PositionOrientation PositionOrientation;
+typedef PositionOrientation::Scalar Scalar;
+typedef PositionOrientation::Point Point;
+typedef PositionOrientation::Vector Vector;
+typedef PositionOrientation::Rotation Rotation;
+typedef Vrui::VRDeviceState::TimeStamp TimeStamp;
+
+class RandomSource // Simple deterministic pseudo-random number generator to create reproducible inputs
+	{
+	/* Elements: */
+	private:
+	Misc::UInt32 state; // Generator state
+	
+	/* Constructors and destructors: */
+	public:
+	RandomSource(Misc::UInt32 sState =1)
+		:state(sState)
+		{
+		}
+	
+	/* Methods: */
+	Scalar operator()(void) // Returns a number uniformly distributed in [0, 1)
+		{
+		state=state*1664525U+1013904223U;
+		return Scalar(double(state>>8)/16777216.0);
+		}
+	};
+
+void createTrajectory(size_t numSamples,const Point& center,Scalar radius,std::vector<TrackerState>& samples) // Creates a noisy circular tracker trajectory
+	{
+	RandomSource random;
+	samples.clear();
+	samples.reserve(numSamples);
+	for(size_t i=0;i<numSamples;++i)
+		{
+		Scalar angle=Scalar(2)*Math::Constants<Scalar>::pi*Scalar(i)/Scalar(numSamples);
+		Vector noise(random()-Scalar(0.5),random()-Scalar(0.5),random()-Scalar(0.5));
+		Point p=center+Vector(Math::cos(angle),Math::sin(angle),Scalar(0))*radius+noise*(radius*Scalar(0.01));
+		Rotation r=Rotation::rotateZ(angle)*Rotation::rotateX(noise[0]*Scalar(0.02));
+		TrackerState state;
+		state.positionOrientation=PositionOrientation(p-Point::origin,r);
+		state.linearVelocity=Vector::zero;
+		state.angularVelocity=Vector::zero;
+		samples.push_back(state);
+		}
+	}
+
+class ConfigurationFixture // Class to create a configuration file for plug-in objects
+	{
+	/* Elements: */
+	private:
+	std::string fileName; // Name of the temporary configuration file
+	
+	/* Constructors and destructors: */
+	public:
+	ConfigurationFixture(const std::string& sFileName,const std::string& sectionContents)
+		:fileName(sFileName)
+		{
+		std::string contents="section Benchmark\n";
+		contents.append(sectionContents);
+		contents.append("endsection\n");
+		IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly);
+		file->writeRaw(contents.data(),contents.size());
+		}
+	~ConfigurationFixture(void)
+		{
+		unlink(fileName.c_str());
+		}
+	
+	/* Methods: */
+	const std::string& getFileName(void) const // Returns the configuration file's name
+		{
+		return fileName;
+		}
+	};
+
+/*************************
+Tracker filter benchmarks:
+*************************/
+
+class FilterBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	public:
+	typedef VRFilter* (*CreateFunction)(VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*,Misc::ConfigurationFile&);
+	typedef void (*DestroyFunction)(VRFilter*,VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*);
+	
+	/* Elements: */
+	private:
+	CreateFunction createFunction; // Function to create the measured filter
+	DestroyFunction destroyFunction; // Function to destroy the measured filter
+	std::string filterSettings; // Configuration file settings for the filter
+	std::vector<TrackerState> samples; // Raw tracker samples fed into the filter
+	VRFilter* filter; // The measured filter
+	TimeStamp timeStamp; // Time stamp of the next fed sample in microseconds
+	
+	/* Constructors and destructors: */
+	public:
+	FilterBenchmark(const char* sName,const char* sParameters,const char* sFilterSettings,CreateFunction sCreateFunction,DestroyFunction sDestroyFunction)
+		:Benchmark("VRDeviceDaemon",sName,sParameters),
+		 createFunction(sCreateFunction),destroyFunction(sDestroyFunction),
+		 filterSettings(sFilterSettings),
+		 filter(0),timeStamp(0)
+		{
+		createTrajectory(1024,Point(0,0,60),Scalar(20),samples);
+		numOperations=double(samples.size());
+		}
+	virtual ~FilterBenchmark(void)
+		{
+		if(filter!=0)
+			(*destroyFunction)(filter,0,0);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		/* Create the filter from a temporary configuration file: */
+		ConfigurationFixture fixture(getTempFileName(".cfg"),filterSettings);
+		Misc::ConfigurationFile configFile(fixture.getFileName().c_str());
+		configFile.setCurrentSection("/Benchmark");
+		filter=(*createFunction)(0,0,configFile);
+		filter->setNumTrackers(1);
+		}
+	virtual void run(size_t numIterations)
+		{
+		Scalar result(0);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(std::vector<TrackerState>::const_iterator sIt=samples.begin();sIt!=samples.end();++sIt)
+				{
+				/* Feed the next sample at 120Hz: */
+				TrackerState state=*sIt;
+				timeStamp+=TimeStamp(8333);
+				result+=filter->filter(0,state,timeStamp).positionOrientation.getOrigin()[0];
+				}
+		sink=size_t(result);
+		}
+	virtual void teardown(void)
+		{
+		(*destroyFunction)(filter,0,0);
+		filter=0;
+		}
+	};
+
+/*****************************
+Tracker calibrator benchmarks:
+*****************************/
+
+class GridCalibratorBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	int gridSize; // Number of calibration grid vertices in each dimension
+	int lookupGridSize; // Number of lookup grid vertices in each dimension, or zero to evaluate the calibration grid exactly
+	std::vector<TrackerState> samples; // Raw tracker samples
+	std::string calibrationFileName; // Name of the temporary calibration data file
+	VRCalibrator* calibrator; // The measured calibrator
+	double setupTime; // Time taken to load the calibration grid and build the lookup grid
+	
+	/* Private methods: */
+	void createCalibrationFile(void) // Writes a calibration grid with smoothly varying, slightly distorted vertex positions and offsets
+		{
+		IO::FilePtr file=IO::openFile(calibrationFileName.c_str(),IO::File::WriteOnly);
+		file->setEndianness(Misc::LittleEndian);
+		for(int i=0;i<3;++i)
+			file->write<int>(gridSize);
+		Scalar cellSize=Scalar(120)/Scalar(gridSize-1);
+		for(int x=0;x<gridSize;++x)
+			for(int y=0;y<gridSize;++y)
+				for(int z=0;z<gridSize;++z)
+					{
+					/* Write the vertex position: */
+					float pos[3];
+					pos[0]=float(Scalar(x)*cellSize-Scalar(60)+Math::sin(Scalar(y)*Scalar(0.3))*cellSize*Scalar(0.1));
+					pos[1]=float(Scalar(y)*cellSize-Scalar(60)+Math::sin(Scalar(z)*Scalar(0.3))*cellSize*Scalar(0.1));
+					pos[2]=float(Scalar(z)*cellSize+Math::sin(Scalar(x)*Scalar(0.3))*cellSize*Scalar(0.1));
+					file->write(pos,3);
+					
+					/* Write the unused raw orientation: */
+					float quat[4]={0.0f,0.0f,0.0f,1.0f};
+					file->write(quat,4);
+					
+					/* Write the position and orientation offsets: */
+					float offsets[6];
+					offsets[0]=float(Math::sin(Scalar(x)*Scalar(0.2))*Scalar(0.5));
+					offsets[1]=float(Math::cos(Scalar(y)*Scalar(0.2))*Scalar(0.5));
+					offsets[2]=float(Math::sin(Scalar(z)*Scalar(0.2))*Scalar(0.5));
+					offsets[3]=float(Math::sin(Scalar(x+y)*Scalar(0.1))*Scalar(0.01));
+					offsets[4]=float(Math::cos(Scalar(y+z)*Scalar(0.1))*Scalar(0.01));
+					offsets[5]=float(Math::sin(Scalar(z+x)*Scalar(0.1))*Scalar(0.01));
+					file->write(offsets,6);
+					}
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	GridCalibratorBenchmark(int sGridSize,int sLookupGridSize)
+		:Benchmark("VRDeviceDaemon","GridCalibrator",sLookupGridSize>=2?Misc::stringPrintf("grid=%d,lookup=%d",sGridSize,sLookupGridSize):Misc::stringPrintf("grid=%d,lookup=none",sGridSize)),
+		 gridSize(sGridSize),lookupGridSize(sLookupGridSize),
+		 calibrator(0),setupTime(0.0)
+		{
+		createTrajectory(1024,Point(0,0,60),Scalar(40),samples);
+		numOperations=double(samples.size());
+		}
+	virtual ~GridCalibratorBenchmark(void)
+		{
+		if(calibrator!=0)
+			destroyObjectGridCalibrator(calibrator,0,0);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		/* Create the calibration data file: */
+		calibrationFileName=getTempFileName(".dat");
+		createCalibrationFile();
+		
+		/* Create the calibrator from a temporary configuration file: */
+		std::string settings=Misc::stringPrintf("calibrationFileName %s\n",calibrationFileName.c_str());
+		settings.append(Misc::stringPrintf("lookupGridSize (%d, %d, %d)\n",lookupGridSize,lookupGridSize,lookupGridSize));
+		settings.append("lookupPositionTolerance 1.0\nlookupOrientationTolerance 1.0\n");
+		ConfigurationFixture fixture(getTempFileName(".cfg"),settings);
+		Misc::ConfigurationFile configFile(fixture.getFileName().c_str());
+		configFile.setCurrentSection("/Benchmark");
+		double start=BenchmarkRunner::getTime();
+		calibrator=createObjectGridCalibrator(0,0,configFile);
+		setupTime=BenchmarkRunner::getTime()-start;
+		calibrator->setNumTrackers(1);
+		}
+	virtual void run(size_t numIterations)
+		{
+		Scalar result(0);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(std::vector<TrackerState>::const_iterator sIt=samples.begin();sIt!=samples.end();++sIt)
+				{
+				TrackerState state=*sIt;
+				result+=calibrator->calibrate(0,state).positionOrientation.getOrigin()[0];
+				}
+		sink=size_t(result);
+		}
+	virtual void teardown(void)
+		{
+		addMetric("setup",setupTime*1.0e3,"ms");
+		destroyObjectGridCalibrator(calibrator,0,0);
+		calibrator=0;
+		unlink(calibrationFileName.c_str());
+		}
+	};
+
+/********************************
+DTrack message parser benchmarks:
+********************************/
+
+class DTrackParserBenchmark:public Benchmark
+	{
+	private:
+	static const size_t maxMessageSize=8192; // Maximum size of a replayed message
+	
+	/* Elements: */
+	bool binary; // Flag whether the replayed messages are in binary format
+	std::vector<std::string> messages; // Hand-written messages replayed by the benchmark
+	ArtDTrackParser* parser; // The measured parser
+	char* messageBuffer; // Buffer receiving messages before parsing, with room for the parser's sentinel characters
+	
+	/* Private methods: */
+	static void appendAsciiBody(std::string& message,int id,const Point& pos) // Appends a 6d body record to an ASCII message
+		{
+		message.append(Misc::stringPrintf("[%d 1.000][%.3f %.3f %.3f 0.0 0.0 90.0]",id,double(pos[0]),double(pos[1]),double(pos[2])));
+		message.append("[0.000 1.000 0.000 -1.000 0.000 0.000 0.000 0.000 1.000]");
+		}
+	template <class DataParam>
+	static void appendBinary(std::string& message,DataParam value) // Appends a value to a binary message in DTrack's little-endian byte order
+		{
+		#if __BYTE_ORDER==__BIG_ENDIAN
+		Misc::swapEndianness(value);
+		#endif
+		message.append(reinterpret_cast<const char*>(&value),sizeof(DataParam));
+		}
+	static void appendBinaryBody(std::string& message,unsigned int id,const Point& pos) // Appends a body record to a binary message
+		{
+		appendBinary<unsigned int>(message,id);
+		appendBinary<float>(message,1.0f);
+		for(int i=0;i<3;++i)
+			appendBinary<float>(message,float(pos[i]));
+		float angles[3]={0.0f,0.0f,90.0f};
+		for(int i=0;i<3;++i)
+			appendBinary<float>(message,angles[i]);
+		float matrix[9]={0.0f,1.0f,0.0f,-1.0f,0.0f,0.0f,0.0f,0.0f,1.0f};
+		for(int i=0;i<9;++i)
+			appendBinary<float>(message,matrix[i]);
+		}
+	void createAsciiMessages(void) // Creates the replayed ASCII messages
+		{
+		Point p[5]={Point(326.848,-187.216,109.231),Point(12.5,-3.25,1500.0),Point(-410.0,220.5,980.75),Point(1.0,2.0,3.0),Point(4.0,5.0,6.0)};
+		
+		/* A complete frame with two 6d bodies and one 6df2 flystick pressing its second button: */
+		std::string m="fr 21753\n6d 2 ";
+		appendAsciiBody(m,0,p[0]);
+		appendAsciiBody(m,1,p[1]);
+		m.append("\n6df2 1 1 [0 1.000 2 1][-410.000 220.500 980.750][0.000 1.000 0.000 -1.000 0.000 0.000 0.000 0.000 1.000][2 0.500]\n");
+		messages.push_back(m);
+		
+		/* A frame with body IDs that are negative or not configured: */
+		m="fr 21754\n6d 3 ";
+		appendAsciiBody(m,5,p[3]);
+		appendAsciiBody(m,-1,p[4]);
+		appendAsciiBody(m,1,p[1]);
+		m.push_back('\n');
+		messages.push_back(m);
+		
+		/* A frame truncated in the middle of its second body: */
+		m="fr 21755\n6d 2 ";
+		appendAsciiBody(m,0,p[0]);
+		m.append("[1 1.000][12.500 -3");
+		messages.push_back(m);
+		
+		/* A frame reporting the same bodies repeatedly: */
+		m="fr 21756\n6d 5 ";
+		for(int i=0;i<5;++i)
+			appendAsciiBody(m,i%2,p[i]);
+		m.push_back('\n');
+		messages.push_back(m);
+		}
+	void createBinaryMessages(void) // Creates the replayed binary messages
+		{
+		Point p[5]={Point(326.848,-187.216,109.231),Point(12.5,-3.25,1500.0),Point(-410.0,220.5,980.75),Point(1.0,2.0,3.0),Point(4.0,5.0,6.0)};
+		
+		/* A complete frame with three bodies: */
+		std::string m;
+		appendBinary<unsigned int>(m,21753U);
+		appendBinary<int>(m,3);
+		for(int i=0;i<3;++i)
+			appendBinaryBody(m,i,p[i]);
+		messages.push_back(m);
+		
+		/* A frame with body IDs that are out of range: */
+		m.clear();
+		appendBinary<unsigned int>(m,21754U);
+		appendBinary<int>(m,3);
+		appendBinaryBody(m,7U,p[3]);
+		appendBinaryBody(m,0xffffffffU,p[4]);
+		appendBinaryBody(m,2U,p[2]);
+		messages.push_back(m);
+		
+		/* A frame claiming more bodies than it contains, truncated in the middle of its third body: */
+		m.clear();
+		appendBinary<unsigned int>(m,21755U);
+		appendBinary<int>(m,1000);
+		for(int i=0;i<3;++i)
+			appendBinaryBody(m,i,p[i]);
+		m.resize(m.size()-20);
+		messages.push_back(m);
+		
+		/* A frame reporting the first bodies repeatedly: */
+		m.clear();
+		appendBinary<unsigned int>(m,21756U);
+		appendBinary<int>(m,5);
+		for(int i=0;i<5;++i)
+			appendBinaryBody(m,i%3,p[i]);
+		messages.push_back(m);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	DTrackParserBenchmark(bool sBinary)
+		:Benchmark("VRDeviceDaemon","ArtDTrackParser",sBinary?"format=binary":"format=ascii"),
+		 binary(sBinary),
+		 parser(0),messageBuffer(new char[maxMessageSize+2])
+		{
+		if(binary)
+			createBinaryMessages();
+		else
+			createAsciiMessages();
+		numOperations=double(messages.size());
+		}
+	virtual ~DTrackParserBenchmark(void)
+		{
+		delete parser;
+		delete[] messageBuffer;
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		/* Configure two 6d bodies and a 6df2 flystick with two buttons and one valuator: */
+		ArtDTrackParser::Device devices[3];
+		for(int i=0;i<3;++i)
+			{
+			devices[i].reportFormat=i<2?ArtDTrackParser::DRF_6D:ArtDTrackParser::DRF_6DF2;
+			devices[i].id=i<2?i:0;
+			devices[i].numButtons=i<2?0:2;
+			devices[i].firstButtonIndex=0;
+			devices[i].numValuators=i<2?0:1;
+			devices[i].firstValuatorIndex=0;
+			}
+		parser=new ArtDTrackParser(3,devices);
+		}
+	virtual void run(size_t numIterations)
+		{
+		int result=0;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(std::vector<std::string>::const_iterator mIt=messages.begin();mIt!=messages.end();++mIt)
+				{
+				/* Copy the message into the receive buffer, as the driver receives it: */
+				memcpy(messageBuffer,mIt->data(),mIt->size());
+				if(binary)
+					parser->parseBinaryMessage(messageBuffer,mIt->size());
+				else
+					parser->parseAsciiMessage(messageBuffer,mIt->size());
+				result+=parser->getNumFrameTrackers();
+				}
+		sink=size_t(result);
+		}
+	virtual void teardown(void)
+		{
+		delete parser;
+		parser=0;
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	BenchmarkRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Tracker filters: */
+	runner.addBenchmark(new FilterBenchmark("OneEuroFilter","op=filter","",createObjectOneEuroFilter,destroyObjectOneEuroFilter));
+	runner.addBenchmark(new FilterBenchmark("KalmanFilter","op=filter","",createObjectKalmanFilter,destroyObjectKalmanFilter));
+	runner.addBenchmark(new FilterBenchmark("DoubleExponentialFilter","op=filter","",createObjectDoubleExponentialFilter,destroyObjectDoubleExponentialFilter));
+	runner.addBenchmark(new FilterBenchmark("DoubleExponentialFilter","op=filter,predictionTime=0.01","predictionTime 0.01\n",createObjectDoubleExponentialFilter,destroyObjectDoubleExponentialFilter));
+	
+	/* Tracker calibrators: */
+	runner.addBenchmark(new GridCalibratorBenchmark(16,0));
+	runner.addBenchmark(new GridCalibratorBenchmark(16,64));
+	
+	/* DTrack message parser: */
+	runner.addBenchmark(new DTrackParserBenchmark(false));
+	runner.addBenchmark(new DTrackParserBenchmark(true));
+	
+	return runner.run();
+	}
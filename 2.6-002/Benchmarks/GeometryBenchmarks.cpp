@@ -0,0 +1,393 @@
+/***********************************************************************
+GeometryBenchmarks - Micro-benchmarks for transformations and kd-tree
+queries of the Templatized Geometry Library.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/StringPrintf.h>
+#include <Threads/Thread.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Rotation.h>
+#include <Geometry/OrthonormalTransformation.h>
+#include <Geometry/AffineTransformation.h>
+#include <Geometry/ProjectiveTransformation.h>
+#include <Geometry/ValuedPoint.h>
+#include <Geometry/ArrayKdTree.h>
+#include <Geometry/PointKdTree.h>
+
+#include "Benchmark.h"
+#include "BenchmarkRunner.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class RandomSource // Simple deterministic pseudo-random number generator to create reproducible inputs
+	{
+	/* Elements: */
+	private:
+	Misc::UInt32 state; // Generator state
+	
+	/* Constructors and destructors: */
+	public:
+	RandomSource(Misc::UInt32 sState =1)
+		:state(sState)
+		{
+		}
+	
+	/* Methods: */
+	double operator()(void) // Returns a number uniformly distributed in [0, 1)
+		{
+		state=state*1664525U+1013904223U;
+		return double(state>>8)/16777216.0;
+		}
+	template <class ScalarParam>
+	Geometry::Point<ScalarParam,3> point(void) // Returns a point uniformly distributed in the unit cube
+		{
+		Geometry::Point<ScalarParam,3> result;
+		for(int i=0;i<3;++i)
+			result[i]=ScalarParam((*this)());
+		return result;
+		}
+	template <class ScalarParam>
+	Geometry::OrthonormalTransformation<ScalarParam,3> transformation(void) // Returns a random rigid body transformation
+		{
+		typedef Geometry::OrthonormalTransformation<ScalarParam,3> ONTransform;
+		typedef typename ONTransform::Vector Vector;
+		typedef typename ONTransform::Rotation Rotation;
+		Vector axis((*this)()-0.5,(*this)()-0.5,(*this)()+0.5);
+		Vector translation((*this)()*10.0,(*this)()*10.0,(*this)()*10.0);
+		return ONTransform(translation,Rotation::rotateAxis(axis,ScalarParam((*this)()*6.0)));
+		}
+	};
+
+/****************************
+Transformation benchmarks:
+****************************/
+
+template <class TransformParam>
+class TransformPointsBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	private:
+	typedef TransformParam Transform;
+	typedef typename Transform::Scalar Scalar;
+	typedef typename Transform::Point Point;
+	
+	/* Elements: */
+	Transform transform; // The applied transformation
+	std::vector<Point> points; // Points to transform
+	
+	/* Constructors and destructors: */
+	public:
+	TransformPointsBenchmark(const char* sName,size_t numPoints)
+		:Benchmark("Geometry",sName,Misc::stringPrintf("op=transformPoint,n=%u",(unsigned int)numPoints))
+		{
+		/* Create the transformation from a random rigid body transformation: */
+		RandomSource random;
+		transform=Transform(random.transformation<Scalar>());
+		for(size_t i=0;i<numPoints;++i)
+			points.push_back(random.point<Scalar>());
+		numOperations=double(numPoints);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		Scalar result(0);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(typename std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+				result+=transform.transform(*pIt)[0];
+		sink=size_t(result);
+		}
+	};
+
+template <class TransformParam>
+class ComposeBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	private:
+	typedef TransformParam Transform;
+	typedef typename Transform::Scalar Scalar;
+	
+	/* Elements: */
+	std::vector<Transform> lefts,rights; // Pairs of transformations to compose
+	
+	/* Constructors and destructors: */
+	public:
+	ComposeBenchmark(const char* sName,size_t numPairs)
+		:Benchmark("Geometry",sName,Misc::stringPrintf("op=compose,n=%u",(unsigned int)numPairs))
+		{
+		RandomSource random;
+		for(size_t i=0;i<numPairs;++i)
+			{
+			lefts.push_back(Transform(random.transformation<Scalar>()));
+			rights.push_back(Transform(random.transformation<Scalar>()));
+			}
+		numOperations=double(numPairs);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		Scalar result(0);
+		size_t numPairs=lefts.size();
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(size_t i=0;i<numPairs;++i)
+				{
+				Transform t=lefts[i]*rights[i];
+				result+=t.transform(Transform::Point::origin)[0];
+				}
+		sink=size_t(result);
+		}
+	};
+
+template <class ScalarParam>
+class RotationBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	private:
+	typedef Geometry::Rotation<ScalarParam,3> Rotation;
+	typedef Geometry::Vector<ScalarParam,3> Vector;
+	
+	/* Elements: */
+	bool compose; // Flag whether to compose rotations instead of transforming vectors
+	std::vector<Rotation> rotations; // Rotations to compose or apply
+	std::vector<Vector> vectors; // Vectors to rotate
+	
+	/* Constructors and destructors: */
+	public:
+	RotationBenchmark(const char* sName,bool sCompose,size_t n)
+		:Benchmark("Geometry",sName,Misc::stringPrintf("op=%s,n=%u",sCompose?"compose":"transformVector",(unsigned int)n)),
+		 compose(sCompose)
+		{
+		RandomSource random;
+		for(size_t i=0;i<n;++i)
+			{
+			rotations.push_back(random.transformation<ScalarParam>().getRotation());
+			vectors.push_back(random.point<ScalarParam>()-Geometry::Point<ScalarParam,3>::origin);
+			}
+		numOperations=double(n);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		ScalarParam result(0);
+		size_t n=rotations.size();
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			if(compose)
+				{
+				/* Concatenate all rotations, as when accumulating incremental orientation changes: */
+				Rotation r=Rotation::identity;
+				for(size_t i=0;i<n;++i)
+					{
+					r*=rotations[i];
+					r.renormalize();
+					}
+				result+=r.getQuaternion()[3];
+				}
+			else
+				{
+				for(size_t i=0;i<n;++i)
+					result+=rotations[i].transform(vectors[i])[0];
+				}
+			}
+		sink=size_t(result);
+		}
+	};
+
+/*******************
+Kd-tree benchmarks:
+*******************/
+
+typedef Geometry::Point<float,3> KdPoint;
+typedef Geometry::ValuedPoint<KdPoint,int> KdStoredPoint;
+typedef Geometry::ArrayKdTree<KdStoredPoint> KdArrayTree;
+typedef Geometry::PointKdTree<float,3,KdStoredPoint> KdPointTree;
+
+void createKdPoints(size_t numPoints,std::vector<KdStoredPoint>& points) // Creates a random point set
+	{
+	RandomSource random(12345);
+	points.clear();
+	points.reserve(numPoints);
+	for(size_t i=0;i<numPoints;++i)
+		points.push_back(KdStoredPoint(random.point<float>(),int(i)));
+	}
+
+template <class TreeParam>
+class KdTreeBuildBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	unsigned int numThreads; // Number of threads building trees concurrently
+	std::vector<KdStoredPoint> points; // The source points
+	size_t numIterations; // Number of trees to build by each thread during the current run
+	
+	/* Private methods: */
+	static void buildTree(const std::vector<KdStoredPoint>& points,KdArrayTree*) // Builds an array kd-tree from the given points
+		{
+		KdArrayTree tree;
+		tree.setPoints(int(points.size()),&points[0]);
+		}
+	static void buildTree(const std::vector<KdStoredPoint>& points,KdPointTree*) // Builds a point kd-tree from the given points; the tree shuffles its input and allocates its nodes from a shared pool
+		{
+		std::vector<KdStoredPoint> scratch(points);
+		KdPointTree tree(int(scratch.size()),&scratch[0]);
+		}
+	void* builderThreadMethod(void) // Builds trees concurrently with other threads
+		{
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			buildTree(points,static_cast<TreeParam*>(0));
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	KdTreeBuildBenchmark(const char* sName,size_t numPoints,unsigned int sNumThreads)
+		:Benchmark("Geometry",sName,Misc::stringPrintf("op=build,n=%u,threads=%u",(unsigned int)numPoints,sNumThreads)),
+		 numThreads(sNumThreads),
+		 numIterations(0)
+		{
+		createKdPoints(numPoints,points);
+		numOperations=double(numPoints)*double(numThreads);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t sNumIterations)
+		{
+		numIterations=sNumIterations;
+		if(numThreads>1)
+			{
+			Threads::Thread* threads=new Threads::Thread[numThreads];
+			for(unsigned int i=0;i<numThreads;++i)
+				threads[i].start(this,&KdTreeBuildBenchmark::builderThreadMethod);
+			for(unsigned int i=0;i<numThreads;++i)
+				threads[i].join();
+			delete[] threads;
+			}
+		else
+			builderThreadMethod();
+		}
+	};
+
+template <class TreeParam>
+class KdTreeQueryBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t numPoints; // Number of points in the tree
+	int numNeighbors; // Number of closest points to find, or one to find the single closest point
+	TreeParam* tree; // The queried tree
+	std::vector<KdPoint> queries; // Query positions
+	
+	/* Constructors and destructors: */
+	public:
+	KdTreeQueryBenchmark(const char* sName,size_t sNumPoints,int sNumNeighbors,size_t numQueries)
+		:Benchmark("Geometry",sName,Misc::stringPrintf("op=%s,n=%u,k=%d",sNumNeighbors>1?"findClosestPoints":"findClosestPoint",(unsigned int)sNumPoints,sNumNeighbors)),
+		 numPoints(sNumPoints),numNeighbors(sNumNeighbors),
+		 tree(0)
+		{
+		RandomSource random(54321);
+		for(size_t i=0;i<numQueries;++i)
+			queries.push_back(random.point<float>());
+		numOperations=double(numQueries);
+		}
+	virtual ~KdTreeQueryBenchmark(void)
+		{
+		delete tree;
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		std::vector<KdStoredPoint> points;
+		createKdPoints(numPoints,points);
+		tree=new TreeParam;
+		tree->setPoints(int(points.size()),&points[0]);
+		}
+	virtual void run(size_t numIterations)
+		{
+		size_t result=0;
+		typename TreeParam::ClosePointSet closestPoints(numNeighbors);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(std::vector<KdPoint>::const_iterator qIt=queries.begin();qIt!=queries.end();++qIt)
+				{
+				if(numNeighbors>1)
+					{
+					closestPoints.clear();
+					tree->findClosestPoints(*qIt,closestPoints);
+					result+=size_t(closestPoints.getNumPoints());
+					}
+				else
+					result+=size_t(tree->findClosestPoint(*qIt).value);
+				}
+		sink=result;
+		}
+	virtual void teardown(void)
+		{
+		delete tree;
+		tree=0;
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	BenchmarkRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Transformations: */
+	runner.addBenchmark(new TransformPointsBenchmark<Geometry::OrthonormalTransformation<float,3> >("OrthonormalTransformation<float>",1024));
+	runner.addBenchmark(new TransformPointsBenchmark<Geometry::OrthonormalTransformation<double,3> >("OrthonormalTransformation<double>",1024));
+	runner.addBenchmark(new TransformPointsBenchmark<Geometry::AffineTransformation<double,3> >("AffineTransformation<double>",1024));
+	runner.addBenchmark(new TransformPointsBenchmark<Geometry::ProjectiveTransformation<double,3> >("ProjectiveTransformation<double>",1024));
+	runner.addBenchmark(new ComposeBenchmark<Geometry::OrthonormalTransformation<float,3> >("OrthonormalTransformation<float>",1024));
+	runner.addBenchmark(new ComposeBenchmark<Geometry::OrthonormalTransformation<double,3> >("OrthonormalTransformation<double>",1024));
+	runner.addBenchmark(new ComposeBenchmark<Geometry::AffineTransformation<double,3> >("AffineTransformation<double>",1024));
+	runner.addBenchmark(new ComposeBenchmark<Geometry::ProjectiveTransformation<double,3> >("ProjectiveTransformation<double>",1024));
+	runner.addBenchmark(new RotationBenchmark<double>("Rotation<double>",false,1024));
+	runner.addBenchmark(new RotationBenchmark<double>("Rotation<double>",true,1024));
+	
+	/* Kd-tree construction: */
+	runner.addBenchmark(new KdTreeBuildBenchmark<KdArrayTree>("ArrayKdTree",100000,1));
+	runner.addBenchmark(new KdTreeBuildBenchmark<KdPointTree>("PointKdTree",100000,1));
+	runner.addBenchmark(new KdTreeBuildBenchmark<KdPointTree>("PointKdTree",10000,4));
+	
+	/* Kd-tree queries: */
+	static const size_t treeSizes[]={10000,1000000};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new KdTreeQueryBenchmark<KdArrayTree>("ArrayKdTree",treeSizes[i],1,1024));
+		runner.addBenchmark(new KdTreeQueryBenchmark<KdArrayTree>("ArrayKdTree",treeSizes[i],8,1024));
+		runner.addBenchmark(new KdTreeQueryBenchmark<KdPointTree>("PointKdTree",treeSizes[i],1,1024));
+		runner.addBenchmark(new KdTreeQueryBenchmark<KdPointTree>("PointKdTree",treeSizes[i],8,1024));
+		}
+	
+	return runner.run();
+	}
@@ -0,0 +1,760 @@
+/***********************************************************************
+IOBenchmarks - Micro-benchmarks for buffered file access, read-ahead,
+number parsing, CSV reading, gzip compression, and ZIP archive access
+of the I/O Support Library.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/StringPrintf.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <IO/ReadAheadFilter.h>
+#include <IO/NumberParser.h>
+#include <IO/ValueSource.h>
+#include <IO/CSVSource.h>
+#include <IO/ParallelCSVSource.h>
+#include <IO/GzipFilter.h>
+#include <IO/ParallelGzipFilter.h>
+#include <IO/IndexedGzipFile.h>
+#include <IO/ZipArchive.h>
+
+#include "Benchmark.h"
+#include "BenchmarkRunner.h"
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline Misc::UInt32 nextRandom(Misc::UInt32& state) // Returns the next value of a simple linear congruential pseudo-random number generator
+	{
+	state=state*1664525U+1013904223U;
+	return state>>8;
+	}
+
+std::string createNumberText(size_t numRecords,unsigned int numColumns,char separator) // Returns text containing records of floating-point numbers in the format of typical earthquake catalogs
+	{
+	std::string result;
+	Misc::UInt32 randomState=1;
+	char buffer[64];
+	for(size_t record=0;record<numRecords;++record)
+		{
+		for(unsigned int column=0;column<numColumns;++column)
+			{
+			if(column>0)
+				result.push_back(separator);
+			double value=double(int(nextRandom(randomState)%3600000)-1800000)/10000.0;
+			snprintf(buffer,sizeof(buffer),"%.4f",value);
+			result.append(buffer);
+			}
+		result.push_back('\n');
+		}
+	return result;
+	}
+
+void writeFile(const std::string& fileName,const std::string& contents) // Writes the given contents into a new file of the given name
+	{
+	IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly);
+	file->writeRaw(contents.data(),contents.size());
+	}
+
+void writeGzipFile(const std::string& fileName,const std::string& contents) // Writes the given contents into a new gzip-compressed file of the given name
+	{
+	IO::FilePtr file=new IO::GzipFilter(fileName.c_str(),IO::File::WriteOnly);
+	file->writeRaw(contents.data(),contents.size());
+	}
+
+/**************************************
+Buffered file read and write benchmarks:
+**************************************/
+
+class FileBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	bool write; // Flag whether to write the file instead of reading it
+	size_t fileSize; // Total size of the file
+	size_t chunkSize; // Number of bytes read or written in each call
+	std::string fileName; // Name of the temporary file
+	std::vector<char> chunk; // Buffer for a single chunk
+	
+	/* Constructors and destructors: */
+	public:
+	FileBenchmark(bool sWrite,size_t sFileSize,size_t sChunkSize)
+		:Benchmark("IO",sWrite?"File.write":"File.read",Misc::stringPrintf("size=%u,chunk=%u",(unsigned int)sFileSize,(unsigned int)sChunkSize)),
+		 write(sWrite),fileSize(sFileSize),chunkSize(sChunkSize),
+		 chunk(sChunkSize,'x')
+		{
+		/* One operation is a single read or write call: */
+		numOperations=double(fileSize/chunkSize);
+		numBytes=double(fileSize);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		fileName=getTempFileName(".dat");
+		if(!write)
+			writeFile(fileName,std::string(fileSize,'x'));
+		}
+	virtual void run(size_t numIterations)
+		{
+		size_t numChunks=fileSize/chunkSize;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			if(write)
+				{
+				IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly);
+				for(size_t i=0;i<numChunks;++i)
+					file->writeRaw(&chunk[0],chunkSize);
+				}
+			else
+				{
+				IO::FilePtr file=IO::openFile(fileName.c_str());
+				for(size_t i=0;i<numChunks;++i)
+					file->readRaw(&chunk[0],chunkSize);
+				}
+			}
+		}
+	virtual void teardown(void)
+		{
+		unlink(fileName.c_str());
+		}
+	};
+
+/*****************************************
+Vectored read benchmarks (header and
+payload records into separate buffers):
+*****************************************/
+
+class VectoredReadBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	bool vectored; // Flag whether to read records with a single vectored read instead of two reads
+	size_t numRecords; // Number of records in the file
+	size_t headerSize,payloadSize; // Sizes of record headers and payloads
+	std::string fileName; // Name of the temporary file
+	std::vector<char> header,payload; // Buffers for the current record
+	
+	/* Constructors and destructors: */
+	public:
+	VectoredReadBenchmark(bool sVectored,size_t sNumRecords,size_t sPayloadSize)
+		:Benchmark("IO",sVectored?"File.readVectored":"File.readRaw",Misc::stringPrintf("op=readRecords,payload=%u",(unsigned int)sPayloadSize)),
+		 vectored(sVectored),numRecords(sNumRecords),
+		 headerSize(32),payloadSize(sPayloadSize),
+		 header(headerSize),payload(payloadSize)
+		{
+		numOperations=double(numRecords);
+		numBytes=double(numRecords)*double(headerSize+payloadSize);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		fileName=getTempFileName(".dat");
+		writeFile(fileName,std::string(numRecords*(headerSize+payloadSize),'x'));
+		}
+	virtual void run(size_t numIterations)
+		{
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			IO::FilePtr file=IO::openFile(fileName.c_str());
+			IO::File::IOVector vectors[2];
+			vectors[0].data=&header[0];
+			vectors[0].size=headerSize;
+			vectors[1].data=&payload[0];
+			vectors[1].size=payloadSize;
+			for(size_t i=0;i<numRecords;++i)
+				{
+				if(vectored)
+					file->readVectored(vectors,2);
+				else
+					{
+					file->readRaw(&header[0],headerSize);
+					file->readRaw(&payload[0],payloadSize);
+					}
+				}
+			}
+		}
+	virtual void teardown(void)
+		{
+		unlink(fileName.c_str());
+		}
+	};
+
+/*****************************
+Read-ahead filter benchmarks:
+*****************************/
+
+class ReadAheadBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	unsigned int numBuffers; // Number of read-ahead buffers, or zero to read without read-ahead
+	size_t fileSize; // Size of the file
+	std::string fileName; // Name of the temporary file
+	unsigned int numStalls; // Number of reader stalls during the last run
+	
+	/* Constructors and destructors: */
+	public:
+	ReadAheadBenchmark(unsigned int sNumBuffers,size_t sFileSize)
+		:Benchmark("IO",sNumBuffers>0?"ReadAheadFilter":"File.read",Misc::stringPrintf("op=checksum,buffers=%u",sNumBuffers)),
+		 numBuffers(sNumBuffers),fileSize(sFileSize),
+		 numStalls(0)
+		{
+		numBytes=double(fileSize);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		fileName=getTempFileName(".dat");
+		writeFile(fileName,std::string(fileSize,'x'));
+		}
+	virtual void run(size_t numIterations)
+		{
+		size_t result=0;
+		numStalls=0;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			/* Checksum the file while the filter reads ahead: */
+			IO::FilePtr file=IO::openFile(fileName.c_str());
+			IO::ReadAheadFilter* filter=0;
+			if(numBuffers>0)
+				{
+				filter=new IO::ReadAheadFilter(file,numBuffers);
+				file=filter;
+				}
+			void* buffer;
+			size_t bufferSize;
+			while((bufferSize=file->readInBuffer(buffer))!=0)
+				result+=adler32(0,static_cast<const Bytef*>(buffer),uInt(bufferSize));
+			if(filter!=0)
+				numStalls+=filter->getStatistics().numStalls;
+			}
+		sink=result;
+		if(numBuffers>0)
+			addMetric("stalls",double(numStalls)/double(numIterations),"count");
+		}
+	virtual void teardown(void)
+		{
+		unlink(fileName.c_str());
+		}
+	};
+
+/**********************************************
+Number parsing benchmarks (in-buffer parser vs.
+strtod and string-based reading):
+**********************************************/
+
+class NumberParseBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	public:
+	enum Method // Enumerated type for number parsing methods
+		{
+		PARSE_NUMBER,STRTOD,VALUESOURCE_READNUMBER,VALUESOURCE_READSTRING
+		};
+	
+	/* Elements: */
+	private:
+	Method method; // The measured parsing method
+	size_t numRecords; // Number of records in the parsed text
+	std::string text; // The parsed text
+	std::string fileName; // Name of the temporary file holding the text
+	
+	/* Constructors and destructors: */
+	public:
+	NumberParseBenchmark(Method sMethod,size_t sNumRecords)
+		:Benchmark("IO",sMethod==PARSE_NUMBER?"parseNumber":sMethod==STRTOD?"strtod":sMethod==VALUESOURCE_READNUMBER?"ValueSource.readNumber":"ValueSource.readString+atof",Misc::stringPrintf("n=%u",(unsigned int)(sNumRecords*4))),
+		 method(sMethod),numRecords(sNumRecords)
+		{
+		numOperations=double(numRecords*4);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		text=createNumberText(numRecords,4,' ');
+		numBytes=double(text.size());
+		if(method==VALUESOURCE_READNUMBER||method==VALUESOURCE_READSTRING)
+			{
+			fileName=getTempFileName(".txt");
+			writeFile(fileName,text);
+			}
+		}
+	virtual void run(size_t numIterations)
+		{
+		double result=0.0;
+		size_t numNumbers=numRecords*4;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			switch(method)
+				{
+				case PARSE_NUMBER:
+					{
+					const char* cPtr=text.data();
+					const char* end=cPtr+text.size();
+					for(size_t i=0;i<numNumbers;++i)
+						{
+						double value;
+						IO::parseNumber(cPtr,end,value);
+						result+=value;
+						++cPtr;
+						}
+					break;
+					}
+				
+				case STRTOD:
+					{
+					const char* cPtr=text.c_str();
+					for(size_t i=0;i<numNumbers;++i)
+						{
+						char* endPtr;
+						result+=strtod(cPtr,&endPtr);
+						cPtr=endPtr+1;
+						}
+					break;
+					}
+				
+				case VALUESOURCE_READNUMBER:
+					{
+					IO::ValueSource source(IO::openFile(fileName.c_str()));
+					source.skipWs();
+					for(size_t i=0;i<numNumbers;++i)
+						result+=source.readNumber();
+					break;
+					}
+				
+				case VALUESOURCE_READSTRING:
+					{
+					IO::ValueSource source(IO::openFile(fileName.c_str()));
+					source.skipWs();
+					for(size_t i=0;i<numNumbers;++i)
+						result+=atof(source.readString().c_str());
+					break;
+					}
+				}
+			}
+		sink=size_t(result);
+		}
+	virtual void teardown(void)
+		{
+		text=std::string();
+		if(!fileName.empty())
+			unlink(fileName.c_str());
+		}
+	};
+
+/*******************************************
+CSV reading benchmarks (CSVSource vs.
+ParallelCSVSource):
+*******************************************/
+
+class CSVBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	unsigned int numThreads; // Number of threads used by the parallel CSV source, or zero to use the sequential CSV source
+	size_t numRecords; // Number of records in the CSV file
+	std::string fileName; // Name of the temporary file
+	
+	/* Constructors and destructors: */
+	public:
+	CSVBenchmark(unsigned int sNumThreads,size_t sNumRecords)
+		:Benchmark("IO",sNumThreads>0?"ParallelCSVSource":"CSVSource",sNumThreads>0?Misc::stringPrintf("threads=%u,records=%u",sNumThreads,(unsigned int)sNumRecords):Misc::stringPrintf("records=%u",(unsigned int)sNumRecords)),
+		 numThreads(sNumThreads),numRecords(sNumRecords)
+		{
+		numOperations=double(numRecords);
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		std::string text="latitude,longitude,depth,magnitude,time\n";
+		text.append(createNumberText(numRecords,5,','));
+		numBytes=double(text.size());
+		fileName=getTempFileName(".csv");
+		writeFile(fileName,text);
+		}
+	virtual void run(size_t numIterations)
+		{
+		double result=0.0;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			if(numThreads>0)
+				{
+				IO::ParallelCSVSource source(fileName.c_str());
+				source.readHeader();
+				for(unsigned int i=0;i<5;++i)
+					source.addColumn(i,IO::ParallelCSVSource::NUMBER);
+				source.read(numThreads);
+				result+=source.getNumberColumn(3)[source.getNumRecords()-1];
+				}
+			else
+				{
+				IO::CSVSource source(IO::openFile(fileName.c_str()));
+				source.skipRecord();
+				double values[5];
+				while(!source.eof())
+					{
+					source.readRecord(values,5);
+					result+=values[3];
+					}
+				}
+			}
+		sink=size_t(result);
+		}
+	virtual void teardown(void)
+		{
+		unlink(fileName.c_str());
+		}
+	};
+
+/*****************************************
+Gzip benchmarks (GzipFilter vs.
+ParallelGzipFilter):
+*****************************************/
+
+class GzipBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	bool compress; // Flag whether to compress data instead of decompressing it
+	unsigned int numThreads; // Number of threads used by the parallel gzip filter, or zero to use the sequential gzip filter
+	std::string text; // The uncompressed data
+	std::string fileName; // Name of the temporary compressed file
+	double compressionRatio; // Compression ratio achieved by the filter
+	
+	/* Constructors and destructors: */
+	public:
+	GzipBenchmark(bool sCompress,unsigned int sNumThreads)
+		:Benchmark("IO",sNumThreads>0?"ParallelGzipFilter":"GzipFilter",sNumThreads>0?Misc::stringPrintf("op=%s,threads=%u",sCompress?"compress":"decompress",sNumThreads):Misc::stringPrintf("op=%s",sCompress?"compress":"decompress")),
+		 compress(sCompress),numThreads(sNumThreads),
+		 compressionRatio(0.0)
+		{
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		text=createNumberText(64*1024,4,',');
+		numBytes=double(text.size());
+		fileName=getTempFileName(".gz");
+		if(!compress)
+			{
+			/* Create the compressed file using the tested filter: */
+			IO::FilePtr file;
+			if(numThreads>0)
+				file=new IO::ParallelGzipFilter(fileName.c_str(),IO::File::WriteOnly,numThreads);
+			else
+				file=new IO::GzipFilter(fileName.c_str(),IO::File::WriteOnly);
+			file->writeRaw(text.data(),text.size());
+			}
+		}
+	virtual void run(size_t numIterations)
+		{
+		std::vector<char> buffer(65536);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			if(compress)
+				{
+				IO::FilePtr file;
+				if(numThreads>0)
+					file=new IO::ParallelGzipFilter(fileName.c_str(),IO::File::WriteOnly,numThreads);
+				else
+					file=new IO::GzipFilter(fileName.c_str(),IO::File::WriteOnly);
+				file->writeRaw(text.data(),text.size());
+				}
+			else
+				{
+				IO::FilePtr file;
+				if(numThreads>0)
+					file=new IO::ParallelGzipFilter(fileName.c_str(),IO::File::ReadOnly,numThreads);
+				else
+					file=new IO::GzipFilter(fileName.c_str(),IO::File::ReadOnly);
+				while(file->readUpTo(&buffer[0],buffer.size())!=0)
+					;
+				}
+			}
+		}
+	virtual void teardown(void)
+		{
+		/* Report the compression ratio: */
+		struct stat fileStats;
+		if(stat(fileName.c_str(),&fileStats)==0)
+			addMetric("ratio",double(text.size())/double(fileStats.st_size),"x");
+		unlink(fileName.c_str());
+		text=std::string();
+		}
+	};
+
+class IndexedGzipSeekBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t checkpointSpacing; // Distance between checkpoints in the uncompressed data
+	size_t readSize; // Amount of data read after each seek
+	std::string fileName; // Name of the temporary compressed file
+	IO::SeekableFilePtr file; // The indexed gzip file
+	Misc::UInt32 randomState; // State of the pseudo-random number generator for seek positions
+	double indexBuildTime; // Time taken to build the file's checkpoint index
+	
+	/* Constructors and destructors: */
+	public:
+	IndexedGzipSeekBenchmark(size_t sCheckpointSpacing,size_t sReadSize)
+		:Benchmark("IO","IndexedGzipFile",Misc::stringPrintf("op=seekRead,spacing=%u,read=%u",(unsigned int)sCheckpointSpacing,(unsigned int)sReadSize)),
+		 checkpointSpacing(sCheckpointSpacing),readSize(sReadSize),
+		 randomState(1),indexBuildTime(0.0)
+		{
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		fileName=getTempFileName(".gz");
+		writeGzipFile(fileName,createNumberText(256*1024,4,','));
+		
+		/* Build the index, and time it as an additional result: */
+		double start=BenchmarkRunner::getTime();
+		file=new IO::IndexedGzipFile(fileName.c_str(),checkpointSpacing);
+		indexBuildTime=BenchmarkRunner::getTime()-start;
+		}
+	virtual void run(size_t numIterations)
+		{
+		std::vector<char> buffer(readSize);
+		IO::SeekableFile::Offset maxPos=file->getSize()-IO::SeekableFile::Offset(readSize);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			/* Read from a random position: */
+			IO::SeekableFile::Offset pos=IO::SeekableFile::Offset((double(nextRandom(randomState))/16777216.0)*double(maxPos));
+			file->setReadPosAbs(pos);
+			file->readRaw(&buffer[0],readSize);
+			}
+		}
+	virtual void teardown(void)
+		{
+		addMetric("indexBuild",indexBuildTime*1.0e3,"ms");
+		file=0;
+		unlink(fileName.c_str());
+		unlink((fileName+".gzidx").c_str());
+		}
+	};
+
+/**********************
+ZIP archive benchmarks:
+**********************/
+
+class ZipArchiveBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	bool open; // Flag whether to open and read found files
+	size_t numFiles; // Number of files in the archive
+	std::string fileName; // Name of the temporary archive file
+	std::vector<std::string> fileNames; // Names of files in the archive
+	IO::ZipArchive* archive; // The archive
+	
+	/* Private methods: */
+	void createArchive(void) // Creates a ZIP archive of small uncompressed files
+		{
+		IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly);
+		file->setEndianness(Misc::LittleEndian);
+		std::vector<Misc::UInt32> offsets;
+		std::vector<Misc::UInt32> crcs;
+		Misc::UInt32 offset=0;
+		std::string contents(64,'x');
+		for(size_t i=0;i<numFiles;++i)
+			{
+			/* Write a local file header and the file's contents: */
+			Misc::UInt32 crc=Misc::UInt32(crc32(crc32(0,0,0),reinterpret_cast<const Bytef*>(contents.data()),uInt(contents.size())));
+			offsets.push_back(offset);
+			crcs.push_back(crc);
+			file->write<Misc::UInt32>(0x04034b50U);
+			file->write<Misc::UInt16>(20); // Version needed to extract
+			file->write<Misc::UInt16>(0); // Flags
+			file->write<Misc::UInt16>(0); // Compression method: stored
+			file->write<Misc::UInt16>(0); // Modification time
+			file->write<Misc::UInt16>(0x21); // Modification date
+			file->write<Misc::UInt32>(crc);
+			file->write<Misc::UInt32>(Misc::UInt32(contents.size()));
+			file->write<Misc::UInt32>(Misc::UInt32(contents.size()));
+			file->write<Misc::UInt16>(Misc::UInt16(fileNames[i].size()));
+			file->write<Misc::UInt16>(0); // Extra field length
+			file->writeRaw(fileNames[i].data(),fileNames[i].size());
+			file->writeRaw(contents.data(),contents.size());
+			offset+=Misc::UInt32(30+fileNames[i].size()+contents.size());
+			}
+		
+		/* Write the central directory: */
+		Misc::UInt32 directoryOffset=offset;
+		for(size_t i=0;i<numFiles;++i)
+			{
+			file->write<Misc::UInt32>(0x02014b50U);
+			file->write<Misc::UInt16>(20); // Version made by
+			file->write<Misc::UInt16>(20); // Version needed to extract
+			file->write<Misc::UInt16>(0); // Flags
+			file->write<Misc::UInt16>(0); // Compression method: stored
+			file->write<Misc::UInt16>(0); // Modification time
+			file->write<Misc::UInt16>(0x21); // Modification date
+			file->write<Misc::UInt32>(crcs[i]);
+			file->write<Misc::UInt32>(Misc::UInt32(contents.size()));
+			file->write<Misc::UInt32>(Misc::UInt32(contents.size()));
+			file->write<Misc::UInt16>(Misc::UInt16(fileNames[i].size()));
+			file->write<Misc::UInt16>(0); // Extra field length
+			file->write<Misc::UInt16>(0); // File comment length
+			file->write<Misc::UInt16>(0); // Disk number start
+			file->write<Misc::UInt16>(0); // Internal file attributes
+			file->write<Misc::UInt32>(0); // External file attributes
+			file->write<Misc::UInt32>(offsets[i]);
+			file->writeRaw(fileNames[i].data(),fileNames[i].size());
+			offset+=Misc::UInt32(46+fileNames[i].size());
+			}
+		
+		/* Write the end-of-central-directory record: */
+		file->write<Misc::UInt32>(0x06054b50U);
+		file->write<Misc::UInt16>(0); // Number of this disk
+		file->write<Misc::UInt16>(0); // Disk containing the central directory
+		file->write<Misc::UInt16>(Misc::UInt16(numFiles));
+		file->write<Misc::UInt16>(Misc::UInt16(numFiles));
+		file->write<Misc::UInt32>(offset-directoryOffset);
+		file->write<Misc::UInt32>(directoryOffset);
+		file->write<Misc::UInt16>(0); // Comment length
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	ZipArchiveBenchmark(bool sOpen,size_t sNumFiles)
+		:Benchmark("IO","ZipArchive",Misc::stringPrintf("op=%s,files=%u",sOpen?"findOpenRead":"findFile",(unsigned int)sNumFiles)),
+		 open(sOpen),numFiles(sNumFiles),
+		 archive(0)
+		{
+		}
+	virtual ~ZipArchiveBenchmark(void)
+		{
+		delete archive;
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		/* Create file names in a shallow directory hierarchy: */
+		for(size_t i=0;i<numFiles;++i)
+			fileNames.push_back(Misc::stringPrintf("Data/Set%03u/File%05u.dat",(unsigned int)(i/100),(unsigned int)i));
+		
+		/* Create and open the archive: */
+		fileName=getTempFileName(".zip");
+		createArchive();
+		archive=new IO::ZipArchive(fileName.c_str());
+		}
+	virtual void run(size_t numIterations)
+		{
+		size_t result=0;
+		size_t fileIndex=0;
+		char buffer[64];
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			/* Find files in a scrambled order: */
+			fileIndex=(fileIndex+7919)%numFiles;
+			IO::ZipArchive::FileID fileId=archive->findFile(fileNames[fileIndex].c_str());
+			if(open)
+				{
+				IO::FilePtr file=archive->openFile(fileId);
+				file->readRaw(buffer,sizeof(buffer));
+				result+=size_t(buffer[0]);
+				}
+			}
+		sink=result;
+		}
+	virtual void teardown(void)
+		{
+		delete archive;
+		archive=0;
+		unlink(fileName.c_str());
+		fileNames.clear();
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	BenchmarkRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Buffered file access: */
+	static const size_t chunkSizes[]={64,65536};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new FileBenchmark(true,16*1024*1024,chunkSizes[i]));
+		runner.addBenchmark(new FileBenchmark(false,16*1024*1024,chunkSizes[i]));
+		}
+	runner.addBenchmark(new VectoredReadBenchmark(false,4096,4064));
+	runner.addBenchmark(new VectoredReadBenchmark(true,4096,4064));
+	runner.addBenchmark(new VectoredReadBenchmark(false,256,65536));
+	runner.addBenchmark(new VectoredReadBenchmark(true,256,65536));
+	
+	/* Read-ahead: */
+	runner.addBenchmark(new ReadAheadBenchmark(0,16*1024*1024));
+	runner.addBenchmark(new ReadAheadBenchmark(2,16*1024*1024));
+	runner.addBenchmark(new ReadAheadBenchmark(4,16*1024*1024));
+	
+	/* Number parsing: */
+	runner.addBenchmark(new NumberParseBenchmark(NumberParseBenchmark::PARSE_NUMBER,100000));
+	runner.addBenchmark(new NumberParseBenchmark(NumberParseBenchmark::STRTOD,100000));
+	runner.addBenchmark(new NumberParseBenchmark(NumberParseBenchmark::VALUESOURCE_READNUMBER,100000));
+	runner.addBenchmark(new NumberParseBenchmark(NumberParseBenchmark::VALUESOURCE_READSTRING,100000));
+	
+	/* CSV reading: */
+	runner.addBenchmark(new CSVBenchmark(0,100000));
+	runner.addBenchmark(new CSVBenchmark(1,100000));
+	long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+	if(numCpus>1)
+		runner.addBenchmark(new CSVBenchmark((unsigned int)numCpus,100000));
+	
+	/* Gzip compression: */
+	for(int compress=1;compress>=0;--compress)
+		{
+		runner.addBenchmark(new GzipBenchmark(compress!=0,0));
+		runner.addBenchmark(new GzipBenchmark(compress!=0,1));
+		if(numCpus>1)
+			runner.addBenchmark(new GzipBenchmark(compress!=0,(unsigned int)numCpus));
+		}
+	runner.addBenchmark(new IndexedGzipSeekBenchmark(1024*1024,4096));
+	runner.addBenchmark(new IndexedGzipSeekBenchmark(256*1024,4096));
+	
+	/* ZIP archives: */
+	runner.addBenchmark(new ZipArchiveBenchmark(false,10000));
+	runner.addBenchmark(new ZipArchiveBenchmark(true,10000));
+	
+	return runner.run();
+	}
@@ -0,0 +1,761 @@
+/***********************************************************************
+MiscBenchmarks - Micro-benchmarks for the containers, allocators,
+callback mechanisms, and configuration files of the Miscellaneous
+Support Library.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <unistd.h>
+#include <stdexcept>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/StringPrintf.h>
+#include <Misc/HashTable.h>
+#include <Misc/OpenHashTable.h>
+#include <Misc/PoolAllocator.h>
+#include <Misc/ChunkedArray.h>
+#include <Misc/PriorityHeap.h>
+#include <Misc/Endianness.h>
+#include <Misc/CallbackData.h>
+#include <Misc/CallbackList.h>
+#include <Misc/TimerEventScheduler.h>
+#include <Misc/ConfigurationFile.h>
+
+#include "Benchmark.h"
+#include "BenchmarkRunner.h"
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline Misc::UInt32 scrambleKey(Misc::UInt32 index) // Maps consecutive indices to distinct, well-spread keys
+	{
+	return index*2654435761U;
+	}
+
+/**************************************
+Hash table benchmarks (HashTable vs.
+OpenHashTable):
+**************************************/
+
+template <class HashTableParam>
+class HashTableBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	public:
+	typedef HashTableParam Table;
+	
+	enum Operation // Enumerated type for measured hash table operations
+		{
+		INSERT,FIND_HIT,FIND_MISS,ITERATE,REMOVE_INSERT
+		};
+	
+	/* Elements: */
+	private:
+	Operation operation; // The measured operation
+	size_t numEntries; // Number of entries in the hash table
+	std::vector<Misc::UInt32> hitKeys; // Keys of entries in the table
+	std::vector<Misc::UInt32> missKeys; // Keys not in the table
+	Table* table; // The hash table
+	
+	/* Constructors and destructors: */
+	public:
+	HashTableBenchmark(const char* tableName,Operation sOperation,size_t sNumEntries)
+		:Benchmark("Misc",tableName,Misc::stringPrintf("op=%s,n=%u",getOperationName(sOperation),(unsigned int)sNumEntries)),
+		 operation(sOperation),numEntries(sNumEntries),
+		 table(0)
+		{
+		numOperations=double(numEntries);
+		}
+	virtual ~HashTableBenchmark(void)
+		{
+		delete table;
+		}
+	
+	/* Methods: */
+	static const char* getOperationName(Operation operation)
+		{
+		static const char* names[]={"insert","findHit","findMiss","iterate","removeInsert"};
+		return names[operation];
+		}
+	virtual void setup(void)
+		{
+		/* Create hit and miss keys: */
+		for(size_t i=0;i<numEntries;++i)
+			{
+			hitKeys.push_back(scrambleKey(Misc::UInt32(i*2)));
+			missKeys.push_back(scrambleKey(Misc::UInt32(i*2+1)));
+			}
+		
+		/* Fill the hash table: */
+		table=new Table(101);
+		for(size_t i=0;i<numEntries;++i)
+			table->setEntry(typename Table::Entry(hitKeys[i],Misc::UInt32(i)));
+		}
+	virtual void run(size_t numIterations)
+		{
+		size_t result=0;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			switch(operation)
+				{
+				case INSERT:
+					{
+					Table newTable(101);
+					for(size_t i=0;i<numEntries;++i)
+						newTable.setEntry(typename Table::Entry(hitKeys[i],Misc::UInt32(i)));
+					result+=newTable.getNumEntries();
+					break;
+					}
+				
+				case FIND_HIT:
+					for(size_t i=0;i<numEntries;++i)
+						result+=table->findEntry(hitKeys[i])->getDest();
+					break;
+				
+				case FIND_MISS:
+					for(size_t i=0;i<numEntries;++i)
+						if(table->isEntry(missKeys[i]))
+							++result;
+					break;
+				
+				case ITERATE:
+					for(typename Table::Iterator tIt=table->begin();!tIt.isFinished();++tIt)
+						result+=tIt->getDest();
+					break;
+				
+				case REMOVE_INSERT:
+					for(size_t i=0;i<numEntries;++i)
+						{
+						table->removeEntry(hitKeys[i]);
+						table->setEntry(typename Table::Entry(hitKeys[i],Misc::UInt32(i)));
+						}
+					break;
+				}
+			}
+		sink=result;
+		}
+	virtual void teardown(void)
+		{
+		delete table;
+		table=0;
+		hitKeys.clear();
+		missKeys.clear();
+		}
+	};
+
+template <class HashTableParam>
+void addHashTableBenchmarks(BenchmarkRunner& runner,const char* tableName) // Adds all hash table benchmarks for the given table type
+	{
+	typedef HashTableBenchmark<HashTableParam> B;
+	static const size_t sizes[]={1024,262144};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new B(tableName,B::INSERT,sizes[i]));
+		runner.addBenchmark(new B(tableName,B::FIND_HIT,sizes[i]));
+		runner.addBenchmark(new B(tableName,B::FIND_MISS,sizes[i]));
+		runner.addBenchmark(new B(tableName,B::ITERATE,sizes[i]));
+		runner.addBenchmark(new B(tableName,B::REMOVE_INSERT,sizes[i]));
+		}
+	}
+
+/****************************************
+Allocator benchmarks (PoolAllocator vs.
+operator new):
+****************************************/
+
+struct Node // Structure for typical small allocated objects such as tree nodes
+	{
+	/* Elements: */
+	public:
+	Node* children[2];
+	double value;
+	};
+
+class NewAllocator // Adapter class to allocate nodes via operator new
+	{
+	/* Methods: */
+	public:
+	void* allocate(void)
+		{
+		return ::operator new(sizeof(Node));
+		}
+	void free(void* item)
+		{
+		::operator delete(item);
+		}
+	};
+
+template <class AllocatorParam>
+class AllocatorBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t batchSize; // Number of objects allocated before they are released
+	AllocatorParam allocator; // The allocator
+	std::vector<void*> items; // Array of allocated objects
+	
+	/* Constructors and destructors: */
+	public:
+	AllocatorBenchmark(const char* allocatorName,size_t sBatchSize)
+		:Benchmark("Misc",allocatorName,Misc::stringPrintf("batch=%u",(unsigned int)sBatchSize)),
+		 batchSize(sBatchSize),
+		 items(sBatchSize,0)
+		{
+		/* One operation is an allocation and its release: */
+		numOperations=double(batchSize);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			for(size_t i=0;i<batchSize;++i)
+				items[i]=allocator.allocate();
+			
+			/* Release the objects in a scrambled order to emulate fragmentation: */
+			for(size_t i=0;i<batchSize;++i)
+				allocator.free(items[(i*7919)%batchSize]);
+			}
+		}
+	};
+
+/****************************************
+Dynamic array benchmarks (ChunkedArray vs.
+std::vector):
+****************************************/
+
+template <class ArrayParam>
+class ArrayPushBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t numElements; // Number of elements pushed into the array
+	
+	/* Constructors and destructors: */
+	public:
+	ArrayPushBenchmark(const char* arrayName,size_t sNumElements)
+		:Benchmark("Misc",arrayName,Misc::stringPrintf("op=pushBack,n=%u",(unsigned int)sNumElements)),
+		 numElements(sNumElements)
+		{
+		numOperations=double(numElements);
+		numBytes=double(numElements)*double(sizeof(typename ArrayParam::value_type));
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		size_t result=0;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			ArrayParam array;
+			for(size_t i=0;i<numElements;++i)
+				array.push_back(typename ArrayParam::value_type(i));
+			result+=array.size();
+			}
+		sink=result;
+		}
+	};
+
+template <class ArrayParam>
+class ArrayIterateBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t numElements; // Number of elements in the array
+	ArrayParam array; // The array
+	
+	/* Constructors and destructors: */
+	public:
+	ArrayIterateBenchmark(const char* arrayName,size_t sNumElements)
+		:Benchmark("Misc",arrayName,Misc::stringPrintf("op=iterate,n=%u",(unsigned int)sNumElements)),
+		 numElements(sNumElements)
+		{
+		numOperations=double(numElements);
+		numBytes=double(numElements)*double(sizeof(typename ArrayParam::value_type));
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		for(size_t i=0;i<numElements;++i)
+			array.push_back(typename ArrayParam::value_type(i));
+		}
+	virtual void run(size_t numIterations)
+		{
+		typename ArrayParam::value_type result(0);
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			for(typename ArrayParam::const_iterator aIt=array.begin();aIt!=array.end();++aIt)
+				result+=*aIt;
+		sink=size_t(result);
+		}
+	};
+
+/* Wrapper class to give ChunkedArray the standard container typedefs: */
+template <class ContentParam>
+class ChunkedArrayAdapter:public Misc::ChunkedArray<ContentParam>
+	{
+	/* Embedded classes: */
+	public:
+	typedef ContentParam value_type;
+	};
+
+/**************************
+Priority heap benchmarks:
+**************************/
+
+class PriorityHeapBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t numElements; // Number of elements in the heap
+	Misc::PriorityHeap<double> heap; // The heap
+	Misc::UInt32 randomState; // State of the pseudo-random number generator for new element values
+	
+	/* Constructors and destructors: */
+	public:
+	PriorityHeapBenchmark(size_t sNumElements)
+		:Benchmark("Misc","PriorityHeap",Misc::stringPrintf("op=removeInsert,n=%u",(unsigned int)sNumElements)),
+		 numElements(sNumElements),
+		 randomState(1)
+		{
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		for(size_t i=0;i<numElements;++i)
+			{
+			randomState=randomState*1664525U+1013904223U;
+			heap.insert(double(randomState));
+			}
+		}
+	virtual void run(size_t numIterations)
+		{
+		/* Simulate an event queue: remove the smallest element and insert a new later one: */
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			double smallest=heap.getSmallest();
+			heap.removeSmallest();
+			randomState=randomState*1664525U+1013904223U;
+			heap.insert(smallest+double(randomState>>16));
+			}
+		sink=size_t(heap.getNumElements());
+		}
+	virtual void teardown(void)
+		{
+		while(!heap.isEmpty())
+			heap.removeSmallest();
+		}
+	};
+
+/**************************************
+Endianness conversion benchmarks (byte
+loop vs. byte swap kernels):
+**************************************/
+
+template <class ValueParam>
+void reverseBytewise(ValueParam* values,size_t numValues) // Reverses the byte order of an array of values one byte at a time, as done before the byte swap kernels
+	{
+	for(size_t i=0;i<numValues;++i)
+		{
+		unsigned char* bytes=reinterpret_cast<unsigned char*>(values+i);
+		for(size_t i1=0,i2=sizeof(ValueParam)-1;i1<i2;++i1,--i2)
+			{
+			unsigned char temp=bytes[i1];
+			bytes[i1]=bytes[i2];
+			bytes[i2]=temp;
+			}
+		}
+	}
+
+template <class ValueParam>
+class EndiannessBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	bool bytewise; // Flag whether to use the byte loop instead of the byte swap kernels
+	size_t numValues; // Number of values in the converted array
+	std::vector<ValueParam> values; // The converted array
+	
+	/* Constructors and destructors: */
+	public:
+	EndiannessBenchmark(bool sBytewise,size_t sNumValues)
+		:Benchmark("Misc",sBytewise?"Endianness.byteLoop":"Endianness.byteReverser",Misc::stringPrintf("size=%u,n=%u",(unsigned int)sizeof(ValueParam),(unsigned int)sNumValues)),
+		 bytewise(sBytewise),numValues(sNumValues),
+		 values(sNumValues)
+		{
+		numOperations=double(numValues);
+		numBytes=double(numValues)*double(sizeof(ValueParam));
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		for(size_t i=0;i<numValues;++i)
+			values[i]=ValueParam(scrambleKey(Misc::UInt32(i)));
+		}
+	virtual void run(size_t numIterations)
+		{
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			if(bytewise)
+				reverseBytewise(&values[0],numValues);
+			else
+				Misc::ByteReverser<sizeof(ValueParam)>::reverse(&values[0],numValues);
+			}
+		sink=size_t(values[numValues/2]);
+		}
+	};
+
+/***********************************
+Callback list and timer event
+scheduler benchmarks:
+***********************************/
+
+class CallbackReceiver // Class receiving callbacks
+	{
+	/* Elements: */
+	public:
+	size_t numCalls; // Number of received callbacks
+	
+	/* Constructors and destructors: */
+	CallbackReceiver(void)
+		:numCalls(0)
+		{
+		}
+	
+	/* Methods: */
+	void callback(Misc::CallbackData*)
+		{
+		++numCalls;
+		}
+	void timerCallback(Misc::TimerEventScheduler::CallbackData*)
+		{
+		++numCalls;
+		}
+	};
+
+class CallbackListCallBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t numCallbacks; // Number of callbacks in the list
+	bool fragmented; // Flag whether the list had callbacks removed from its middle
+	std::vector<CallbackReceiver> receivers; // The callback receivers
+	Misc::CallbackList* list; // The callback list
+	
+	/* Constructors and destructors: */
+	public:
+	CallbackListCallBenchmark(size_t sNumCallbacks,bool sFragmented)
+		:Benchmark("Misc","CallbackList",Misc::stringPrintf("op=call,n=%u,fragmented=%d",(unsigned int)sNumCallbacks,sFragmented?1:0)),
+		 numCallbacks(sNumCallbacks),fragmented(sFragmented),
+		 list(0)
+		{
+		/* One operation is the dispatch of a single callback: */
+		numOperations=double(numCallbacks);
+		}
+	virtual ~CallbackListCallBenchmark(void)
+		{
+		delete list;
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		/* Create twice the number of callbacks if the list is to be fragmented, and remove every other one: */
+		size_t numReceivers=fragmented?numCallbacks*2:numCallbacks;
+		receivers.resize(numReceivers);
+		list=new Misc::CallbackList;
+		for(size_t i=0;i<numReceivers;++i)
+			list->add(&receivers[i],&CallbackReceiver::callback);
+		if(fragmented)
+			for(size_t i=0;i<numReceivers;i+=2)
+				list->remove(&receivers[i],&CallbackReceiver::callback);
+		}
+	virtual void run(size_t numIterations)
+		{
+		Misc::CallbackData cbData;
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			list->call(&cbData);
+		sink=receivers.back().numCalls;
+		}
+	virtual void teardown(void)
+		{
+		delete list;
+		list=0;
+		receivers.clear();
+		}
+	};
+
+class CallbackListAddRemoveBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t numCallbacks; // Number of callbacks in the list
+	std::vector<CallbackReceiver> receivers; // The callback receivers
+	Misc::CallbackList* list; // The callback list
+	
+	/* Constructors and destructors: */
+	public:
+	CallbackListAddRemoveBenchmark(size_t sNumCallbacks)
+		:Benchmark("Misc","CallbackList",Misc::stringPrintf("op=addRemove,n=%u",(unsigned int)sNumCallbacks)),
+		 numCallbacks(sNumCallbacks),
+		 list(0)
+		{
+		}
+	virtual ~CallbackListAddRemoveBenchmark(void)
+		{
+		delete list;
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		receivers.resize(numCallbacks+1);
+		list=new Misc::CallbackList;
+		for(size_t i=0;i<numCallbacks;++i)
+			list->add(&receivers[i],&CallbackReceiver::callback);
+		}
+	virtual void run(size_t numIterations)
+		{
+		/* Add and remove a callback at the end of the list: */
+		CallbackReceiver* receiver=&receivers[numCallbacks];
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			list->add(receiver,&CallbackReceiver::callback);
+			list->remove(receiver,&CallbackReceiver::callback);
+			}
+		}
+	virtual void teardown(void)
+		{
+		delete list;
+		list=0;
+		receivers.clear();
+		}
+	};
+
+class TimerEventBenchmark:public Benchmark
+	{
+	/* Embedded classes: */
+	public:
+	enum Operation // Enumerated type for measured scheduler operations
+		{
+		CANCEL_BY_ID,CANCEL_BY_CALLBACK,TRIGGER
+		};
+	
+	/* Elements: */
+	private:
+	Operation operation; // The measured operation
+	size_t numEvents; // Number of pending events in the scheduler
+	std::vector<CallbackReceiver> receivers; // The callback receivers
+	Misc::TimerEventScheduler* scheduler; // The event scheduler
+	double nextTime; // Time for newly scheduled triggered events
+	Misc::UInt32 nextCancelIndex; // Index from which the time of the next scheduled and cancelled event is derived
+	
+	/* Constructors and destructors: */
+	public:
+	TimerEventBenchmark(Operation sOperation,size_t sNumEvents)
+		:Benchmark("Misc","TimerEventScheduler",Misc::stringPrintf("op=%s,n=%u",sOperation==CANCEL_BY_ID?"scheduleCancelById":sOperation==CANCEL_BY_CALLBACK?"scheduleCancelByCallback":"scheduleTrigger",(unsigned int)sNumEvents)),
+		 operation(sOperation),numEvents(sNumEvents),
+		 scheduler(0),nextTime(0.0),nextCancelIndex(0)
+		{
+		}
+	virtual ~TimerEventBenchmark(void)
+		{
+		delete scheduler;
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		/* Schedule the pending events far in the future: */
+		receivers.resize(numEvents+1);
+		scheduler=new Misc::TimerEventScheduler;
+		for(size_t i=0;i<numEvents;++i)
+			scheduler->scheduleEvent(1.0e12+double(scrambleKey(Misc::UInt32(i))),&receivers[i],&CallbackReceiver::timerCallback);
+		nextTime=0.0;
+		nextCancelIndex=Misc::UInt32(numEvents);
+		}
+	virtual void run(size_t numIterations)
+		{
+		CallbackReceiver* receiver=&receivers[numEvents];
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			switch(operation)
+				{
+				case CANCEL_BY_ID:
+					{
+					/* Schedule and cancel an event at a random time among the pending events: */
+					double cancelTime=1.0e12+double(scrambleKey(nextCancelIndex++))+0.5;
+					Misc::TimerEventScheduler::EventId id=scheduler->scheduleEvent(cancelTime,receiver,&CallbackReceiver::timerCallback);
+					scheduler->removeEvent(id);
+					break;
+					}
+				
+				case CANCEL_BY_CALLBACK:
+					{
+					/* Schedule and cancel an event at a random time among the pending events: */
+					double cancelTime=1.0e12+double(scrambleKey(nextCancelIndex++))+0.5;
+					scheduler->scheduleEvent(cancelTime,receiver,&CallbackReceiver::timerCallback);
+					scheduler->removeEvent(cancelTime,receiver,&CallbackReceiver::timerCallback);
+					break;
+					}
+				
+				case TRIGGER:
+					/* Schedule and trigger an event before all pending events: */
+					nextTime+=1.0;
+					scheduler->scheduleEvent(nextTime,receiver,&CallbackReceiver::timerCallback);
+					scheduler->triggerEvents(nextTime);
+					break;
+				}
+			}
+		sink=receiver->numCalls;
+		}
+	virtual void teardown(void)
+		{
+		delete scheduler;
+		scheduler=0;
+		receivers.clear();
+		}
+	};
+
+/**********************************************
+Configuration file benchmarks (text vs.
+compiled configuration files):
+**********************************************/
+
+class ConfigurationFileBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	std::string configFileName; // Name of the loaded configuration file
+	bool compiled; // Flag whether to load a compiled version of the configuration file
+	std::string compiledFileName; // Name of the compiled configuration file
+	
+	/* Constructors and destructors: */
+	public:
+	ConfigurationFileBenchmark(const char* sConfigFileName,bool sCompiled)
+		:Benchmark("Misc","ConfigurationFile",Misc::stringPrintf("op=%s,file=%s",sCompiled?"loadCompiled":"load",sConfigFileName)),
+		 configFileName(sConfigFileName),compiled(sCompiled)
+		{
+		}
+	
+	/* Methods: */
+	virtual void setup(void)
+		{
+		if(compiled)
+			{
+			/* Compile the configuration file: */
+			compiledFileName=getTempFileName(".cfgc");
+			Misc::ConfigurationFile configFile(configFileName.c_str());
+			const char* sourceFileNames[1]={configFileName.c_str()};
+			configFile.saveCompiled(compiledFileName.c_str(),1,sourceFileNames);
+			}
+		}
+	virtual void run(size_t numIterations)
+		{
+		const char* sourceFileNames[1]={configFileName.c_str()};
+		for(size_t iteration=0;iteration<numIterations;++iteration)
+			{
+			Misc::ConfigurationFile configFile;
+			if(compiled)
+				{
+				if(!configFile.loadCompiled(compiledFileName.c_str(),1,sourceFileNames))
+					throw std::runtime_error("Compiled configuration file is out of date");
+				}
+			else
+				configFile.load(configFileName.c_str());
+			}
+		}
+	virtual void teardown(void)
+		{
+		if(compiled)
+			unlink(compiledFileName.c_str());
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	BenchmarkRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Hash tables: */
+	addHashTableBenchmarks<Misc::HashTable<Misc::UInt32,Misc::UInt32> >(runner,"HashTable");
+	addHashTableBenchmarks<Misc::OpenHashTable<Misc::UInt32,Misc::UInt32> >(runner,"OpenHashTable");
+	
+	/* Allocators: */
+	static const size_t batchSizes[]={16,4096};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new AllocatorBenchmark<NewAllocator>("Allocator.new",batchSizes[i]));
+		runner.addBenchmark(new AllocatorBenchmark<Misc::PoolAllocator<Node> >("PoolAllocator",batchSizes[i]));
+		}
+	
+	/* Dynamic arrays: */
+	runner.addBenchmark(new ArrayPushBenchmark<std::vector<int> >("Array.vector",1000000));
+	runner.addBenchmark(new ArrayPushBenchmark<ChunkedArrayAdapter<int> >("ChunkedArray",1000000));
+	runner.addBenchmark(new ArrayIterateBenchmark<std::vector<int> >("Array.vector",1000000));
+	runner.addBenchmark(new ArrayIterateBenchmark<ChunkedArrayAdapter<int> >("ChunkedArray",1000000));
+	
+	/* Priority heaps: */
+	runner.addBenchmark(new PriorityHeapBenchmark(64));
+	runner.addBenchmark(new PriorityHeapBenchmark(65536));
+	
+	/* Endianness conversion: */
+	runner.addBenchmark(new EndiannessBenchmark<Misc::UInt32>(true,1<<20));
+	runner.addBenchmark(new EndiannessBenchmark<Misc::UInt32>(false,1<<20));
+	runner.addBenchmark(new EndiannessBenchmark<Misc::UInt64>(true,1<<20));
+	runner.addBenchmark(new EndiannessBenchmark<Misc::UInt64>(false,1<<20));
+	
+	/* Callback lists: */
+	static const size_t numCallbacks[]={4,64,4096};
+	for(int i=0;i<3;++i)
+		{
+		runner.addBenchmark(new CallbackListCallBenchmark(numCallbacks[i],false));
+		runner.addBenchmark(new CallbackListCallBenchmark(numCallbacks[i],true));
+		runner.addBenchmark(new CallbackListAddRemoveBenchmark(numCallbacks[i]));
+		}
+	
+	/* Timer event schedulers: */
+	static const size_t numEvents[]={16,4096};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new TimerEventBenchmark(TimerEventBenchmark::CANCEL_BY_ID,numEvents[i]));
+		runner.addBenchmark(new TimerEventBenchmark(TimerEventBenchmark::CANCEL_BY_CALLBACK,numEvents[i]));
+		runner.addBenchmark(new TimerEventBenchmark(TimerEventBenchmark::TRIGGER,numEvents[i]));
+		}
+	
+	/* Configuration files; requires running from the Vrui source directory: */
+	const char* configFileName="Share/Vrui.cfg";
+	if(access(configFileName,R_OK)==0)
+		{
+		runner.addBenchmark(new ConfigurationFileBenchmark(configFileName,false));
+		runner.addBenchmark(new ConfigurationFileBenchmark(configFileName,true));
+		}
+	
+	return runner.run();
+	}
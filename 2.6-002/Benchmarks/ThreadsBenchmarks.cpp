@@ -0,0 +1,460 @@
+/***********************************************************************
+ThreadsBenchmarks - Micro-benchmarks for the locks, barriers, inter-
+thread buffers, and allocators of the Portable Threading Library.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <sched.h>
+#include <vector>
+#include <Misc/StringPrintf.h>
+#include <Threads/Config.h>
+#include <Threads/Mutex.h>
+#include <Threads/Spinlock.h>
+#include <Threads/Thread.h>
+#include <Threads/Barrier.h>
+#include <Threads/SpinBarrier.h>
+#include <Threads/RingBuffer.h>
+#include <Threads/SPSCRingBuffer.h>
+#include <Threads/TripleBuffer.h>
+#include <Threads/PoolAllocator.h>
+
+#include "Benchmark.h"
+#include "BenchmarkRunner.h"
+
+namespace {
+
+/*****************************************************
+Lock benchmarks; comparing results of builds with and
+without THREADS_PROFILE_LOCKS measures the overhead of
+lock profiling:
+*****************************************************/
+
+template <class LockParam>
+class LockBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	unsigned int numThreads; // Number of threads competing for the lock
+	LockParam lock; // The lock
+	size_t counter; // Counter protected by the lock
+	size_t numThreadIterations; // Number of lock acquisitions per thread in the current run
+	
+	/* Private methods: */
+	void* threadMethod(void) // Method run by each thread
+		{
+		for(size_t i=0;i<numThreadIterations;++i)
+			{
+			lock.lock();
+			++counter;
+			lock.unlock();
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	LockBenchmark(const char* lockName,unsigned int sNumThreads)
+		:Benchmark("Threads",lockName,Misc::stringPrintf("threads=%u",sNumThreads)),
+		 numThreads(sNumThreads),
+		 counter(0),numThreadIterations(0)
+		{
+		/* One operation is a lock/unlock pair in each thread: */
+		numOperations=double(numThreads);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		numThreadIterations=numIterations;
+		if(numThreads==1)
+			threadMethod();
+		else
+			{
+			/* Run all threads concurrently: */
+			Threads::Thread* threads=new Threads::Thread[numThreads];
+			for(unsigned int i=0;i<numThreads;++i)
+				threads[i].start(this,&LockBenchmark::threadMethod);
+			for(unsigned int i=0;i<numThreads;++i)
+				threads[i].join();
+			delete[] threads;
+			}
+		sink=counter;
+		}
+	};
+
+/**************************************
+Barrier benchmarks (Barrier vs.
+SpinBarrier):
+**************************************/
+
+template <class BarrierParam>
+class BarrierBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	unsigned int numThreads; // Number of synchronizing threads
+	BarrierParam barrier; // The barrier
+	size_t numThreadIterations; // Number of synchronizations in the current run
+	
+	/* Private methods: */
+	void* threadMethod(void) // Method run by each additional synchronizing thread
+		{
+		for(size_t i=0;i<numThreadIterations;++i)
+			barrier.synchronize();
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	BarrierBenchmark(const char* barrierName,unsigned int sNumThreads)
+		:Benchmark("Threads",barrierName,Misc::stringPrintf("threads=%u",sNumThreads)),
+		 numThreads(sNumThreads),
+		 barrier(sNumThreads),
+		 numThreadIterations(0)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		/* Start the additional threads and synchronize with them from the calling thread: */
+		numThreadIterations=numIterations;
+		Threads::Thread* threads=new Threads::Thread[numThreads-1];
+		for(unsigned int i=0;i<numThreads-1;++i)
+			threads[i].start(this,&BarrierBenchmark::threadMethod);
+		threadMethod();
+		for(unsigned int i=0;i<numThreads-1;++i)
+			threads[i].join();
+		delete[] threads;
+		}
+	};
+
+/*********************************************
+Ring buffer benchmarks (RingBuffer vs.
+SPSCRingBuffer):
+*********************************************/
+
+template <class RingBufferParam>
+class RingBufferThroughputBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	size_t chunkSize; // Number of values written and read at once
+	RingBufferParam buffer; // The ring buffer
+	size_t numValues; // Number of values to transfer in the current run
+	
+	/* Private methods: */
+	void* producerThreadMethod(void) // Method writing values into the ring buffer
+		{
+		std::vector<int> chunk(chunkSize);
+		for(size_t i=0;i<numValues;i+=chunkSize)
+			{
+			for(size_t j=0;j<chunkSize;++j)
+				chunk[j]=int(i+j);
+			buffer.blockingWrite(&chunk[0],chunkSize);
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	RingBufferThroughputBenchmark(const char* bufferName,size_t sBufferSize,size_t sChunkSize)
+		:Benchmark("Threads",bufferName,Misc::stringPrintf("op=throughput,size=%u,chunk=%u",(unsigned int)sBufferSize,(unsigned int)sChunkSize)),
+		 chunkSize(sChunkSize),
+		 buffer(sBufferSize),
+		 numValues(0)
+		{
+		/* One iteration transfers one chunk of values: */
+		numOperations=double(chunkSize);
+		numBytes=double(chunkSize)*double(sizeof(int));
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		/* Start a producer and consume its values in the calling thread: */
+		numValues=numIterations*chunkSize;
+		Threads::Thread producer;
+		producer.start(this,&RingBufferThroughputBenchmark::producerThreadMethod);
+		std::vector<int> chunk(chunkSize);
+		size_t result=0;
+		for(size_t i=0;i<numValues;i+=chunkSize)
+			{
+			buffer.blockingRead(&chunk[0],chunkSize);
+			result+=size_t(chunk[chunkSize-1]);
+			}
+		producer.join();
+		sink=result;
+		}
+	};
+
+template <class RingBufferParam>
+class RingBufferLatencyBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	RingBufferParam requests; // Ring buffer from the calling thread to the echo thread
+	RingBufferParam replies; // Ring buffer from the echo thread to the calling thread
+	size_t numRoundTrips; // Number of round trips in the current run
+	
+	/* Private methods: */
+	void* echoThreadMethod(void) // Method echoing values from the request buffer into the reply buffer
+		{
+		for(size_t i=0;i<numRoundTrips;++i)
+			{
+			int value;
+			requests.blockingRead(&value,1);
+			replies.blockingWrite(&value,1);
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	RingBufferLatencyBenchmark(const char* bufferName)
+		:Benchmark("Threads",bufferName,"op=roundTrip"),
+		 requests(16),replies(16),
+		 numRoundTrips(0)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		/* Start an echo thread and send values back and forth: */
+		numRoundTrips=numIterations;
+		Threads::Thread echo;
+		echo.start(this,&RingBufferLatencyBenchmark::echoThreadMethod);
+		size_t result=0;
+		for(size_t i=0;i<numRoundTrips;++i)
+			{
+			int value=int(i);
+			requests.blockingWrite(&value,1);
+			replies.blockingRead(&value,1);
+			result+=size_t(value);
+			}
+		echo.join();
+		sink=result;
+		}
+	};
+
+/*************************
+Triple buffer benchmarks:
+*************************/
+
+class TripleBufferBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	bool concurrent; // Flag whether a consumer thread polls the buffer concurrently
+	Threads::TripleBuffer<size_t> buffer; // The triple buffer
+	size_t lastValue; // The last value posted in the current run
+	size_t numReceived; // Number of new values seen by the consumer in the current run
+	
+	/* Private methods: */
+	void* consumerThreadMethod(void) // Method polling the buffer until the last value arrives
+		{
+		numReceived=0;
+		while(true)
+			{
+			if(buffer.lockNewValue())
+				{
+				++numReceived;
+				if(buffer.getLockedValue()==lastValue)
+					break;
+				}
+			else
+				sched_yield();
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	TripleBufferBenchmark(bool sConcurrent)
+		:Benchmark("Threads","TripleBuffer",sConcurrent?"op=postConcurrent":"op=postLock"),
+		 concurrent(sConcurrent),
+		 lastValue(0),numReceived(0)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		size_t firstValue=lastValue+1;
+		lastValue+=numIterations;
+		if(concurrent)
+			{
+			/* Post values while a consumer polls for them: */
+			Threads::Thread consumer;
+			consumer.start(this,&TripleBufferBenchmark::consumerThreadMethod);
+			for(size_t value=firstValue;value<=lastValue;++value)
+				{
+				buffer.startNewValue()=value;
+				buffer.postNewValue();
+				}
+			consumer.join();
+			addMetric("received",double(numReceived)*100.0/double(numIterations),"%");
+			}
+		else
+			{
+			/* Post and lock each value in turn: */
+			size_t result=0;
+			for(size_t value=firstValue;value<=lastValue;++value)
+				{
+				buffer.startNewValue()=value;
+				buffer.postNewValue();
+				if(buffer.lockNewValue())
+					result+=buffer.getLockedValue();
+				}
+			sink=result;
+			}
+		}
+	};
+
+/************************************************
+Allocator benchmarks (Threads::PoolAllocator vs.
+operator new):
+************************************************/
+
+struct Node // Structure for typical small allocated objects such as tree nodes
+	{
+	/* Elements: */
+	public:
+	Node* children[2];
+	double value;
+	};
+
+class NewAllocator // Adapter class to allocate nodes via operator new
+	{
+	/* Methods: */
+	public:
+	void* allocate(void)
+		{
+		return ::operator new(sizeof(Node));
+		}
+	void free(void* item)
+		{
+		::operator delete(item);
+		}
+	};
+
+template <class AllocatorParam>
+class AllocatorBenchmark:public Benchmark
+	{
+	/* Elements: */
+	private:
+	unsigned int numThreads; // Number of threads concurrently using the allocator
+	size_t batchSize; // Number of objects allocated before they are released
+	AllocatorParam allocator; // The allocator
+	size_t numThreadIterations; // Number of batches per thread in the current run
+	
+	/* Private methods: */
+	void* threadMethod(void) // Method run by each allocating thread
+		{
+		std::vector<void*> items(batchSize);
+		for(size_t iteration=0;iteration<numThreadIterations;++iteration)
+			{
+			for(size_t i=0;i<batchSize;++i)
+				items[i]=allocator.allocate();
+			for(size_t i=0;i<batchSize;++i)
+				allocator.free(items[(i*7919)%batchSize]);
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	AllocatorBenchmark(const char* allocatorName,unsigned int sNumThreads,size_t sBatchSize)
+		:Benchmark("Threads",allocatorName,Misc::stringPrintf("threads=%u,batch=%u",sNumThreads,(unsigned int)sBatchSize)),
+		 numThreads(sNumThreads),batchSize(sBatchSize),
+		 numThreadIterations(0)
+		{
+		/* One operation is an allocation and its release in each thread: */
+		numOperations=double(numThreads)*double(batchSize);
+		}
+	
+	/* Methods: */
+	virtual void run(size_t numIterations)
+		{
+		numThreadIterations=numIterations;
+		if(numThreads==1)
+			threadMethod();
+		else
+			{
+			Threads::Thread* threads=new Threads::Thread[numThreads];
+			for(unsigned int i=0;i<numThreads;++i)
+				threads[i].start(this,&AllocatorBenchmark::threadMethod);
+			for(unsigned int i=0;i<numThreads;++i)
+				threads[i].join();
+			delete[] threads;
+			}
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	BenchmarkRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Locks: */
+	static const unsigned int lockThreads[]={1,2,4};
+	for(int i=0;i<3;++i)
+		{
+		runner.addBenchmark(new LockBenchmark<Threads::Mutex>("Mutex",lockThreads[i]));
+		#if THREADS_CONFIG_HAVE_SPINLOCKS
+		runner.addBenchmark(new LockBenchmark<Threads::Spinlock>("Spinlock",lockThreads[i]));
+		#endif
+		}
+	
+	/* Barriers: */
+	for(unsigned int numThreads=2;numThreads<=8;numThreads*=2)
+		{
+		runner.addBenchmark(new BarrierBenchmark<Threads::Barrier>("Barrier",numThreads));
+		runner.addBenchmark(new BarrierBenchmark<Threads::SpinBarrier>("SpinBarrier",numThreads));
+		}
+	
+	/* Ring buffers: */
+	static const size_t chunkSizes[]={1,64};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new RingBufferThroughputBenchmark<Threads::RingBuffer<int> >("RingBuffer",1024,chunkSizes[i]));
+		runner.addBenchmark(new RingBufferThroughputBenchmark<Threads::SPSCRingBuffer<int> >("SPSCRingBuffer",1024,chunkSizes[i]));
+		}
+	runner.addBenchmark(new RingBufferLatencyBenchmark<Threads::RingBuffer<int> >("RingBuffer"));
+	runner.addBenchmark(new RingBufferLatencyBenchmark<Threads::SPSCRingBuffer<int> >("SPSCRingBuffer"));
+	
+	/* Triple buffers: */
+	runner.addBenchmark(new TripleBufferBenchmark(false));
+	runner.addBenchmark(new TripleBufferBenchmark(true));
+	
+	/* Allocators: */
+	static const unsigned int allocatorThreads[]={1,4};
+	for(int i=0;i<2;++i)
+		{
+		runner.addBenchmark(new AllocatorBenchmark<NewAllocator>("Allocator.new",allocatorThreads[i],256));
+		runner.addBenchmark(new AllocatorBenchmark<Threads::PoolAllocator<Node> >("PoolAllocator",allocatorThreads[i],256));
+		}
+	
+	return runner.run();
+	}
@@ -2,7 +2,7 @@
 PacketBuffer - Class to read/write arbitrary data types from/into memory
 buffers, as intermediate storage for file access or network
 transmission.
-Copyright (c) 2010 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the Vrui calibration utility package.
 
@@ -214,20 +214,10 @@ class PacketBuffer
 			resizeBuffer((dataEnd+sizeof(DataParam)*numItems)-buffer);
 		
 		if(mustSwapEndianness)
-			{
-			for(size_t i=0;i<numItems;++i)
-				{
-				DataParam temp=data[i];
-				Misc::swapEndianness(temp);
-				memcpy(dataEnd,&temp,sizeof(DataParam));
-				dataEnd+=sizeof(DataParam);
-				}
-			}
+			Misc::copySwapEndianness(data,numItems,dataEnd);
 		else
-			{
-			memcpy(dataEnd,&data,sizeof(DataParam)*numItems);
-			dataEnd+=sizeof(DataParam)*numItems;
-			}
+			memcpy(dataEnd,data,sizeof(DataParam)*numItems);
+		dataEnd+=sizeof(DataParam)*numItems;
 		}
 	};
 
@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <Misc/ThrowStdErr.h>
+#include <Threads/PlacementPolicy.h>
 #include <Cluster/Config.h>
 
 #if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
@@ -361,6 +362,9 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
 	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
 	
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("ClusterMultiplexer");
+	
 	/* Handle message exchange during multiplexer initialization: */
 	bool* slaveConnecteds=new bool[numSlaves];
 	for(unsigned int i=0;i<numSlaves;++i)
@@ -777,6 +781,9 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
 	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
 	
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("ClusterMultiplexer");
+	
 	/* Set the MSB on the nodeIndex to identify a slave-originating message: */
 	unsigned int sendNodeIndex=nodeIndex|0x80000000U;
 	
@@ -1052,8 +1059,10 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 	:numSlaves(sNumSlaves),nodeIndex(sNodeIndex),
 	 masterAddress(new sockaddr_in),
 	 otherAddress(new sockaddr_in),
+	 socketMutex("Cluster::Multiplexer::socketMutex"),
 	 socketFd(0),
 	 connected(false),
+	 pipeStateTableMutex("Cluster::Multiplexer::pipeStateTableMutex"),
 	 newPipes(17),
 	 lastPipeId(0),
 	 pipeStateTable(17),
@@ -1,7 +1,7 @@
 /***********************************************************************
 Multiplexer - Class to share several intra-cluster multicast pipes
 across a single UDP socket connection.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2013 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -24,7 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define CLUSTER_MULTIPLEXER_INCLUDED
 
 #include <string>
-#include <Misc/HashTable.h>
+#include <Misc/OpenHashTable.h>
 #include <Misc/Time.h>
 #include <Threads/Thread.h>
 #include <Threads/Mutex.h>
@@ -108,8 +108,8 @@ class Multiplexer
 		~PipeState(void); // Destroys a pipe state and all buffers in its delivery queue
 		};
 	
-	typedef Misc::HashTable<Threads::Thread::ID,PipeState*,Threads::Thread::ID> NewPipeHasher; // Hash table to map from thread IDs to pipe state table entries during pipe creation
-	typedef Misc::HashTable<unsigned int,PipeState*> PipeHasher; // Hash table to map from pipe IDs to pipe state table entries
+	typedef Misc::OpenHashTable<Threads::Thread::ID,PipeState*,Threads::Thread::ID> NewPipeHasher; // Hash table to map from thread IDs to pipe state table entries during pipe creation
+	typedef Misc::OpenHashTable<unsigned int,PipeState*> PipeHasher; // Hash table to map from pipe IDs to pipe state table entries
 	
 	class LockedPipe // Helper class to obtain locks on pipe state objects retrieved by pipe ID
 		{
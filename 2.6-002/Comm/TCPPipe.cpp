@@ -1,7 +1,7 @@
 /***********************************************************************
 TCPPipe - Class for high-performance reading/writing from/to connected
 TCP sockets.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -25,7 +25,10 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <unistd.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdio.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -37,6 +40,33 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Comm {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+#if defined(IOV_MAX)&&IOV_MAX<1024
+const unsigned int maxNumIovecs=IOV_MAX; // Maximum number of memory regions passed to a single readv/writev call
+#else
+const unsigned int maxNumIovecs=1024; // Maximum number of memory regions passed to a single readv/writev call
+#endif
+
+unsigned int prepareIovecs(const IO::File::IOVector* vectors,unsigned int numVectors,size_t firstOffset,struct iovec* iovecs) // Converts a batch of memory regions, skipping the given amount of data in the first one; returns number of converted regions
+	{
+	unsigned int numIovecs=numVectors<maxNumIovecs?numVectors:maxNumIovecs;
+	for(unsigned int i=0;i<numIovecs;++i)
+		{
+		iovecs[i].iov_base=vectors[i].data;
+		iovecs[i].iov_len=vectors[i].size;
+		}
+	iovecs[0].iov_base=static_cast<char*>(iovecs[0].iov_base)+firstOffset;
+	iovecs[0].iov_len-=firstOffset;
+	return numIovecs;
+	}
+
+}
+
 /************************
 Methods of class TCPPipe:
 ************************/
@@ -96,6 +126,89 @@ void TCPPipe::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 		}
 	}
 
+size_t TCPPipe::readDataVectored(const IO::File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Read more data from source into the first batch of memory regions: */
+	struct iovec iovecs[maxNumIovecs];
+	int numIovecs=int(prepareIovecs(vectors,numVectors,0,iovecs));
+	ssize_t readResult;
+	do
+		{
+		readResult=::readv(fd,iovecs,numIovecs);
+		}
+	while(readResult<0&&(errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR));
+	
+	/* Handle the result from the read call: */
+	if(readResult<0)
+		{
+		/* Unknown error; probably a bad thing: */
+		int errorCode=errno;
+		Misc::throwStdErr("Comm::TCPPipe: Fatal error %d while reading from source",errorCode);
+		}
+	
+	return size_t(readResult);
+	}
+
+void TCPPipe::writeDataVectored(const IO::File::IOVector* vectors,unsigned int numVectors)
+	{
+	struct iovec iovecs[maxNumIovecs];
+	size_t firstOffset=0;
+	while(true)
+		{
+		/* Skip all completely written memory regions: */
+		while(numVectors>0&&firstOffset==vectors->size)
+			{
+			++vectors;
+			--numVectors;
+			firstOffset=0;
+			}
+		if(numVectors==0)
+			break;
+		
+		/* Write the next batch of memory regions: */
+		int numIovecs=int(prepareIovecs(vectors,numVectors,firstOffset,iovecs));
+		ssize_t writeResult=::writev(fd,iovecs,numIovecs);
+		if(writeResult>0)
+			{
+			/* Prepare to write more data: */
+			size_t writeSize=writeResult;
+			while(writeSize>=vectors->size-firstOffset)
+				{
+				writeSize-=vectors->size-firstOffset;
+				++vectors;
+				--numVectors;
+				firstOffset=0;
+				if(numVectors==0)
+					break;
+				}
+			firstOffset+=writeSize;
+			}
+		else if(errno==EPIPE)
+			{
+			/* Other side hung up: */
+			Misc::throwStdErr("Comm::TCPPipe: Connection terminated by peer");
+			}
+		else if(writeResult<0&&(errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR))
+			{
+			/* Do nothing and try again */
+			}
+		else if(writeResult==0)
+			{
+			/* Sink has reached end-of-file: */
+			size_t numMissingBytes=vectors->size-firstOffset;
+			for(unsigned int i=1;i<numVectors;++i)
+				numMissingBytes+=vectors[i].size;
+			throw WriteError(numMissingBytes);
+			}
+		else
+			{
+			/* Unknown error; probably a bad thing: */
+			int errorCode=errno;
+			Misc::throwStdErr("Comm::TCPPipe: Fatal error %d while writing to sink",errorCode);
+			}
+		}
+	}
+
 TCPPipe::TCPPipe(const char* hostName,int portId)
 	:NetPipe(ReadWrite),
 	 fd(-1)
@@ -148,6 +261,14 @@ TCPPipe::TCPPipe(const char* hostName,int portId)
 		fd=-1;
 		Misc::throwStdErr("Cluster::TCPPipe::TCPPipe: Unable to disable Nagle's algorithm on socket");
 		}
+	
+	/* Label the pipe's performance counters: */
+	if(getStatistics()!=0)
+		{
+		char label[1024];
+		snprintf(label,sizeof(label),"tcp://%s:%d",hostName,portId);
+		setStatisticsLabel(label);
+		}
 	}
 
 TCPPipe::TCPPipe(ListeningTCPSocket& listenSocket)
@@ -162,6 +283,14 @@ TCPPipe::TCPPipe(ListeningTCPSocket& listenSocket)
 	/* Set the TCP_NODELAY socket option: */
 	int flag=1;
 	setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&flag,sizeof(flag));
+	
+	/* Label the pipe's performance counters: */
+	if(getStatistics()!=0)
+		{
+		char label[1024];
+		snprintf(label,sizeof(label),"tcp://%s:%d",getPeerAddress().c_str(),getPeerPortId());
+		setStatisticsLabel(label);
+		}
 	}
 
 TCPPipe::~TCPPipe(void)
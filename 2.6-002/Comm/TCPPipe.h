@@ -1,7 +1,7 @@
 /***********************************************************************
 TCPPipe - Class for high-performance reading/writing from/to connected
 TCP sockets.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -43,6 +43,8 @@ class TCPPipe:public NetPipe
 	protected:
 	virtual size_t readData(Byte* buffer,size_t bufferSize);
 	virtual void writeData(const Byte* buffer,size_t bufferSize);
+	virtual size_t readDataVectored(const IOVector* vectors,unsigned int numVectors);
+	virtual void writeDataVectored(const IOVector* vectors,unsigned int numVectors);
 	
 	/* Constructors and destructors: */
 	public:
@@ -21,6 +21,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 ***********************************************************************/
 
 #include <unistd.h>
+#include <string.h>
 #include <errno.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -204,4 +205,77 @@ size_t UDPSocket::receiveMessage(void* messageBuffer,size_t messageSize)
 	return size_t(recvResult);
 	}
 
+size_t UDPSocket::receiveLatestMessage(void* messageBuffer,size_t messageBufferSize,unsigned int* numDiscardedMessages)
+	{
+	unsigned int numReceived=0;
+	size_t latestSize=0;
+	
+	#ifdef __linux__
+	
+	/* Point all message headers at the same buffer, so each received message overwrites its predecessor: */
+	const int batchSize=16;
+	struct iovec iov;
+	iov.iov_base=messageBuffer;
+	iov.iov_len=messageBufferSize;
+	struct mmsghdr messages[batchSize];
+	memset(messages,0,sizeof(messages));
+	for(int i=0;i<batchSize;++i)
+		{
+		messages[i].msg_hdr.msg_iov=&iov;
+		messages[i].msg_hdr.msg_iovlen=1;
+		}
+	
+	/* Block for the first message, then drain the socket without blocking: */
+	int flags=MSG_WAITFORONE;
+	while(true)
+		{
+		int recvResult=recvmmsg(socketFd,messages,batchSize,flags,0);
+		if(recvResult<0)
+			{
+			if(errno==EINTR||((errno==EAGAIN||errno==EWOULDBLOCK)&&numReceived==0))
+				continue;
+			if(errno==EAGAIN||errno==EWOULDBLOCK)
+				break;
+			
+			/* Unknown error; probably a bad thing: */
+			int errorCode=errno;
+			Misc::throwStdErr("Comm::UDPSocket: Fatal error %d while receiving messages",errorCode);
+			}
+		numReceived+=(unsigned int)recvResult;
+		latestSize=messages[recvResult-1].msg_len;
+		if(recvResult<batchSize)
+			break;
+		flags=MSG_DONTWAIT;
+		}
+	
+	#else
+	
+	/* Block for the first message, then drain the socket without blocking: */
+	int flags=0;
+	while(true)
+		{
+		ssize_t recvResult=recv(socketFd,messageBuffer,messageBufferSize,flags);
+		if(recvResult<0)
+			{
+			if(errno==EINTR||((errno==EAGAIN||errno==EWOULDBLOCK)&&numReceived==0))
+				continue;
+			if(errno==EAGAIN||errno==EWOULDBLOCK)
+				break;
+			
+			/* Unknown error; probably a bad thing: */
+			int errorCode=errno;
+			Misc::throwStdErr("Comm::UDPSocket: Fatal error %d while receiving messages",errorCode);
+			}
+		++numReceived;
+		latestSize=size_t(recvResult);
+		flags=MSG_DONTWAIT;
+		}
+	
+	#endif
+	
+	if(numDiscardedMessages!=0)
+		*numDiscardedMessages=numReceived-1;
+	return latestSize;
+	}
+
 }
@@ -76,6 +76,7 @@ class UDPSocket
 	/* I/O methods: */
 	void sendMessage(const void* messageBuffer,size_t messageSize); // Sends a message on a connected socket
 	size_t receiveMessage(void* messageBuffer,size_t messageBufferSize); // Receives a message; returns size of received message
+	size_t receiveLatestMessage(void* messageBuffer,size_t messageBufferSize,unsigned int* numDiscardedMessages =0); // Blocks until at least one message is available, then drains all pending messages and keeps only the newest one; returns size of newest message
 	};
 
 }
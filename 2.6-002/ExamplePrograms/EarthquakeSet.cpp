@@ -1,7 +1,7 @@
 /***********************************************************************
 EarthquakeSet - Class to represent and render sets of earthquakes with
 3D locations, magnitude and event time.
-Copyright (c) 2006-2012 Oliver Kreylos
+Copyright (c) 2006-2013 Oliver Kreylos
 
 This program is free software; you can redistribute it and/or modify it
 under the terms of the GNU General Public License as published by the
@@ -25,12 +25,18 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <string>
 #include <iostream>
 #include <algorithm>
 #include <Misc/ThrowStdErr.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/FileNameExtensions.h>
 #include <IO/ValueSource.h>
+#include <IO/NumberParser.h>
+#include <IO/StandardFile.h>
+#include <IO/VariableMemoryFile.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Geometry/HVector.h>
@@ -69,6 +75,27 @@ bool strequal(std::string s1,const char* s2)
 	return s1It==s1.end()&&*s2Ptr=='\0';
 	}
 
+double parseColumn(const std::string& line,size_t start,size_t width)
+	{
+	/* Clip the column to the line: */
+	if(start>line.size())
+		start=line.size();
+	if(width>line.size()-start)
+		width=line.size()-start;
+	const char* cPtr=line.data()+start;
+	const char* end=cPtr+width;
+	
+	/* Skip leading whitespace: */
+	while(cPtr!=end&&isspace(*cPtr))
+		++cPtr;
+	
+	/* Parse the column's number in place; malformed columns read as zero: */
+	double result;
+	if(!IO::parseNumber(cPtr,end,result))
+		result=0.0;
+	return result;
+	}
+
 double parseDateTime(const char* date,const char* time)
 	{
 	struct tm dateTime;
@@ -123,6 +150,61 @@ double parseDateTime(const char* date,const char* time)
 	return double(mktime(&dateTime));
 	}
 
+
+/***********************************************************************
+Helper functions to maintain binary cache files of parsed earthquake
+files:
+***********************************************************************/
+
+const char* cacheFileHeader="Vrui Earthquake Cache v1.0\n"; // Identifying header of earthquake cache files
+const size_t cacheFileHeaderSize=27;
+const size_t sourceHashBlockSize=65536; // Size of the blocks at the beginning and end of an earthquake file that contribute to its hash
+
+bool getSourceStamp(const char* earthquakeFileName,Misc::UInt64 sourceStamp[3]) // Identifies the current state of an earthquake file by its size, modification time, and a hash of its first and last blocks; returns false if the file is not a local file
+	{
+	/* Query the earthquake file's size and modification time: */
+	struct stat statBuffer;
+	if(stat(earthquakeFileName,&statBuffer)!=0||!S_ISREG(statBuffer.st_mode))
+		return false;
+	sourceStamp[0]=Misc::UInt64(statBuffer.st_size);
+	sourceStamp[1]=Misc::UInt64(statBuffer.st_mtime);
+	
+	try
+		{
+		/* Hash the first and last blocks of the earthquake file with 64-bit FNV-1a: */
+		IO::StandardFile sourceFile(earthquakeFileName);
+		Misc::UInt64 hash=0xcbf29ce484222325ULL;
+		IO::SeekableFile::Offset blockOffsets[2];
+		blockOffsets[0]=0;
+		blockOffsets[1]=sourceFile.getSize()>IO::SeekableFile::Offset(2*sourceHashBlockSize)?sourceFile.getSize()-IO::SeekableFile::Offset(sourceHashBlockSize):IO::SeekableFile::Offset(sourceHashBlockSize);
+		for(int block=0;block<2;++block)
+			{
+			sourceFile.setReadPosAbs(blockOffsets[block]);
+			size_t hashSize=sourceHashBlockSize;
+			while(hashSize>0)
+				{
+				void* buffer;
+				size_t bufferSize=sourceFile.readInBuffer(buffer,hashSize);
+				if(bufferSize==0)
+					break;
+				const unsigned char* bPtr=static_cast<const unsigned char*>(buffer);
+				for(size_t i=0;i<bufferSize;++i,++bPtr)
+					{
+					hash^=Misc::UInt64(*bPtr);
+					hash*=0x100000001b3ULL;
+					}
+				hashSize-=bufferSize;
+				}
+			}
+		sourceStamp[2]=hash;
+		}
+	catch(std::runtime_error err)
+		{
+		return false;
+		}
+	
+	return true;
+	}
 }
 
 /****************************************
@@ -154,13 +236,13 @@ EarthquakeSet::DataItem::DataItem(void)
 			GLARBMultitexture::initExtension();
 			GLARBPointParameters::initExtension();
 			GLARBPointSprite::initExtension();
-
+			
 			/* Create the shader object: */
 			pointRenderer=new GLShader;
-
+			
 			/* Create the point texture object: */
 			glGenTextures(1,&pointTextureObjectId);
-
+			
 			/* Create the sorted point index buffer: */
 			glGenBuffersARB(1,&sortedPointIndicesBufferObjectId);
 			}
@@ -231,23 +313,19 @@ void EarthquakeSet::loadANSSFile(IO::FilePtr earthquakeFile,double scaleFactor)
 		float sphericalCoordinates[3];
 		
 		/* Read latitude: */
-		std::string lat(line,23,8);
-		sphericalCoordinates[0]=Math::rad(float(atof(lat.c_str())));
+		sphericalCoordinates[0]=Math::rad(float(parseColumn(line,23,8)));
 		
 		/* Read longitude: */
-		std::string lon(line,32,9);
-		sphericalCoordinates[1]=Math::rad(float(atof(lon.c_str())));
+		sphericalCoordinates[1]=Math::rad(float(parseColumn(line,32,9)));
 		
 		/* Read depth: */
-		std::string dep(line,42,6);
-		sphericalCoordinates[2]=float(atof(dep.c_str()));
+		sphericalCoordinates[2]=float(parseColumn(line,42,6));
 		
 		/* Convert the spherical position to Cartesian: */
 		calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
 		
 		/* Read magnitude: */
-		std::string mag(line,49,5);
-		e.magnitude=float(atof(mag.c_str()));
+		e.magnitude=float(parseColumn(line,49,5));
 		
 		/* Save the event: */
 		events.push_back(e);
@@ -441,7 +519,7 @@ void EarthquakeSet::drawBackToFront(int left,int right,int splitDimension,const
 		childSplitDimension=0;
 	
 	/* Traverse into the subtree on the far side of the split plane first: */
-	if(eyePos[splitDimension]>events[treePointIndices[mid]].position[splitDimension])
+	if(eyePos[splitDimension]>events[mid].position[splitDimension])
 		{
 		/* Traverse left child: */
 		if(left<mid)
@@ -585,22 +663,8 @@ void EarthquakeSet::createShader(EarthquakeSet::DataItem* dataItem,const GLClipP
 	dataItem->pointTextureLocation=dataItem->pointRenderer->getUniformLocation("pointTexture");
 	}
 
-EarthquakeSet::EarthquakeSet(const char* earthquakeFileName,IO::FilePtr earthquakeFile,double scaleFactor)
-	:treePointIndices(0),
-	 pointRadius(1.0f),highlightTime(1.0),currentTime(0.0)
+void EarthquakeSet::sortEvents(void)
 	{
-	/* Check the earthquake file name's extension: */
-	if(Misc::hasCaseExtension(earthquakeFileName,".anss"))
-		{
-		/* Read an earthquake database snapshot in "readable" ANSS format: */
-		loadANSSFile(earthquakeFile,scaleFactor);
-		}
-	else
-		{
-		/* Read an earthquake event file in space- or comma-separated format: */
-		loadCSVFile(earthquakeFileName,earthquakeFile,scaleFactor);
-		}
-	
 	/* Create a temporary kd-tree to sort the events for back-to-front traversal: */
 	Geometry::ArrayKdTree<Geometry::ValuedPoint<Point,int> > sortTree(events.size());
 	Geometry::ValuedPoint<Point,int>* stPtr=sortTree.accessPoints();
@@ -612,16 +676,160 @@ EarthquakeSet::EarthquakeSet(const char* earthquakeFileName,IO::FilePtr earthqua
 		}
 	sortTree.releasePoints(8);
 	
-	/* Retrieve the sorted event indices: */
-	treePointIndices=new int[events.size()];
+	/* Reorder the events into kd-tree order: */
+	std::vector<Event> sortedEvents;
+	sortedEvents.reserve(events.size());
 	stPtr=sortTree.accessPoints();
 	for(int i=0;i<sortTree.getNumNodes();++i,++stPtr)
-		treePointIndices[i]=stPtr->value;
+		sortedEvents.push_back(events[stPtr->value]);
+	events.swap(sortedEvents);
+	}
+
+void EarthquakeSet::loadCacheFile(IO::File& cacheFile)
+	{
+	/* Skip the cache file's header, source stamp, and scale factor, which were checked by isCacheFileValid: */
+	cacheFile.setEndianness(Misc::LittleEndian);
+	char header[cacheFileHeaderSize];
+	cacheFile.read<char>(header,cacheFileHeaderSize);
+	Misc::UInt64 sourceStamp[3];
+	cacheFile.read<Misc::UInt64>(sourceStamp,3);
+	cacheFile.read<Misc::Float64>();
+	
+	/* Read the event position, time, and magnitude columns: */
+	Misc::UInt64 numEvents=cacheFile.read<Misc::UInt64>();
+	events.resize(numEvents);
+	for(std::vector<Event>::iterator eIt=events.begin();eIt!=events.end();++eIt)
+		cacheFile.read<Misc::Float32>(eIt->position.getComponents(),3);
+	for(std::vector<Event>::iterator eIt=events.begin();eIt!=events.end();++eIt)
+		eIt->time=cacheFile.read<Misc::Float64>();
+	for(std::vector<Event>::iterator eIt=events.begin();eIt!=events.end();++eIt)
+		eIt->magnitude=cacheFile.read<Misc::Float32>();
+	}
+
+bool EarthquakeSet::saveCacheFile(const char* earthquakeFileName,double scaleFactor) const
+	{
+	/* Identify the current state of the earthquake file: */
+	Misc::UInt64 sourceStamp[3];
+	if(!getSourceStamp(earthquakeFileName,sourceStamp))
+		return false;
+	
+	std::string cacheFileName=getCacheFileName(earthquakeFileName);
+	try
+		{
+		/* Assemble the cache file in memory: */
+		IO::VariableMemoryFile cache;
+		cache.setEndianness(Misc::LittleEndian);
+		
+		/* Write the cache file's header: */
+		cache.write<char>(cacheFileHeader,cacheFileHeaderSize);
+		cache.write<Misc::UInt64>(sourceStamp,3);
+		cache.write<Misc::Float64>(scaleFactor);
+		cache.write<Misc::UInt64>(events.size());
+		
+		/* Write the event position, time, and magnitude columns: */
+		for(std::vector<Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt)
+			cache.write<Misc::Float32>(eIt->position.getComponents(),3);
+		for(std::vector<Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt)
+			cache.write<Misc::Float64>(eIt->time);
+		for(std::vector<Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt)
+			cache.write<Misc::Float32>(eIt->magnitude);
+		
+		/* Write the cache file without a write buffer, so that write errors are reported here instead of when the file is closed: */
+		IO::StandardFile cacheFile(cacheFileName.c_str(),IO::File::WriteOnly);
+		cacheFile.resizeWriteBuffer(0);
+		cache.writeToSink(cacheFile);
+		}
+	catch(std::runtime_error err)
+		{
+		/* Remove the incomplete cache file; the earthquake file will be parsed again the next time: */
+		unlink(cacheFileName.c_str());
+		return false;
+		}
+	
+	return true;
+	}
+
+std::string EarthquakeSet::getCacheFileName(const char* earthquakeFileName)
+	{
+	std::string result=earthquakeFileName;
+	result.append(".eqcache");
+	return result;
+	}
+
+bool EarthquakeSet::isCacheFileValid(const char* earthquakeFileName,double scaleFactor)
+	{
+	/* Identify the current state of the earthquake file: */
+	Misc::UInt64 sourceStamp[3];
+	if(!getSourceStamp(earthquakeFileName,sourceStamp))
+		return false;
+	
+	try
+		{
+		/* Open the cache file: */
+		IO::StandardFile cacheFile(getCacheFileName(earthquakeFileName).c_str());
+		cacheFile.setEndianness(Misc::LittleEndian);
+		
+		/* Check the cache file's header: */
+		if(cacheFile.getSize()<IO::SeekableFile::Offset(cacheFileHeaderSize+5*sizeof(Misc::UInt64)))
+			return false;
+		char header[cacheFileHeaderSize];
+		cacheFile.read<char>(header,cacheFileHeaderSize);
+		if(memcmp(header,cacheFileHeader,cacheFileHeaderSize)!=0)
+			return false;
+		
+		/* Check that the cache file was created from the current earthquake file with the same scale factor: */
+		for(int i=0;i<3;++i)
+			if(cacheFile.read<Misc::UInt64>()!=sourceStamp[i])
+				return false;
+		if(cacheFile.read<Misc::Float64>()!=Misc::Float64(scaleFactor))
+			return false;
+		
+		/* Check that the cache file is complete: */
+		Misc::UInt64 numEvents=cacheFile.read<Misc::UInt64>();
+		if(cacheFile.getSize()!=IO::SeekableFile::Offset(cacheFileHeaderSize+5*sizeof(Misc::UInt64)+numEvents*(3*sizeof(Misc::Float32)+sizeof(Misc::Float64)+sizeof(Misc::Float32))))
+			return false;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Treat missing or unreadable cache files as invalid; the earthquake file will be parsed */
+		return false;
+		}
+	
+	return true;
+	}
+
+EarthquakeSet::EarthquakeSet(const char* earthquakeFileName,IO::FilePtr earthquakeFile,double scaleFactor,bool saveCache)
+	:pointRadius(1.0f),highlightTime(1.0),currentTime(0.0)
+	{
+	/* Check the earthquake file name's extension: */
+	if(Misc::hasCaseExtension(earthquakeFileName,".anss"))
+		{
+		/* Read an earthquake database snapshot in "readable" ANSS format: */
+		loadANSSFile(earthquakeFile,scaleFactor);
+		}
+	else
+		{
+		/* Read an earthquake event file in space- or comma-separated format: */
+		loadCSVFile(earthquakeFileName,earthquakeFile,scaleFactor);
+		}
+	
+	/* Sort the events for back-to-front traversal: */
+	sortEvents();
+	
+	/* Save the sorted events for the next time the earthquake file is loaded: */
+	if(saveCache)
+		saveCacheFile(earthquakeFileName,scaleFactor);
+	}
+
+EarthquakeSet::EarthquakeSet(IO::FilePtr cacheFile)
+	:pointRadius(1.0f),highlightTime(1.0),currentTime(0.0)
+	{
+	/* Read the pre-sorted events from the cache file: */
+	loadCacheFile(*cacheFile);
 	}
 
 EarthquakeSet::~EarthquakeSet(void)
 	{
-	delete[] treePointIndices;
 	}
 
 void EarthquakeSet::initContext(GLContextData& contextData) const
@@ -642,7 +850,7 @@ void EarthquakeSet::initContext(GLContextData& contextData) const
 		for(int i=0;i<numPoints;++i,++vPtr)
 			{
 			/* Get a reference to the event in kd-tree order: */
-			const Event& e=events[treePointIndices[i]];
+			const Event& e=events[i];
 			
 			/* Copy the event's magnitude and time: */
 			vPtr->texCoord[0]=Vertex::TexCoord::Scalar(e.magnitude);
@@ -1,7 +1,7 @@
 /***********************************************************************
 EarthquakeSet - Class to represent and render sets of earthquakes with
 3D locations, magnitude and event time.
-Copyright (c) 2006-2012 Oliver Kreylos
+Copyright (c) 2006-2013 Oliver Kreylos
 
 This program is free software; you can redistribute it and/or modify it
 under the terms of the GNU General Public License as published by the
@@ -22,6 +22,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define EARTHQUAKESET_INCLUDED
 
 #include <utility>
+#include <string>
 #include <vector>
 #include <IO/File.h>
 #include <Geometry/Point.h>
@@ -76,8 +77,7 @@ class EarthquakeSet:public GLObject
 		};
 	
 	/* Elements: */
-	std::vector<Event> events; // Vector of earthquakes
-	int* treePointIndices; // Array of event indices in kd-tree order
+	std::vector<Event> events; // Vector of earthquakes in kd-tree order
 	float pointRadius; // Point radius in model space
 	double highlightTime; // Time span (in real time) for which earthquake events are highlighted during animation
 	double currentTime; // Current event time during animation
@@ -85,14 +85,22 @@ class EarthquakeSet:public GLObject
 	/* Private methods: */
 	void loadANSSFile(IO::FilePtr earthquakeFile,double scaleFactor); // Loads an earthquake event file in ANSS readable database snapshot format
 	void loadCSVFile(const char* earthquakeFileName,IO::FilePtr earthquakeFile,double scaleFactor); // Loads an earthquake event file in space- or comma-separated format
+	void sortEvents(void); // Sorts the loaded events into kd-tree order for back-to-front traversal
+	void loadCacheFile(IO::File& cacheFile); // Reads pre-sorted events from a binary cache file
 	void drawBackToFront(int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr) const; // Renders the given kd-tree subtree in back-to-front order
 	void createShader(DataItem* dataItem,const GLClipPlaneTracker& cpt) const; // Creates the particle rendering shader based on current OpenGL settings
 	
 	/* Constructors and destructors: */
 	public:
-	EarthquakeSet(const char* earthquakeFileName,IO::FilePtr earthquakeFile,double scaleFactor); // Creates an earthquake set by reading a file; applies scale factor to Cartesian coordinates
+	EarthquakeSet(const char* earthquakeFileName,IO::FilePtr earthquakeFile,double scaleFactor,bool saveCache =true); // Creates an earthquake set by parsing a file; applies scale factor to Cartesian coordinates; writes a new cache file if requested
+	EarthquakeSet(IO::FilePtr cacheFile); // Creates an earthquake set from a binary cache file that was checked with isCacheFileValid
 	~EarthquakeSet(void);
 	
+	/* Methods: */
+	static std::string getCacheFileName(const char* earthquakeFileName); // Returns the name of the binary cache file of the given earthquake file
+	static bool isCacheFileValid(const char* earthquakeFileName,double scaleFactor); // Returns true if the given earthquake file has a complete cache file created from its current contents with the given scale factor
+	bool saveCacheFile(const char* earthquakeFileName,double scaleFactor) const; // Saves the sorted events to the binary cache file of the given earthquake file; returns false if the cache file could not be written
+	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
 	
@@ -0,0 +1,81 @@
+/***********************************************************************
+MakeEarthquakeCache - Utility to convert earthquake event files into
+binary cache files offline, so that ShowEarthModel can load them
+without parsing.
+Copyright (c) 2013 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <IO/OpenFile.h>
+
+#include "EarthquakeSet.h"
+
+int main(int argc,char* argv[])
+	{
+	/* Parse command line: */
+	double scaleFactor=1.0e-3;
+	int numFiles=0;
+	int result=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"scale")==0)
+				{
+				++i;
+				if(i<argc)
+					scaleFactor=atof(argv[i]);
+				else
+					fprintf(stderr,"Ignored dangling -scale switch\n");
+				}
+			else
+				fprintf(stderr,"Unrecognized switch %s\n",argv[i]);
+			}
+		else
+			{
+			/* Load the earthquake file and write its cache file: */
+			try
+				{
+				EarthquakeSet earthquakeSet(argv[i],IO::openFile(argv[i]),scaleFactor,false);
+				if(earthquakeSet.saveCacheFile(argv[i],scaleFactor))
+					printf("Wrote cache file for %s\n",argv[i]);
+				else
+					{
+					fprintf(stderr,"Unable to write cache file for earthquake file %s\n",argv[i]);
+					result=1;
+					}
+				}
+			catch(std::runtime_error err)
+				{
+				fprintf(stderr,"Unable to convert earthquake file %s due to exception %s\n",argv[i],err.what());
+				result=1;
+				}
+			++numFiles;
+			}
+		}
+	
+	if(numFiles==0)
+		{
+		fprintf(stderr,"Usage: %s [-scale <scale factor>] <earthquake file name> [<earthquake file name> ...]\n",argv[0]);
+		return 1;
+		}
+	
+	return result;
+	}
@@ -2,7 +2,7 @@
 ShowEarthModel - Simple Vrui application to render a model of Earth,
 with the ability to additionally display earthquake location data and
 other geology-related stuff.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2013 Oliver Kreylos
 
 This program is free software; you can redistribute it and/or modify it
 under the terms of the GNU General Public License as published by the
@@ -70,6 +70,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <SceneGraph/GroupNode.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <Cluster/MulticastPipe.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/CoordinateManager.h>
 #include <Vrui/Viewer.h>
@@ -833,8 +834,26 @@ ShowEarthModel::ShowEarthModel(int& argc,char**& argv,char**& appDefaults)
 				
 				case EARTHQUAKESETFILE:
 					{
-					/* Load an earthquake set: */
-					EarthquakeSet* earthquakeSet=new EarthquakeSet(argv[i],Vrui::openFile(argv[i]),1.0e-3);
+					/* Check on the master whether the earthquake file's cache file is up to date, and share the decision with the slaves: */
+					bool useCache=false;
+					if(Vrui::isMaster())
+						{
+						useCache=EarthquakeSet::isCacheFileValid(argv[i],1.0e-3);
+						if(Vrui::getMainPipe()!=0)
+							{
+							Vrui::getMainPipe()->write<char>(useCache?1:0);
+							Vrui::getMainPipe()->flush();
+							}
+						}
+					else
+						useCache=Vrui::getMainPipe()->read<char>()!=0;
+					
+					/* Load an earthquake set from its cache file or its source file; both are forwarded to the slaves by the master: */
+					EarthquakeSet* earthquakeSet;
+					if(useCache)
+						earthquakeSet=new EarthquakeSet(Vrui::openFile(EarthquakeSet::getCacheFileName(argv[i]).c_str()));
+					else
+						earthquakeSet=new EarthquakeSet(argv[i],Vrui::openFile(argv[i]),1.0e-3,Vrui::isMaster());
 					earthquakeSets.push_back(earthquakeSet);
 					showEarthquakeSets.push_back(false);
 					break;
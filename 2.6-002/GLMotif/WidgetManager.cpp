@@ -1,7 +1,7 @@
 /***********************************************************************
 WidgetManager - Class to manage top-level GLMotif UI components and user
 events.
-Copyright (c) 2001-2010 Oliver Kreylos
+Copyright (c) 2001-2013 Oliver Kreylos
 
 This file is part of the GLMotif Widget Library (GLMotif).
 
@@ -277,9 +277,10 @@ void WidgetManager::unmanageWidget(Widget* widget)
 	WidgetAttributeMap::Iterator waIt=widgetAttributeMap.findEntry(widget);
 	if(!waIt.isFinished())
 		{
-		/* Delete the attribute: */
-		delete waIt->getDest();
+		/* Remove and delete the attribute: */
+		WidgetAttributeBase* attribute=waIt->getDest();
 		widgetAttributeMap.removeEntry(waIt);
+		delete attribute;
 		}
 	}
 
@@ -387,7 +388,9 @@ void WidgetManager::popdownWidget(Widget* widget)
 		if(binding->succ!=0)
 			binding->succ->pred=binding->pred;
 		delete binding;
-		popupBindingMap.removeEntry(pbmIt);
+		
+		/* Remove the binding from the map; popping down secondary widgets might have moved its entry: */
+		popupBindingMap.removeEntry(topLevelWidget);
 		}
 	}
 
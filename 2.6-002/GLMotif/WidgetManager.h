@@ -1,7 +1,7 @@
 /***********************************************************************
 WidgetManager - Class to manage top-level GLMotif UI components and user
 events.
-Copyright (c) 2001-2010 Oliver Kreylos
+Copyright (c) 2001-2013 Oliver Kreylos
 
 This file is part of the GLMotif Widget Library (GLMotif).
 
@@ -26,7 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <vector>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
-#include <Misc/HashTable.h>
+#include <Misc/OpenHashTable.h>
 #include <Misc/ThrowStdErr.h>
 #include <Geometry/OrthogonalTransformation.h>
 #include <GLMotif/Types.h>
@@ -121,7 +121,7 @@ class WidgetManager
 		void draw(bool overlayWidgets,GLContextData& contextData) const;
 		};
 	
-	typedef Misc::HashTable<const Widget*,PopupBinding*> PopupBindingMap; // Type to map top-level widgets to their popup bindings
+	typedef Misc::OpenHashTable<const Widget*,PopupBinding*> PopupBindingMap; // Type to map top-level widgets to their popup bindings
 	
 	public:
 	class PoppedWidgetIterator // Class to iterate through popped-up widgets
@@ -218,7 +218,7 @@ class WidgetManager
 		};
 	
 	private:
-	typedef Misc::HashTable<const Widget*,WidgetAttributeBase*> WidgetAttributeMap; // Type for hash tables mapping widgets to widget attributes
+	typedef Misc::OpenHashTable<const Widget*,WidgetAttributeBase*> WidgetAttributeMap; // Type for hash tables mapping widgets to widget attributes
 	
 	/* Elements: */
 	private:
@@ -1,7 +1,7 @@
 /***********************************************************************
 Endianness - Helper functions to deal with endianness conversion of
 geometry data types.
-Copyright (c) 2006 Oliver Kreylos
+Copyright (c) 2006-2013 Oliver Kreylos
 
 This file is part of the Templatized Geometry Library (TGL).
 
@@ -62,6 +62,12 @@ class EndiannessSwapper<Geometry::ComponentArray<ScalarParam,dimensionParam> >
 		for(size_t i=0;i<numCas;++i)
 			swapEndianness(cas[i].getComponents(),dimensionParam);
 		}
+	static void copySwap(const Geometry::ComponentArray<ScalarParam,dimensionParam>* cas,size_t numCas,void* dest)
+		{
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numCas;++i,dPtr+=sizeof(Geometry::ComponentArray<ScalarParam,dimensionParam>))
+			copySwapEndianness(cas[i].getComponents(),dimensionParam,dPtr);
+		}
 	};
 
 template <class ScalarParam,int dimensionParam>
@@ -78,6 +84,12 @@ class EndiannessSwapper<Geometry::Vector<ScalarParam,dimensionParam> >
 		for(size_t i=0;i<numVs;++i)
 			swapEndianness(vs[i].getComponents(),dimensionParam);
 		}
+	static void copySwap(const Geometry::Vector<ScalarParam,dimensionParam>* vs,size_t numVs,void* dest)
+		{
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numVs;++i,dPtr+=sizeof(Geometry::Vector<ScalarParam,dimensionParam>))
+			copySwapEndianness(vs[i].getComponents(),dimensionParam,dPtr);
+		}
 	};
 
 template <class ScalarParam,int dimensionParam>
@@ -94,6 +106,12 @@ class EndiannessSwapper<Geometry::Point<ScalarParam,dimensionParam> >
 		for(size_t i=0;i<numPs;++i)
 			swapEndianness(ps[i].getComponents(),dimensionParam);
 		}
+	static void copySwap(const Geometry::Point<ScalarParam,dimensionParam>* ps,size_t numPs,void* dest)
+		{
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numPs;++i,dPtr+=sizeof(Geometry::Point<ScalarParam,dimensionParam>))
+			copySwapEndianness(ps[i].getComponents(),dimensionParam,dPtr);
+		}
 	};
 
 template <class ScalarParam,int dimensionParam>
@@ -110,6 +128,12 @@ class EndiannessSwapper<Geometry::HVector<ScalarParam,dimensionParam> >
 		for(size_t i=0;i<numVs;++i)
 			swapEndianness(vs[i].getComponents(),dimensionParam+1);
 		}
+	static void copySwap(const Geometry::HVector<ScalarParam,dimensionParam>* vs,size_t numVs,void* dest)
+		{
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numVs;++i,dPtr+=sizeof(Geometry::HVector<ScalarParam,dimensionParam>))
+			copySwapEndianness(vs[i].getComponents(),dimensionParam+1,dPtr);
+		}
 	};
 
 template <class ScalarParam,int numRowsParam,int numColumnsParam>
@@ -123,13 +147,19 @@ class EndiannessSwapper<Geometry::Matrix<ScalarParam,numRowsParam,numColumnsPara
 			for(int column=0;column<numColumnsParam;++column)
 				swapEndianness(m(row,column));
 		}
-	static void swap(Geometry::Matrix<ScalarParam,numRowsParam,numColumnsParam>& ms,size_t numMs)
+	static void swap(Geometry::Matrix<ScalarParam,numRowsParam,numColumnsParam>* ms,size_t numMs)
 		{
 		for(size_t i=0;i<numMs;++i)
 			for(int row=0;row<numRowsParam;++row)
 				for(int column=0;column<numColumnsParam;++column)
 					swapEndianness(ms[i](row,column));
 		}
+	static void copySwap(const Geometry::Matrix<ScalarParam,numRowsParam,numColumnsParam>* ms,size_t numMs,void* dest)
+		{
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numMs;++i,dPtr+=sizeof(Geometry::Matrix<ScalarParam,numRowsParam,numColumnsParam>))
+			copySwapEndianness(ms[i].getEntries(),numRowsParam*numColumnsParam,dPtr);
+		}
 	};
 
 template <class PointParam,class ValueParam>
@@ -150,6 +180,16 @@ class EndiannessSwapper<Geometry::ValuedPoint<PointParam,ValueParam> >
 			swapEndianness(vps[i].value);
 			}
 		}
+	static void copySwap(const Geometry::ValuedPoint<PointParam,ValueParam>* vps,size_t numVps,void* dest)
+		{
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numVps;++i,dPtr+=sizeof(Geometry::ValuedPoint<PointParam,ValueParam>))
+			{
+			Geometry::ValuedPoint<PointParam,ValueParam> temp=vps[i];
+			swap(temp);
+			memcpy(dPtr,&temp,sizeof(Geometry::ValuedPoint<PointParam,ValueParam>));
+			}
+		}
 	};
 
 }
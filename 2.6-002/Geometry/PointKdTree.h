@@ -1,6 +1,6 @@
 /***********************************************************************
 PointKdTree - Class to store k-dimensional points in a kd-tree.
-Copyright (c) 2003-2010 Oliver Kreylos
+Copyright (c) 2003-2013 Oliver Kreylos
 
 This file is part of the Templatized Geometry Library (TGL).
 
@@ -23,7 +23,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_POINTKDTREE_INCLUDED
 #define GEOMETRY_POINTKDTREE_INCLUDED
 
-#include <Misc/PoolAllocator.h>
+#include <Threads/PoolAllocator.h>
 #include <Geometry/Point.h>
 #include <Geometry/ClosePointSet.h>
 
@@ -60,7 +60,7 @@ class PointKdTree
 		{
 		/* Elements: */
 		public:
-		static Misc::PoolAllocator<Node> nodeAllocator; // Memory allocator for nodes
+		static Threads::PoolAllocator<Node> nodeAllocator; // Memory allocator for nodes; shared by all trees of the same type, which can be created and destroyed from multiple threads
 		StoredPoint point; // Point stored in node
 		Node* left; // Pointer to left child node
 		Node* right; // Pointer to right child node
@@ -1,7 +1,7 @@
 /***********************************************************************
 CSVSource - Class to read tabular data from input streams in generalized
 comma-separated value (CSV) format.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -23,9 +23,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/CSVSource.h>
 
 #include <ctype.h>
-#include <math.h>
 #include <string>
 #include <Misc/ThrowStdErr.h>
+#include <IO/NumberParser.h>
 
 namespace IO {
 
@@ -257,92 +257,8 @@ bool CSVSource::convertNumber(int& nextChar,int& value)
 template <>
 bool CSVSource::convertNumber(int& nextChar,double& value)
 	{
-	/* Check for optional sign: */
-	bool negated=false;
-	if(nextChar=='-')
-		{
-		negated=true;
-		nextChar=source->getChar();
-		}
-	else if(nextChar=='+')
-		nextChar=source->getChar();
-	
-	/* Keep track if any digits have been read: */
-	bool haveDigit=false;
-	
-	/* Read an integral number part: */
-	value=0.0;
-	while(nextChar>='0'&&nextChar<='9')
-		{
-		haveDigit=true;
-		value=value*10.0+double(nextChar-'0');
-		nextChar=source->getChar();
-		}
-	
-	/* Check for a period: */
-	if(nextChar=='.')
-		{
-		nextChar=source->getChar();
-		
-		/* Read a fractional number part: */
-		double fraction=0.0;
-		double fractionBase=1.0;
-		while(nextChar>='0'&&nextChar<='9')
-			{
-			haveDigit=true;
-			fraction=fraction*10.0+double(nextChar-'0');
-			fractionBase*=10.0;
-			nextChar=source->getChar();
-			}
-		
-		value+=fraction/fractionBase;
-		}
-	
-	/* Signal a conversion error if no digits were read in the integral or fractional part: */
-	if(!haveDigit)
-		return false;
-	
-	/* Negate the result if a minus sign was read: */
-	if(negated)
-		value=-value;
-	
-	/* Check for an exponent indicator: */
-	if(nextChar=='e'||nextChar=='E')
-		{
-		nextChar=source->getChar();
-		
-		/* Read a plus or minus sign: */
-		bool exponentNegated=false;
-		if(nextChar=='-')
-			{
-			exponentNegated=true;
-			nextChar=source->getChar();
-			}
-		else if(nextChar=='+')
-			nextChar=source->getChar();
-		
-		/* Signal a conversion error if the next character is not a digit: */
-		if(nextChar<'0'||nextChar>'9')
-			return false;
-		
-		/* Read the first exponent digit: */
-		double exponent=double(nextChar-'0');
-		nextChar=source->getChar();
-		
-		/* Read the rest of the exponent digits: */
-		while(nextChar>='0'&&nextChar<='9')
-			{
-			exponent=exponent*10.0+double(nextChar-'0');
-			nextChar=source->getChar();
-			}
-		
-		/* Multiply the mantissa with the exponent: */
-		if(exponentNegated)
-			exponent=-exponent;
-		value*=pow(10.0,exponent);
-		}
-	
-	return true;
+	/* Parse the number directly from the character source's read buffer: */
+	return readNumber(*source,nextChar,value);
 	}
 
 template <>
@@ -496,6 +412,23 @@ std::string CSVSource::readField(void)
 	return result;
 	}
 
+unsigned int CSVSource::readRecord(double* values,unsigned int maxNumFields)
+	{
+	/* Read fields until the field index resets to zero: */
+	unsigned int numFields=0;
+	do
+		{
+		if(numFields<maxNumFields)
+			values[numFields]=readField<double>();
+		else
+			skipField();
+		++numFields;
+		}
+	while(fieldIndex!=0);
+	
+	return numFields;
+	}
+
 /************************************************************************
 Force instantiation of standard versions of CSVSource::readField methods:
 ************************************************************************/
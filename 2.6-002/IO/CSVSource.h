@@ -1,7 +1,7 @@
 /***********************************************************************
 CSVSource - Class to read tabular data from input streams in generalized
 comma-separated value (CSV) format.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -129,6 +129,7 @@ class CSVSource
 		}
 	template <class ValueParam>
 	ValueParam readField(void); // Reads the next field as the given data type; throws exception if the field contents cannot be fully converted, or the end of the field cannot be determined reliably
+	unsigned int readRecord(double* values,unsigned int maxNumFields); // Reads the rest of the current record as floating-point numbers into the given array, skipping fields beyond the given maximum; returns the number of fields in the record
 	};
 
 /**********************************************
@@ -1,7 +1,7 @@
 /***********************************************************************
 File - Base class for high-performance buffered binary read/write access
 to file-like objects.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -25,10 +25,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/File.h>
 
 #include <string.h>
+#include <vector>
 #if DEBUGGING
 #include <iostream>
 #endif
 #include <Misc/ThrowStdErr.h>
+#include <Misc/Timer.h>
+#include <IO/FileStatistics.h>
 
 namespace IO {
 
@@ -163,6 +166,117 @@ void File::writeData(const File::Byte* buffer,size_t bufferSize)
 	throw WriteError(bufferSize);
 	}
 
+size_t File::readDataVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Read into the first non-empty memory region: */
+	for(unsigned int i=0;i<numVectors;++i)
+		if(vectors[i].size>0)
+			return readData(static_cast<Byte*>(vectors[i].data),vectors[i].size);
+	
+	return 0;
+	}
+
+void File::writeDataVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Write each non-empty memory region in order: */
+	for(unsigned int i=0;i<numVectors;++i)
+		if(vectors[i].size>0)
+			writeData(static_cast<const Byte*>(vectors[i].data),vectors[i].size);
+	}
+
+size_t File::timedReadData(File::Byte* buffer,size_t bufferSize)
+	{
+	Misc::Timer timer;
+	size_t result=readData(buffer,bufferSize);
+	timer.elapse();
+	if(statistics->minReadBufferSize>readBufferSize)
+		statistics->minReadBufferSize=readBufferSize;
+	statistics->addRead(result,buffer==readBuffer,timer.getTime());
+	return result;
+	}
+
+void File::timedWriteData(const File::Byte* buffer,size_t bufferSize)
+	{
+	Misc::Timer timer;
+	writeData(buffer,bufferSize);
+	timer.elapse();
+	if(statistics->minWriteBufferSize>writeBufferSize)
+		statistics->minWriteBufferSize=writeBufferSize;
+	statistics->addWrite(bufferSize,timer.getTime());
+	}
+
+size_t File::timedReadDataVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	Misc::Timer timer;
+	size_t result=readDataVectored(vectors,numVectors);
+	timer.elapse();
+	if(statistics->minReadBufferSize>readBufferSize)
+		statistics->minReadBufferSize=readBufferSize;
+	statistics->addRead(result,false,timer.getTime());
+	return result;
+	}
+
+void File::timedWriteDataVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	Misc::Timer timer;
+	writeDataVectored(vectors,numVectors);
+	timer.elapse();
+	size_t writeSize=0;
+	for(unsigned int i=0;i<numVectors;++i)
+		writeSize+=vectors[i].size;
+	if(statistics->minWriteBufferSize>writeBufferSize)
+		statistics->minWriteBufferSize=writeBufferSize;
+	statistics->addWrite(writeSize,timer.getTime());
+	}
+
+void File::readThrough(File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Append the read buffer as an additional region to read ahead into it: */
+	vectors[numVectors].data=readBuffer;
+	vectors[numVectors].size=readBufferSize;
+	readDataEnd=readBuffer;
+	readPtr=readBuffer;
+	
+	/* Read until all provided regions are filled: */
+	IOVector* vPtr=vectors;
+	IOVector* vEnd=vectors+numVectors;
+	while(vPtr!=vEnd&&vPtr->size==0)
+		++vPtr;
+	while(vPtr!=vEnd)
+		{
+		/* Read directly into the remaining regions and the read buffer: */
+		size_t readSize=sourceReadVectored(vPtr,(unsigned int)(vEnd-vPtr)+1);
+		
+		/* Check for premature end-of-file: */
+		if(readSize==0)
+			{
+			haveEof=true;
+			size_t numMissingBytes=0;
+			for(;vPtr!=vEnd;++vPtr)
+				numMissingBytes+=vPtr->size;
+			throw ReadError(numMissingBytes);
+			}
+		
+		/* Advance past all filled regions: */
+		while(vPtr!=vEnd&&readSize>=vPtr->size)
+			{
+			readSize-=vPtr->size;
+			++vPtr;
+			}
+		if(vPtr!=vEnd)
+			{
+			/* Prepare to read the rest of the partially filled region: */
+			vPtr->data=static_cast<Byte*>(vPtr->data)+readSize;
+			vPtr->size-=readSize;
+			}
+		else
+			{
+			/* Any excess data went into the read buffer: */
+			readDataEnd=readBuffer+readSize;
+			}
+		}
+	}
+
 void File::bufferedRead(void* buffer,size_t bufferSize)
 	{
 	#if DEBUGGING
@@ -183,23 +297,11 @@ void File::bufferedRead(void* buffer,size_t bufferSize)
 	/* Bypass the read buffer if supported and if there is a lot of data left to read: */
 	if(canReadThrough&&bufferSize>=readBufferSize/2)
 		{
-		/* Read directly from the source: */
-		while(bufferSize>0)
-			{
-			/* Read directly into the provided buffer: */
-			size_t readSize=readData(bufPtr,bufferSize);
-			
-			/* Check for premature end-of-file: */
-			if(readSize==0)
-				{
-				haveEof=true;
-				throw ReadError(bufferSize);
-				}
-			
-			/* Prepare to read more data: */
-			bufPtr+=readSize;
-			bufferSize-=readSize;
-			}
+		/* Read directly into the provided buffer, and read ahead into the read buffer in the same calls: */
+		IOVector vectors[2];
+		vectors[0].data=bufPtr;
+		vectors[0].size=bufferSize;
+		readThrough(vectors,1);
 		}
 	else
 		{
@@ -261,6 +363,20 @@ void File::bufferedWrite(const void* buffer,size_t bufferSize)
 	
 	const Byte* bufPtr=static_cast<const Byte*>(buffer);
 	
+	/* Bypass the write buffer if supported and if there is a lot of data to write: */
+	if(canWriteThrough&&bufferSize>=writeBufferSize/2)
+		{
+		/* Write the buffered data and the provided data to the sink in one go: */
+		IOVector vectors[2];
+		vectors[0].data=writeBuffer;
+		vectors[0].size=writePtr-writeBuffer;
+		vectors[1].data=const_cast<Byte*>(bufPtr);
+		vectors[1].size=bufferSize;
+		sinkWriteVectored(vectors,2);
+		writePtr=writeBuffer;
+		return;
+		}
+	
 	/* Copy the first chunk of data into the write buffer: */
 	size_t copySize=writeBufferEnd-writePtr;
 	memcpy(writePtr,bufPtr,copySize);
@@ -268,21 +384,16 @@ void File::bufferedWrite(const void* buffer,size_t bufferSize)
 	bufferSize-=copySize;
 	
 	/* Write the full write buffer: */
-	writeData(writeBuffer,writeBufferSize);
+	sinkWrite(writeBuffer,writeBufferSize);
 	writePtr=writeBuffer;
 	
-	/* Bypass the write buffer if supported and if there is a lot of data left to write: */
+	/* Check if the rest of the data fits into the write buffer: */
 	if(bufferSize<writeBufferSize/2)
 		{
 		/* Copy the rest of the data into the write buffer: */
 		memcpy(writePtr,bufPtr,bufferSize);
 		writePtr+=bufferSize;
 		}
-	else if(canWriteThrough)
-		{
-		/* Write the rest of the data directly to the sink: */
-		writeData(bufPtr,bufferSize);
-		}
 	else
 		{
 		/* Copy the rest of the data into the write buffer in multiple steps: */
@@ -291,7 +402,7 @@ void File::bufferedWrite(const void* buffer,size_t bufferSize)
 			/* Write the write buffer to sink if it is full: */
 			if(writePtr==writeBufferEnd)
 				{
-				writeData(writeBuffer,writeBufferSize);
+				sinkWrite(writeBuffer,writeBufferSize);
 				writePtr=writeBuffer;
 				}
 			
@@ -311,7 +422,8 @@ File::File(void)
 	:readBufferSize(0),readBuffer(0),readDataEnd(0),haveEof(false),readPtr(0),
 	 canReadThrough(true),readMustSwapEndianness(false),
 	 writeBufferSize(0),writeBuffer(0),writeBufferEnd(0),writePtr(0),
-	 canWriteThrough(true),writeMustSwapEndianness(false)
+	 canWriteThrough(true),writeMustSwapEndianness(false),
+	 statistics(FileStatistics::isEnabled()?FileStatistics::registerFile():0)
 	{
 	#if DEBUGGING
 	std::cout<<"Created File object at "<<this<<std::endl;
@@ -322,7 +434,8 @@ File::File(File::AccessMode sAccessMode)
 	:readBufferSize(0),readBuffer(0),readDataEnd(0),haveEof(false),readPtr(0),
 	 canReadThrough(true),readMustSwapEndianness(false),
 	 writeBufferSize(0),writeBuffer(0),writeBufferEnd(0),writePtr(0),
-	 canWriteThrough(true),writeMustSwapEndianness(false)
+	 canWriteThrough(true),writeMustSwapEndianness(false),
+	 statistics(FileStatistics::isEnabled()?FileStatistics::registerFile():0)
 	{
 	if(sAccessMode==ReadOnly||sAccessMode==ReadWrite)
 		{
@@ -351,6 +464,10 @@ File::~File(void)
 	/* Delete the read and write buffers: */
 	delete[] readBuffer;
 	delete[] writeBuffer;
+	
+	/* Retire the performance counters: */
+	if(statistics!=0)
+		FileStatistics::unregisterFile(statistics);
 	#if DEBUGGING
 	std::cout<<"Destroyed File object at "<<this<<std::endl;
 	#endif
@@ -403,7 +520,7 @@ void File::resizeWriteBuffer(size_t newWriteBufferSize)
 	{
 	/* Write the entire write buffer if there is any data in it: */
 	if(writePtr!=writeBuffer)
-		writeData(writeBuffer,writePtr-writeBuffer);
+		sinkWrite(writeBuffer,writePtr-writeBuffer);
 	
 	/* Re-allocate the write buffer: */
 	delete[] writeBuffer;
@@ -413,6 +530,90 @@ void File::resizeWriteBuffer(size_t newWriteBufferSize)
 	writePtr=writeBuffer;
 	}
 
+void File::readVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Calculate the total amount of data to read: */
+	size_t remainingSize=0;
+	for(unsigned int i=0;i<numVectors;++i)
+		remainingSize+=vectors[i].size;
+	
+	/* Copy data from the read buffer into the leading regions: */
+	unsigned int vIndex=0;
+	size_t vOffset=0;
+	while(vIndex<numVectors&&(readPtr!=readDataEnd||vectors[vIndex].size==0))
+		{
+		size_t copySize=vectors[vIndex].size-vOffset;
+		if(copySize>size_t(readDataEnd-readPtr))
+			copySize=readDataEnd-readPtr;
+		memcpy(static_cast<Byte*>(vectors[vIndex].data)+vOffset,readPtr,copySize);
+		readPtr+=copySize;
+		remainingSize-=copySize;
+		vOffset+=copySize;
+		if(vOffset==vectors[vIndex].size)
+			{
+			++vIndex;
+			vOffset=0;
+			}
+		}
+	if(remainingSize==0)
+		return;
+	
+	/* Bypass the read buffer if supported and if there is a lot of data left to read: */
+	if(canReadThrough&&remainingSize>=readBufferSize/2)
+		{
+		/* Read the remaining regions directly from the source, leaving room for the read buffer: */
+		std::vector<IOVector> remainingVectors(vectors+vIndex,vectors+numVectors);
+		remainingVectors[0].data=static_cast<Byte*>(remainingVectors[0].data)+vOffset;
+		remainingVectors[0].size-=vOffset;
+		remainingVectors.push_back(IOVector());
+		readThrough(&remainingVectors[0],numVectors-vIndex);
+		}
+	else
+		{
+		/* Read the remaining regions through the read buffer: */
+		readRaw(static_cast<Byte*>(vectors[vIndex].data)+vOffset,vectors[vIndex].size-vOffset);
+		for(++vIndex;vIndex<numVectors;++vIndex)
+			readRaw(vectors[vIndex].data,vectors[vIndex].size);
+		}
+	}
+
+void File::writeVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Calculate the total amount of data to write: */
+	size_t totalSize=0;
+	for(unsigned int i=0;i<numVectors;++i)
+		totalSize+=vectors[i].size;
+	
+	if(totalSize<=size_t(writeBufferEnd-writePtr))
+		{
+		/* Copy all regions into the write buffer: */
+		for(unsigned int i=0;i<numVectors;++i)
+			{
+			memcpy(writePtr,vectors[i].data,vectors[i].size);
+			writePtr+=vectors[i].size;
+			}
+		}
+	else if(canWriteThrough&&totalSize>=writeBufferSize/2)
+		{
+		/* Write the buffered data and all regions to the sink in one go: */
+		std::vector<IOVector> allVectors;
+		allVectors.reserve(numVectors+1);
+		IOVector buffered;
+		buffered.data=writeBuffer;
+		buffered.size=writePtr-writeBuffer;
+		allVectors.push_back(buffered);
+		allVectors.insert(allVectors.end(),vectors,vectors+numVectors);
+		sinkWriteVectored(&allVectors[0],numVectors+1);
+		writePtr=writeBuffer;
+		}
+	else
+		{
+		/* Write all regions through the write buffer: */
+		for(unsigned int i=0;i<numVectors;++i)
+			writeRaw(vectors[i].data,vectors[i].size);
+		}
+	}
+
 void File::setEndianness(Misc::Endianness newEndianness)
 	{
 	#if __BYTE_ORDER==__LITTLE_ENDIAN
@@ -433,4 +634,10 @@ void File::setSwapOnWrite(bool newSwapOnWrite)
 	writeMustSwapEndianness=newSwapOnWrite;
 	}
 
+void File::setStatisticsLabel(const char* newLabel)
+	{
+	if(statistics!=0)
+		statistics->label=newLabel;
+	}
+
 }
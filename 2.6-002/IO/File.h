@@ -1,7 +1,7 @@
 /***********************************************************************
 File - Base class for high-performance buffered binary read/write access
 to file-like objects.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -30,6 +30,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/RefCounted.h>
 #include <Misc/Autopointer.h>
 
+/* Forward declarations: */
+namespace IO {
+class FileStatistics;
+}
+
 namespace IO {
 
 class File:public Misc::RefCounted
@@ -41,6 +46,14 @@ class File:public Misc::RefCounted
 		NoAccess,ReadOnly,WriteOnly,ReadWrite
 		};
 	
+	struct IOVector // Structure describing a contiguous memory region for vectored reads and writes; modeled after POSIX struct iovec
+		{
+		/* Elements: */
+		public:
+		void* data; // Pointer to the beginning of the memory region
+		size_t size; // Size of the memory region in bytes
+		};
+	
 	class Error:public std::runtime_error // Base exception class for file-related errors
 		{
 		/* Constructors and destructors: */
@@ -110,6 +123,9 @@ class File:public Misc::RefCounted
 	bool canWriteThrough; // Flag whether the concrete implementation supports out-of-buffer writes
 	bool writeMustSwapEndianness; // Flag if data has to be endianness-swapped before writing
 	
+	private:
+	FileStatistics* statistics; // Performance counters, or null if statistics collection was disabled when the file was created
+	
 	/* Protected methods: */
 	protected:
 	static AccessMode disableRead(AccessMode accessMode); // Disables reading in the given access mode
@@ -117,9 +133,10 @@ class File:public Misc::RefCounted
 	static const char* getAccessModeName(AccessMode accessMode); // Returns a string describing the given access mode
 	void flushReadBuffer(void) // Clears the read buffer so that the next read access has to go to the data source
 		{
-		/* Reset the read buffer pointers: */
+		/* Reset the read buffer pointers and end-of-file flag: */
 		readDataEnd=readBuffer;
 		readPtr=readBuffer;
+		haveEof=false;
 		}
 	void setReadBuffer(size_t newReadBufferSize,Byte* newReadBuffer,bool deleteOldBuffer =true); // Allows derived class to set a new read buffer while deleting or releasing the previous buffer; discards unread data in read buffer
 	size_t getReadBufferDataSize(void) const // Returns current amount of data in the read buffer
@@ -151,16 +168,45 @@ class File:public Misc::RefCounted
 	/* Protected low-level methods to be implemented by concrete derived classes; default implementations return EOF or throw error: */
 	virtual size_t readData(Byte* buffer,size_t bufferSize); // Method to read data into the given buffer; must block until at least one byte is read; returns number of bytes read; zero return value signals end-of-source condition
 	virtual void writeData(const Byte* buffer,size_t bufferSize); // Method to write all data contained in the write buffer to a sink; should throw appropriate exception in case of errors
+	virtual size_t readDataVectored(const IOVector* vectors,unsigned int numVectors); // Method to read data into the given memory regions in order; must block until at least one byte is read; returns total number of bytes read; default implementation calls readData on the first non-empty region
+	virtual void writeDataVectored(const IOVector* vectors,unsigned int numVectors); // Method to write all data contained in the given memory regions to a sink in order; default implementation calls writeData on each region
 	
 	/* Private methods: */
 	private:
+	size_t timedReadData(Byte* buffer,size_t bufferSize); // Calls readData and updates performance counters
+	void timedWriteData(const Byte* buffer,size_t bufferSize); // Calls writeData and updates performance counters
+	size_t timedReadDataVectored(const IOVector* vectors,unsigned int numVectors); // Calls readDataVectored and updates performance counters
+	void timedWriteDataVectored(const IOVector* vectors,unsigned int numVectors); // Calls writeDataVectored and updates performance counters
+	size_t sourceRead(Byte* buffer,size_t bufferSize) // Reads data from the source
+		{
+		return statistics==0?readData(buffer,bufferSize):timedReadData(buffer,bufferSize);
+		}
+	void sinkWrite(const Byte* buffer,size_t bufferSize) // Writes data to the sink
+		{
+		if(statistics==0)
+			writeData(buffer,bufferSize);
+		else
+			timedWriteData(buffer,bufferSize);
+		}
+	size_t sourceReadVectored(const IOVector* vectors,unsigned int numVectors) // Reads data from the source into the given memory regions
+		{
+		return statistics==0?readDataVectored(vectors,numVectors):timedReadDataVectored(vectors,numVectors);
+		}
+	void sinkWriteVectored(const IOVector* vectors,unsigned int numVectors) // Writes data from the given memory regions to the sink
+		{
+		if(statistics==0)
+			writeDataVectored(vectors,numVectors);
+		else
+			timedWriteDataVectored(vectors,numVectors);
+		}
 	void fillReadBuffer(void) // Reads more data from the source, and updates the read buffer's state
 		{
-		size_t readSize=readData(readBuffer,readBufferSize);
+		size_t readSize=sourceRead(readBuffer,readBufferSize);
 		readDataEnd=readBuffer+readSize;
 		haveEof=readDataEnd==readBuffer;
 		readPtr=readBuffer;
 		}
+	void readThrough(IOVector* vectors,unsigned int numVectors); // Reads directly from the source until the given regions are filled, reading ahead into the empty read buffer in the same calls; modifies the given regions
 	void bufferedRead(void* buffer,size_t bufferSize); // Reads exactly given amount of data into the given buffer
 	void bufferedSkip(size_t skipSize); // Skips exactly given amount of data from the read data stream
 	void bufferedWrite(const void* buffer,size_t bufferSize); // Writes exactly given amount of data from the given buffer
@@ -271,6 +317,10 @@ class File:public Misc::RefCounted
 		
 		return result;
 		}
+	void unreadInBuffer(size_t unreadSize) // Puts back the given number of bytes from the end of the data returned by the most recent call to readInBuffer; does not check for buffer bounds
+		{
+		readPtr-=unreadSize;
+		}
 	void readRaw(void* buffer,size_t bufferSize) // Reads exactly the given amount of data into the provided buffer; blocks until read complete
 		{
 		/* Check if there is enough data in the read buffer: */
@@ -288,13 +338,14 @@ class File:public Misc::RefCounted
 			bufferedRead(buffer,bufferSize);
 			}
 		}
+	void readVectored(const IOVector* vectors,unsigned int numVectors); // Reads exactly the total size of the given memory regions into them in order; bypasses the read buffer for large requests if supported; does not swap endianness
 	void putChar(int character) // Writes a single character to the file
 		{
 		/* Check if the write buffer is full: */
 		if(writePtr==writeBufferEnd)
 			{
 			/* Write the full write buffer and reset the write pointer: */
-			writeData(writeBuffer,writeBufferSize);
+			sinkWrite(writeBuffer,writeBufferSize);
 			writePtr=writeBuffer;
 			}
 		
@@ -308,7 +359,7 @@ class File:public Misc::RefCounted
 		if(writePtr==writeBufferEnd)
 			{
 			/* Write the full write buffer and reset the write pointer: */
-			writeData(writeBuffer,writeBufferSize);
+			sinkWrite(writeBuffer,writeBufferSize);
 			writePtr=writeBuffer;
 			}
 		
@@ -338,16 +389,22 @@ class File:public Misc::RefCounted
 			bufferedWrite(buffer,bufferSize);
 			}
 		}
+	void writeVectored(const IOVector* vectors,unsigned int numVectors); // Writes the given memory regions in order; writes pending buffered data and large requests to the sink in a single call if supported; does not swap endianness
 	void flush(void) // Flushes the write buffer to the data sink
 		{
 		/* Write the entire write buffer if there is any data in it: */
 		if(writePtr!=writeBuffer)
-			writeData(writeBuffer,writePtr-writeBuffer);
+			sinkWrite(writeBuffer,writePtr-writeBuffer);
 		
 		/* Reset the write buffer: */
 		writePtr=writeBuffer;
 		}
 	void setEndianness(Misc::Endianness newEndianness); // Sets the endianness of the source and/or sink
+	const FileStatistics* getStatistics(void) const // Returns the file's performance counters, or null if statistics collection was disabled when the file was created
+		{
+		return statistics;
+		}
+	void setStatisticsLabel(const char* newLabel); // Sets the label identifying the file in statistics summaries; ignored if the file does not collect statistics
 	
 	/* Endianness-safe binary read interface: */
 	bool mustSwapOnRead(void) // Returns true if the file must endianness-swap data on read
@@ -443,17 +500,26 @@ class File:public Misc::RefCounted
 		{
 		if(writeMustSwapEndianness)
 			{
-			for(size_t i=0;i<numItems;++i)
+			while(numItems>0)
 				{
-				DataParam temp=data[i];
-				Misc::swapEndianness(temp);
-				if(sizeof(DataParam)<=size_t(writeBufferEnd-writePtr))
+				/* Swap as many items as fit directly into the write buffer: */
+				size_t numFittingItems=size_t(writeBufferEnd-writePtr)/sizeof(DataParam);
+				if(numFittingItems>numItems)
+					numFittingItems=numItems;
+				Misc::copySwapEndianness(data,numFittingItems,writePtr);
+				writePtr+=numFittingItems*sizeof(DataParam);
+				data+=numFittingItems;
+				numItems-=numFittingItems;
+				
+				if(numItems>0)
 					{
-					memcpy(writePtr,&temp,sizeof(DataParam));
-					writePtr+=sizeof(DataParam);
+					/* Write the next item through the buffered write path to make room in the write buffer: */
+					Byte temp[sizeof(DataParam)];
+					Misc::copySwapEndianness(data,1,temp);
+					bufferedWrite(temp,sizeof(DataParam));
+					++data;
+					--numItems;
 					}
-				else
-					bufferedWrite(&temp,sizeof(DataParam));
 				}
 			}
 		else
@@ -2,7 +2,7 @@
 FileMonitor - Class to monitor a set of files and/or directories and
 send callbacks on any changes to any of the monitored files or
 directories.
-Copyright (c) 2012 Oliver Kreylos
+Copyright (c) 2012-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -307,7 +307,7 @@ FileMonitor::Cookie FileMonitor::addPath(const char* pathName,int eventMask,File
 	Threads::Mutex::Lock eventCallbacksLock(eventCallbacksMutex);
 	
 	/* Add the given path to inotify's watch list: */
-	Cookie cookie=inotify_add_watch(fd,pathName,eventMask);
+	Cookie cookie=inotify_add_watch(fd,pathName,em);
 	if(cookie<0)
 		{
 		int error=errno;
@@ -0,0 +1,277 @@
+/***********************************************************************
+FileStatistics - Class to collect optional performance counters for
+individual files, and a global registry to aggregate and report them.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/FileStatistics.h>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
+#include <Threads/Mutex.h>
+
+namespace IO {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+struct Registry // Structure holding the statistics of all open and closed files
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::HashTable<std::string,FileStatistics> ClosedFileMap; // Hash table type mapping labels to accumulated statistics of closed files
+	
+	/* Elements: */
+	Threads::Mutex mutex; // Mutex serializing access to the registry
+	std::vector<FileStatistics*> openFiles; // Statistics of all open files
+	ClosedFileMap closedFiles; // Accumulated statistics of closed files
+	
+	/* Constructors and destructors: */
+	Registry(void)
+		:closedFiles(17)
+		{
+		}
+	};
+
+Registry& getRegistry(void) // Returns the registry; never destroyed to allow files to unregister during static destruction
+	{
+	static Registry* registry=new Registry;
+	return *registry;
+	}
+
+bool compareBlockedTime(const FileStatistics& s1,const FileStatistics& s2) // Orders statistics by descending total blocked time
+	{
+	return s1.readTime+s1.writeTime>s2.readTime+s2.writeTime;
+	}
+
+void printSize(std::ostream& os,double size) // Prints the given amount of data in bytes using a suitable unit
+	{
+	if(size>=1024.0*1024.0)
+		os<<size/(1024.0*1024.0)<<" MB";
+	else if(size>=1024.0)
+		os<<size/1024.0<<" KB";
+	else
+		os<<size<<" B";
+	}
+
+}
+
+/***************************************
+Static elements of class FileStatistics:
+***************************************/
+
+bool FileStatistics::enabled=false;
+double FileStatistics::slowOperationTime=0.1;
+
+/*******************************
+Methods of class FileStatistics:
+*******************************/
+
+FileStatistics::FileStatistics(const char* sLabel)
+	:label(sLabel),numFiles(1),
+	 minReadBufferSize(~size_t(0)),minWriteBufferSize(~size_t(0)),
+	 numBytesRead(0),numReads(0),numBufferRefills(0),numSlowReads(0),readTime(0.0),maxReadTime(0.0),
+	 numBytesWritten(0),numWrites(0),numSlowWrites(0),writeTime(0.0),maxWriteTime(0.0)
+	{
+	}
+
+void FileStatistics::addRead(size_t readSize,bool bufferRefill,double time)
+	{
+	numBytesRead+=readSize;
+	++numReads;
+	if(bufferRefill)
+		++numBufferRefills;
+	if(time>=slowOperationTime)
+		++numSlowReads;
+	readTime+=time;
+	if(maxReadTime<time)
+		maxReadTime=time;
+	}
+
+void FileStatistics::addWrite(size_t writeSize,double time)
+	{
+	numBytesWritten+=writeSize;
+	++numWrites;
+	if(time>=slowOperationTime)
+		++numSlowWrites;
+	writeTime+=time;
+	if(maxWriteTime<time)
+		maxWriteTime=time;
+	}
+
+FileStatistics& FileStatistics::operator+=(const FileStatistics& other)
+	{
+	numFiles+=other.numFiles;
+	if(other.numReads>0&&minReadBufferSize>other.minReadBufferSize)
+		minReadBufferSize=other.minReadBufferSize;
+	if(other.numWrites>0&&minWriteBufferSize>other.minWriteBufferSize)
+		minWriteBufferSize=other.minWriteBufferSize;
+	numBytesRead+=other.numBytesRead;
+	numReads+=other.numReads;
+	numBufferRefills+=other.numBufferRefills;
+	numSlowReads+=other.numSlowReads;
+	readTime+=other.readTime;
+	if(maxReadTime<other.maxReadTime)
+		maxReadTime=other.maxReadTime;
+	numBytesWritten+=other.numBytesWritten;
+	numWrites+=other.numWrites;
+	numSlowWrites+=other.numSlowWrites;
+	writeTime+=other.writeTime;
+	if(maxWriteTime<other.maxWriteTime)
+		maxWriteTime=other.maxWriteTime;
+	return *this;
+	}
+
+void FileStatistics::print(std::ostream& os) const
+	{
+	os<<(label.empty()?"<unnamed>":label.c_str())<<" ("<<numFiles<<(numFiles==1?" file):":" files):")<<std::endl;
+	if(numReads>0)
+		{
+		os<<"  read:  ";
+		printSize(os,double(numBytesRead));
+		os<<" in "<<numReads<<" calls, average ";
+		printSize(os,double(numBytesRead)/double(numReads));
+		os<<", "<<(numBytesRead>0?double(numBufferRefills)*1048576.0/double(numBytesRead):0.0)<<" refills/MB";
+		if(minReadBufferSize!=~size_t(0))
+			{
+			os<<", buffer ";
+			printSize(os,double(minReadBufferSize));
+			}
+		os<<", blocked "<<readTime<<" s (max "<<maxReadTime<<" s, "<<numSlowReads<<" slow)"<<std::endl;
+		}
+	if(numWrites>0)
+		{
+		os<<"  write: ";
+		printSize(os,double(numBytesWritten));
+		os<<" in "<<numWrites<<" calls, average ";
+		printSize(os,double(numBytesWritten)/double(numWrites));
+		if(minWriteBufferSize!=~size_t(0))
+			{
+			os<<", buffer ";
+			printSize(os,double(minWriteBufferSize));
+			}
+		os<<", blocked "<<writeTime<<" s (max "<<maxWriteTime<<" s, "<<numSlowWrites<<" slow)"<<std::endl;
+		}
+	}
+
+void FileStatistics::setEnabled(bool newEnabled)
+	{
+	enabled=newEnabled;
+	}
+
+void FileStatistics::setSlowOperationTime(double newSlowOperationTime)
+	{
+	slowOperationTime=newSlowOperationTime;
+	}
+
+FileStatistics* FileStatistics::registerFile(void)
+	{
+	FileStatistics* result=new FileStatistics;
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	registry.openFiles.push_back(result);
+	return result;
+	}
+
+void FileStatistics::unregisterFile(FileStatistics* statistics)
+	{
+	Registry& registry=getRegistry();
+	{
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	
+	/* Remove the statistics object from the list of open files: */
+	std::vector<FileStatistics*>::iterator ofIt=std::find(registry.openFiles.begin(),registry.openFiles.end(),statistics);
+	if(ofIt!=registry.openFiles.end())
+		{
+		*ofIt=registry.openFiles.back();
+		registry.openFiles.pop_back();
+		}
+	
+	/* Accumulate the statistics object into the closed files of the same label: */
+	Registry::ClosedFileMap::Iterator cfIt=registry.closedFiles.findEntry(statistics->label);
+	if(cfIt.isFinished())
+		registry.closedFiles.setEntry(Registry::ClosedFileMap::Entry(statistics->label,*statistics));
+	else
+		cfIt->getDest()+=*statistics;
+	}
+	
+	delete statistics;
+	}
+
+FileStatistics FileStatistics::getTotal(void)
+	{
+	FileStatistics result("Total");
+	result.numFiles=0;
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	for(std::vector<FileStatistics*>::iterator ofIt=registry.openFiles.begin();ofIt!=registry.openFiles.end();++ofIt)
+		result+=**ofIt;
+	for(Registry::ClosedFileMap::Iterator cfIt=registry.closedFiles.begin();!cfIt.isFinished();++cfIt)
+		result+=cfIt->getDest();
+	return result;
+	}
+
+void FileStatistics::printSummary(std::ostream& os)
+	{
+	/* Take a snapshot of the registry; counters of open files used by other threads might be slightly inconsistent: */
+	std::vector<FileStatistics> openFiles,closedFiles;
+	FileStatistics total("Total");
+	total.numFiles=0;
+	{
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	for(std::vector<FileStatistics*>::iterator ofIt=registry.openFiles.begin();ofIt!=registry.openFiles.end();++ofIt)
+		{
+		openFiles.push_back(**ofIt);
+		total+=**ofIt;
+		}
+	for(Registry::ClosedFileMap::Iterator cfIt=registry.closedFiles.begin();!cfIt.isFinished();++cfIt)
+		{
+		closedFiles.push_back(cfIt->getDest());
+		total+=cfIt->getDest();
+		}
+	}
+	
+	/* Print the files with the longest blocked times first: */
+	std::sort(openFiles.begin(),openFiles.end(),compareBlockedTime);
+	std::sort(closedFiles.begin(),closedFiles.end(),compareBlockedTime);
+	std::streamsize oldPrecision=os.precision(4);
+	if(!openFiles.empty())
+		{
+		os<<"Open files:"<<std::endl;
+		for(std::vector<FileStatistics>::iterator fIt=openFiles.begin();fIt!=openFiles.end();++fIt)
+			fIt->print(os);
+		}
+	if(!closedFiles.empty())
+		{
+		os<<"Closed files:"<<std::endl;
+		for(std::vector<FileStatistics>::iterator fIt=closedFiles.begin();fIt!=closedFiles.end();++fIt)
+			fIt->print(os);
+		}
+	total.print(os);
+	os.precision(oldPrecision);
+	}
+
+}
@@ -0,0 +1,81 @@
+/***********************************************************************
+FileStatistics - Class to collect optional performance counters for
+individual files, and a global registry to aggregate and report them.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_FILESTATISTICS_INCLUDED
+#define IO_FILESTATISTICS_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <iosfwd>
+#include <Misc/SizedTypes.h>
+
+namespace IO {
+
+class FileStatistics
+	{
+	/* Elements: */
+	public:
+	std::string label; // Label identifying the file in summaries, typically its name
+	unsigned int numFiles; // Number of files whose counters were accumulated into this object
+	size_t minReadBufferSize; // Smallest read buffer size of any accumulated file that read data
+	size_t minWriteBufferSize; // Smallest write buffer size of any accumulated file that wrote data
+	Misc::UInt64 numBytesRead; // Total amount of data read from the source
+	Misc::UInt64 numReads; // Number of calls reading from the source
+	Misc::UInt64 numBufferRefills; // Number of source reads that refilled the read buffer, as opposed to reading into caller memory
+	Misc::UInt64 numSlowReads; // Number of source reads that took longer than the slow operation threshold
+	double readTime; // Total time spent blocked in source reads in seconds
+	double maxReadTime; // Longest time spent in a single source read in seconds
+	Misc::UInt64 numBytesWritten; // Total amount of data written to the sink
+	Misc::UInt64 numWrites; // Number of calls writing to the sink
+	Misc::UInt64 numSlowWrites; // Number of sink writes that took longer than the slow operation threshold
+	double writeTime; // Total time spent blocked in sink writes in seconds
+	double maxWriteTime; // Longest time spent in a single sink write in seconds
+	
+	/* Constructors and destructors: */
+	FileStatistics(const char* sLabel =""); // Creates zeroed statistics with the given label
+	
+	/* Methods: */
+	void addRead(size_t readSize,bool bufferRefill,double time); // Accounts for a single source read
+	void addWrite(size_t writeSize,double time); // Accounts for a single sink write
+	FileStatistics& operator+=(const FileStatistics& other); // Accumulates the counters of the given object into this one
+	void print(std::ostream& os) const; // Prints a human-readable summary of the counters
+	
+	/* Registry methods: */
+	static void setEnabled(bool newEnabled); // Enables or disables statistics collection for files created from now on; disabled by default
+	static bool isEnabled(void) // Returns true if files created now collect statistics
+		{
+		return enabled;
+		}
+	static void setSlowOperationTime(double newSlowOperationTime); // Sets the time in seconds after which a single read or write counts as slow
+	static FileStatistics* registerFile(void); // Creates and registers a statistics object for a newly created file
+	static void unregisterFile(FileStatistics* statistics); // Accumulates the given statistics object by its label and destroys it when its file is destroyed
+	static FileStatistics getTotal(void); // Returns the accumulated counters of all open and closed files
+	static void printSummary(std::ostream& os); // Prints counters of all open files and of closed files aggregated by label, ordered by total blocked time
+	
+	private:
+	static bool enabled; // Flag whether newly created files collect statistics
+	static double slowOperationTime; // Time in seconds after which a single read or write counts as slow
+	};
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+/***********************************************************************
+FileTailer - Class to follow a growing file and deliver newly appended
+complete records to a callback, using a FileMonitor to react to changes
+and coping with truncation and rotation of the followed file.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/FileTailer.h>
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <Misc/FunctionCalls.h>
+#include <IO/StandardFile.h>
+
+namespace IO {
+
+/***************************
+Methods of class FileTailer:
+***************************/
+
+void FileTailer::deliverRecord(const char* begin,const char* end)
+	{
+	/* Ignore empty records: */
+	if(begin==end)
+		return;
+	
+	Record record;
+	record.begin=begin;
+	record.end=end;
+	record.offset=recordOffset;
+	record.generation=generation;
+	(*recordCallback)(record);
+	}
+
+void FileTailer::openFile(void)
+	{
+	try
+		{
+		/* Open the followed file and remember its identity: */
+		StandardFile* newFile=new StandardFile(fileName.c_str(),File::ReadOnly);
+		file=newFile;
+		struct stat fileStat;
+		if(fstat(newFile->getFd(),&fileStat)==0)
+			{
+			fileDevice=Misc::UInt64(fileStat.st_dev);
+			fileInode=Misc::UInt64(fileStat.st_ino);
+			}
+		
+		/* Start reading the new file from its beginning: */
+		if(haveOpened)
+			++generation;
+		haveOpened=true;
+		readOffset=0;
+		recordOffset=0;
+		skipPartialRecord=false;
+		partialRecord.clear();
+		}
+	catch(File::OpenError err)
+		{
+		/* The file disappeared again; wait for it to be recreated: */
+		file=0;
+		}
+	}
+
+void FileTailer::readNewData(void)
+	{
+	/* Determine how much data was appended since the last update: */
+	SeekableFile::Offset fileSize=file->getSize();
+	if(fileSize<=readOffset)
+		return;
+	
+	/* Read the appended data directly from the file's read buffer: */
+	file->setReadPosAbs(readOffset);
+	while(readOffset<fileSize)
+		{
+		void* data;
+		size_t dataSize=file->readInBuffer(data,size_t(fileSize-readOffset));
+		if(dataSize==0)
+			break;
+		const char* dataBegin=static_cast<const char*>(data);
+		const char* dataEnd=dataBegin+dataSize;
+		
+		/* Deliver all records completed by the new data: */
+		const char* recordBegin=dataBegin;
+		const char* separator;
+		while((separator=static_cast<const char*>(memchr(recordBegin,recordSeparator,dataEnd-recordBegin)))!=0)
+			{
+			if(skipPartialRecord)
+				{
+				/* Discard the record's head, which was written before the tailer started: */
+				skipPartialRecord=false;
+				}
+			else if(partialRecord.empty())
+				{
+				/* Deliver the record straight from the read buffer: */
+				deliverRecord(recordBegin,separator);
+				}
+			else
+				{
+				/* Complete the partial record and deliver it: */
+				partialRecord.insert(partialRecord.end(),recordBegin,separator);
+				deliverRecord(&partialRecord[0],&partialRecord[0]+partialRecord.size());
+				partialRecord.clear();
+				}
+			
+			/* Start the next record: */
+			recordBegin=separator+1;
+			recordOffset=readOffset+SeekableFile::Offset(recordBegin-dataBegin);
+			}
+		
+		/* Keep the incomplete record at the end of the new data until it is completed: */
+		if(!skipPartialRecord)
+			partialRecord.insert(partialRecord.end(),recordBegin,dataEnd);
+		readOffset+=SeekableFile::Offset(dataSize);
+		}
+	}
+
+void FileTailer::flushPartialRecord(void)
+	{
+	/* Deliver the incomplete record: */
+	if(!skipPartialRecord&&!partialRecord.empty())
+		deliverRecord(&partialRecord[0],&partialRecord[0]+partialRecord.size());
+	partialRecord.clear();
+	skipPartialRecord=false;
+	}
+
+void FileTailer::monitorCallback(const FileMonitor::Event& event)
+	{
+	/* Update if the event concerns the followed file: */
+	if(event.name==baseName)
+		{
+		try
+			{
+			update();
+			}
+		catch(std::runtime_error err)
+			{
+			/* Ignore the error; the next event will retry reading: */
+			}
+		}
+	}
+
+FileTailer::FileTailer(const char* sFileName,FileTailer::RecordCallback* sRecordCallback,char sRecordSeparator,bool readExisting)
+	:fileName(sFileName),
+	 recordSeparator(sRecordSeparator),
+	 recordCallback(sRecordCallback),
+	 fileDevice(0),fileInode(0),
+	 haveOpened(false),generation(0),
+	 readOffset(0),recordOffset(0),skipPartialRecord(false),
+	 directoryCookie(-1)
+	{
+	/* Split the file name into directory and base name: */
+	std::string::size_type slashPos=fileName.rfind('/');
+	std::string directoryName;
+	if(slashPos!=std::string::npos)
+		{
+		directoryName=std::string(fileName,0,slashPos+1);
+		baseName=std::string(fileName,slashPos+1);
+		}
+	else
+		{
+		directoryName=".";
+		baseName=fileName;
+		}
+	
+	/* Watch the directory, to catch appends, truncation, and replacement of the followed file: */
+	try
+		{
+		directoryCookie=monitor.addPath(directoryName.c_str(),FileMonitor::Modified|FileMonitor::Created|FileMonitor::Moved|FileMonitor::Deleted,Misc::createFunctionCall(this,&FileTailer::monitorCallback));
+		}
+	catch(...)
+		{
+		/* Clean up and re-throw the exception: */
+		delete recordCallback;
+		throw;
+		}
+	
+	/* Open the followed file if it already exists: */
+	openFile();
+	if(file!=0&&!readExisting)
+		{
+		/* Skip existing data, including the head of an incomplete last record: */
+		readOffset=file->getSize();
+		recordOffset=readOffset;
+		if(readOffset>0)
+			{
+			file->setReadPosAbs(readOffset-1);
+			skipPartialRecord=file->getChar()!=(unsigned char)(recordSeparator);
+			}
+		}
+	
+	/* Deliver existing records and start following the file in the background: */
+	update();
+	monitor.startEventHandling();
+	}
+
+FileTailer::~FileTailer(void)
+	{
+	/* Stop the background thread before tearing down the tailer's state: */
+	monitor.stopEventHandling();
+	delete recordCallback;
+	}
+
+void FileTailer::update(void)
+	{
+	Threads::Mutex::Lock updateLock(updateMutex);
+	
+	/* Check whether the followed file still exists, and which file it is: */
+	struct stat pathStat;
+	bool pathExists=stat(fileName.c_str(),&pathStat)==0&&S_ISREG(pathStat.st_mode);
+	
+	if(file!=0)
+		{
+		if(!pathExists||Misc::UInt64(pathStat.st_dev)!=fileDevice||Misc::UInt64(pathStat.st_ino)!=fileInode)
+			{
+			/* The file was rotated or removed; consume the rest of the old file, which will not grow any more: */
+			readNewData();
+			flushPartialRecord();
+			file=0;
+			}
+		else if(file->getSize()<readOffset)
+			{
+			/* The file was truncated; start over from its new beginning: */
+			file=0;
+			}
+		}
+	
+	/* Open a new instance of the followed file if there is one: */
+	if(file==0&&pathExists)
+		openFile();
+	
+	/* Deliver any records appended to the current file: */
+	if(file!=0)
+		readNewData();
+	}
+
+}
@@ -0,0 +1,109 @@
+/***********************************************************************
+FileTailer - Class to follow a growing file and deliver newly appended
+complete records to a callback, using a FileMonitor to react to changes
+and coping with truncation and rotation of the followed file.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_FILETAILER_INCLUDED
+#define IO_FILETAILER_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Threads/Mutex.h>
+#include <IO/SeekableFile.h>
+#include <IO/FileMonitor.h>
+
+/* Forward declarations: */
+namespace Misc {
+template <class ParameterParam>
+class FunctionCall;
+}
+
+namespace IO {
+
+class FileTailer
+	{
+	/* Embedded classes: */
+	public:
+	struct Record // Structure describing a complete record passed to record callbacks
+		{
+		/* Elements: */
+		public:
+		const char* begin; // Beginning of the record's data; only valid during the callback
+		const char* end; // End of the record's data, excluding the record separator
+		SeekableFile::Offset offset; // Position of the record's first byte in its file
+		unsigned int generation; // Number of times the followed file had been truncated or replaced when the record was read
+		};
+	
+	typedef Misc::FunctionCall<const Record&> RecordCallback; // Type for record callback functions
+	
+	/* Elements: */
+	private:
+	std::string fileName; // Name of the followed file
+	std::string baseName; // Name of the followed file inside its directory
+	char recordSeparator; // Character terminating records
+	RecordCallback* recordCallback; // Callback called for each complete record
+	Threads::Mutex updateMutex; // Mutex serializing updates from the background thread and explicit calls
+	SeekableFilePtr file; // Currently open instance of the followed file, or null if the file does not exist
+	Misc::UInt64 fileDevice; // Device ID of the currently open file, to detect rotation
+	Misc::UInt64 fileInode; // Inode number of the currently open file, to detect rotation
+	bool haveOpened; // Flag whether any instance of the followed file was opened before
+	unsigned int generation; // Number of times the followed file was truncated or replaced
+	SeekableFile::Offset readOffset; // Position up to which the currently open file was read
+	SeekableFile::Offset recordOffset; // Position of the first byte of the current partial record
+	bool skipPartialRecord; // Flag whether the current partial record started before the tailer and must be discarded
+	std::vector<char> partialRecord; // Data of an incomplete record at the end of the data read so far
+	FileMonitor monitor; // File monitor watching the followed file's directory
+	FileMonitor::Cookie directoryCookie; // Cookie for the followed file's directory
+	
+	/* Private methods: */
+	void deliverRecord(const char* begin,const char* end); // Calls the record callback for a record at the current record offset
+	void openFile(void); // Opens the followed file if it exists
+	void readNewData(void); // Reads all data appended to the currently open file since the last update and delivers complete records
+	void flushPartialRecord(void); // Delivers a final incomplete record from a file that will not grow any more
+	void monitorCallback(const FileMonitor::Event& event); // Callback called when a file in the followed file's directory changes
+	
+	/* Constructors and destructors: */
+	public:
+	FileTailer(const char* sFileName,RecordCallback* sRecordCallback,char sRecordSeparator ='\n',bool readExisting =true); // Follows the given file and delivers records ending in the given separator to the given callback, which is adopted by the tailer; delivers existing records from the calling thread if flag is true, and all later records from a background thread
+	private:
+	FileTailer(const FileTailer& source); // Prohibit copy constructor
+	FileTailer& operator=(const FileTailer& source); // Prohibit assignment operator
+	public:
+	~FileTailer(void); // Stops following the file
+	
+	/* Methods: */
+	void update(void); // Reads and delivers any data appended to the followed file; called automatically by the background thread, but can be called explicitly on systems without file monitoring
+	SeekableFile::Offset getReadOffset(void) // Returns the position up to which the current instance of the followed file was read
+		{
+		Threads::Mutex::Lock updateLock(updateMutex);
+		return readOffset;
+		}
+	unsigned int getGeneration(void) // Returns the number of times the followed file was truncated or replaced
+		{
+		Threads::Mutex::Lock updateLock(updateMutex);
+		return generation;
+		}
+	};
+
+}
+
+#endif
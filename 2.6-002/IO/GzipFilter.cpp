@@ -1,7 +1,7 @@
 /***********************************************************************
 GzipFilter - Class for read/write access to gzip-compressed files using
 a IO::File abstraction.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -60,16 +60,31 @@ size_t GzipFilter::readData(File::Byte* buffer,size_t bufferSize)
 		int result=inflate(&stream,Z_NO_FLUSH);
 		if(result==Z_STREAM_END)
 			{
-			/* Set the eof flag and clean out the decompressor: */
-			readEof=true;
-			if(inflateEnd(&stream)!=Z_OK)
+			/* Check if another gzip member follows, as in files written by ParallelGzipFilter or concatenated by cat: */
+			if(stream.avail_in==0)
 				{
-				if(stream.msg!=0)
-					Misc::throwStdErr("IO::GzipFilter: Error \"%s\" after decompression",stream.msg);
-				else
-					Misc::throwStdErr("IO::GzipFilter: Data corruption detected after decompression");
+				void* compressedBuffer;
+				size_t compressedSize=gzippedFile->readInBuffer(compressedBuffer);
+				if(compressedSize==0)
+					{
+					/* Set the eof flag and clean out the decompressor: */
+					readEof=true;
+					if(inflateEnd(&stream)!=Z_OK)
+						{
+						if(stream.msg!=0)
+							Misc::throwStdErr("IO::GzipFilter: Error \"%s\" after decompression",stream.msg);
+						else
+							Misc::throwStdErr("IO::GzipFilter: Data corruption detected after decompression");
+						}
+					break;
+					}
+				stream.next_in=static_cast<Bytef*>(compressedBuffer);
+				stream.avail_in=compressedSize;
 				}
-			break;
+			
+			/* Start decompressing the next member: */
+			if(inflateReset(&stream)!=Z_OK)
+				Misc::throwStdErr("IO::GzipFilter: Internal zlib error while decompressing");
 			}
 		else if(result!=Z_OK)
 			{
@@ -0,0 +1,268 @@
+/***********************************************************************
+GzipIndex - Class for indices of checkpoints into gzip-compressed files
+to support random access to the uncompressed data.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+
+#include <IO/GzipIndex.h>
+
+#include <string.h>
+#include <zlib.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+
+namespace IO {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const char* indexFileHeader="Vrui Gzip Index v1.0\n"; // Identifying header of gzip index files
+const size_t indexFileHeaderSize=21;
+
+void throwZlibError(z_stream& stream,const char* what)
+	{
+	if(stream.msg!=0)
+		Misc::throwStdErr("IO::GzipIndex: Error \"%s\" while %s",stream.msg,what);
+	else
+		Misc::throwStdErr("IO::GzipIndex: Internal zlib error while %s",what);
+	}
+
+}
+
+/**************************
+Methods of class GzipIndex:
+**************************/
+
+const size_t GzipIndex::windowSize;
+
+void GzipIndex::addCheckpoint(GzipIndex::Offset uncompressedOffset,GzipIndex::Offset compressedOffset,int bits,const GzipIndex::Byte* window,size_t windowPos)
+	{
+	Checkpoint cp;
+	cp.uncompressedOffset=uncompressedOffset;
+	cp.compressedOffset=compressedOffset;
+	cp.bits=bits;
+	cp.window=0;
+	if(window!=0)
+		{
+		/* Unroll the circular window buffer into the checkpoint's window: */
+		cp.window=new Byte[windowSize];
+		memcpy(cp.window,window+windowPos,windowSize-windowPos);
+		memcpy(cp.window+(windowSize-windowPos),window,windowPos);
+		}
+	checkpoints.push_back(cp);
+	}
+
+GzipIndex::GzipIndex(File& gzippedFile,size_t sCheckpointSpacing,long int sModificationTime)
+	:compressedSize(0),uncompressedSize(0),
+	 modificationTime(sModificationTime),
+	 checkpointSpacing(sCheckpointSpacing)
+	{
+	/* Initialize a decompressor that parses gzip headers: */
+	z_stream stream;
+	stream.next_in=Z_NULL;
+	stream.avail_in=0;
+	stream.zalloc=Z_NULL;
+	stream.zfree=Z_NULL;
+	stream.opaque=0;
+	if(inflateInit2(&stream,15+16)!=Z_OK)
+		throwZlibError(stream,"initializing");
+	
+	/* Decompress into a circular window buffer: */
+	Byte* window=new Byte[windowSize];
+	stream.next_out=window;
+	stream.avail_out=windowSize;
+	
+	try
+		{
+		/* The beginning of the first gzip member is the first checkpoint: */
+		addCheckpoint(0,0,-1,0,0);
+		Offset lastCheckpoint=0;
+		
+		/* Decompress the entire file: */
+		while(true)
+			{
+			/* Check if the decompressor needs more input: */
+			if(stream.avail_in==0)
+				{
+				void* compressedBuffer;
+				size_t readSize=gzippedFile.readInBuffer(compressedBuffer);
+				if(readSize==0)
+					Misc::throwStdErr("IO::GzipIndex: Premature end of gzip-compressed file");
+				stream.next_in=static_cast<Bytef*>(compressedBuffer);
+				stream.avail_in=readSize;
+				}
+			
+			/* Wrap around the circular window buffer: */
+			if(stream.avail_out==0)
+				{
+				stream.next_out=window;
+				stream.avail_out=windowSize;
+				}
+			
+			/* Decompress up to the end of the next deflate block: */
+			size_t availIn=stream.avail_in;
+			size_t availOut=stream.avail_out;
+			int result=inflate(&stream,Z_BLOCK);
+			compressedSize+=Offset(availIn-stream.avail_in);
+			uncompressedSize+=Offset(availOut-stream.avail_out);
+			
+			if(result==Z_STREAM_END)
+				{
+				/* Check if another gzip member follows: */
+				if(stream.avail_in==0)
+					{
+					void* compressedBuffer;
+					size_t readSize=gzippedFile.readInBuffer(compressedBuffer);
+					if(readSize==0)
+						break;
+					stream.next_in=static_cast<Bytef*>(compressedBuffer);
+					stream.avail_in=readSize;
+					}
+				
+				/* Start decompressing the next member, and mark its beginning as a checkpoint: */
+				if(inflateReset2(&stream,15+16)!=Z_OK)
+					throwZlibError(stream,"decompressing");
+				addCheckpoint(uncompressedSize,compressedSize,-1,0,0);
+				lastCheckpoint=uncompressedSize;
+				}
+			else if(result!=Z_OK)
+				throwZlibError(stream,"decompressing");
+			else if((stream.data_type&128)!=0&&(stream.data_type&64)==0&&uncompressedSize-lastCheckpoint>=Offset(checkpointSpacing))
+				{
+				/* Create a checkpoint at the end of a non-final deflate block: */
+				addCheckpoint(uncompressedSize,compressedSize,stream.data_type&7,window,windowSize-stream.avail_out);
+				lastCheckpoint=uncompressedSize;
+				}
+			}
+		}
+	catch(...)
+		{
+		/* Clean up and re-throw: */
+		inflateEnd(&stream);
+		delete[] window;
+		for(std::vector<Checkpoint>::iterator cpIt=checkpoints.begin();cpIt!=checkpoints.end();++cpIt)
+			delete[] cpIt->window;
+		throw;
+		}
+	
+	/* Clean up: */
+	inflateEnd(&stream);
+	delete[] window;
+	}
+
+GzipIndex::GzipIndex(File& indexFile)
+	:compressedSize(0),uncompressedSize(0),
+	 modificationTime(0),
+	 checkpointSpacing(0)
+	{
+	/* Check the index file's header: */
+	indexFile.setEndianness(Misc::LittleEndian);
+	char header[indexFileHeaderSize];
+	indexFile.read<char>(header,indexFileHeaderSize);
+	if(memcmp(header,indexFileHeader,indexFileHeaderSize)!=0)
+		Misc::throwStdErr("IO::GzipIndex: File is not a gzip index file");
+	
+	/* Read the index parameters: */
+	compressedSize=Offset(indexFile.read<Misc::SInt64>());
+	uncompressedSize=Offset(indexFile.read<Misc::SInt64>());
+	modificationTime=long(indexFile.read<Misc::SInt64>());
+	checkpointSpacing=size_t(indexFile.read<Misc::UInt64>());
+	
+	/* Read all checkpoints: */
+	size_t numCheckpoints=indexFile.read<Misc::UInt32>();
+	checkpoints.reserve(numCheckpoints);
+	try
+		{
+		for(size_t i=0;i<numCheckpoints;++i)
+			{
+			Checkpoint cp;
+			cp.uncompressedOffset=Offset(indexFile.read<Misc::SInt64>());
+			cp.compressedOffset=Offset(indexFile.read<Misc::SInt64>());
+			cp.bits=indexFile.read<Misc::SInt32>();
+			cp.window=0;
+			if(cp.bits>=0)
+				{
+				cp.window=new Byte[windowSize];
+				checkpoints.push_back(cp);
+				indexFile.read<Byte>(cp.window,windowSize);
+				}
+			else
+				checkpoints.push_back(cp);
+			}
+		}
+	catch(...)
+		{
+		/* Clean up and re-throw: */
+		for(std::vector<Checkpoint>::iterator cpIt=checkpoints.begin();cpIt!=checkpoints.end();++cpIt)
+			delete[] cpIt->window;
+		throw;
+		}
+	}
+
+GzipIndex::~GzipIndex(void)
+	{
+	/* Delete all checkpoint windows: */
+	for(std::vector<Checkpoint>::iterator cpIt=checkpoints.begin();cpIt!=checkpoints.end();++cpIt)
+		delete[] cpIt->window;
+	}
+
+void GzipIndex::save(File& indexFile) const
+	{
+	/* Write the index file's header and parameters: */
+	indexFile.setEndianness(Misc::LittleEndian);
+	indexFile.write<char>(indexFileHeader,indexFileHeaderSize);
+	indexFile.write<Misc::SInt64>(compressedSize);
+	indexFile.write<Misc::SInt64>(uncompressedSize);
+	indexFile.write<Misc::SInt64>(modificationTime);
+	indexFile.write<Misc::UInt64>(checkpointSpacing);
+	
+	/* Write all checkpoints: */
+	indexFile.write<Misc::UInt32>(checkpoints.size());
+	for(std::vector<Checkpoint>::const_iterator cpIt=checkpoints.begin();cpIt!=checkpoints.end();++cpIt)
+		{
+		indexFile.write<Misc::SInt64>(cpIt->uncompressedOffset);
+		indexFile.write<Misc::SInt64>(cpIt->compressedOffset);
+		indexFile.write<Misc::SInt32>(cpIt->bits);
+		if(cpIt->bits>=0)
+			indexFile.write<Byte>(cpIt->window,windowSize);
+		}
+	}
+
+const GzipIndex::Checkpoint& GzipIndex::findCheckpoint(GzipIndex::Offset uncompressedOffset) const
+	{
+	/* Binary search for the last checkpoint at or before the given offset: */
+	size_t l=0;
+	size_t r=checkpoints.size();
+	while(r-l>1)
+		{
+		size_t m=(l+r)>>1;
+		if(checkpoints[m].uncompressedOffset<=uncompressedOffset)
+			l=m;
+		else
+			r=m;
+		}
+	
+	return checkpoints[l];
+	}
+
+}
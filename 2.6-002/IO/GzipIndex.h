@@ -0,0 +1,106 @@
+/***********************************************************************
+GzipIndex - Class for indices of checkpoints into gzip-compressed files
+to support random access to the uncompressed data.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_GZIPINDEX_INCLUDED
+#define IO_GZIPINDEX_INCLUDED
+
+#include <vector>
+#include <Misc/Autopointer.h>
+#include <Threads/RefCounted.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+
+namespace IO {
+
+class GzipIndex:public Threads::RefCounted
+	{
+	/* Embedded classes: */
+	public:
+	typedef SeekableFile::Offset Offset; // Type for file offsets
+	typedef unsigned char Byte; // Type for uncompressed data
+	static const size_t windowSize=32768; // Size of the zlib decompression window stored with each checkpoint
+	
+	struct Checkpoint // Structure for positions at which decompression can be restarted
+		{
+		/* Elements: */
+		public:
+		Offset uncompressedOffset; // Position of the checkpoint in the uncompressed data
+		Offset compressedOffset; // Position of the first compressed byte following the checkpoint
+		int bits; // Number of bits of the compressed byte preceding compressedOffset that belong to the data after the checkpoint, or -1 if the checkpoint is the beginning of a gzip member
+		Byte* window; // Last windowSize bytes of uncompressed data preceding the checkpoint; null if the checkpoint is the beginning of a gzip member
+		};
+	
+	/* Elements: */
+	private:
+	Offset compressedSize; // Total size of the indexed gzip-compressed file
+	Offset uncompressedSize; // Total size of the uncompressed data
+	long int modificationTime; // Modification time of the indexed gzip-compressed file at the time the index was built
+	size_t checkpointSpacing; // Minimum amount of uncompressed data between adjacent checkpoints
+	std::vector<Checkpoint> checkpoints; // List of checkpoints in order of increasing offsets
+	
+	/* Private methods: */
+	void addCheckpoint(Offset uncompressedOffset,Offset compressedOffset,int bits,const Byte* window,size_t windowPos); // Adds a checkpoint; windowPos is the position in the circular window buffer where the oldest data starts
+	
+	/* Constructors and destructors: */
+	public:
+	GzipIndex(File& gzippedFile,size_t sCheckpointSpacing,long int sModificationTime =0); // Builds an index by decompressing the given gzip-compressed file from its current position to its end
+	GzipIndex(File& indexFile); // Loads an index from the given index file
+	private:
+	GzipIndex(const GzipIndex& source); // Prohibit copy constructor
+	GzipIndex& operator=(const GzipIndex& source); // Prohibit assignment operator
+	public:
+	virtual ~GzipIndex(void);
+	
+	/* Methods: */
+	void save(File& indexFile) const; // Writes the index to the given index file
+	Offset getCompressedSize(void) const // Returns the total size of the indexed gzip-compressed file
+		{
+		return compressedSize;
+		}
+	Offset getUncompressedSize(void) const // Returns the total size of the uncompressed data
+		{
+		return uncompressedSize;
+		}
+	long int getModificationTime(void) const // Returns the modification time of the indexed file at the time the index was built
+		{
+		return modificationTime;
+		}
+	size_t getCheckpointSpacing(void) const // Returns the minimum spacing between checkpoints
+		{
+		return checkpointSpacing;
+		}
+	size_t getNumCheckpoints(void) const // Returns the number of checkpoints
+		{
+		return checkpoints.size();
+		}
+	const Checkpoint& getCheckpoint(size_t index) const // Returns the checkpoint of the given index
+		{
+		return checkpoints[index];
+		}
+	const Checkpoint& findCheckpoint(Offset uncompressedOffset) const; // Returns the last checkpoint at or before the given uncompressed position
+	};
+
+typedef Misc::Autopointer<GzipIndex> GzipIndexPtr; // Type for pointers to reference-counted gzip index objects
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+/***********************************************************************
+IndexedGzipFile - Class for random-access reading from gzip-compressed
+files using a checkpoint index that is built on the first pass and
+persisted in a sidecar index file.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/IndexedGzipFile.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <stdexcept>
+#include <Misc/ThrowStdErr.h>
+#include <IO/StandardFile.h>
+
+namespace IO {
+
+/********************************
+Methods of class IndexedGzipFile:
+********************************/
+
+size_t IndexedGzipFile::readData(File::Byte* buffer,size_t bufferSize)
+	{
+	/* Check for end-of-file: */
+	if(readPos>=index->getUncompressedSize())
+		return 0;
+	
+	/* Check if the decompressor needs to be moved to the read position: */
+	if(decompressPos!=readPos)
+		{
+		/* Restart at the closest preceding checkpoint unless the read position is closer ahead: */
+		const GzipIndex::Checkpoint& checkpoint=index->findCheckpoint(readPos);
+		if(readPos<decompressPos||checkpoint.uncompressedOffset>decompressPos)
+			restart(checkpoint);
+		
+		/* Decompress and discard data up to the read position: */
+		while(decompressPos<readPos)
+			{
+			size_t skipSize=bufferSize;
+			if(Offset(skipSize)>readPos-decompressPos)
+				skipSize=size_t(readPos-decompressPos);
+			if(decompress(buffer,skipSize)==0)
+				throw SeekError(readPos);
+			}
+		}
+	
+	/* Decompress data into the given buffer: */
+	size_t result=decompress(buffer,bufferSize);
+	readPos+=result;
+	
+	return result;
+	}
+
+void IndexedGzipFile::init(void)
+	{
+	/* Install an output buffer for uncompressed data: */
+	resizeReadBuffer(gzippedFile->getReadBufferSize()*2);
+	
+	/* Initialize the zlib stream object: */
+	stream.next_in=Z_NULL;
+	stream.avail_in=0;
+	stream.zalloc=Z_NULL;
+	stream.zfree=Z_NULL;
+	stream.opaque=0;
+	if(inflateInit2(&stream,15+16)!=Z_OK)
+		{
+		if(stream.msg!=0)
+			throw OpenError(Misc::printStdErrMsg("IO::IndexedGzipFile: Error \"%s\" during initialization",stream.msg));
+		else
+			throw OpenError(Misc::printStdErrMsg("IO::IndexedGzipFile: Internal zlib error during initialization"));
+		}
+	
+	/* Start decompressing at the beginning of the file: */
+	restart(index->getCheckpoint(0));
+	}
+
+void IndexedGzipFile::restart(const GzipIndex::Checkpoint& checkpoint)
+	{
+	/* Discard any pending compressed data: */
+	stream.next_in=Z_NULL;
+	stream.avail_in=0;
+	
+	int result;
+	if(checkpoint.bits<0)
+		{
+		/* Start decompressing a new gzip member, including its header: */
+		gzippedFile->setReadPosAbs(checkpoint.compressedOffset);
+		result=inflateReset2(&stream,15+16);
+		rawDeflate=false;
+		}
+	else
+		{
+		/* Start decompressing raw deflate data in the middle of a gzip member: */
+		result=inflateReset2(&stream,-15);
+		if(result==Z_OK&&checkpoint.bits>0)
+			{
+			/* Feed the remaining bits of the partial byte preceding the checkpoint: */
+			gzippedFile->setReadPosAbs(checkpoint.compressedOffset-1);
+			int partialByte=gzippedFile->getChar();
+			if(partialByte<0)
+				throw SeekError(checkpoint.compressedOffset);
+			result=inflatePrime(&stream,checkpoint.bits,partialByte>>(8-checkpoint.bits));
+			}
+		else
+			gzippedFile->setReadPosAbs(checkpoint.compressedOffset);
+		
+		/* Restore the decompression window: */
+		if(result==Z_OK)
+			result=inflateSetDictionary(&stream,checkpoint.window,GzipIndex::windowSize);
+		rawDeflate=true;
+		}
+	if(result!=Z_OK)
+		{
+		if(stream.msg!=0)
+			Misc::throwStdErr("IO::IndexedGzipFile: Error \"%s\" while restarting decompression",stream.msg);
+		else
+			Misc::throwStdErr("IO::IndexedGzipFile: Internal zlib error while restarting decompression");
+		}
+	
+	decompressPos=checkpoint.uncompressedOffset;
+	}
+
+void IndexedGzipFile::fillInput(void)
+	{
+	/* Read the next glob of compressed data: */
+	void* compressedBuffer;
+	size_t compressedSize=gzippedFile->readInBuffer(compressedBuffer);
+	if(compressedSize==0)
+		Misc::throwStdErr("IO::IndexedGzipFile: Premature end of gzip-compressed file");
+	
+	/* Pass the compressed data to the decompressor: */
+	stream.next_in=static_cast<Bytef*>(compressedBuffer);
+	stream.avail_in=compressedSize;
+	}
+
+size_t IndexedGzipFile::decompress(File::Byte* buffer,size_t bufferSize)
+	{
+	/* Decompress data into the given buffer: */
+	stream.next_out=buffer;
+	stream.avail_out=bufferSize;
+	
+	/* Try until at least some output is produced, or the end of the uncompressed data is reached: */
+	while(stream.avail_out==bufferSize&&decompressPos<index->getUncompressedSize())
+		{
+		/* Check if the decompressor needs more input: */
+		if(stream.avail_in==0)
+			fillInput();
+		
+		/* Decompress from the gzipped file's buffer: */
+		int result=inflate(&stream,Z_NO_FLUSH);
+		if(result==Z_STREAM_END)
+			{
+			if(rawDeflate)
+				{
+				/* Skip the gzip member's trailer, which the raw decompressor does not process: */
+				size_t trailerSize=8;
+				while(trailerSize>0)
+					{
+					if(stream.avail_in==0)
+						fillInput();
+					size_t skipSize=trailerSize;
+					if(skipSize>stream.avail_in)
+						skipSize=stream.avail_in;
+					stream.next_in+=skipSize;
+					stream.avail_in-=skipSize;
+					trailerSize-=skipSize;
+					}
+				}
+			
+			/* Prepare to decompress the next gzip member: */
+			if(inflateReset2(&stream,15+16)!=Z_OK)
+				Misc::throwStdErr("IO::IndexedGzipFile: Internal zlib error while decompressing");
+			rawDeflate=false;
+			}
+		else if(result!=Z_OK)
+			{
+			if(stream.msg!=0)
+				Misc::throwStdErr("IO::IndexedGzipFile: Error \"%s\" while decompressing",stream.msg);
+			else
+				Misc::throwStdErr("IO::IndexedGzipFile: Internal zlib error while decompressing");
+			}
+		}
+	
+	size_t result=bufferSize-stream.avail_out;
+	decompressPos+=result;
+	return result;
+	}
+
+IndexedGzipFile::IndexedGzipFile(const char* gzippedFileName,size_t checkpointSpacing)
+	:SeekableFile(),
+	 gzippedFile(new StandardFile(gzippedFileName,File::ReadOnly)),
+	 rawDeflate(false),decompressPos(0)
+	{
+	/* Query the compressed file's modification time to detect outdated index files: */
+	long int modificationTime=0;
+	struct stat statBuffer;
+	if(stat(gzippedFileName,&statBuffer)==0)
+		modificationTime=long(statBuffer.st_mtime);
+	
+	/* Try loading the index from the sidecar index file: */
+	std::string indexFileName=gzippedFileName;
+	indexFileName.append(".gzidx");
+	try
+		{
+		FilePtr indexFile=new StandardFile(indexFileName.c_str(),File::ReadOnly);
+		GzipIndexPtr loadedIndex=new GzipIndex(*indexFile);
+		if(loadedIndex->getCompressedSize()==gzippedFile->getSize()&&loadedIndex->getModificationTime()==modificationTime)
+			index=loadedIndex;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Ignore missing or corrupted index files; the index will be rebuilt */
+		}
+	
+	if(index==0)
+		{
+		/* Build the index by decompressing the entire file: */
+		index=new GzipIndex(*gzippedFile,checkpointSpacing,modificationTime);
+		
+		/* Try saving the index for the next time the file is opened: */
+		try
+			{
+			FilePtr indexFile=new StandardFile(indexFileName.c_str(),File::WriteOnly);
+			index->save(*indexFile);
+			}
+		catch(std::runtime_error err)
+			{
+			/* Ignore the error; the index will be rebuilt the next time */
+			}
+		}
+	
+	init();
+	}
+
+IndexedGzipFile::IndexedGzipFile(SeekableFilePtr sGzippedFile,GzipIndexPtr sIndex)
+	:SeekableFile(),
+	 gzippedFile(sGzippedFile),
+	 index(sIndex),
+	 rawDeflate(false),decompressPos(0)
+	{
+	init();
+	}
+
+IndexedGzipFile::~IndexedGzipFile(void)
+	{
+	/* Clean out the decompressor: */
+	inflateEnd(&stream);
+	}
+
+SeekableFile::Offset IndexedGzipFile::getSize(void) const
+	{
+	return index->getUncompressedSize();
+	}
+
+}
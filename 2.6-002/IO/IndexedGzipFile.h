@@ -0,0 +1,73 @@
+/***********************************************************************
+IndexedGzipFile - Class for random-access reading from gzip-compressed
+files using a checkpoint index that is built on the first pass and
+persisted in a sidecar index file.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_INDEXEDGZIPFILE_INCLUDED
+#define IO_INDEXEDGZIPFILE_INCLUDED
+
+#include <zlib.h>
+#include <IO/SeekableFile.h>
+#include <IO/GzipIndex.h>
+
+namespace IO {
+
+class IndexedGzipFile:public SeekableFile
+	{
+	/* Elements: */
+	private:
+	SeekableFilePtr gzippedFile; // Underlying gzip-compressed file
+	GzipIndexPtr index; // Checkpoint index; can be shared between several files reading from the same compressed file concurrently
+	z_stream stream; // Zlib decompression structure
+	bool rawDeflate; // Flag if the decompressor was restarted at a checkpoint inside a gzip member, and has to skip the member's trailer itself
+	Offset decompressPos; // Position in the uncompressed data at which the decompressor will produce its next output
+	
+	/* Protected methods from File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize);
+	
+	/* Private methods: */
+	private:
+	void init(void); // Initializes the decompressor
+	void restart(const GzipIndex::Checkpoint& checkpoint); // Restarts the decompressor at the given checkpoint
+	void fillInput(void); // Reads more compressed data from the gzip-compressed file
+	size_t decompress(Byte* buffer,size_t bufferSize); // Decompresses data into the given buffer; returns zero at the end of the uncompressed data
+	
+	/* Constructors and destructors: */
+	public:
+	static const size_t defaultCheckpointSpacing=1024*1024; // Default amount of uncompressed data between checkpoints
+	IndexedGzipFile(const char* gzippedFileName,size_t checkpointSpacing =defaultCheckpointSpacing); // Opens the gzip-compressed file of the given name; loads its index from the sidecar file <gzippedFileName>.gzidx, or builds and saves it if the sidecar file is missing or outdated
+	IndexedGzipFile(SeekableFilePtr sGzippedFile,GzipIndexPtr sIndex); // Reads from the given gzip-compressed file using the given index
+	virtual ~IndexedGzipFile(void);
+	
+	/* Methods from SeekableFile: */
+	virtual Offset getSize(void) const;
+	
+	/* New methods: */
+	GzipIndexPtr getIndex(void) const // Returns the checkpoint index, to open additional files reading independent ranges in parallel
+		{
+		return index;
+		}
+	};
+
+}
+
+#endif
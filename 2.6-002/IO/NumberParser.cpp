@@ -0,0 +1,276 @@
+/***********************************************************************
+NumberParser - Functions to quickly parse decimal floating-point numbers
+from character buffers or directly from the read buffers of files, with
+correctly rounded conversion.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/NumberParser.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <IO/File.h>
+
+namespace IO {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const int maxMantissaDigits=19; // Maximum number of significant decimal digits that fit into a 64-bit mantissa
+const Misc::UInt64 maxExactMantissa=Misc::UInt64(1)<<53; // Largest mantissa that converts to double without rounding
+
+const double exactPowersOfTen[23]= // Powers of ten that are exactly representable as doubles
+	{
+	1.0e0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,
+	1.0e10,1.0e11,1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,
+	1.0e20,1.0e21,1.0e22
+	};
+
+inline bool isDigit(char c)
+	{
+	return c>='0'&&c<='9';
+	}
+
+#if __BYTE_ORDER==__LITTLE_ENDIAN
+
+inline bool areEightDigits(Misc::UInt64 chunk) // Returns true if all eight characters packed into the given chunk are decimal digits
+	{
+	return ((chunk&0xf0f0f0f0f0f0f0f0ULL)|(((chunk+0x0606060606060606ULL)&0xf0f0f0f0f0f0f0f0ULL)>>4))==0x3333333333333333ULL;
+	}
+
+inline Misc::UInt32 parseEightDigits(Misc::UInt64 chunk) // Converts eight decimal digits packed into the given chunk, first digit in the lowest byte
+	{
+	/* Combine digits pairwise, then pairs of pairs, then both halves: */
+	chunk-=0x3030303030303030ULL;
+	chunk=chunk*10U+(chunk>>8);
+	chunk=((chunk&0x000000ff000000ffULL)*(100U+(1000000ULL<<32))+((chunk>>16)&0x000000ff000000ffULL)*(1U+(10000ULL<<32)))>>32;
+	return Misc::UInt32(chunk);
+	}
+
+#endif
+
+inline int accumulateDigits(const char*& cPtr,const char* end,Misc::UInt64& mantissa,int& numDigits,bool& truncated) // Accumulates a run of decimal digits into the mantissa; returns the number of digits that did not fit
+	{
+	#if __BYTE_ORDER==__LITTLE_ENDIAN
+	/* Accumulate blocks of eight digits at once while they fit into the mantissa: */
+	while(end-cPtr>=8&&numDigits<=maxMantissaDigits-8)
+		{
+		Misc::UInt64 chunk;
+		memcpy(&chunk,cPtr,8);
+		if(!areEightDigits(chunk))
+			break;
+		mantissa=mantissa*100000000U+parseEightDigits(chunk);
+		if(mantissa!=0)
+			numDigits+=8; // Might over-count leading zeros, which only causes an earlier fallback
+		cPtr+=8;
+		}
+	#endif
+	
+	/* Accumulate the remaining digits one at a time: */
+	int numDropped=0;
+	while(cPtr!=end&&isDigit(*cPtr))
+		{
+		if(numDigits<maxMantissaDigits)
+			{
+			mantissa=mantissa*10U+Misc::UInt64(*cPtr-'0');
+			if(mantissa!=0)
+				++numDigits;
+			}
+		else
+			{
+			if(*cPtr!='0')
+				truncated=true;
+			++numDropped;
+			}
+		++cPtr;
+		}
+	
+	return numDropped;
+	}
+
+double convertSlow(const char* begin,const char* end) // Converts the given unsigned number using the C library, which rounds correctly in all cases
+	{
+	/* Copy the number into a NUL-terminated buffer: */
+	size_t length=end-begin;
+	if(length<64)
+		{
+		char buffer[64];
+		memcpy(buffer,begin,length);
+		buffer[length]='\0';
+		return strtod(buffer,0);
+		}
+	else
+		{
+		std::string buffer(begin,end);
+		return strtod(buffer.c_str(),0);
+		}
+	}
+
+inline void appendChar(std::string& number,File& source,int& nextChar) // Appends the given character to a gathered number and reads the next character
+	{
+	number.push_back(char(nextChar));
+	nextChar=source.getChar();
+	}
+
+}
+
+bool parseNumber(const char*& cPtr,const char* end,double& value)
+	{
+	/* Read a plus or minus sign: */
+	bool negate=false;
+	if(cPtr!=end&&(*cPtr=='-'||*cPtr=='+'))
+		{
+		negate=*cPtr=='-';
+		++cPtr;
+		}
+	const char* numberStart=cPtr;
+	
+	/* Read an integral number part: */
+	Misc::UInt64 mantissa=0;
+	int numDigits=0;
+	bool truncated=false;
+	int exponent=accumulateDigits(cPtr,end,mantissa,numDigits,truncated);
+	bool haveDigit=cPtr!=numberStart;
+	
+	/* Check for a period: */
+	if(cPtr!=end&&*cPtr=='.')
+		{
+		++cPtr;
+		
+		/* Read a fractional number part: */
+		const char* fractionStart=cPtr;
+		int numDropped=accumulateDigits(cPtr,end,mantissa,numDigits,truncated);
+		exponent-=int(cPtr-fractionStart)-numDropped;
+		if(cPtr!=fractionStart)
+			haveDigit=true;
+		}
+	
+	/* Signal an error if no digits were read in the integral or fractional part: */
+	if(!haveDigit)
+		return false;
+	
+	/* Check for an exponent indicator: */
+	if(cPtr!=end&&(*cPtr=='e'||*cPtr=='E'))
+		{
+		++cPtr;
+		
+		/* Read a plus or minus sign: */
+		bool negateExponent=false;
+		if(cPtr!=end&&(*cPtr=='-'||*cPtr=='+'))
+			{
+			negateExponent=*cPtr=='-';
+			++cPtr;
+			}
+		
+		/* Check if there are any digits in the exponent: */
+		if(cPtr==end||!isDigit(*cPtr))
+			return false;
+		
+		/* Read the exponent, saturating at a value beyond the range of doubles: */
+		int explicitExponent=0;
+		while(cPtr!=end&&isDigit(*cPtr))
+			{
+			if(explicitExponent<100000)
+				explicitExponent=explicitExponent*10+int(*cPtr-'0');
+			++cPtr;
+			}
+		exponent+=negateExponent?-explicitExponent:explicitExponent;
+		}
+	
+	/* Convert the mantissa and exponent: */
+	if(!truncated&&mantissa<=maxExactMantissa&&exponent>=-22&&exponent<=22)
+		{
+		/* Both operands are exact, hence a single IEEE multiplication or division rounds correctly: */
+		value=double(mantissa);
+		if(exponent<0)
+			value/=exactPowersOfTen[-exponent];
+		else
+			value*=exactPowersOfTen[exponent];
+		}
+	else if(mantissa==0&&!truncated)
+		value=0.0;
+	else
+		value=convertSlow(numberStart,cPtr);
+	
+	/* Negate the result if a minus sign was read: */
+	if(negate)
+		value=-value;
+	
+	return true;
+	}
+
+bool readNumber(File& source,int& nextChar,double& value)
+	{
+	/* Bail out if the first character cannot start a number, to avoid reading ahead needlessly: */
+	if(!((nextChar>='0'&&nextChar<='9')||nextChar=='-'||nextChar=='+'||nextChar=='.'))
+		return false;
+	
+	/* Copy the first character and a window of following characters from the file's read buffer into a local buffer: */
+	char window[64];
+	window[0]=char(nextChar);
+	void* data;
+	size_t dataSize=source.readInBuffer(data,sizeof(window)-1);
+	memcpy(window+1,data,dataSize);
+	const char* windowEnd=window+1+dataSize;
+	
+	/* Parse the number from the window: */
+	const char* cPtr=window;
+	bool result=parseNumber(cPtr,windowEnd,value);
+	if(cPtr!=windowEnd)
+		{
+		/* Put back the unconsumed part of the window and read the character following the number: */
+		source.unreadInBuffer(windowEnd-cPtr);
+		nextChar=source.getChar();
+		return result;
+		}
+	
+	/* The number might extend beyond the window; put back the window and gather the number one character at a time: */
+	source.unreadInBuffer(dataSize);
+	std::string number;
+	if(nextChar=='-'||nextChar=='+')
+		appendChar(number,source,nextChar);
+	while(nextChar>='0'&&nextChar<='9')
+		appendChar(number,source,nextChar);
+	if(nextChar=='.')
+		{
+		appendChar(number,source,nextChar);
+		while(nextChar>='0'&&nextChar<='9')
+			appendChar(number,source,nextChar);
+		}
+	if(nextChar=='e'||nextChar=='E')
+		{
+		appendChar(number,source,nextChar);
+		if(nextChar=='-'||nextChar=='+')
+			appendChar(number,source,nextChar);
+		while(nextChar>='0'&&nextChar<='9')
+			appendChar(number,source,nextChar);
+		}
+	
+	/* Parse the gathered number: */
+	const char* nPtr=number.data();
+	return parseNumber(nPtr,nPtr+number.size(),value);
+	}
+
+}
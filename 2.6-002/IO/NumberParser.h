@@ -0,0 +1,39 @@
+/***********************************************************************
+NumberParser - Functions to quickly parse decimal floating-point numbers
+from character buffers or directly from the read buffers of files, with
+correctly rounded conversion.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_NUMBERPARSER_INCLUDED
+#define IO_NUMBERPARSER_INCLUDED
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
+namespace IO {
+
+bool parseNumber(const char*& cPtr,const char* end,double& value); // Parses a number of the form [+-](digits[.digits]|.digits)[(e|E)[+-]digits] from the given character range; advances the character pointer past all consumed characters; returns false on format errors
+bool readNumber(File& source,int& nextChar,double& value); // Ditto, reading from the given file, where the given character is the first character of the number and was already read; updates it to the first character following the number
+
+}
+
+#endif
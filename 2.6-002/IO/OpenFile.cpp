@@ -1,7 +1,7 @@
 /***********************************************************************
 OpenFile - Convenience functions to open files of several types using
 the File abstraction.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -26,12 +26,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/FileNameExtensions.h>
 #include <IO/StandardFile.h>
 #include <IO/GzipFilter.h>
+#include <IO/ParallelGzipFilter.h>
 #include <IO/SeekableFilter.h>
 #include <IO/StandardDirectory.h>
 
 namespace IO {
 
 FilePtr openFile(const char* fileName,File::AccessMode accessMode)
+	{
+	return openFile(fileName,accessMode,0);
+	}
+
+FilePtr openFile(const char* fileName,File::AccessMode accessMode,unsigned int numGzipThreads)
 	{
 	FilePtr result;
 	
@@ -41,8 +47,11 @@ FilePtr openFile(const char* fileName,File::AccessMode accessMode)
 	/* Check if the file name has the .gz extension: */
 	if(Misc::hasCaseExtension(fileName,".gz"))
 		{
-		/* Wrap a gzip filter around the base file: */
-		result=new GzipFilter(result);
+		/* Wrap a single-threaded or parallel gzip filter around the base file: */
+		if(numGzipThreads>0)
+			result=new ParallelGzipFilter(result,numGzipThreads);
+		else
+			result=new GzipFilter(result);
 		}
 	
 	/* Return the open file: */
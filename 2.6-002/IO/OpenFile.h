@@ -1,7 +1,7 @@
 /***********************************************************************
 OpenFile - Convenience functions to open files of several types using
 the File abstraction.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace IO {
 
 FilePtr openFile(const char* fileName,File::AccessMode accessMode =File::ReadOnly); // Opens a file of the given name
+FilePtr openFile(const char* fileName,File::AccessMode accessMode,unsigned int numGzipThreads); // Ditto; compresses or decompresses gzip-compressed files on the given number of background threads, or with a single-threaded gzip filter if zero
 SeekableFilePtr openSeekableFile(const char* fileName,File::AccessMode accessMode =File::ReadOnly); // Opens a seekable file of the given name
 DirectoryPtr openDirectory(const char* directoryName); // Opens a directory of the given name
 
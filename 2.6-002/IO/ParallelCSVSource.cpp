@@ -0,0 +1,465 @@
+/***********************************************************************
+ParallelCSVSource - Class to read tabular data in generalized comma-
+separated value (CSV) format from memory-mapped files in parallel, by
+splitting files into chunks and converting selected fields into typed
+columns.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/ParallelCSVSource.h>
+
+#include <ctype.h>
+#include <unistd.h>
+#include <Misc/ThrowStdErr.h>
+#include <Threads/Thread.h>
+#include <IO/NumberParser.h>
+
+namespace IO {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const size_t minChunkSize=65536; // Minimum amount of data to hand to a single thread
+
+inline void trimWhitespace(const char*& begin,const char*& end) // Removes leading and trailing whitespace from the given character range
+	{
+	while(begin!=end&&isspace(*begin))
+		++begin;
+	while(end!=begin&&isspace(end[-1]))
+		--end;
+	}
+
+bool convertInteger(const char* begin,const char* end,int& value) // Converts the entire given character range to a signed integer
+	{
+	trimWhitespace(begin,end);
+	
+	/* Read a plus or minus sign: */
+	bool negate=false;
+	if(begin!=end&&(*begin=='-'||*begin=='+'))
+		{
+		negate=*begin=='-';
+		++begin;
+		}
+	
+	/* Signal a conversion error if the next character is not a digit: */
+	if(begin==end||*begin<'0'||*begin>'9')
+		return false;
+	
+	/* Read all digits: */
+	unsigned int tempValue=0;
+	while(begin!=end&&*begin>='0'&&*begin<='9')
+		{
+		tempValue=tempValue*10+(unsigned int)(*begin-'0');
+		++begin;
+		}
+	value=negate?-int(tempValue):int(tempValue);
+	
+	/* Signal a conversion error if there are characters left: */
+	return begin==end;
+	}
+
+bool convertNumber(const char* begin,const char* end,double& value) // Converts the entire given character range to a floating-point number
+	{
+	trimWhitespace(begin,end);
+	return parseNumber(begin,end,value)&&begin==end;
+	}
+
+std::string unescape(const char* begin,const char* end,char quote) // Returns the given quoted field contents with doubled quotes replaced by single quotes
+	{
+	std::string result;
+	result.reserve(end-begin);
+	for(const char* cPtr=begin;cPtr!=end;++cPtr)
+		{
+		result.push_back(*cPtr);
+		if(*cPtr==quote)
+			++cPtr;
+		}
+	return result;
+	}
+
+}
+
+/**********************************
+Methods of class ParallelCSVSource:
+**********************************/
+
+const char* ParallelCSVSource::findFieldEnd(const char* fieldBegin,const char* end,bool& quoted,bool& escaped,const char*& contentBegin,const char*& contentEnd) const
+	{
+	const char* cPtr=fieldBegin;
+	quoted=cPtr!=end&&*cPtr==quote;
+	escaped=false;
+	if(quoted)
+		{
+		/* Find the closing quote, skipping quoted quotes: */
+		contentBegin=++cPtr;
+		while(true)
+			{
+			while(cPtr!=end&&*cPtr!=quote)
+				++cPtr;
+			
+			/* End of data inside quote is a format error: */
+			if(cPtr==end)
+				return 0;
+			
+			/* Check for quoted quotes: */
+			if(cPtr+1!=end&&cPtr[1]==quote)
+				{
+				escaped=true;
+				cPtr+=2;
+				}
+			else
+				break;
+			}
+		contentEnd=cPtr;
+		++cPtr;
+		
+		/* The closing quote must be followed by a separator: */
+		if(cPtr!=end&&*cPtr!=fieldSeparator&&*cPtr!=recordSeparator)
+			return 0;
+		}
+	else
+		{
+		/* Find the next field or record separator: */
+		contentBegin=cPtr;
+		while(cPtr!=end&&*cPtr!=fieldSeparator&&*cPtr!=recordSeparator)
+			++cPtr;
+		contentEnd=cPtr;
+		}
+	
+	return cPtr;
+	}
+
+void* ParallelCSVSource::scanChunk(ParallelCSVSource::Chunk* chunk)
+	{
+	/* Count quotes and remember the first record separators after even and odd numbers of quotes: */
+	size_t numQuotes=0;
+	const char* firstBreak[2]={0,0};
+	for(const char* cPtr=chunk->begin;cPtr!=chunk->end;++cPtr)
+		{
+		if(*cPtr==quote)
+			++numQuotes;
+		else if(*cPtr==recordSeparator&&firstBreak[numQuotes&0x1U]==0)
+			firstBreak[numQuotes&0x1U]=cPtr;
+		}
+	chunk->numQuotes=numQuotes;
+	for(int i=0;i<2;++i)
+		chunk->firstBreak[i]=firstBreak[i];
+	
+	return 0;
+	}
+
+void* ParallelCSVSource::parseChunk(ParallelCSVSource::Chunk* chunk)
+	{
+	chunk->columns.resize(columns.size());
+	unsigned int numFields=fieldColumns.size();
+	const char* cPtr=chunk->recordsBegin;
+	const char* end=chunk->recordsEnd;
+	while(cPtr!=end)
+		{
+		/* Skip empty records: */
+		if(*cPtr==recordSeparator)
+			{
+			++cPtr;
+			continue;
+			}
+		
+		/* Parse all fields of the record: */
+		unsigned int fieldIndex=0;
+		while(true)
+			{
+			/* Find the extent of the next field: */
+			bool quoted,escaped;
+			const char* contentBegin;
+			const char* contentEnd;
+			const char* fieldEnd=findFieldEnd(cPtr,end,quoted,escaped,contentBegin,contentEnd);
+			if(fieldEnd==0)
+				{
+				chunk->error="IO::ParallelCSVSource::read: Format error in field %u of record %u";
+				chunk->errorFieldIndex=fieldIndex;
+				return 0;
+				}
+			
+			/* Convert the field if it is part of the projection: */
+			if(fieldIndex<numFields&&fieldColumns[fieldIndex]>=0)
+				{
+				int columnIndex=fieldColumns[fieldIndex];
+				ColumnData& data=chunk->columns[columnIndex];
+				bool success=true;
+				switch(columns[columnIndex].type)
+					{
+					case INTEGER:
+						{
+						int value;
+						success=convertInteger(contentBegin,contentEnd,value);
+						data.integers.push_back(value);
+						break;
+						}
+					
+					case NUMBER:
+						{
+						double value;
+						success=convertNumber(contentBegin,contentEnd,value);
+						data.numbers.push_back(value);
+						break;
+						}
+					
+					case STRING:
+						if(escaped)
+							data.strings.push_back(unescape(contentBegin,contentEnd,quote));
+						else
+							data.strings.push_back(std::string(contentBegin,contentEnd));
+						break;
+					}
+				
+				if(!success)
+					{
+					chunk->error="IO::ParallelCSVSource::read: Could not convert field %u of record %u";
+					chunk->errorFieldIndex=fieldIndex;
+					return 0;
+					}
+				}
+			
+			/* Go to the next field: */
+			++fieldIndex;
+			cPtr=fieldEnd;
+			if(cPtr==end||*cPtr==recordSeparator)
+				break;
+			++cPtr;
+			}
+		
+		/* Skip the record separator: */
+		if(cPtr!=end)
+			++cPtr;
+		
+		/* Check that all projected fields were present: */
+		if(fieldIndex<numFields)
+			{
+			chunk->error="IO::ParallelCSVSource::read: Missing field %u in record %u";
+			chunk->errorFieldIndex=fieldIndex;
+			return 0;
+			}
+		
+		++chunk->numRecords;
+		}
+	
+	return 0;
+	}
+
+void ParallelCSVSource::processChunks(std::vector<ParallelCSVSource::Chunk>& chunks,void* (ParallelCSVSource::*chunkMethod)(ParallelCSVSource::Chunk*))
+	{
+	/* Process all but the first chunk in background threads: */
+	size_t numThreads=chunks.size()-1;
+	Threads::Thread* threads=new Threads::Thread[numThreads];
+	for(size_t i=0;i<numThreads;++i)
+		threads[i].start(this,chunkMethod,&chunks[i+1]);
+	
+	/* Process the first chunk in the calling thread: */
+	(this->*chunkMethod)(&chunks[0]);
+	
+	/* Wait for all background threads to finish: */
+	for(size_t i=0;i<numThreads;++i)
+		threads[i].join();
+	delete[] threads;
+	}
+
+ParallelCSVSource::ParallelCSVSource(const char* fileName)
+	:file(new MemMappedFile(fileName)),
+	 fieldSeparator(','),recordSeparator('\n'),quote('\"'),
+	 numHeaderRecords(0),
+	 numRecords(0)
+	{
+	/* Access the file's memory map: */
+	fileBegin=static_cast<const char*>(file->getMemory());
+	fileEnd=fileBegin+file->getSize();
+	dataBegin=fileBegin;
+	}
+
+ParallelCSVSource::~ParallelCSVSource(void)
+	{
+	}
+
+void ParallelCSVSource::setFieldSeparator(char newFieldSeparator)
+	{
+	fieldSeparator=newFieldSeparator;
+	}
+
+void ParallelCSVSource::setRecordSeparator(char newRecordSeparator)
+	{
+	recordSeparator=newRecordSeparator;
+	}
+
+void ParallelCSVSource::setQuote(char newQuote)
+	{
+	quote=newQuote;
+	}
+
+std::vector<std::string> ParallelCSVSource::readHeader(void)
+	{
+	std::vector<std::string> result;
+	if(dataBegin==fileEnd)
+		return result;
+	
+	/* Read all fields of the next record as strings: */
+	const char* cPtr=dataBegin;
+	while(true)
+		{
+		bool quoted,escaped;
+		const char* contentBegin;
+		const char* contentEnd;
+		const char* fieldEnd=findFieldEnd(cPtr,fileEnd,quoted,escaped,contentBegin,contentEnd);
+		if(fieldEnd==0)
+			Misc::throwStdErr("IO::ParallelCSVSource::readHeader: Format error in field %u of record %u",(unsigned int)result.size(),(unsigned int)numHeaderRecords);
+		if(escaped)
+			result.push_back(unescape(contentBegin,contentEnd,quote));
+		else
+			result.push_back(std::string(contentBegin,contentEnd));
+		
+		/* Go to the next field: */
+		cPtr=fieldEnd;
+		if(cPtr==fileEnd||*cPtr==recordSeparator)
+			break;
+		++cPtr;
+		}
+	
+	/* Skip the record separator and start data records after the header: */
+	if(cPtr!=fileEnd)
+		++cPtr;
+	dataBegin=cPtr;
+	++numHeaderRecords;
+	
+	return result;
+	}
+
+unsigned int ParallelCSVSource::addColumn(unsigned int fieldIndex,ParallelCSVSource::ColumnType type)
+	{
+	/* Add the column to the projection: */
+	Column newColumn;
+	newColumn.fieldIndex=fieldIndex;
+	newColumn.type=type;
+	columns.push_back(newColumn);
+	
+	/* Map the field to the new column: */
+	if(fieldColumns.size()<=fieldIndex)
+		fieldColumns.resize(fieldIndex+1,-1);
+	fieldColumns[fieldIndex]=int(columns.size()-1);
+	
+	return columns.size()-1;
+	}
+
+void ParallelCSVSource::read(unsigned int numThreads)
+	{
+	/* Determine the number of chunks: */
+	if(numThreads==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	size_t dataSize=fileEnd-dataBegin;
+	size_t numChunks=numThreads;
+	if(numChunks>dataSize/minChunkSize)
+		numChunks=dataSize/minChunkSize;
+	if(numChunks<1)
+		numChunks=1;
+	
+	/* Split the data into chunks of roughly equal size: */
+	std::vector<Chunk> chunks(numChunks);
+	for(size_t i=0;i<numChunks;++i)
+		{
+		Chunk& c=chunks[i];
+		c.begin=dataBegin+dataSize*i/numChunks;
+		c.end=dataBegin+dataSize*(i+1)/numChunks;
+		c.numQuotes=0;
+		c.firstBreak[0]=c.firstBreak[1]=0;
+		c.recordsBegin=c.recordsEnd=0;
+		c.numRecords=0;
+		c.error=0;
+		c.errorFieldIndex=0;
+		}
+	
+	/* Find candidate record boundaries in all chunks in parallel: */
+	if(numChunks>1)
+		processChunks(chunks,&ParallelCSVSource::scanChunk);
+	
+	/* Start each chunk at the first record separator outside of quotes, by tracking quote parity across chunks: */
+	chunks[0].recordsBegin=dataBegin;
+	size_t parity=0;
+	for(size_t i=1;i<numChunks;++i)
+		{
+		parity=(parity+chunks[i-1].numQuotes)&0x1U;
+		const char* recordBreak=chunks[i].firstBreak[parity];
+		chunks[i].recordsBegin=recordBreak!=0?recordBreak+1:0;
+		}
+	
+	/* End each chunk where the next one begins; chunks without a record boundary are merged into their predecessors: */
+	const char* recordsEnd=fileEnd;
+	for(size_t i=numChunks;i>0;--i)
+		{
+		Chunk& c=chunks[i-1];
+		if(c.recordsBegin==0)
+			c.recordsBegin=recordsEnd;
+		c.recordsEnd=recordsEnd;
+		recordsEnd=c.recordsBegin;
+		}
+	
+	/* Parse all chunks in parallel: */
+	processChunks(chunks,&ParallelCSVSource::parseChunk);
+	
+	/* Report the first error in file order: */
+	numRecords=0;
+	for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		{
+		if(cIt->error!=0)
+			Misc::throwStdErr(cIt->error,cIt->errorFieldIndex,(unsigned int)(numHeaderRecords+numRecords+cIt->numRecords));
+		numRecords+=cIt->numRecords;
+		}
+	
+	/* Concatenate the chunks' column values in file order: */
+	for(size_t columnIndex=0;columnIndex<columns.size();++columnIndex)
+		{
+		ColumnData& data=columns[columnIndex].data;
+		data.integers.clear();
+		data.numbers.clear();
+		data.strings.clear();
+		switch(columns[columnIndex].type)
+			{
+			case INTEGER:
+				data.integers.reserve(numRecords);
+				for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+					data.integers.insert(data.integers.end(),cIt->columns[columnIndex].integers.begin(),cIt->columns[columnIndex].integers.end());
+				break;
+			
+			case NUMBER:
+				data.numbers.reserve(numRecords);
+				for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+					data.numbers.insert(data.numbers.end(),cIt->columns[columnIndex].numbers.begin(),cIt->columns[columnIndex].numbers.end());
+				break;
+			
+			case STRING:
+				data.strings.reserve(numRecords);
+				for(std::vector<Chunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+					data.strings.insert(data.strings.end(),cIt->columns[columnIndex].strings.begin(),cIt->columns[columnIndex].strings.end());
+				break;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,130 @@
+/***********************************************************************
+ParallelCSVSource - Class to read tabular data in generalized comma-
+separated value (CSV) format from memory-mapped files in parallel, by
+splitting files into chunks and converting selected fields into typed
+columns.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_PARALLELCSVSOURCE_INCLUDED
+#define IO_PARALLELCSVSOURCE_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/Autopointer.h>
+#include <IO/MemMappedFile.h>
+
+namespace IO {
+
+class ParallelCSVSource
+	{
+	/* Embedded classes: */
+	public:
+	enum ColumnType // Enumerated type for data types of result columns
+		{
+		INTEGER,NUMBER,STRING
+		};
+	
+	private:
+	struct ColumnData // Structure holding the converted values of a column
+		{
+		/* Elements: */
+		public:
+		std::vector<int> integers; // Values of integer columns
+		std::vector<double> numbers; // Values of floating-point columns
+		std::vector<std::string> strings; // Values of string columns
+		};
+	
+	struct Column // Structure describing a column in the projection
+		{
+		/* Elements: */
+		public:
+		unsigned int fieldIndex; // Index of the field in each record from which the column is read
+		ColumnType type; // Data type of the column
+		ColumnData data; // The column's values in file order
+		};
+	
+	struct Chunk // Structure describing a chunk of the file processed by a single thread
+		{
+		/* Elements: */
+		public:
+		const char* begin; // Beginning of the chunk's raw character range
+		const char* end; // End of the chunk's raw character range
+		size_t numQuotes; // Number of quote characters in the chunk's raw range
+		const char* firstBreak[2]; // First record separators in the chunk's raw range preceded by an even or odd number of quotes inside the chunk, or null
+		const char* recordsBegin; // Beginning of the range of complete records assigned to the chunk
+		const char* recordsEnd; // End of the range of complete records assigned to the chunk
+		size_t numRecords; // Number of records parsed from the chunk
+		std::vector<ColumnData> columns; // Converted values of all projected columns
+		const char* error; // Error message if parsing the chunk failed, or null
+		unsigned int errorFieldIndex; // Index of field in which parsing failed
+		};
+	
+	/* Elements: */
+	Misc::Autopointer<MemMappedFile> file; // The memory-mapped source file
+	const char* fileBegin; // Beginning of the file's memory map
+	const char* fileEnd; // End of the file's memory map
+	char fieldSeparator; // Character used to separate fields in a record; comma by default
+	char recordSeparator; // Character used to separate records; newline by default
+	char quote; // Character used to quote field contents; double quote by default
+	const char* dataBegin; // Beginning of the first data record after any header records
+	size_t numHeaderRecords; // Number of header records read before the first data record
+	std::vector<Column> columns; // List of columns in the projection
+	std::vector<int> fieldColumns; // Map from field indices to indices of projected columns, or -1 for skipped fields
+	size_t numRecords; // Number of data records read by the last call to read
+	
+	/* Private methods: */
+	const char* findFieldEnd(const char* fieldBegin,const char* end,bool& quoted,bool& escaped,const char*& contentBegin,const char*& contentEnd) const; // Finds the extent of the field starting at the given position; returns pointer to the separator following the field, or null on format error
+	void* scanChunk(Chunk* chunk); // Counts quotes and finds candidate record boundaries in the given chunk
+	void* parseChunk(Chunk* chunk); // Parses all complete records assigned to the given chunk
+	void processChunks(std::vector<Chunk>& chunks,void* (ParallelCSVSource::*chunkMethod)(Chunk*)); // Calls the given method on all chunks in parallel
+	
+	/* Constructors and destructors: */
+	public:
+	ParallelCSVSource(const char* fileName); // Creates a parallel CSV source for the file of the given name
+	~ParallelCSVSource(void);
+	
+	/* Methods: */
+	void setFieldSeparator(char newFieldSeparator); // Sets the field separator
+	void setRecordSeparator(char newRecordSeparator); // Sets the record separator
+	void setQuote(char newQuote); // Sets the quote character
+	std::vector<std::string> readHeader(void); // Reads the next record as a header of column names, and excludes it from data records
+	unsigned int addColumn(unsigned int fieldIndex,ColumnType type); // Adds the field of the given index to the projection; returns the index of the new column
+	void read(unsigned int numThreads =0); // Converts all data records using the given number of threads, or one per CPU if zero; throws exception on format or conversion errors
+	size_t getNumRecords(void) const // Returns the number of data records read by the last call to read
+		{
+		return numRecords;
+		}
+	const std::vector<int>& getIntegerColumn(unsigned int columnIndex) const // Returns the values of the given integer column
+		{
+		return columns[columnIndex].data.integers;
+		}
+	const std::vector<double>& getNumberColumn(unsigned int columnIndex) const // Returns the values of the given floating-point column
+		{
+		return columns[columnIndex].data.numbers;
+		}
+	const std::vector<std::string>& getStringColumn(unsigned int columnIndex) const // Returns the values of the given string column
+		{
+		return columns[columnIndex].data.strings;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,554 @@
+/***********************************************************************
+ParallelGzipFilter - Class for read/write access to gzip-compressed
+files using a IO::File abstraction, compressing and decompressing
+independent blocks in parallel background threads.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/ParallelGzipFilter.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <Misc/ThrowStdErr.h>
+#include <IO/StandardFile.h>
+
+namespace IO {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+/*****************************************************************
+Gzip members written by ParallelGzipFilter carry an extra header
+field with subfield ID "VR" that stores the member's total compressed
+size and its uncompressed size as 32-bit little-endian numbers. This
+allows the reader to hand complete members to worker threads without
+decompressing them first. The members are standard gzip members, and
+files are readable by any gzip decompressor.
+*****************************************************************/
+
+const size_t gzipHeaderSize=24; // Size of the gzip member header including the "VR" extra field
+const size_t gzipTrailerSize=8; // Size of the gzip member trailer
+
+inline void putLE16(unsigned char* dest,unsigned int value)
+	{
+	dest[0]=(unsigned char)(value&0xffU);
+	dest[1]=(unsigned char)((value>>8)&0xffU);
+	}
+
+inline void putLE32(unsigned char* dest,unsigned long value)
+	{
+	for(int i=0;i<4;++i,value>>=8)
+		dest[i]=(unsigned char)(value&0xffU);
+	}
+
+inline unsigned int getLE16(const unsigned char* src)
+	{
+	return (unsigned int)(src[0])|((unsigned int)(src[1])<<8);
+	}
+
+inline unsigned long getLE32(const unsigned char* src)
+	{
+	return (unsigned long)(src[0])|((unsigned long)(src[1])<<8)|((unsigned long)(src[2])<<16)|((unsigned long)(src[3])<<24);
+	}
+
+template <class ByteParam>
+inline void ensureCapacity(ByteParam*& buffer,size_t& capacity,size_t requiredCapacity) // Grows a buffer without retaining its contents
+	{
+	if(requiredCapacity==0)
+		requiredCapacity=1;
+	if(capacity<requiredCapacity)
+		{
+		delete[] buffer;
+		buffer=new ByteParam[requiredCapacity];
+		capacity=requiredCapacity;
+		}
+	}
+
+size_t readFully(File& file,void* buffer,size_t bufferSize) // Reads up to the given amount of data; returns less only at end-of-file
+	{
+	char* bufPtr=static_cast<char*>(buffer);
+	size_t result=0;
+	while(result<bufferSize)
+		{
+		size_t readSize=file.readUpTo(bufPtr+result,bufferSize-result);
+		if(readSize==0)
+			break;
+		result+=readSize;
+		}
+	return result;
+	}
+
+}
+
+/***********************************
+Methods of class ParallelGzipFilter:
+***********************************/
+
+size_t ParallelGzipFilter::readData(File::Byte* buffer,size_t bufferSize)
+	{
+	while(!sequential)
+		{
+		/* Keep the worker threads busy by reading ahead complete gzip members: */
+		while(!sourceEof&&memberHeaderSize==0&&nextSubmitBlock-nextRetireBlock<numBlocks)
+			if(readMember(blocks[nextSubmitBlock%numBlocks]))
+				submitBlock();
+		
+		/* Check if all blocks have been read: */
+		if(nextRetireBlock==nextSubmitBlock)
+			{
+			/* Check for end-of-file: */
+			if(memberHeaderSize==0)
+				return 0;
+			
+			/* Decompress the rest of the file, starting with the already read member header, in the calling thread: */
+			stream.next_in=memberHeader;
+			stream.avail_in=memberHeaderSize;
+			stream.zalloc=Z_NULL;
+			stream.zfree=Z_NULL;
+			stream.opaque=0;
+			if(inflateInit2(&stream,15+16)!=Z_OK)
+				{
+				if(stream.msg!=0)
+					Misc::throwStdErr("IO::ParallelGzipFilter: Error \"%s\" during initialization",stream.msg);
+				else
+					Misc::throwStdErr("IO::ParallelGzipFilter: Internal zlib error during initialization");
+				}
+			sequential=true;
+			break;
+			}
+		
+		/* Wait for the oldest block to be decompressed: */
+		Block& block=blocks[nextRetireBlock%numBlocks];
+		{
+		Threads::Mutex::Lock blockLock(blockMutex);
+		while(!block.done)
+			blockCond.wait(blockMutex);
+		}
+		if(block.error)
+			Misc::throwStdErr("IO::ParallelGzipFilter: Data corruption detected while decompressing");
+		
+		/* Return data from the block if there is any left: */
+		if(outputPos<block.outputSize)
+			{
+			size_t copySize=block.outputSize-outputPos;
+			if(copySize>bufferSize)
+				copySize=bufferSize;
+			memcpy(buffer,block.output+outputPos,copySize);
+			outputPos+=copySize;
+			return copySize;
+			}
+		
+		/* Retire the block: */
+		{
+		Threads::Mutex::Lock blockLock(blockMutex);
+		block.done=false;
+		}
+		++nextRetireBlock;
+		outputPos=0;
+		}
+	
+	return readSequential(buffer,bufferSize);
+	}
+
+void ParallelGzipFilter::writeData(const File::Byte* buffer,size_t bufferSize)
+	{
+	/* Split the data into blocks: */
+	while(bufferSize>0)
+		{
+		/* Make room for the next block: */
+		if(nextSubmitBlock-nextRetireBlock>=numBlocks)
+			retireCompressedBlock();
+		
+		/* Copy the next chunk of data into the next block and submit it: */
+		Block& block=blocks[nextSubmitBlock%numBlocks];
+		size_t blockDataSize=bufferSize;
+		if(blockDataSize>blockSize)
+			blockDataSize=blockSize;
+		ensureCapacity(block.input,block.inputCapacity,blockDataSize);
+		memcpy(block.input,buffer,blockDataSize);
+		block.inputSize=blockDataSize;
+		submitBlock();
+		
+		buffer+=blockDataSize;
+		bufferSize-=blockDataSize;
+		}
+	}
+
+void ParallelGzipFilter::init(unsigned int sNumThreads)
+	{
+	/* Adopt the compressed file's write mode: */
+	bool canRead=gzippedFile->getReadBufferSize()!=0;
+	bool canWrite=gzippedFile->getWriteBufferSize()!=0;
+	if(canRead&&canWrite)
+		Misc::throwStdErr("IO::ParallelGzipFilter: Cannot read and write from/to gzipped file simultaneously");
+	compressing=canWrite;
+	
+	/* Use one worker thread per CPU by default: */
+	numThreads=sNumThreads;
+	if(numThreads==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	
+	/* Create the block queue: */
+	numBlocks=numThreads*2;
+	blocks=new Block[numBlocks];
+	for(unsigned int i=0;i<numBlocks;++i)
+		{
+		blocks[i].input=0;
+		blocks[i].inputSize=0;
+		blocks[i].inputCapacity=0;
+		blocks[i].output=0;
+		blocks[i].outputSize=0;
+		blocks[i].outputCapacity=0;
+		blocks[i].done=false;
+		blocks[i].error=false;
+		}
+	
+	if(canRead)
+		{
+		/* Install an output buffer for uncompressed data: */
+		resizeReadBuffer(gzippedFile->getReadBufferSize()*2);
+		}
+	else if(canWrite)
+		{
+		/* Install an input buffer for uncompressed data that holds one block: */
+		resizeWriteBuffer(blockSize);
+		}
+	
+	/* Start the worker threads: */
+	workerThreads=new Threads::Thread[numThreads];
+	for(unsigned int i=0;i<numThreads;++i)
+		workerThreads[i].start(this,&ParallelGzipFilter::workerThreadMethod);
+	}
+
+void* ParallelGzipFilter::workerThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Claim the next submitted block: */
+		Block* block;
+		{
+		Threads::Mutex::Lock blockLock(blockMutex);
+		while(!shutdown&&nextWorkBlock==nextSubmitBlock)
+			blockCond.wait(blockMutex);
+		if(shutdown)
+			break;
+		block=&blocks[nextWorkBlock%numBlocks];
+		++nextWorkBlock;
+		}
+		
+		/* Process the block: */
+		block->error=false;
+		try
+			{
+			if(compressing)
+				compressBlock(*block);
+			else
+				decompressBlock(*block);
+			}
+		catch(...)
+			{
+			/* Let the calling thread report the error: */
+			block->error=true;
+			}
+		
+		{
+		Threads::Mutex::Lock blockLock(blockMutex);
+		
+		/* Hand the processed block back to the calling thread: */
+		block->done=true;
+		blockCond.broadcast();
+		}
+		}
+	
+	return 0;
+	}
+
+void ParallelGzipFilter::compressBlock(ParallelGzipFilter::Block& block)
+	{
+	/* Allocate an output buffer large enough for the entire gzip member: */
+	ensureCapacity(block.output,block.outputCapacity,gzipHeaderSize+compressBound(block.inputSize)+gzipTrailerSize);
+	
+	/* Compress the block into a raw deflate stream independent of all other blocks: */
+	z_stream deflater;
+	deflater.zalloc=Z_NULL;
+	deflater.zfree=Z_NULL;
+	deflater.opaque=0;
+	if(deflateInit2(&deflater,compressionLevel,Z_DEFLATED,-15,8,Z_DEFAULT_STRATEGY)!=Z_OK)
+		{
+		block.error=true;
+		return;
+		}
+	deflater.next_in=block.input;
+	deflater.avail_in=block.inputSize;
+	deflater.next_out=block.output+gzipHeaderSize;
+	deflater.avail_out=block.outputCapacity-gzipHeaderSize-gzipTrailerSize;
+	int result=deflate(&deflater,Z_FINISH);
+	size_t compressedSize=deflater.total_out;
+	deflateEnd(&deflater);
+	if(result!=Z_STREAM_END)
+		{
+		block.error=true;
+		return;
+		}
+	block.outputSize=gzipHeaderSize+compressedSize+gzipTrailerSize;
+	
+	/* Write the gzip member header with the "VR" extra field: */
+	Byte* header=block.output;
+	header[0]=0x1fU; // Gzip magic number
+	header[1]=0x8bU;
+	header[2]=8U; // Deflate compression method
+	header[3]=0x04U; // FEXTRA flag
+	putLE32(header+4,0); // No modification time
+	header[8]=0U; // No extra flags
+	header[9]=255U; // Unknown operating system
+	putLE16(header+10,12); // Size of the extra field
+	header[12]='V'; // Subfield ID
+	header[13]='R';
+	putLE16(header+14,8); // Size of the subfield
+	putLE32(header+16,block.outputSize);
+	putLE32(header+20,block.inputSize);
+	
+	/* Write the gzip member trailer: */
+	Byte* trailer=block.output+gzipHeaderSize+compressedSize;
+	putLE32(trailer,crc32(crc32(0L,Z_NULL,0),block.input,block.inputSize));
+	putLE32(trailer+4,block.inputSize);
+	}
+
+void ParallelGzipFilter::decompressBlock(ParallelGzipFilter::Block& block)
+	{
+	/* Decompress the entire gzip member, including header and trailer checks: */
+	z_stream inflater;
+	inflater.zalloc=Z_NULL;
+	inflater.zfree=Z_NULL;
+	inflater.opaque=0;
+	inflater.next_in=block.input;
+	inflater.avail_in=block.inputSize;
+	if(inflateInit2(&inflater,15+16)!=Z_OK)
+		{
+		block.error=true;
+		return;
+		}
+	inflater.next_out=block.output;
+	inflater.avail_out=block.outputSize;
+	int result=inflate(&inflater,Z_FINISH);
+	if(result!=Z_STREAM_END||inflater.avail_out!=0||inflater.avail_in!=0)
+		block.error=true;
+	inflateEnd(&inflater);
+	}
+
+void ParallelGzipFilter::submitBlock(void)
+	{
+	Threads::Mutex::Lock blockLock(blockMutex);
+	
+	/* Hand the next block to the worker threads: */
+	++nextSubmitBlock;
+	blockCond.broadcast();
+	}
+
+void ParallelGzipFilter::retireCompressedBlock(void)
+	{
+	/* Wait for the oldest block to be compressed: */
+	Block& block=blocks[nextRetireBlock%numBlocks];
+	{
+	Threads::Mutex::Lock blockLock(blockMutex);
+	while(!block.done)
+		blockCond.wait(blockMutex);
+	block.done=false;
+	}
+	++nextRetireBlock;
+	
+	/* Write the block's gzip member to the compressed file: */
+	if(block.error)
+		Misc::throwStdErr("IO::ParallelGzipFilter: Internal zlib error while compressing");
+	gzippedFile->writeRaw(block.output,block.outputSize);
+	}
+
+bool ParallelGzipFilter::readMember(ParallelGzipFilter::Block& block)
+	{
+	/* Read the fixed part of the next member's header: */
+	memberHeaderSize=readFully(*gzippedFile,memberHeader,10);
+	if(memberHeaderSize==0)
+		{
+		sourceEof=true;
+		return false;
+		}
+	
+	/* Check if the member was written by this class: */
+	if(memberHeaderSize<10||memberHeader[0]!=0x1fU||memberHeader[1]!=0x8bU||memberHeader[2]!=8U||memberHeader[3]!=0x04U)
+		return false;
+	memberHeaderSize+=readFully(*gzippedFile,memberHeader+10,14);
+	if(memberHeaderSize<gzipHeaderSize||getLE16(memberHeader+10)!=12||memberHeader[12]!='V'||memberHeader[13]!='R'||getLE16(memberHeader+14)!=8)
+		return false;
+	size_t memberSize=getLE32(memberHeader+16);
+	size_t uncompressedSize=getLE32(memberHeader+20);
+	if(memberSize<gzipHeaderSize+gzipTrailerSize||uncompressedSize>memberSize*1032) // Deflate can not compress by more than a factor of 1032
+		return false;
+	
+	/* Read the entire member into the block's input buffer: */
+	ensureCapacity(block.input,block.inputCapacity,memberSize);
+	memcpy(block.input,memberHeader,memberHeaderSize);
+	if(readFully(*gzippedFile,block.input+memberHeaderSize,memberSize-memberHeaderSize)!=memberSize-memberHeaderSize)
+		Misc::throwStdErr("IO::ParallelGzipFilter: Premature end of gzip-compressed file");
+	block.inputSize=memberSize;
+	
+	/* Prepare the block's output buffer: */
+	ensureCapacity(block.output,block.outputCapacity,uncompressedSize);
+	block.outputSize=uncompressedSize;
+	
+	memberHeaderSize=0;
+	return true;
+	}
+
+size_t ParallelGzipFilter::readSequential(File::Byte* buffer,size_t bufferSize)
+	{
+	/* Check for end-of-file: */
+	if(readEof)
+		return 0;
+	
+	/* Decompress data into the given buffer: */
+	stream.next_out=buffer;
+	stream.avail_out=bufferSize;
+	
+	/* Try until at least some output is produced: */
+	do
+		{
+		/* Check if the decompressor needs more input: */
+		if(stream.avail_in==0)
+			{
+			/* Read the next glob of compressed data: */
+			void* compressedBuffer;
+			size_t compressedSize=gzippedFile->readInBuffer(compressedBuffer);
+			if(compressedSize==0)
+				Misc::throwStdErr("IO::ParallelGzipFilter: Premature end of gzip-compressed file");
+			
+			/* Pass the compressed data to the decompressor: */
+			stream.next_in=static_cast<Bytef*>(compressedBuffer);
+			stream.avail_in=compressedSize;
+			}
+		
+		/* Decompress from the gzipped file's buffer: */
+		int result=inflate(&stream,Z_NO_FLUSH);
+		if(result==Z_STREAM_END)
+			{
+			/* Check if another gzip member follows: */
+			if(stream.avail_in==0)
+				{
+				void* compressedBuffer;
+				size_t compressedSize=gzippedFile->readInBuffer(compressedBuffer);
+				if(compressedSize==0)
+					{
+					/* Set the eof flag and clean out the decompressor: */
+					readEof=true;
+					inflateEnd(&stream);
+					break;
+					}
+				stream.next_in=static_cast<Bytef*>(compressedBuffer);
+				stream.avail_in=compressedSize;
+				}
+			
+			/* Start decompressing the next member: */
+			if(inflateReset(&stream)!=Z_OK)
+				Misc::throwStdErr("IO::ParallelGzipFilter: Internal zlib error while decompressing");
+			}
+		else if(result!=Z_OK)
+			{
+			if(stream.msg!=0)
+				Misc::throwStdErr("IO::ParallelGzipFilter: Error \"%s\" while decompressing",stream.msg);
+			else
+				Misc::throwStdErr("IO::ParallelGzipFilter: Internal zlib error while decompressing");
+			}
+		}
+	while(stream.avail_out==bufferSize);
+	
+	return bufferSize-stream.avail_out;
+	}
+
+ParallelGzipFilter::ParallelGzipFilter(FilePtr sGzippedFile,unsigned int sNumThreads,size_t sBlockSize,int sCompressionLevel)
+	:File(),
+	 gzippedFile(sGzippedFile),
+	 compressing(false),compressionLevel(sCompressionLevel),blockSize(sBlockSize),
+	 numThreads(0),workerThreads(0),
+	 numBlocks(0),blocks(0),
+	 nextSubmitBlock(0),nextWorkBlock(0),nextRetireBlock(0),shutdown(false),
+	 outputPos(0),sourceEof(false),sequential(false),memberHeaderSize(0),readEof(false)
+	{
+	init(sNumThreads);
+	}
+
+ParallelGzipFilter::ParallelGzipFilter(const char* gzippedFileName,File::AccessMode sAccessMode,unsigned int sNumThreads,size_t sBlockSize,int sCompressionLevel)
+	:File(),
+	 gzippedFile(new IO::StandardFile(gzippedFileName,sAccessMode)),
+	 compressing(false),compressionLevel(sCompressionLevel),blockSize(sBlockSize),
+	 numThreads(0),workerThreads(0),
+	 numBlocks(0),blocks(0),
+	 nextSubmitBlock(0),nextWorkBlock(0),nextRetireBlock(0),shutdown(false),
+	 outputPos(0),sourceEof(false),sequential(false),memberHeaderSize(0),readEof(false)
+	{
+	init(sNumThreads);
+	}
+
+ParallelGzipFilter::~ParallelGzipFilter(void)
+	{
+	if(compressing)
+		{
+		/* Flush the write buffer: */
+		flush();
+		
+		/* Write an empty gzip member if no data was written to create a valid gzip file: */
+		if(nextSubmitBlock==0)
+			{
+			blocks[0].inputSize=0;
+			submitBlock();
+			}
+		
+		/* Write all outstanding blocks: */
+		while(nextRetireBlock!=nextSubmitBlock)
+			retireCompressedBlock();
+		}
+	
+	/* Shut down the worker threads: */
+	{
+	Threads::Mutex::Lock blockLock(blockMutex);
+	shutdown=true;
+	blockCond.broadcast();
+	}
+	for(unsigned int i=0;i<numThreads;++i)
+		workerThreads[i].join();
+	delete[] workerThreads;
+	
+	/* Clean out the sequential decompressor: */
+	if(sequential&&!readEof)
+		inflateEnd(&stream);
+	
+	/* Delete the block queue: */
+	for(unsigned int i=0;i<numBlocks;++i)
+		{
+		delete[] blocks[i].input;
+		delete[] blocks[i].output;
+		}
+	delete[] blocks;
+	}
+
+}
@@ -0,0 +1,101 @@
+/***********************************************************************
+ParallelGzipFilter - Class for read/write access to gzip-compressed
+files using a IO::File abstraction, compressing and decompressing
+independent blocks in parallel background threads.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_PARALLELGZIPFILTER_INCLUDED
+#define IO_PARALLELGZIPFILTER_INCLUDED
+
+#include <zlib.h>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#include <Threads/Thread.h>
+#include <IO/File.h>
+
+namespace IO {
+
+class ParallelGzipFilter:public IO::File
+	{
+	/* Embedded classes: */
+	private:
+	struct Block // Structure for a block of data handed to a worker thread; each block is compressed into a separate gzip member
+		{
+		/* Elements: */
+		public:
+		Byte* input; // Buffer of data to be compressed or decompressed
+		size_t inputSize; // Amount of data in the input buffer
+		size_t inputCapacity; // Allocated size of the input buffer
+		Byte* output; // Buffer of compressed or decompressed data
+		size_t outputSize; // Amount of data in the output buffer
+		size_t outputCapacity; // Allocated size of the output buffer
+		bool done; // Flag whether a worker thread finished processing the block
+		bool error; // Flag whether processing the block failed
+		};
+	
+	/* Elements: */
+	FilePtr gzippedFile; // Underlying gzip-compressed file
+	bool compressing; // Flag whether the filter compresses written data; otherwise it decompresses read data
+	int compressionLevel; // Zlib compression level
+	size_t blockSize; // Amount of uncompressed data per compressed gzip member
+	unsigned int numThreads; // Number of worker threads
+	Threads::Thread* workerThreads; // The worker threads
+	Threads::Mutex blockMutex; // Mutex serializing access to the block queue
+	Threads::Cond blockCond; // Condition variable to signal a change in block queue state
+	unsigned int numBlocks; // Number of blocks in the block queue
+	Block* blocks; // Ring buffer of blocks
+	unsigned int nextSubmitBlock; // Index of the next block to be handed to the worker threads
+	unsigned int nextWorkBlock; // Index of the next block to be claimed by a worker thread
+	unsigned int nextRetireBlock; // Index of the next block to be written to the compressed file or read from in order
+	bool shutdown; // Flag to shut down the worker threads
+	size_t outputPos; // Read position in the output buffer of the block currently being read
+	bool sourceEof; // Flag whether the compressed file has been read completely
+	bool sequential; // Flag if the compressed file contains foreign gzip members that are decompressed sequentially in the calling thread
+	Byte memberHeader[24]; // Buffer for the header of the next gzip member
+	size_t memberHeaderSize; // Amount of data in the member header buffer
+	z_stream stream; // Zlib decompression structure for sequential decompression
+	bool readEof; // Flag if the sequential decompressor has signaled end-of-file
+	
+	/* Methods from File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize);
+	virtual void writeData(const Byte* buffer,size_t bufferSize);
+	
+	/* Private methods: */
+	private:
+	void init(unsigned int sNumThreads); // Initializes the filter and starts the worker threads
+	void* workerThreadMethod(void); // Method run by the worker threads
+	void compressBlock(Block& block); // Compresses the given block into a gzip member
+	void decompressBlock(Block& block); // Decompresses the gzip member contained in the given block
+	void submitBlock(void); // Hands the next block to the worker threads
+	void retireCompressedBlock(void); // Waits for the oldest compressed block and writes it to the compressed file
+	bool readMember(Block& block); // Reads the next gzip member into the given block; returns false if the member was not written by this class
+	size_t readSequential(Byte* buffer,size_t bufferSize); // Decompresses foreign gzip members in the calling thread
+	
+	/* Constructors and destructors: */
+	public:
+	ParallelGzipFilter(FilePtr sGzippedFile,unsigned int sNumThreads =0,size_t sBlockSize =1024*1024,int sCompressionLevel =Z_DEFAULT_COMPRESSION); // Creates a parallel gzip filter for the given underlying gzip-compressed file; inherits access mode from compressed file; uses one thread per CPU if the number of threads is zero
+	ParallelGzipFilter(const char* gzippedFileName,File::AccessMode sAccessMode,unsigned int sNumThreads =0,size_t sBlockSize =1024*1024,int sCompressionLevel =Z_DEFAULT_COMPRESSION); // Opens the gzip-compressed file of the given name with the given access mode
+	virtual ~ParallelGzipFilter(void); // Destroys the parallel gzip filter
+	};
+
+}
+
+#endif
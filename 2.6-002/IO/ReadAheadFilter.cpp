@@ -1,7 +1,7 @@
 /***********************************************************************
 ReadAheadFilter - Class to add background read-ahead to other IO::File
 abstractions to improve read throughput.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -22,8 +22,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <IO/ReadAheadFilter.h>
 
+#include <unistd.h>
+#include <errno.h>
 #include <stdexcept>
 #include <Misc/Utility.h>
+#include <Misc/ThrowStdErr.h>
 
 namespace IO {
 
@@ -33,30 +36,48 @@ Methods of class ReadAheadFilter:
 
 size_t ReadAheadFilter::readData(File::Byte* buffer,size_t bufferSize)
 	{
+	/* Signal end-of-file after the last, partially filled buffer has been consumed: */
+	if(readEof)
+		return 0;
+	
+	unsigned int slot;
 	{
 	Threads::Mutex::Lock bufferLock(bufferMutex);
 	
 	if(haveReadOnce)
 		{
-		/* Release the just-finished buffer half: */
-		--numFullBuffers;
-		bufferCond.signal();
+		/* Release the just-finished buffer to the read-ahead threads: */
+		bufferFull[(nextReadBlock-1)%numBuffers]=false;
+		bufferCond.broadcast();
 		}
 	
-	/* Check if the double buffer is empty: */
-	while(numFullBuffers==0)
+	/* Wait until the next buffer in sequence has been filled: */
+	slot=nextReadBlock%numBuffers;
+	if(!bufferFull[slot])
 		{
-		/* Wait for more data: */
-		bufferCond.wait(bufferMutex);
+		++stats.numStalls;
+		Misc::Timer stallTimer;
+		while(!bufferFull[slot])
+			bufferCond.wait(bufferMutex);
+		stallTimer.elapse();
+		stats.stallTime+=stallTimer.getTime();
 		}
-	}
 	
-	/* Read from the next double buffer half: */
-	outBuffer=1-outBuffer;
-	setReadBuffer(bufferSizes[outBuffer],buffers[outBuffer],false);
+	/* Report an error that occurred while filling the buffer; read-ahead threads stop at the failed block, so the error repeats on further reads: */
+	if(!bufferErrors[slot].empty())
+		throw Error(bufferErrors[slot].c_str());
+	
+	++nextReadBlock;
 	haveReadOnce=true;
+	++stats.numBuffersRead;
+	stats.numBytesRead+=bufferSizes[slot];
+	}
 	
-	return bufferSizes[outBuffer];
+	/* Hand the filled buffer to the reader without copying: */
+	setReadBuffer(bufferSizes[slot],bufferMemory+slot*this->bufferSize,false);
+	readEof=bufferSizes[slot]<this->bufferSize;
+	
+	return bufferSizes[slot];
 	}
 
 void* ReadAheadFilter::readAheadThreadMethod(void)
@@ -65,69 +86,146 @@ void* ReadAheadFilter::readAheadThreadMethod(void)
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
 	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
 	
-	do
+	while(true)
+		{
+		/* Claim the next source block as soon as its ring buffer slot is free: */
+		unsigned int block;
 		{
-		/* Fill the next double-buffer half: */
-		inBuffer=1-inBuffer;
-		Byte* bufPtr=buffers[inBuffer];
-		size_t bufSize=halfBufferSize;
+		Threads::Mutex::Lock bufferLock(bufferMutex);
+		while(nextFillBlock<endBlock&&(nextFillBlock-nextReadBlock>=numBuffers-(haveReadOnce?1U:0U)||bufferFull[nextFillBlock%numBuffers]))
+			bufferCond.wait(bufferMutex);
+		if(nextFillBlock>=endBlock)
+			break;
+		block=nextFillBlock;
+		++nextFillBlock;
+		}
+		
+		/* Fill the block's slot: */
+		unsigned int slot=block%numBuffers;
+		Byte* bufPtr=bufferMemory+slot*bufferSize;
+		size_t bufSize=bufferSize;
+		std::string error;
 		try
 			{
-			while(bufSize>0)
+			if(sourceFd>=0)
+				{
+				/* Read the block with positional reads, concurrently with other threads: */
+				SeekableFile::Offset offset=sourceOffset+SeekableFile::Offset(block)*SeekableFile::Offset(bufferSize);
+				while(bufSize>0)
+					{
+					ssize_t readSize=pread(sourceFd,bufPtr,bufSize,offset);
+					if(readSize<0&&errno==EINTR)
+						continue;
+					if(readSize<0)
+						throw Error(Misc::printStdErrMsg("IO::ReadAheadFilter: Fatal error %d while reading from source",int(errno)));
+					
+					/* Check for end-of-file: */
+					if(readSize==0)
+						break;
+					
+					bufPtr+=readSize;
+					bufSize-=readSize;
+					offset+=readSize;
+					}
+				}
+			else
 				{
-				/* Read into the buffer: */
-				size_t readSize=source->readUpTo(bufPtr,bufSize);
-				
-				/* Check for end-of-file: */
-				if(readSize==0)
-					break;
-				
-				bufPtr+=readSize;
-				bufSize-=readSize;
+				/* Read the block sequentially from the source: */
+				while(bufSize>0)
+					{
+					size_t readSize=source->readUpTo(bufPtr,bufSize);
+					
+					/* Check for end-of-file: */
+					if(readSize==0)
+						break;
+					
+					bufPtr+=readSize;
+					bufSize-=readSize;
+					}
 				}
-			bufferSizes[inBuffer]=halfBufferSize-bufSize;
 			}
-		catch(std::runtime_error)
+		catch(std::runtime_error err)
 			{
-			/* Ignore the error; reader thread will treat it as end-of-file: */
-			bufferSizes[inBuffer]=0;
+			/* Remember the error to report it to the reader when it reaches this block: */
+			error=err.what();
 			}
 		
 		{
 		Threads::Mutex::Lock bufferLock(bufferMutex);
 		
 		/* Hand the filled buffer to the reader: */
-		++numFullBuffers;
-		bufferCond.signal();
+		bufferSizes[slot]=bufferSize-bufSize;
+		bufferErrors[slot]=error;
+		bufferFull[slot]=true;
 		
-		/* Check if the double buffer is full: */
-		while(numFullBuffers==2)
-			{
-			/* Wait for room in the buffer: */
-			bufferCond.wait(bufferMutex);
-			}
+		/* Stop claiming blocks beyond the end of the source or a failed block: */
+		if((bufferSizes[slot]<bufferSize||!error.empty())&&endBlock>block+1)
+			endBlock=block+1;
+		
+		bufferCond.broadcast();
 		}
 		}
-	while(bufferSizes[inBuffer]!=0);
 	
 	return 0;
 	}
 
-ReadAheadFilter::ReadAheadFilter(FilePtr sSource)
+ReadAheadFilter::ReadAheadFilter(FilePtr sSource,unsigned int sNumBuffers,size_t sBufferSize,unsigned int sNumThreads)
 	:File(),
 	 source(sSource),
-	 halfBufferSize(Misc::max(source->getReadBufferSize(),size_t(8192))),
-	 inBuffer(1),outBuffer(1),numFullBuffers(0),
-	 haveReadOnce(false)
+	 sourceFd(-1),sourceOffset(0),
+	 numThreads(1),readAheadThreads(0),
+	 bufferSize(sBufferSize!=0?sBufferSize:Misc::max(source->getReadBufferSize(),size_t(8192))),
+	 numBuffers(Misc::max(sNumBuffers,2U)),
+	 bufferMemory(0),bufferSizes(0),bufferFull(0),bufferErrors(0),
+	 nextFillBlock(0),endBlock(~0U),nextReadBlock(0),
+	 haveReadOnce(false),readEof(false)
 	{
-	/* Initialize the double buffer halves: */
-	buffers[0]=new Byte[halfBufferSize*2];
-	buffers[1]=buffers[0]+halfBufferSize;
-	for(int i=0;i<2;++i)
+	/* Initialize the performance counters: */
+	stats.numBytesRead=0;
+	stats.numBuffersRead=0;
+	stats.numStalls=0;
+	stats.stallTime=0.0;
+	stats.elapsedTime=0.0;
+	
+	/* Use concurrent positional reads if requested and the source is a seekable file with a file descriptor: */
+	if(sNumThreads>1)
+		{
+		SeekableFile* seekableSource=dynamic_cast<SeekableFile*>(source.getPointer());
+		if(seekableSource!=0)
+			{
+			int fd=-1;
+			try
+				{
+				fd=seekableSource->getFd();
+				}
+			catch(std::runtime_error err)
+				{
+				/* Read the source sequentially instead */
+				}
+			if(fd>=0)
+				{
+				sourceFd=fd;
+				sourceOffset=seekableSource->getReadPos();
+				numThreads=Misc::min(sNumThreads,numBuffers);
+				}
+			}
+		}
+	
+	/* Initialize the ring buffer: */
+	bufferMemory=new Byte[bufferSize*numBuffers];
+	bufferSizes=new size_t[numBuffers];
+	bufferFull=new bool[numBuffers];
+	bufferErrors=new std::string[numBuffers];
+	for(unsigned int i=0;i<numBuffers;++i)
+		{
 		bufferSizes[i]=0;
+		bufferFull[i]=false;
+		}
 	
-	/* Start the read-ahead thread: */
-	readAheadThread.start(this,&ReadAheadFilter::readAheadThreadMethod);
+	/* Start the read-ahead threads: */
+	readAheadThreads=new Threads::Thread[numThreads];
+	for(unsigned int i=0;i<numThreads;++i)
+		readAheadThreads[i].start(this,&ReadAheadFilter::readAheadThreadMethod);
 	
 	/* Disable read-through: */
 	canReadThrough=false;
@@ -135,27 +233,42 @@ ReadAheadFilter::ReadAheadFilter(FilePtr sSource)
 
 ReadAheadFilter::~ReadAheadFilter(void)
 	{
-	/* Shut down the read-ahead thread: */
-	readAheadThread.cancel();
-	readAheadThread.join();
+	/* Shut down the read-ahead threads: */
+	for(unsigned int i=0;i<numThreads;++i)
+		{
+		readAheadThreads[i].cancel();
+		readAheadThreads[i].join();
+		}
+	delete[] readAheadThreads;
 	
 	/* Release the file's read buffer: */
 	setReadBuffer(0,0,false);
 	
-	/* Delete the double buffer: */
-	delete[] buffers[0];
+	/* Delete the ring buffer: */
+	delete[] bufferMemory;
+	delete[] bufferSizes;
+	delete[] bufferFull;
+	delete[] bufferErrors;
 	}
 
 size_t ReadAheadFilter::getReadBufferSize(void) const
 	{
-	/* Return the size of a half buffer: */
-	return halfBufferSize;
+	/* Return the size of a ring buffer slot: */
+	return bufferSize;
 	}
 
 size_t ReadAheadFilter::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the request and return the current read buffer size: */
-	return halfBufferSize;
+	return bufferSize;
+	}
+
+ReadAheadFilter::Statistics ReadAheadFilter::getStatistics(void)
+	{
+	Threads::Mutex::Lock bufferLock(bufferMutex);
+	Statistics result=stats;
+	result.elapsedTime=lifetimeTimer.peekTime();
+	return result;
 	}
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 ReadAheadFilter - Class to add background read-ahead to other IO::File
 abstractions to improve read throughput.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -23,28 +23,53 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_READAHEADFILTER_INCLUDED
 #define IO_READAHEADFILTER_INCLUDED
 
+#include <string>
+#include <Misc/Timer.h>
 #include <Threads/Mutex.h>
 #include <Threads/Cond.h>
 #include <Threads/Thread.h>
 #include <IO/File.h>
+#include <IO/SeekableFile.h>
 
 namespace IO {
 
 class ReadAheadFilter:public File
 	{
+	/* Embedded classes: */
+	public:
+	struct Statistics // Structure reporting read-ahead performance counters
+		{
+		/* Elements: */
+		public:
+		SeekableFile::Offset numBytesRead; // Total amount of data handed to the reader
+		unsigned int numBuffersRead; // Total number of buffers handed to the reader
+		unsigned int numStalls; // Number of times the reader had to wait for a buffer to be filled
+		double stallTime; // Total time the reader spent waiting for buffers in seconds
+		double elapsedTime; // Time since the filter was created in seconds
+		};
+	
 	/* Elements: */
 	private:
 	FilePtr source; // The source file
-	Threads::Thread readAheadThread; // The background read-ahead thread
+	int sourceFd; // File descriptor for positional reads from a seekable source, or -1 to read the source sequentially
+	SeekableFile::Offset sourceOffset; // Absolute source position of the first ring buffer block in positional read mode
+	unsigned int numThreads; // Number of background read-ahead threads
+	Threads::Thread* readAheadThreads; // The background read-ahead threads
 	Threads::Mutex bufferMutex; // Mutex serializing access to the read-ahead ring buffer
 	Threads::Cond bufferCond; // Condition variable to signal a change in ring buffer state
-	size_t halfBufferSize; // Size of each half of the double buffer
-	Byte* buffers[2]; // Pointers to double buffer halves
-	unsigned int inBuffer; // Index of buffer currently read into
-	unsigned int outBuffer; // Index of buffer currently read from
-	unsigned int numFullBuffers; // Number of filled double buffer halves
-	unsigned int bufferSizes[2]; // Amount of data in the two buffer halves; amount less than full size indicates source was read completely
-	bool haveReadOnce; // Flag true if readData has consumed at least one buffer half
+	size_t bufferSize; // Size of each ring buffer slot
+	unsigned int numBuffers; // Number of slots in the ring buffer
+	Byte* bufferMemory; // Memory block holding all ring buffer slots
+	size_t* bufferSizes; // Amount of data in each ring buffer slot; amount less than full size indicates source was read completely
+	bool* bufferFull; // Flags whether each ring buffer slot has been filled
+	std::string* bufferErrors; // Messages of errors that occurred while filling each ring buffer slot, or empty strings if the slots were filled without error
+	unsigned int nextFillBlock; // Index of the next source block to be claimed by a read-ahead thread
+	unsigned int endBlock; // Index of the first source block beyond the end of the source
+	unsigned int nextReadBlock; // Index of the next source block to be handed to the reader
+	bool haveReadOnce; // Flag true if readData has consumed at least one buffer
+	bool readEof; // Flag true if the reader has received the last, partially filled buffer
+	Statistics stats; // Performance counters; protected by bufferMutex
+	Misc::Timer lifetimeTimer; // Timer running since the filter was created
 	
 	/* Protected methods from IO::File: */
 	protected:
@@ -52,16 +77,19 @@ class ReadAheadFilter:public File
 	
 	/* Private methods: */
 	private:
-	void* readAheadThreadMethod(void); // The background read-ahead thread's method
+	void* readAheadThreadMethod(void); // The background read-ahead threads' method
 	
 	/* Constructors and destructors: */
 	public:
-	ReadAheadFilter(FilePtr sSource);
+	ReadAheadFilter(FilePtr sSource,unsigned int sNumBuffers =2,size_t sBufferSize =0,unsigned int sNumThreads =1); // Creates a read-ahead filter with the given number and size of buffers (0 uses the source's read buffer size); several threads issue concurrent positional reads if the source is a seekable file with an OS file descriptor
 	virtual ~ReadAheadFilter(void);
 	
 	/* Methods from File: */
 	virtual size_t getReadBufferSize(void) const;
 	virtual size_t resizeReadBuffer(size_t newReadBufferSize);
+	
+	/* New methods: */
+	Statistics getStatistics(void); // Returns a snapshot of the filter's performance counters
 	};
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 StandardFile - Class for high-performance reading/writing from/to
 standard operating system files.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -24,7 +24,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <errno.h>
 #include <unistd.h>
 #include <Misc/ThrowStdErr.h>
@@ -35,6 +37,33 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace IO {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+#if defined(IOV_MAX)&&IOV_MAX<1024
+const unsigned int maxNumIovecs=IOV_MAX; // Maximum number of memory regions passed to a single readv/writev call
+#else
+const unsigned int maxNumIovecs=1024; // Maximum number of memory regions passed to a single readv/writev call
+#endif
+
+unsigned int prepareIovecs(const File::IOVector* vectors,unsigned int numVectors,size_t firstOffset,struct iovec* iovecs) // Converts a batch of memory regions, skipping the given amount of data in the first one; returns number of converted regions
+	{
+	unsigned int numIovecs=numVectors<maxNumIovecs?numVectors:maxNumIovecs;
+	for(unsigned int i=0;i<numIovecs;++i)
+		{
+		iovecs[i].iov_base=vectors[i].data;
+		iovecs[i].iov_len=vectors[i].size;
+		}
+	iovecs[0].iov_base=static_cast<char*>(iovecs[0].iov_base)+firstOffset;
+	iovecs[0].iov_len-=firstOffset;
+	return numIovecs;
+	}
+
+}
+
 /*****************************
 Methods of class StandardFile:
 *****************************/
@@ -105,6 +134,100 @@ void StandardFile::writeData(const File::Byte* buffer,size_t bufferSize)
 		}
 	}
 
+size_t StandardFile::readDataVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Check if file needs to be repositioned: */
+	if(filePos!=readPos)
+		if(lseek64(fd,readPos,SEEK_SET)<0)
+			throw SeekError(readPos);
+	
+	/* Read more data from source into the first batch of memory regions: */
+	struct iovec iovecs[maxNumIovecs];
+	int numIovecs=int(prepareIovecs(vectors,numVectors,0,iovecs));
+	ssize_t readResult;
+	do
+		{
+		readResult=::readv(fd,iovecs,numIovecs);
+		}
+	while(readResult<0&&(errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR));
+	
+	/* Handle the result from the read call: */
+	if(readResult<0)
+		{
+		/* Unknown error; probably a bad thing: */
+		throw Error(Misc::printStdErrMsg("IO::StandardFile: Fatal error %d while reading from file",int(errno)));
+		}
+	
+	/* Advance the read pointer: */
+	readPos+=readResult;
+	filePos=readPos;
+	
+	return size_t(readResult);
+	}
+
+void StandardFile::writeDataVectored(const File::IOVector* vectors,unsigned int numVectors)
+	{
+	/* Check if file needs to be repositioned: */
+	if(filePos!=writePos)
+		if(lseek64(fd,writePos,SEEK_SET)<0)
+			throw SeekError(writePos);
+	
+	struct iovec iovecs[maxNumIovecs];
+	size_t firstOffset=0;
+	while(true)
+		{
+		/* Skip all completely written memory regions: */
+		while(numVectors>0&&firstOffset==vectors->size)
+			{
+			++vectors;
+			--numVectors;
+			firstOffset=0;
+			}
+		if(numVectors==0)
+			break;
+		
+		/* Write the next batch of memory regions: */
+		int numIovecs=int(prepareIovecs(vectors,numVectors,firstOffset,iovecs));
+		ssize_t writeResult=::writev(fd,iovecs,numIovecs);
+		if(writeResult>0)
+			{
+			/* Advance the write pointer: */
+			writePos+=writeResult;
+			filePos=writePos;
+			
+			/* Prepare to write more data: */
+			size_t writeSize=writeResult;
+			while(writeSize>=vectors->size-firstOffset)
+				{
+				writeSize-=vectors->size-firstOffset;
+				++vectors;
+				--numVectors;
+				firstOffset=0;
+				if(numVectors==0)
+					break;
+				}
+			firstOffset+=writeSize;
+			}
+		else if(writeResult<0&&(errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR))
+			{
+			/* Do nothing */
+			}
+		else if(writeResult==0)
+			{
+			/* Sink has reached end-of-file: */
+			size_t numMissingBytes=vectors->size-firstOffset;
+			for(unsigned int i=1;i<numVectors;++i)
+				numMissingBytes+=vectors[i].size;
+			throw WriteError(numMissingBytes);
+			}
+		else
+			{
+			/* Unknown error; probably a bad thing: */
+			throw Error(Misc::printStdErrMsg("IO::StandardFile: Fatal error %d while writing to file",int(errno)));
+			}
+		}
+	}
+
 void StandardFile::openFile(const char* fileName,File::AccessMode accessMode,int flags,int mode)
 	{
 	/* Adjust flags according to access mode: */
@@ -154,6 +277,7 @@ StandardFile::StandardFile(const char* fileName,File::AccessMode accessMode)
 	
 	/* Open the file: */
 	openFile(fileName,accessMode,flags,mode);
+	setStatisticsLabel(fileName);
 	}
 
 StandardFile::StandardFile(const char* fileName,File::AccessMode accessMode,int flags,int mode)
@@ -163,6 +287,7 @@ StandardFile::StandardFile(const char* fileName,File::AccessMode accessMode,int
 	{
 	/* Open the file: */
 	openFile(fileName,accessMode,flags,mode);
+	setStatisticsLabel(fileName);
 	}
 
 StandardFile::StandardFile(int sFd,File::AccessMode accessMode)
@@ -1,6 +1,6 @@
 /***********************************************************************
 ValueSource - Class to read strings or numbers from files.
-Copyright (c) 2009-2011 Oliver Kreylos
+Copyright (c) 2009-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -22,7 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/ValueSource.h>
 
 #include <ctype.h>
-#include <math.h>
+#include <IO/NumberParser.h>
 
 namespace IO {
 
@@ -630,79 +630,30 @@ unsigned int ValueSource::readUnsignedInteger(void)
 
 double ValueSource::readNumber(void)
 	{
-	/* Read a plus or minus sign: */
-	bool negate=lastChar=='-';
-	if(lastChar=='-'||lastChar=='+')
-		lastChar=source->getChar();
-	
-	/* Read an integral number part: */
-	bool haveDigit=false;
-	double result=0.0;
-	while(cc[lastChar]&DIGIT)
-		{
-		haveDigit=true;
-		result=result*10.0+double(lastChar-'0');
-		lastChar=source->getChar();
-		}
-	
-	/* Check for a period: */
-	if(lastChar=='.')
-		{
-		lastChar=source->getChar();
-		
-		/* Read a fractional number part: */
-		double fraction=0.0;
-		double fractionBase=1.0;
-		while(cc[lastChar]&DIGIT)
-			{
-			haveDigit=true;
-			fraction=fraction*10.0+double(lastChar-'0');
-			fractionBase*=10.0;
-			lastChar=source->getChar();
-			}
-		
-		result+=fraction/fractionBase;
-		}
-	
-	/* Signal an error if no digits were read in the integral or fractional part: */
-	if(!haveDigit)
+	/* Parse the number directly from the character source's read buffer: */
+	double result;
+	if(!IO::readNumber(*source,lastChar,result))
 		throw NumberError();
 	
-	/* Negate the result if a minus sign was read: */
-	if(negate)
-		result=-result;
+	/* Skip whitespace: */
+	while(cc[lastChar]&WHITESPACE)
+		lastChar=source->getChar();
 	
-	/* Check for an exponent indicator: */
-	if(lastChar=='e'||lastChar=='E')
+	return result;
+	}
+
+void ValueSource::readNumbers(double* values,size_t numValues)
+	{
+	for(size_t i=0;i<numValues;++i)
 		{
-		lastChar=source->getChar();
-		
-		/* Read a plus or minus sign: */
-		bool negateExponent=lastChar=='-';
-		if(lastChar=='-'||lastChar=='+')
-			lastChar=source->getChar();
-		
-		/* Check if there are any digits in the exponent: */
-		if(!(cc[lastChar]&DIGIT))
+		/* Parse the next number directly from the character source's read buffer: */
+		if(!IO::readNumber(*source,lastChar,values[i]))
 			throw NumberError();
 		
-		/* Read the exponent: */
-		double exponent=0.0;
-		while(cc[lastChar]&DIGIT)
-			{
-			exponent=exponent*10.0+double(lastChar-'0');
+		/* Skip whitespace: */
+		while(cc[lastChar]&WHITESPACE)
 			lastChar=source->getChar();
-			}
-		
-		/* Multiply the mantissa with the exponent: */
-		result*=pow(10.0,negateExponent?-exponent:exponent);
 		}
-	
-	/* Skip whitespace: */
-	while(cc[lastChar]&WHITESPACE)
-		lastChar=source->getChar();
-	
-	return result;
 	}
 
 }
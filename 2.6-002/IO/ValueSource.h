@@ -1,6 +1,6 @@
 /***********************************************************************
 ValueSource - Class to read strings or numbers from files.
-Copyright (c) 2009-2011 Oliver Kreylos
+Copyright (c) 2009-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -140,6 +140,7 @@ class ValueSource
 	int readInteger(void); // Reads the next signed integer from the character source
 	unsigned int readUnsignedInteger(void); // Reads the next unsigned integer from the character source
 	double readNumber(void); // Reads the next floating-point number from the character source
+	void readNumbers(double* values,size_t numValues); // Reads the given number of floating-point numbers from the character source into the given array
 	};
 
 }
@@ -2,7 +2,7 @@
 ZipArchive - Class to represent ZIP archive files, with functionality to
 traverse contained directory hierarchies and extract files using a File
 interface.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -24,17 +24,102 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/ZipArchive.h>
 
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 #include <zlib.h>
 #include <string>
 #include <vector>
 #include <Misc/ThrowStdErr.h>
+#include <Threads/Mutex.h>
+#include <Threads/RefCounted.h>
 #include <IO/StandardFile.h>
 #include <IO/FixedMemoryFile.h>
 
 namespace IO {
 
+/**********************************************
+Declaration of class ZipArchive::ArchiveReader:
+**********************************************/
+
+class ZipArchive::ArchiveReader:public Threads::RefCounted
+	{
+	/* Elements: */
+	private:
+	SeekableFilePtr archive; // File object to access the ZIP archive
+	int archiveFd; // File descriptor of the ZIP archive for positional reads, or -1 if reads have to be serialized
+	Threads::Mutex archiveMutex; // Mutex serializing reads if the archive does not have a file descriptor
+	
+	/* Constructors and destructors: */
+	public:
+	ArchiveReader(SeekableFilePtr sArchive)
+		:archive(sArchive),
+		 archiveFd(-1)
+		{
+		/* Use positional reads if the archive is backed by an OS file: */
+		try
+			{
+			archiveFd=archive->getFd();
+			}
+		catch(std::runtime_error err)
+			{
+			/* Serialize reads through the archive file object instead */
+			}
+		}
+	
+	/* Methods: */
+	size_t read(Offset pos,void* buffer,size_t bufferSize) // Reads up to the given amount of data from the given archive position; returns less only at end-of-file
+		{
+		char* bufPtr=static_cast<char*>(buffer);
+		size_t result=0;
+		if(archiveFd>=0)
+			{
+			/* Read with positional reads that do not change the archive's file position: */
+			while(result<bufferSize)
+				{
+				ssize_t readSize=pread(archiveFd,bufPtr+result,bufferSize-result,pos+Offset(result));
+				if(readSize<0&&errno==EINTR)
+					continue;
+				if(readSize<0)
+					throw File::ReadError(bufferSize-result);
+				if(readSize==0)
+					break;
+				result+=size_t(readSize);
+				}
+			}
+		else
+			{
+			/* Serialize access to the archive's file position: */
+			Threads::Mutex::Lock archiveLock(archiveMutex);
+			archive->setReadPosAbs(pos);
+			while(result<bufferSize)
+				{
+				size_t readSize=archive->readUpTo(bufPtr+result,bufferSize-result);
+				if(readSize==0)
+					break;
+				result+=readSize;
+				}
+			}
+		
+		return result;
+		}
+	};
+
 namespace {
 
+/****************
+Helper functions:
+****************/
+
+inline unsigned int getUInt16(const unsigned char* ptr) // Extracts a little-endian 16-bit number from a buffer
+	{
+	return (unsigned int)(ptr[0])|((unsigned int)(ptr[1])<<8);
+	}
+
+inline unsigned int getUInt32(const unsigned char* ptr) // Extracts a little-endian 32-bit number from a buffer
+	{
+	return (unsigned int)(ptr[0])|((unsigned int)(ptr[1])<<8)|((unsigned int)(ptr[2])<<16)|((unsigned int)(ptr[3])<<24);
+	}
+
 /**************
 Helper classes:
 **************/
@@ -47,7 +132,7 @@ class ZipArchiveStreamingFile:public File // Class to read ZIP archive entries i
 	
 	/* Elements: */
 	private:
-	SeekableFilePtr archive; // Reference to the ZIP archive containing the file
+	Misc::Autopointer<ZipArchive::ArchiveReader> reader; // Reader for the ZIP archive containing the file
 	Offset nextReadPos; // Position of next data block to read from archive
 	size_t compressedSize; // Amount of data remaining to be read from archive
 	size_t compressedBufferSize; // Size of allocated buffer for compressed data read from the archive
@@ -62,7 +147,7 @@ class ZipArchiveStreamingFile:public File // Class to read ZIP archive entries i
 	
 	/* Constructors and destructors: */
 	public:
-	ZipArchiveStreamingFile(SeekableFilePtr sArchive,unsigned int sCompressionMethod,Offset sNextReadPos,size_t sCompressedSize);
+	ZipArchiveStreamingFile(Misc::Autopointer<ZipArchive::ArchiveReader> sReader,unsigned int sCompressionMethod,Offset sNextReadPos,size_t sCompressedSize);
 	virtual ~ZipArchiveStreamingFile(void);
 	};
 
@@ -91,8 +176,7 @@ size_t ZipArchiveStreamingFile::readData(File::Byte* buffer,size_t bufferSize)
 				size_t compressedReadSize=compressedBufferSize;
 				if(compressedReadSize>compressedSize)
 					compressedReadSize=compressedSize;
-				archive->setReadPosAbs(nextReadPos);
-				compressedReadSize=archive->readUpTo(compressedBuffer,compressedReadSize);
+				compressedReadSize=reader->read(nextReadPos,compressedBuffer,compressedReadSize);
 				nextReadPos+=compressedReadSize;
 				compressedSize-=compressedReadSize;
 				
@@ -124,8 +208,7 @@ size_t ZipArchiveStreamingFile::readData(File::Byte* buffer,size_t bufferSize)
 		size_t readSize=bufferSize;
 		if(readSize>compressedSize)
 			readSize=compressedSize;
-		archive->setReadPosAbs(nextReadPos);
-		readSize=archive->readUpTo(buffer,readSize);
+		readSize=reader->read(nextReadPos,buffer,readSize);
 		nextReadPos+=readSize;
 		compressedSize-=readSize;
 		eof=compressedSize==0;
@@ -139,9 +222,9 @@ void ZipArchiveStreamingFile::writeData(const File::Byte* buffer,size_t bufferSi
 	/* Writing is not supported; ignore silently */
 	}
 
-ZipArchiveStreamingFile::ZipArchiveStreamingFile(SeekableFilePtr sArchive,unsigned int sCompressionMethod,SeekableFile::Offset sNextReadPos,size_t sCompressedSize)
+ZipArchiveStreamingFile::ZipArchiveStreamingFile(Misc::Autopointer<ZipArchive::ArchiveReader> sReader,unsigned int sCompressionMethod,SeekableFile::Offset sNextReadPos,size_t sCompressedSize)
 	:File(ReadOnly),
-	 archive(sArchive),
+	 reader(sReader),
 	 nextReadPos(sNextReadPos),compressedSize(sCompressedSize),
 	 compressedBufferSize(8192),compressedBuffer(sCompressionMethod!=0?new Bytef[compressedBufferSize]:0),
 	 stream(0),eof(false)
@@ -152,8 +235,7 @@ ZipArchiveStreamingFile::ZipArchiveStreamingFile(SeekableFilePtr sArchive,unsign
 		size_t compressedReadSize=compressedBufferSize;
 		if(compressedReadSize>compressedSize)
 			compressedReadSize=compressedSize;
-		archive->setReadPosAbs(nextReadPos);
-		compressedReadSize=archive->readUpTo(compressedBuffer,compressedReadSize);
+		compressedReadSize=reader->read(nextReadPos,compressedBuffer,compressedReadSize);
 		nextReadPos+=compressedReadSize;
 		compressedSize-=compressedReadSize;
 		
@@ -181,30 +263,13 @@ ZipArchiveStreamingFile::~ZipArchiveStreamingFile(void)
 
 class ZipArchiveDirectory:public Directory // Class to represent directories inside a ZIP archive using an IO::Directory abstraction
 	{
-	/* Embedded classes: */
-	private:
-	struct DirectoryEntry // Structure for directory entries
-		{
-		/* Elements: */
-		public:
-		bool isFile; // Flag whether the entry is a file or a directory
-		ZipArchive::FileID id; // File ID of the directory entry
-		std::string name; // Name of the file or subdirectory inside this directory
-		
-		/* Constructors and destructors: */
-		DirectoryEntry(bool sIsFile,const ZipArchive::FileID& sId,const std::string& sName)
-			:isFile(sIsFile),
-			 id(sId),
-			 name(sName)
-			{
-			}
-		};
-	
 	/* Elements: */
+	private:
 	ZipArchivePtr archive; // The ZIP archive from which this directory was extracted
 	std::string pathName; // Path name of this directory inside the ZIP archive
-	std::vector<DirectoryEntry> entries; // List of entries in this directory
-	std::vector<DirectoryEntry>::iterator currentEntry; // Iterator to the current directory entry
+	const ZipArchive::DirectoryEntryList* entries; // List of entries in this directory in the archive's directory tree, or null if the directory does not exist
+	size_t numEntries; // Number of entries in this directory
+	size_t currentEntry; // Index of the current directory entry; equal to numEntries before the first entry is read
 	
 	/* Constructors and destructors: */
 	public:
@@ -239,40 +304,12 @@ ZipArchiveDirectory::ZipArchiveDirectory(ZipArchivePtr sArchive,const std::strin
 	/* Normalize the path name: */
 	normalizePath(pathName,1);
 	
-	/* Collect all files/directories from the ZIP archive's central directory that match the directory name: */
-	const char* dn=pathName.c_str();
-	size_t dnLen=pathName.length();
-	for(ZipArchive::DirectoryIterator dIt=archive->readDirectory();dIt.isValid();archive->getNextEntry(dIt))
-		{
-		/* Match the iterator name's prefix against the directory name: */
-		if(strncmp(dn+1,dIt.getFileName(),dnLen-1)==0&&(dnLen==1||dIt.getFileName()[dnLen-1]=='/'))
-			{
-			/* Get the beginning of the entry name: */
-			const char* nameBegin=dIt.getFileName()+(dnLen>1?dnLen:0);
-			
-			if(*nameBegin!='\0')
-				{
-				/* Get the end of the entry name: */
-				const char* nameEnd;
-				for(nameEnd=nameBegin;*nameEnd!='\0'&&*nameEnd!='/';++nameEnd)
-					;
-
-				if(*nameEnd=='\0')
-					{
-					/* Iterator points to a regular file: */
-					entries.push_back(DirectoryEntry(true,dIt,std::string(nameBegin,nameEnd)));
-					}
-				else if(*nameEnd=='/'&&*(nameEnd+1)=='\0')
-					{
-					/* Iterator points to a subdirectory: */
-					entries.push_back(DirectoryEntry(false,dIt,std::string(nameBegin,nameEnd)));
-					}
-				}
-			}
-		}
+	/* Look up the directory's entries in the archive's directory tree: */
+	entries=archive->findDirectory(pathName.c_str()+1);
+	numEntries=entries!=0?entries->size():0;
 	
-	/* Initialize the current entry iterator: */
-	currentEntry=entries.end();
+	/* Initialize the current entry index: */
+	currentEntry=numEntries;
 	}
 
 std::string ZipArchiveDirectory::getName(void) const
@@ -323,29 +360,29 @@ DirectoryPtr ZipArchiveDirectory::getParent(void) const
 
 void ZipArchiveDirectory::rewind(void)
 	{
-	/* Reset the current entry iterator: */
-	currentEntry=entries.end();
+	/* Reset the current entry index: */
+	currentEntry=numEntries;
 	}
 
 bool ZipArchiveDirectory::readNextEntry(void)
 	{
-	/* Increment the current entry iterator or wrap it around at the end of the directory: */
-	if(currentEntry!=entries.end())
+	/* Increment the current entry index or wrap it around at the end of the directory: */
+	if(currentEntry!=numEntries)
 		++currentEntry;
 	else
-		currentEntry=entries.begin();
+		currentEntry=0;
 	
-	return currentEntry!=entries.end();
+	return currentEntry!=numEntries;
 	}
 
 const char* ZipArchiveDirectory::getEntryName(void) const
 	{
-	return currentEntry->name.c_str();
+	return (*entries)[currentEntry].name.c_str();
 	}
 
 Misc::PathType ZipArchiveDirectory::getEntryType(void) const
 	{
-	if(currentEntry->isFile)
+	if((*entries)[currentEntry].isFile)
 		return Misc::PATHTYPE_FILE;
 	else
 		return Misc::PATHTYPE_DIRECTORY;
@@ -531,8 +568,96 @@ int ZipArchive::initArchive(void)
 	return 0;
 	}
 
+ZipArchive::DirectoryEntryList& ZipArchive::addDirectory(const std::string& directoryPath)
+	{
+	/* Check if the directory already exists: */
+	DirectoryMap::Iterator dIt=directoryMap.findEntry(directoryPath);
+	if(!dIt.isFinished())
+		return dIt->getDest();
+	
+	if(!directoryPath.empty())
+		{
+		/* Split the directory path into parent path and name: */
+		std::string::size_type slashPos=directoryPath.rfind('/');
+		std::string parentPath=slashPos!=std::string::npos?std::string(directoryPath,0,slashPos):std::string();
+		std::string name=slashPos!=std::string::npos?std::string(directoryPath,slashPos+1):directoryPath;
+		
+		/* Add the directory to its parent directory: */
+		addDirectory(parentPath).push_back(DirectoryEntry(false,FileID(),name));
+		}
+	
+	/* Create the new directory: */
+	return directoryMap[directoryPath].getDest();
+	}
+
+void ZipArchive::buildIndex(void)
+	{
+	/* Read the entire central directory with a single read: */
+	std::vector<unsigned char> directory(directorySize);
+	if(directorySize>0&&reader->read(directoryPos,&directory[0],directorySize)!=directorySize)
+		Misc::throwStdErr("IO::ZipArchive: Truncated central directory");
+	
+	/* Create the root directory: */
+	addDirectory(std::string());
+	
+	/* Parse all file entries: */
+	const unsigned char* dPtr=directorySize>0?&directory[0]:0;
+	const unsigned char* dEnd=dPtr+directorySize;
+	while(dEnd-dPtr>=46&&getUInt32(dPtr)==0x02014b50U)
+		{
+		/* Read the entry header: */
+		FileID id;
+		id.compressedSize=size_t(getUInt32(dPtr+20));
+		id.uncompressedSize=size_t(getUInt32(dPtr+24));
+		size_t fileNameLength=getUInt16(dPtr+28);
+		size_t extraFieldLength=getUInt16(dPtr+30);
+		size_t fileCommentLength=getUInt16(dPtr+32);
+		id.filePos=Offset(getUInt32(dPtr+42));
+		if(size_t(dEnd-dPtr)<46+fileNameLength)
+			Misc::throwStdErr("IO::ZipArchive: Bad entry in central directory");
+		std::string fileName(reinterpret_cast<const char*>(dPtr+46),fileNameLength);
+		
+		if(!fileName.empty()&&fileName[fileName.length()-1]=='/')
+			{
+			/* Add an explicit directory entry: */
+			addDirectory(std::string(fileName,0,fileName.length()-1));
+			}
+		else if(!fileName.empty())
+			{
+			/* Add the file to the file index and its directory: */
+			fileMap[fileName]=id;
+			std::string::size_type slashPos=fileName.rfind('/');
+			if(slashPos!=std::string::npos)
+				addDirectory(std::string(fileName,0,slashPos)).push_back(DirectoryEntry(true,id,std::string(fileName,slashPos+1)));
+			else
+				addDirectory(std::string()).push_back(DirectoryEntry(true,id,fileName));
+			}
+		
+		/* Go to the next entry: */
+		dPtr+=46+fileNameLength+extraFieldLength+fileCommentLength;
+		}
+	}
+
+ZipArchive::Offset ZipArchive::getFileDataPos(const ZipArchive::FileID& fileId,unsigned short& compressionMethod,const char* methodName)
+	{
+	/* Read the file's local header: */
+	unsigned char header[30];
+	if(reader->read(fileId.filePos,header,sizeof(header))!=sizeof(header)||getUInt32(header)!=0x04034b50U)
+		Misc::throwStdErr("IO::ZipArchive::%s: Invalid file header signature",methodName);
+	
+	/* Extract file header information: */
+	compressionMethod=(unsigned short)getUInt16(header+8);
+	unsigned int fileNameLength=getUInt16(header+26);
+	unsigned int extraFieldLength=getUInt16(header+28);
+	
+	/* Skip file name and extra field: */
+	return fileId.filePos+Offset(sizeof(header)+fileNameLength+extraFieldLength);
+	}
+
 ZipArchive::ZipArchive(const char* archiveFileName)
-	:archive(new StandardFile(archiveFileName,File::ReadOnly))
+	:archive(new StandardFile(archiveFileName,File::ReadOnly)),
+	 reader(new ArchiveReader(archive)),
+	 fileMap(1021),directoryMap(101)
 	{
 	/* Initialize the archive and handle errors: */
 	switch(initArchive())
@@ -549,10 +674,15 @@ ZipArchive::ZipArchive(const char* archiveFileName)
 			Misc::throwStdErr("IO::ZipArchive: Invalid central directory in ZIP archive %s",archiveFileName);
 			break;
 		}
+	
+	/* Index the archive's central directory: */
+	buildIndex();
 	}
 
 ZipArchive::ZipArchive(SeekableFilePtr sArchive)
-	:archive(sArchive)
+	:archive(sArchive),
+	 reader(new ArchiveReader(archive)),
+	 fileMap(1021),directoryMap(101)
 	{
 	/* Initialize the archive and handle errors: */
 	switch(initArchive())
@@ -569,6 +699,9 @@ ZipArchive::ZipArchive(SeekableFilePtr sArchive)
 			Misc::throwStdErr("IO::ZipArchive: Invalid central directory in ZIP archive");
 			break;
 		}
+	
+	/* Index the archive's central directory: */
+	buildIndex();
 	}
 
 ZipArchive::~ZipArchive(void)
@@ -643,78 +776,65 @@ ZipArchive::DirectoryIterator& ZipArchive::getNextEntry(ZipArchive::DirectoryIte
 	return dIt;
 	}
 
-ZipArchive::FileID ZipArchive::findFile(const char* fileName)
+ZipArchive::FileID ZipArchive::findFile(const char* fileName) const
 	{
-	/* Read the archive's central directory: */
-	for(DirectoryIterator dIt=readDirectory();dIt.isValid();getNextEntry(dIt))
-		{
-		/* Check if the file was found: */
-		if(strcmp(dIt.getFileName(),fileName)==0)
-			return dIt;
-		}
+	/* Look up the file in the file index: */
+	FileMap::ConstIterator fIt=fileMap.findEntry(fileName);
+	if(fIt.isFinished())
+		throw FileNotFoundError(fileName);
+	
+	return fIt->getDest();
+	}
+
+const ZipArchive::DirectoryEntryList* ZipArchive::findDirectory(const char* directoryPath) const
+	{
+	/* Look up the directory in the directory tree: */
+	DirectoryMap::ConstIterator dIt=directoryMap.findEntry(directoryPath);
+	if(dIt.isFinished())
+		return 0;
 	
-	/* File was not found; throw exception: */
-	throw FileNotFoundError(fileName);
+	return &dIt->getDest();
 	}
 
 FilePtr ZipArchive::openFile(const ZipArchive::FileID& fileId)
 	{
 	/* Read the file's header: */
-	archive->setReadPosAbs(fileId.filePos);
-	if(archive->read<unsigned int>()!=0x04034b50U)
-		Misc::throwStdErr("IO::ZipArchive::openFile: Invalid file header signature");
-	
-	/* Read file header information: */
-	archive->skip<unsigned short>(2);
-	unsigned short compressionMethod=archive->read<unsigned short>();
-	archive->skip<unsigned short>(2);
-	archive->skip<unsigned int>(1);
-	unsigned int compressedSize=archive->read<unsigned int>();
-	archive->skip<unsigned int>(1);
-	unsigned short fileNameLength=archive->read<unsigned short>();
-	unsigned short extraFieldLength=archive->read<unsigned short>();
-	
-	/* Skip file name and extra field: */
-	archive->skip<char>(fileNameLength);
-	archive->skip<char>(extraFieldLength);
+	unsigned short compressionMethod;
+	Offset dataPos=getFileDataPos(fileId,compressionMethod,"openFile");
 	
 	/* Create and return the result file: */
-	return new ZipArchiveStreamingFile(archive,compressionMethod,archive->getReadPos(),compressedSize);
+	return new ZipArchiveStreamingFile(reader,compressionMethod,dataPos,fileId.compressedSize);
 	}
 
 SeekableFilePtr ZipArchive::openSeekableFile(const ZipArchive::FileID& fileId)
 	{
 	/* Read the file's header: */
-	archive->setReadPosAbs(fileId.filePos);
-	if(archive->read<unsigned int>()!=0x04034b50U)
-		Misc::throwStdErr("IO::ZipArchive::openSeekableFile: Invalid file header signature");
-	
-	/* Read file header information: */
-	archive->skip<unsigned short>(2);
-	unsigned short compressionMethod=archive->read<unsigned short>();
-	archive->skip<unsigned short>(2);
-	archive->skip<unsigned int>(1);
-	unsigned int compressedSize=archive->read<unsigned int>();
-	unsigned int uncompressedSize=archive->read<unsigned int>();
-	unsigned short fileNameLength=archive->read<unsigned short>();
-	unsigned short extraFieldLength=archive->read<unsigned short>();
-	
-	/* Skip file name and extra field: */
-	archive->skip<char>(fileNameLength);
-	archive->skip<char>(extraFieldLength);
+	unsigned short compressionMethod;
+	Offset dataPos=getFileDataPos(fileId,compressionMethod,"openSeekableFile");
+	size_t compressedSize=fileId.compressedSize;
+	size_t uncompressedSize=fileId.uncompressedSize;
 	
 	/* Create the result file: */
 	FixedMemoryFile* result=new FixedMemoryFile(uncompressedSize);
 	if(compressionMethod==0)
 		{
 		/* Directly read the uncompressed data: */
-		archive->read<char>(static_cast<char*>(result->getMemory()),compressedSize);
+		if(reader->read(dataPos,result->getMemory(),compressedSize)!=compressedSize)
+			{
+			delete result;
+			Misc::throwStdErr("IO::ZipArchive::openSeekableFile: Truncated file data");
+			}
 		}
 	else
 		{
 		/* Read the compressed data: */
 		Bytef* compressed=new Bytef[compressedSize];
-		archive->read<Bytef>(compressed,compressedSize);
+		if(reader->read(dataPos,compressed,compressedSize)!=compressedSize)
+			{
+			delete[] compressed;
+			delete result;
+			Misc::throwStdErr("IO::ZipArchive::openSeekableFile: Truncated file data");
+			}
 		
 		/* Uncompress the data: */
 		z_stream stream;
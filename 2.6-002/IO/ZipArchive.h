@@ -2,7 +2,7 @@
 ZipArchive - Class to represent ZIP archive files, with functionality to
 traverse contained directory hierarchies and extract files using a File
 interface.
-Copyright (c) 2011 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -24,8 +24,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_ZIPARCHIVE_INCLUDED
 #define IO_ZIPARCHIVE_INCLUDED
 
+#include <string>
+#include <vector>
 #include <stdexcept>
 #include <Misc/RefCounted.h>
+#include <Misc/Autopointer.h>
+#include <Misc/HashTable.h>
+#include <Misc/StringHashFunctions.h>
 #include <IO/File.h>
 #include <IO/SeekableFile.h>
 #include <IO/Directory.h>
@@ -122,14 +127,44 @@ class ZipArchive:public Misc::RefCounted
 			};
 		};
 	
-	/* Elements: */
+	struct DirectoryEntry // Structure for entries in the archive's directory tree
+		{
+		/* Elements: */
+		public:
+		bool isFile; // Flag whether the entry is a file or a directory
+		FileID id; // File ID of a file entry; invalid for directories
+		std::string name; // Name of the file or subdirectory inside its parent directory
+		
+		/* Constructors and destructors: */
+		DirectoryEntry(bool sIsFile,const FileID& sId,const std::string& sName)
+			:isFile(sIsFile),
+			 id(sId),
+			 name(sName)
+			{
+			}
+		};
+	
+	typedef std::vector<DirectoryEntry> DirectoryEntryList; // Type for lists of entries in a directory
+	
+	class ArchiveReader; // Class to read from the archive file concurrently from multiple threads
+	
 	private:
+	typedef Misc::HashTable<std::string,FileID> FileMap; // Hash table mapping fully-qualified file names to file IDs
+	typedef Misc::HashTable<std::string,DirectoryEntryList> DirectoryMap; // Hash table mapping directory path names without leading or trailing slashes to directory contents
+	
+	/* Elements: */
 	SeekableFilePtr archive; // File object to access the ZIP archive
+	Misc::Autopointer<ArchiveReader> reader; // Object for thread-safe positional reads from the ZIP archive
 	Offset directoryPos; // Position of ZIP archive's root directory
 	size_t directorySize; // Total size of root directory
+	FileMap fileMap; // Index of all files in the ZIP archive
+	DirectoryMap directoryMap; // Directory tree of the ZIP archive, including implicit directories
 	
 	/* Private methods: */
 	int initArchive(void); // Initializes the ZIP archive file structures; returns error code
+	DirectoryEntryList& addDirectory(const std::string& directoryPath); // Adds a directory and all its parents to the directory tree if they do not already exist
+	void buildIndex(void); // Reads the entire central directory and builds the file index and directory tree
+	Offset getFileDataPos(const FileID& fileId,unsigned short& compressionMethod,const char* methodName); // Reads a file's local header; returns the position of the file's data in the archive
 	
 	/* Constructors and destructors: */
 	public:
@@ -138,11 +173,16 @@ class ZipArchive:public Misc::RefCounted
 	~ZipArchive(void); // Closes the ZIP archive
 	
 	/* Methods: */
-	DirectoryIterator readDirectory(void); // Returns a new directory iterator
+	DirectoryIterator readDirectory(void); // Returns a new directory iterator; directory iterators must not be used concurrently with other methods
 	DirectoryIterator& getNextEntry(DirectoryIterator& dIt); // Advances the directory iterator to the next entry
-	FileID findFile(const char* fileName); // Returns a file identifier for a file of the given name; throws exception if file does not exist
-	FilePtr openFile(const FileID& fileId); // Returns a file for streaming reading
-	SeekableFilePtr openSeekableFile(const FileID& fileId); // Returns a file for seekable reading
+	size_t getNumFiles(void) const // Returns the number of files in the archive
+		{
+		return fileMap.getNumEntries();
+		}
+	FileID findFile(const char* fileName) const; // Returns a file identifier for a file of the given name; throws exception if file does not exist
+	const DirectoryEntryList* findDirectory(const char* directoryPath) const; // Returns the list of entries of the given directory, without leading or trailing slashes; returns null if the directory does not exist
+	FilePtr openFile(const FileID& fileId); // Returns a file for streaming reading; can be called from multiple threads concurrently
+	SeekableFilePtr openSeekableFile(const FileID& fileId); // Returns a file for seekable reading; can be called from multiple threads concurrently
 	DirectoryPtr openDirectory(const char* directoryName); // Returns a directory object representing the given directory name
 	};
 
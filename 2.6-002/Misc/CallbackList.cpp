@@ -2,7 +2,7 @@
 CallbackList - Class for lists of callback functions associated with
 certain events. Uses new-style templatized callback mechanism and offers
 backwards compatibility for traditional C-style callbacks.
-Copyright (c) 2000-2012 Oliver Kreylos
+Copyright (c) 2000-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -26,120 +26,131 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Misc {
 
-/***********************************************
-Methods of class CallbackList::CallbackListItem:
-***********************************************/
+/********************************************
+Declaration of class CallbackList::CallGuard:
+********************************************/
 
-CallbackList::CallbackListItem::CallbackListItem(void)
-	:succ(0)
+class CallbackList::CallGuard
 	{
-	}
-
-CallbackList::CallbackListItem::~CallbackListItem(void)
-	{
-	}
-
-/***********************************************
-Methods of class CallbackList::FunctionCallback:
-***********************************************/
-
-CallbackList::FunctionCallback::FunctionCallback(CallbackList::FunctionCallback::CallbackFunction sCallbackFunction)
-	:callbackFunction(sCallbackFunction)
-	{
-	}
-
-bool CallbackList::FunctionCallback::operator==(const CallbackList::CallbackListItem& other) const
-	{
-	const FunctionCallback* other2=dynamic_cast<const FunctionCallback*>(&other);
-	return other2!=0&&callbackFunction==other2->callbackFunction;
-	}
-
-void CallbackList::FunctionCallback::call(CallbackData* callbackData) const
-	{
-	/* Call the callback function: */
-	callbackFunction(callbackData);
-	}
-
-/******************************************************
-Methods of class CallbackList::FunctionVoidArgCallback:
-******************************************************/
-
-CallbackList::FunctionVoidArgCallback::FunctionVoidArgCallback(CallbackList::FunctionVoidArgCallback::CallbackFunction sCallbackFunction,void* sUserData)
-	:callbackFunction(sCallbackFunction),
-	 userData(sUserData)
-	{
-	}
-
-bool CallbackList::FunctionVoidArgCallback::operator==(const CallbackList::CallbackListItem& other) const
-	{
-	const FunctionVoidArgCallback* other2=dynamic_cast<const FunctionVoidArgCallback*>(&other);
-	return other2!=0&&callbackFunction==other2->callbackFunction&&userData==other2->userData;
-	}
-
-void CallbackList::FunctionVoidArgCallback::call(CallbackData* callbackData) const
-	{
-	/* Call the callback function: */
-	callbackFunction(callbackData,userData);
-	}
+	/* Elements: */
+	private:
+	CallbackList& callbackList; // The called callback list
+	
+	/* Constructors and destructors: */
+	public:
+	CallGuard(CallbackList& sCallbackList) // Enters a call() operation on the given callback list
+		:callbackList(sCallbackList)
+		{
+		++callbackList.callDepth;
+		}
+	~CallGuard(void) // Leaves the call() operation and applies deferred changes if it was the outermost one, even if a callback threw an exception
+		{
+		if(--callbackList.callDepth==0&&callbackList.hasDeferredChanges)
+			callbackList.applyDeferredChanges();
+		}
+	};
 
 /*****************************
 Methods of class CallbackList:
 *****************************/
 
-void CallbackList::addCli(CallbackList::CallbackListItem* newCli)
+void CallbackList::addCallback(const CallbackList::Callback& newCallback)
 	{
-	if(tail!=0)
-		tail->succ=newCli;
+	if(callDepth!=0)
+		{
+		/* Defer the addition to not disturb the active call() operation: */
+		backAdditions.push_back(newCallback);
+		hasDeferredChanges=true;
+		}
 	else
-		head=newCli;
-	tail=newCli;
+		items.push_back(CallbackListItem(newCallback));
 	}
 
-void CallbackList::addCliToFront(CallbackList::CallbackListItem* newCli)
+void CallbackList::addCallbackToFront(const CallbackList::Callback& newCallback)
 	{
-	newCli->succ=head;
-	if(head==0)
-		tail=newCli;
-	head=newCli;
+	if(callDepth!=0)
+		{
+		/* Defer the addition to not disturb the active call() operation: */
+		frontAdditions.push_back(newCallback);
+		hasDeferredChanges=true;
+		}
+	else
+		items.insert(items.begin(),CallbackListItem(newCallback));
 	}
 
-void CallbackList::removeCli(const CallbackList::CallbackListItem& removeCli)
+void CallbackList::removeCallback(const CallbackList::Callback& callback)
 	{
-	/* Find the first callback list item equal to the given one: */
-	CallbackListItem* ptr1=0;
-	for(CallbackListItem* ptr2=head;ptr2!=0;ptr1=ptr2,ptr2=ptr2->succ)
-		if(*ptr2==removeCli)
+	/* Find the first callback in calling order equal to the given one, including deferred additions: */
+	for(CallbackVector::reverse_iterator faIt=frontAdditions.rbegin();faIt!=frontAdditions.rend();++faIt)
+		if(*faIt==callback)
 			{
-			/* Remove the item from the list: */
-			if(tail==ptr2)
-				tail=ptr1;
-			if(ptr1!=0)
-				ptr1->succ=ptr2->succ;
+			frontAdditions.erase(faIt.base()-1);
+			return;
+			}
+	for(ItemList::iterator iIt=items.begin();iIt!=items.end();++iIt)
+		if(!iIt->removed&&iIt->callback==callback)
+			{
+			if(callDepth!=0)
+				{
+				/* Only mark the item as removed, as the callback might currently be executing: */
+				iIt->removed=true;
+				hasDeferredChanges=true;
+				hasRemovedItems=true;
+				}
 			else
-				head=ptr2->succ;
-			
-			/* Delete the item: */
-			delete ptr2;
-			
-			break;
+				items.erase(iIt);
+			return;
+			}
+	for(CallbackVector::iterator baIt=backAdditions.begin();baIt!=backAdditions.end();++baIt)
+		if(*baIt==callback)
+			{
+			backAdditions.erase(baIt);
+			return;
 			}
 	}
 
+void CallbackList::applyDeferredChanges(void)
+	{
+	/* Remove all items marked as removed: */
+	if(hasRemovedItems)
+		{
+		ItemList::iterator destIt=items.begin();
+		for(ItemList::iterator iIt=items.begin();iIt!=items.end();++iIt)
+			if(!iIt->removed)
+				{
+				if(destIt!=iIt)
+					*destIt=*iIt;
+				++destIt;
+				}
+		items.erase(destIt,items.end());
+		hasRemovedItems=false;
+		}
+	
+	/* Add callbacks to the front of the list in reverse order of addition: */
+	if(!frontAdditions.empty())
+		{
+		items.insert(items.begin(),frontAdditions.rbegin(),frontAdditions.rend());
+		frontAdditions.clear();
+		}
+	
+	/* Add callbacks to the back of the list in order of addition: */
+	if(!backAdditions.empty())
+		{
+		items.insert(items.end(),backAdditions.begin(),backAdditions.end());
+		backAdditions.clear();
+		}
+	
+	hasDeferredChanges=false;
+	}
+
 CallbackList::CallbackList(void)
-	:head(0),tail(0),
+	:callDepth(0),hasDeferredChanges(false),hasRemovedItems(false),
 	 interruptRequested(false)
 	{
 	}
 
 CallbackList::~CallbackList(void)
 	{
-	/* Delete all callback list items: */
-	while(head!=0)
-		{
-		CallbackListItem* succ=head->succ;
-		delete head;
-		head=succ;
-		}
 	}
 
 void CallbackList::call(CallbackData* callbackData) const
@@ -150,9 +161,13 @@ void CallbackList::call(CallbackData* callbackData) const
 	/* Set the originator pointer in the callback data structure: */
 	callbackData->callbackList=this;
 	
+	/* Defer changes to the list made by callbacks until the outermost call returns: */
+	CallGuard guard(const_cast<CallbackList&>(*this));
+	
 	/* Call all callbacks until interrupted: */
-	for(const CallbackListItem* cliPtr=head;cliPtr!=0&&!interruptRequested;cliPtr=cliPtr->succ)
-		cliPtr->call(callbackData);
+	for(ItemList::const_iterator iIt=items.begin();iIt!=items.end()&&!interruptRequested;++iIt)
+		if(!iIt->removed)
+			iIt->callback(callbackData);
 	}
 
 void CallbackList::requestInterrupt(void) const
@@ -2,7 +2,7 @@
 CallbackList - Class for lists of callback functions associated with
 certain events. Uses new-style templatized callback mechanism and offers
 backwards compatibility for traditional C-style callbacks.
-Copyright (c) 2000-2012 Oliver Kreylos
+Copyright (c) 2000-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -25,6 +25,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef MISC_CALLBACKLIST_INCLUDED
 #define MISC_CALLBACKLIST_INCLUDED
 
+#include <vector>
+#include <Misc/FlatCallback.h>
 #include <Misc/CallbackData.h>
 
 namespace Misc {
@@ -34,27 +36,8 @@ class CallbackList // Class for lists of callbacks
 	/* Embedded classes: */
 	private:
 	
-	/* Abstract base class for callback list items: */
-	class CallbackListItem
-		{
-		friend class CallbackList;
-		
-		/* Elements: */
-		private:
-		CallbackListItem* succ; // Pointer to next item in callback list
-		
-		/* Constructors and destructors: */
-		public:
-		CallbackListItem(void); // Creates an empty singleton callback list item
-		virtual ~CallbackListItem(void); // Virtual destructor
-		
-		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const =0; // Virtual method to compare callbacks
-		virtual void call(CallbackData* callbackData) const =0; // Virtual method to invoke callback
-		};
-	
 	/* Class to call C functions: */
-	class FunctionCallback:public CallbackListItem
+	struct FunctionCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -66,15 +49,25 @@ class CallbackList // Class for lists of callbacks
 		
 		/* Constructors and destructors: */
 		public:
-		FunctionCallback(CallbackFunction sCallbackFunction); // Creates callback for given function
+		FunctionCallback(CallbackFunction sCallbackFunction) // Creates callback for given function
+			:callbackFunction(sCallbackFunction)
+			{
+			}
 		
 		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const;
-		virtual void call(CallbackData* cbData) const;
+		bool operator==(const FunctionCallback& other) const
+			{
+			return callbackFunction==other.callbackFunction;
+			}
+		void call(CallbackData* callbackData) const
+			{
+			/* Call the callback function: */
+			callbackFunction(callbackData);
+			}
 		};
 	
 	/* Class to call C functions with an additional void* parameter (traditional C-style callback): */
-	class FunctionVoidArgCallback:public CallbackListItem
+	struct FunctionVoidArgCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -87,16 +80,26 @@ class CallbackList // Class for lists of callbacks
 		
 		/* Constructors and destructors: */
 		public:
-		FunctionVoidArgCallback(CallbackFunction sCallbackFunction,void* sUserData); // Creates callback for given function with given additional parameter
+		FunctionVoidArgCallback(CallbackFunction sCallbackFunction,void* sUserData) // Creates callback for given function with given additional parameter
+			:callbackFunction(sCallbackFunction),userData(sUserData)
+			{
+			}
 		
 		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const;
-		virtual void call(CallbackData* cbData) const;
+		bool operator==(const FunctionVoidArgCallback& other) const
+			{
+			return callbackFunction==other.callbackFunction&&userData==other.userData;
+			}
+		void call(CallbackData* callbackData) const
+			{
+			/* Call the callback function: */
+			callbackFunction(callbackData,userData);
+			}
 		};
 	
 	/* Class to call arbitrary methods on objects of arbitrary type: */
 	template <class CallbackClassParam>
-	class MethodCallback:public CallbackListItem
+	struct MethodCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -116,12 +119,11 @@ class CallbackList // Class for lists of callbacks
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const
+		bool operator==(const MethodCallback& other) const
 			{
-			const MethodCallback* other2=dynamic_cast<const MethodCallback*>(&other);
-			return other2!=0&&callbackObject==other2->callbackObject&&callbackMethod==other2->callbackMethod;
+			return callbackObject==other.callbackObject&&callbackMethod==other.callbackMethod;
 			}
-		virtual void call(CallbackData* callbackData) const
+		void call(CallbackData* callbackData) const
 			{
 			/* Call the callback method on the callback object: */
 			(callbackObject->*callbackMethod)(callbackData);
@@ -130,7 +132,7 @@ class CallbackList // Class for lists of callbacks
 	
 	/* Class to call arbitrary methods on objects of arbitrary type with an additional parameter of arbitrary type: */
 	template <class CallbackClassParam,class ParameterParam>
-	class MethodParameterCallback:public CallbackListItem
+	struct MethodParameterCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -152,12 +154,11 @@ class CallbackList // Class for lists of callbacks
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const
+		bool operator==(const MethodParameterCallback& other) const
 			{
-			const MethodParameterCallback* other2=dynamic_cast<const MethodParameterCallback*>(&other);
-			return other2!=0&&callbackObject==other2->callbackObject&&callbackMethod==other2->callbackMethod&&parameter==other2->parameter;
+			return callbackObject==other.callbackObject&&callbackMethod==other.callbackMethod&&parameter==other.parameter;
 			}
-		virtual void call(CallbackData* callbackData) const
+		void call(CallbackData* callbackData) const
 			{
 			/* Call the callback method on the callback object: */
 			(callbackObject->*callbackMethod)(callbackData,parameter);
@@ -166,7 +167,7 @@ class CallbackList // Class for lists of callbacks
 	
 	/* Class to call arbitrary methods taking a parameter derived from CallbackData on objects of arbitrary type: */
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
-	class MethodCastCallback:public CallbackListItem
+	struct MethodCastCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -187,12 +188,11 @@ class CallbackList // Class for lists of callbacks
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const
+		bool operator==(const MethodCastCallback& other) const
 			{
-			const MethodCastCallback* other2=dynamic_cast<const MethodCastCallback*>(&other);
-			return other2!=0&&callbackObject==other2->callbackObject&&callbackMethod==other2->callbackMethod;
+			return callbackObject==other.callbackObject&&callbackMethod==other.callbackMethod;
 			}
-		virtual void call(CallbackData* callbackData) const
+		void call(CallbackData* callbackData) const
 			{
 			/* Call the callback method on the callback object with downcasted callback data: */
 			(callbackObject->*callbackMethod)(static_cast<DerivedCallbackData*>(callbackData));
@@ -201,7 +201,7 @@ class CallbackList // Class for lists of callbacks
 	
 	/* Class to call arbitrary methods taking a parameter derived from CallbackData on objects of arbitrary type and an additional parameter of arbitrary type: */
 	template <class CallbackClassParam,class DerivedCallbackDataParam,class ParameterParam>
-	class MethodCastParameterCallback:public CallbackListItem
+	struct MethodCastParameterCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -224,28 +224,54 @@ class CallbackList // Class for lists of callbacks
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const CallbackListItem& other) const
+		bool operator==(const MethodCastParameterCallback& other) const
 			{
-			const MethodCastParameterCallback* other2=dynamic_cast<const MethodCastParameterCallback*>(&other);
-			return other2!=0&&callbackObject==other2->callbackObject&&callbackMethod==other2->callbackMethod&&parameter==other2->parameter;
+			return callbackObject==other.callbackObject&&callbackMethod==other.callbackMethod&&parameter==other.parameter;
 			}
-		virtual void call(CallbackData* callbackData) const
+		void call(CallbackData* callbackData) const
 			{
 			/* Call the callback method on the callback object with downcasted callback data and the additional parameter: */
 			(callbackObject->*callbackMethod)(static_cast<DerivedCallbackData*>(callbackData),parameter);
 			}
 		};
 	
+	typedef FlatCallback<CallbackData*> Callback; // Type for callbacks stored by value
+	
+	struct CallbackListItem // Structure for callback list items
+		{
+		/* Elements: */
+		public:
+		Callback callback; // The callback
+		bool removed; // Flag whether the callback was removed during a call() operation and must not be called anymore
+		
+		/* Constructors and destructors: */
+		CallbackListItem(const Callback& sCallback)
+			:callback(sCallback),removed(false)
+			{
+			}
+		};
+	
+	typedef std::vector<CallbackListItem> ItemList; // Type for contiguous lists of callback list items
+	typedef std::vector<Callback> CallbackVector; // Type for lists of callbacks
+	
+	class CallGuard; // Class to apply deferred changes when the outermost call() operation returns
+	friend class CallGuard;
+	
 	/* Elements: */
 	private:
-	CallbackListItem* head; // Pointer to first callback in list
-	CallbackListItem* tail; // Pointer to last callback in list
+	ItemList items; // List of callback list items in calling order; items removed during a call() operation stay in the list until the outermost call returns
+	CallbackVector frontAdditions; // Callbacks added to the front of the list during a call() operation, in order of addition
+	CallbackVector backAdditions; // Callbacks added to the end of the list during a call() operation, in order of addition
+	mutable unsigned int callDepth; // Number of active, possibly nested, call() operations
+	bool hasDeferredChanges; // Flag whether callbacks were added or removed during a call() operation
+	bool hasRemovedItems; // Flag whether items were removed during a call() operation
 	mutable bool interruptRequested; // Flag that the current call() operation is to be aborted after the current callback
 	
 	/* Private methods: */
-	void addCli(CallbackListItem* newCli); // Adds a new callback list item to the back of the list
-	void addCliToFront(CallbackListItem* newCli); // Adds a new callback list item to the front of the list
-	void removeCli(const CallbackListItem& removeCli); // Removes the first callback list item equal to the given one from the list
+	void addCallback(const Callback& newCallback); // Adds a new callback to the back of the list
+	void addCallbackToFront(const Callback& newCallback); // Adds a new callback to the front of the list
+	void removeCallback(const Callback& callback); // Removes the first callback equal to the given one from the list
+	void applyDeferredChanges(void); // Applies changes to the list that were made during call() operations
 	
 	/* Constructors and destructors: */
 	public:
@@ -263,101 +289,101 @@ class CallbackList // Class for lists of callbacks
 	/* Interface for C-style callbacks with no additional argument: */
 	void add(FunctionCallback::CallbackFunction newCallbackFunction) // Adds a callback to the end of the list
 		{
-		addCli(new FunctionCallback(newCallbackFunction));
+		addCallback(Callback(FunctionCallback(newCallbackFunction)));
 		}
 	void addToFront(FunctionCallback::CallbackFunction newCallbackFunction) // Adds a callback to the front of the list
 		{
-		addCliToFront(new FunctionCallback(newCallbackFunction));
+		addCallbackToFront(Callback(FunctionCallback(newCallbackFunction)));
 		}
 	void remove(FunctionCallback::CallbackFunction removeCallbackFunction) // Removes the first matching callback from the list
 		{
-		removeCli(FunctionCallback(removeCallbackFunction));
+		removeCallback(Callback(FunctionCallback(removeCallbackFunction)));
 		}
 	
 	/* Interface for traditional C-style callbacks (with void* argument): */
 	void add(FunctionVoidArgCallback::CallbackFunction newCallbackFunction,void* newUserData) // Adds a callback to the end of the list
 		{
-		addCli(new FunctionVoidArgCallback(newCallbackFunction,newUserData));
+		addCallback(Callback(FunctionVoidArgCallback(newCallbackFunction,newUserData)));
 		}
 	void addToFront(FunctionVoidArgCallback::CallbackFunction newCallbackFunction,void* newUserData) // Adds a callback to the front of the list
 		{
-		addCliToFront(new FunctionVoidArgCallback(newCallbackFunction,newUserData));
+		addCallbackToFront(Callback(FunctionVoidArgCallback(newCallbackFunction,newUserData)));
 		}
 	void remove(FunctionVoidArgCallback::CallbackFunction removeCallbackFunction,void* removeUserData) // Removes the first matching callback from the list
 		{
-		removeCli(FunctionVoidArgCallback(removeCallbackFunction,removeUserData));
+		removeCallback(Callback(FunctionVoidArgCallback(removeCallbackFunction,removeUserData)));
 		}
 	
 	/* Interface for method callbacks: */
 	template <class CallbackClassParam>
 	void add(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(CallbackData*)) // Adds a callback to the end of the list
 		{
-		addCli(new MethodCallback<CallbackClassParam>(newCallbackObject,newCallbackMethod));
+		addCallback(Callback(MethodCallback<CallbackClassParam>(newCallbackObject,newCallbackMethod)));
 		}
 	template <class CallbackClassParam>
 	void addToFront(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(CallbackData*)) // Adds a callback to the front of the list
 		{
-		addCliToFront(new MethodCallback<CallbackClassParam>(newCallbackObject,newCallbackMethod));
+		addCallbackToFront(Callback(MethodCallback<CallbackClassParam>(newCallbackObject,newCallbackMethod)));
 		}
 	template <class CallbackClassParam>
 	void remove(CallbackClassParam* removeCallbackObject,void (CallbackClassParam::*removeCallbackMethod)(CallbackData*)) // Removes the first matching callback from the list
 		{
-		removeCli(MethodCallback<CallbackClassParam>(removeCallbackObject,removeCallbackMethod));
+		removeCallback(Callback(MethodCallback<CallbackClassParam>(removeCallbackObject,removeCallbackMethod)));
 		}
 	
 	/* Interface for method callbacks with additional parameter: */
 	template <class CallbackClassParam,class ParameterParam>
 	void add(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(CallbackData*,const ParameterParam&),const ParameterParam& newParameter) // Adds a callback to the end of the list
 		{
-		addCli(new MethodParameterCallback<CallbackClassParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter));
+		addCallback(Callback(MethodParameterCallback<CallbackClassParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter)));
 		}
 	template <class CallbackClassParam,class ParameterParam>
 	void addToFront(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(CallbackData*,const ParameterParam&),const ParameterParam& newParameter) // Adds a callback to the front of the list
 		{
-		addCliToFront(new MethodParameterCallback<CallbackClassParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter));
+		addCallbackToFront(Callback(MethodParameterCallback<CallbackClassParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter)));
 		}
 	template <class CallbackClassParam,class ParameterParam>
 	void remove(CallbackClassParam* removeCallbackObject,void (CallbackClassParam::*removeCallbackMethod)(CallbackData*,const ParameterParam&),const ParameterParam& removeParameter) // Removes the first matching callback from the list
 		{
-		removeCli(MethodParameterCallback<CallbackClassParam,ParameterParam>(removeCallbackObject,removeCallbackMethod,removeParameter));
+		removeCallback(Callback(MethodParameterCallback<CallbackClassParam,ParameterParam>(removeCallbackObject,removeCallbackMethod,removeParameter)));
 		}
 	
 	/* Interface for method callbacks with automatic callback data downcast: */
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
 	void add(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(DerivedCallbackDataParam*)) // Adds a callback to the end of the list
 		{
-		addCli(new MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(newCallbackObject,newCallbackMethod));
+		addCallback(Callback(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(newCallbackObject,newCallbackMethod)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
 	void addToFront(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(DerivedCallbackDataParam*)) // Adds a callback to the front of the list
 		{
-		addCliToFront(new MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(newCallbackObject,newCallbackMethod));
+		addCallbackToFront(Callback(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(newCallbackObject,newCallbackMethod)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
 	void remove(CallbackClassParam* removeCallbackObject,void (CallbackClassParam::*removeCallbackMethod)(DerivedCallbackDataParam*)) // Removes the first matching callback from the list
 		{
-		removeCli(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(removeCallbackObject,removeCallbackMethod));
+		removeCallback(Callback(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(removeCallbackObject,removeCallbackMethod)));
 		}
 	
 	/* Interface for method callbacks with automatic callback data downcast and additional parameter: */
 	template <class CallbackClassParam,class DerivedCallbackDataParam,class ParameterParam>
 	void add(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(DerivedCallbackDataParam*,const ParameterParam&),const ParameterParam& newParameter) // Adds a callback to the end of the list
 		{
-		addCli(new MethodCastParameterCallback<CallbackClassParam,DerivedCallbackDataParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter));
+		addCallback(Callback(MethodCastParameterCallback<CallbackClassParam,DerivedCallbackDataParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam,class ParameterParam>
 	void addToFront(CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(DerivedCallbackDataParam*,const ParameterParam&),const ParameterParam& newParameter) // Adds a callback to the front of the list
 		{
-		addCliToFront(new MethodCastParameterCallback<CallbackClassParam,DerivedCallbackDataParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter));
+		addCallbackToFront(Callback(MethodCastParameterCallback<CallbackClassParam,DerivedCallbackDataParam,ParameterParam>(newCallbackObject,newCallbackMethod,newParameter)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam,class ParameterParam>
 	void remove(CallbackClassParam* removeCallbackObject,void (CallbackClassParam::*removeCallbackMethod)(DerivedCallbackDataParam*,const ParameterParam&),const ParameterParam& removeParameter) // Removes the first matching callback from the list
 		{
-		removeCli(MethodCastParameterCallback<CallbackClassParam,DerivedCallbackDataParam,ParameterParam>(removeCallbackObject,removeCallbackMethod,removeParameter));
+		removeCallback(Callback(MethodCastParameterCallback<CallbackClassParam,DerivedCallbackDataParam,ParameterParam>(removeCallbackObject,removeCallbackMethod,removeParameter)));
 		}
 	
 	/* Callback list calling interface: */
-	void call(CallbackData* callbackData) const; // Calls all callbacks in the list
+	void call(CallbackData* callbackData) const; // Calls all callbacks in the list; callbacks added or removed by called callbacks take effect when the outermost call returns
 	void requestInterrupt(void) const; // Allows a callback to request interrupting callback processing
 	};
 
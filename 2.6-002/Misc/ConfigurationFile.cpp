@@ -1,7 +1,7 @@
 /***********************************************************************
 ConfigurationFile - Class to handle permanent storage of configuration
 data in human-readable text files.
-Copyright (c) 2002-2012 Oliver Kreylos
+Copyright (c) 2002-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -24,11 +24,116 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/ConfigurationFile.h>
 
 #include <ctype.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
 #include <Misc/File.h>
+#include <Misc/MemMappedFile.h>
+#include <Misc/StringMarshaller.h>
 #include <Misc/StandardValueCoders.h>
 
 namespace Misc {
 
+namespace {
+
+/***********************************************************************
+Helper functions to maintain compiled configuration files:
+***********************************************************************/
+
+const char* compiledFileHeader="Vrui Compiled Configuration v1.0\n"; // Identifying header of compiled configuration files
+const size_t compiledFileHeaderSize=33;
+
+/***********************************************************************
+Number of subsections or tag/value pairs above which a section indexes
+them in a hash table; smaller sections are searched linearly:
+***********************************************************************/
+
+const unsigned int sectionIndexThreshold=8;
+
+void getSourceStamp(const char* sourceFileName,UInt64 sourceStamp[5]) // Identifies the current state of a source file by its identity, size, and modification time; all zero if the file does not exist
+	{
+	struct stat statBuffer;
+	if(stat(sourceFileName,&statBuffer)==0)
+		{
+		sourceStamp[0]=UInt64(statBuffer.st_dev);
+		sourceStamp[1]=UInt64(statBuffer.st_ino);
+		sourceStamp[2]=UInt64(statBuffer.st_size);
+		sourceStamp[3]=UInt64(statBuffer.st_mtime);
+		#ifdef __APPLE__
+		sourceStamp[4]=UInt64(statBuffer.st_mtimespec.tv_nsec);
+		#else
+		sourceStamp[4]=UInt64(statBuffer.st_mtim.tv_nsec);
+		#endif
+		}
+	else
+		{
+		for(int i=0;i<5;++i)
+			sourceStamp[i]=0;
+		}
+	}
+
+void checkCompiledString(MemMappedFile& file,size_t fileSize) // Skips a string in a compiled configuration file; throws an exception if its length exceeds the rest of the file
+	{
+	unsigned int length=file.read<unsigned int>();
+	if(length!=~0x0U) // Look for the null-pointer string magic number
+		{
+		if(size_t(length)>fileSize-size_t(file.tell()))
+			throwStdErr("Misc::ConfigurationFile: String length %u exceeds the size of the compiled configuration file",length);
+		file.seekCurrent(MemMappedFile::Offset(length));
+		}
+	}
+
+void checkCompiledCount(unsigned int count,size_t minItemSize,MemMappedFile& file,size_t fileSize) // Throws an exception if the given number of items of the given minimum size does not fit into the rest of a compiled configuration file
+	{
+	if(size_t(count)>(fileSize-size_t(file.tell()))/minItemSize)
+		throwStdErr("Misc::ConfigurationFile: Item count %u exceeds the size of the compiled configuration file",count);
+	}
+
+void checkCompiledSection(MemMappedFile& file,size_t fileSize) // Skips a section and its subsections in a compiled configuration file; throws an exception if any length or count exceeds the rest of the file
+	{
+	/* Skip the section name: */
+	checkCompiledString(file,fileSize);
+	
+	/* Skip all subsections, each of which stores at least a name length and two counts: */
+	unsigned int numSubsections=file.read<unsigned int>();
+	checkCompiledCount(numSubsections,3*sizeof(unsigned int),file,fileSize);
+	for(unsigned int i=0;i<numSubsections;++i)
+		checkCompiledSection(file,fileSize);
+	
+	/* Skip all tag/value pairs, each of which stores at least two string lengths: */
+	unsigned int numTagValuePairs=file.read<unsigned int>();
+	checkCompiledCount(numTagValuePairs,2*sizeof(unsigned int),file,fileSize);
+	for(unsigned int i=0;i<numTagValuePairs;++i)
+		{
+		checkCompiledString(file,fileSize);
+		checkCompiledString(file,fileSize);
+		}
+	}
+
+void checkCompiledFile(MemMappedFile& file,size_t fileSize) // Skips the contents of a compiled configuration file after its header; throws an exception if any length or count exceeds the rest of the file, so that corrupted files cannot cause huge allocations
+	{
+	/* Skip the names and stamps of the source files: */
+	unsigned int numSourceFiles=file.read<unsigned int>();
+	checkCompiledCount(numSourceFiles,sizeof(unsigned int)+5*sizeof(UInt64),file,fileSize);
+	for(unsigned int i=0;i<numSourceFiles;++i)
+		{
+		checkCompiledString(file,fileSize);
+		file.seekCurrent(MemMappedFile::Offset(5*sizeof(UInt64)));
+		}
+	
+	/* Skip the file name and the root section: */
+	checkCompiledString(file,fileSize);
+	checkCompiledSection(file,fileSize);
+	}
+
+}
+
 /****************************************************************
 Methods of class ConfigurationFileBase::MalFormedConfigFileError:
 ****************************************************************/
@@ -64,6 +169,7 @@ ConfigurationFileBase::Section::Section(ConfigurationFileBase::Section* sParent,
 	:parent(sParent),name(sName),
 	 sibling(0),
 	 firstSubsection(0),lastSubsection(0),
+	 numSubsections(0),subsectionMap(0),numValues(0),tagMap(0),
 	 edited(false)
 	{
 	}
@@ -77,6 +183,114 @@ ConfigurationFileBase::Section::~Section(void)
 		delete firstSubsection;
 		firstSubsection=next;
 		}
+	
+	/* Delete the indices: */
+	delete subsectionMap;
+	delete tagMap;
+	}
+
+void ConfigurationFileBase::Section::indexSubsections(void)
+	{
+	/* Enter all subsections into a new subsection map: */
+	subsectionMap=new SubsectionMap(numSubsections*2);
+	for(Section* sPtr=firstSubsection;sPtr!=0;sPtr=sPtr->sibling)
+		subsectionMap->setEntry(SubsectionMap::Entry(sPtr->name,sPtr));
+	}
+
+void ConfigurationFileBase::Section::indexTags(void)
+	{
+	/* Enter all tag/value pairs into a new tag map: */
+	tagMap=new TagMap(numValues*2);
+	for(std::list<TagValue>::iterator tvIt=values.begin();tvIt!=values.end();++tvIt)
+		tagMap->setEntry(TagMap::Entry(tvIt->tag,tvIt));
+	}
+
+ConfigurationFileBase::Section* ConfigurationFileBase::Section::findSubsection(const std::string& subsectionName) const
+	{
+	if(subsectionMap!=0)
+		{
+		/* Look up the subsection in the subsection map: */
+		SubsectionMap::Iterator smIt=subsectionMap->findEntry(subsectionName);
+		return smIt.isFinished()?0:smIt->getDest();
+		}
+	else
+		{
+		/* Search the subsection list: */
+		Section* sPtr;
+		for(sPtr=firstSubsection;sPtr!=0&&sPtr->name!=subsectionName;sPtr=sPtr->sibling)
+			;
+		return sPtr;
+		}
+	}
+
+std::list<ConfigurationFileBase::Section::TagValue>::iterator ConfigurationFileBase::Section::findTag(const std::string& tag)
+	{
+	if(tagMap!=0)
+		{
+		/* Look up the tag name in the tag map: */
+		TagMap::Iterator tmIt=tagMap->findEntry(tag);
+		return tmIt.isFinished()?values.end():tmIt->getDest();
+		}
+	else
+		{
+		/* Search the value list: */
+		std::list<TagValue>::iterator tvIt;
+		for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=tag;++tvIt)
+			;
+		return tvIt;
+		}
+	}
+
+const ConfigurationFileBase::Section::TagValue* ConfigurationFileBase::Section::findTagValue(const std::string& tag) const
+	{
+	if(tagMap!=0)
+		{
+		/* Look up the tag name in the tag map: */
+		TagMap::Iterator tmIt=tagMap->findEntry(tag);
+		return tmIt.isFinished()?0:&*tmIt->getDest();
+		}
+	else
+		{
+		/* Search the value list: */
+		std::list<TagValue>::const_iterator tvIt;
+		for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=tag;++tvIt)
+			;
+		return tvIt!=values.end()?&*tvIt:0;
+		}
+	}
+
+void ConfigurationFileBase::Section::linkSubsection(ConfigurationFileBase::Section* newSubsection)
+	{
+	/* Append the subsection to the subsection list: */
+	if(lastSubsection!=0)
+		lastSubsection->sibling=newSubsection;
+	else
+		firstSubsection=newSubsection;
+	lastSubsection=newSubsection;
+	++numSubsections;
+	
+	/* Add the subsection to the subsection map, or create the map once there are many subsections: */
+	if(subsectionMap!=0)
+		subsectionMap->setEntry(SubsectionMap::Entry(newSubsection->name,newSubsection));
+	else if(numSubsections>sectionIndexThreshold)
+		indexSubsections();
+	}
+
+void ConfigurationFileBase::Section::appendTagValue(const std::string& newTag,const std::string& newValue)
+	{
+	/* Append the tag/value pair to the value list: */
+	values.push_back(TagValue(newTag,newValue));
+	++numValues;
+	
+	/* Add the tag/value pair to the tag map, or create the map once there are many tag/value pairs: */
+	if(tagMap!=0)
+		{
+		std::list<TagValue>::iterator tvIt=values.end();
+		--tvIt;
+		tagMap->setEntry(TagMap::Entry(newTag,tvIt));
+		}
+	else if(numValues>sectionIndexThreshold)
+		indexTags();
 	}
 
 void ConfigurationFileBase::Section::clear(void)
@@ -89,9 +303,15 @@ void ConfigurationFileBase::Section::clear(void)
 		firstSubsection=succ;
 		}
 	lastSubsection=0;
+	numSubsections=0;
+	delete subsectionMap;
+	subsectionMap=0;
 	
 	/* Remove all tag/value pairs: */
 	values.clear();
+	numValues=0;
+	delete tagMap;
+	tagMap=0;
 	
 	/* Mark the section as edited: */
 	edited=true;
@@ -100,20 +320,13 @@ void ConfigurationFileBase::Section::clear(void)
 ConfigurationFileBase::Section* ConfigurationFileBase::Section::addSubsection(const std::string& subsectionName)
 	{
 	/* Check if the subsection already exists: */
-	Section* sPtr;
-	for(sPtr=firstSubsection;sPtr!=0;sPtr=sPtr->sibling)
-		if(sPtr->name==subsectionName)
-			break;
+	Section* sPtr=findSubsection(subsectionName);
 	
 	if(sPtr==0)
 		{
 		/* Add new subsection: */
 		Section* newSubsection=new Section(this,subsectionName);
-		if(lastSubsection!=0)
-			lastSubsection->sibling=newSubsection;
-		else
-			firstSubsection=newSubsection;
-		lastSubsection=newSubsection;
+		linkSubsection(newSubsection);
 		
 		/* Mark the section as edited: */
 		edited=true;
@@ -140,6 +353,9 @@ void ConfigurationFileBase::Section::removeSubsection(const std::string& subsect
 			firstSubsection=sPtr->sibling;
 		if(sPtr->sibling==0)
 			lastSubsection=sPred;
+		--numSubsections;
+		if(subsectionMap!=0)
+			subsectionMap->removeEntry(subsectionName);
 		delete sPtr;
 		
 		/* Mark the section as edited: */
@@ -150,15 +366,13 @@ void ConfigurationFileBase::Section::removeSubsection(const std::string& subsect
 void ConfigurationFileBase::Section::addTagValue(const std::string& newTag,const std::string& newValue)
 	{
 	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::iterator tvIt;
-	for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=newTag;++tvIt)
-		;
+	std::list<TagValue>::iterator tvIt=findTag(newTag);
 	
 	/* Set tag value: */
 	if(tvIt==values.end())
 		{
 		/* Add a new tag/value pair: */
-		values.push_back(TagValue(newTag,newValue));
+		appendTagValue(newTag,newValue);
 		}
 	else
 		{
@@ -173,15 +387,16 @@ void ConfigurationFileBase::Section::addTagValue(const std::string& newTag,const
 void ConfigurationFileBase::Section::removeTag(const std::string& tag)
 	{
 	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::iterator tvIt;
-	for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=tag;++tvIt)
-		;
+	std::list<TagValue>::iterator tvIt=findTag(tag);
 	
 	/* Check if the tag was found: */
 	if(tvIt!=values.end())
 		{
 		/* Remove tag/value pair: */
+		if(tagMap!=0)
+			tagMap->removeEntry(tag);
 		values.erase(tvIt);
+		--numValues;
 		}
 	
 	/* Mark the section as edited: */
@@ -321,9 +536,7 @@ const ConfigurationFileBase::Section* ConfigurationFileBase::Section::getSection
 			{
 			/* Find subsection name in current section: */
 			std::string subsectionName(pathSuffixPtr,nextSlashPtr-pathSuffixPtr);
-			Section* ssPtr;
-			for(ssPtr=sPtr->firstSubsection;ssPtr!=0&&ssPtr->name!=subsectionName;ssPtr=ssPtr->sibling)
-				;
+			Section* ssPtr=sPtr->findSubsection(subsectionName);
 			
 			/* Go down in the section hierarchy: */
 			if(ssPtr==0)
@@ -408,11 +621,7 @@ bool ConfigurationFileBase::Section::hasTag(const char* relativeTagPath) const
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
 	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
-	
-	return tvIt!=sPtr->values.end();
+	return sPtr->findTagValue(tagName)!=0;
 	}
 
 const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath) const
@@ -422,14 +631,12 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
 	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	const TagValue* tv=sPtr->findTagValue(tagName);
 	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tv==0)
 		throw TagNotFoundError(tagName,sPtr->getPath());
-	return tvIt->value;
+	return tv->value;
 	}
 
 std::string ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath,const std::string& defaultValue) const
@@ -448,14 +655,12 @@ std::string ConfigurationFileBase::Section::retrieveTagValue(const char* relativ
 		}
 	
 	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
-
+	const TagValue* tv=sPtr->findTagValue(tagName);
+	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tv==0)
 		throw TagNotFoundError(tagName,sPtr->getPath());
-	return tvIt->value;
+	return tv->value;
 	}
 
 const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath,const std::string& defaultValue)
@@ -465,15 +670,13 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 	Section* sPtr=getSection(relativeTagPath,&tagName);
 	
 	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	const TagValue* tv=sPtr->findTagValue(tagName);
 	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tv==0)
 		{
 		/* Add a new tag/value pair: */
-		sPtr->values.push_back(TagValue(tagName,defaultValue));
+		sPtr->appendTagValue(tagName,defaultValue);
 		
 		/* Mark section as edited: */
 		sPtr->edited=true;
@@ -481,7 +684,7 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 		return defaultValue;
 		}
 	else
-		return tvIt->value;
+		return tv->value;
 	}
 
 void ConfigurationFileBase::Section::storeTagValue(const char* relativeTagPath,const std::string& newValue)
@@ -686,6 +889,117 @@ void ConfigurationFileBase::saveAs(const char* newFileName)
 	rootSection->save(file,0);
 	}
 
+bool ConfigurationFileBase::loadCompiled(const char* compiledFileName,int numSourceFiles,const char* const sourceFileNames[])
+	{
+	/* Open and map the compiled file: */
+	int fd=open(compiledFileName,O_RDONLY);
+	if(fd<0)
+		return false;
+	struct stat statBuffer;
+	void* map=MAP_FAILED;
+	if(fstat(fd,&statBuffer)==0&&statBuffer.st_size>off_t(compiledFileHeaderSize))
+		map=mmap(0,size_t(statBuffer.st_size),PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if(map==MAP_FAILED)
+		return false;
+	
+	bool result=false;
+	Section* newRootSection=0;
+	try
+		{
+		MemMappedFile file(static_cast<const unsigned char*>(map),size_t(statBuffer.st_size),MemMappedFile::LittleEndian);
+		
+		/* Check the file header: */
+		char header[compiledFileHeaderSize];
+		file.readRaw(header,compiledFileHeaderSize);
+		if(memcmp(header,compiledFileHeader,compiledFileHeaderSize)!=0)
+			throw std::runtime_error("Not a compiled configuration file");
+		
+		/* Check all lengths and counts in the file before reading anything that allocates memory: */
+		MemMappedFile::Offset contentsStart=file.tell();
+		checkCompiledFile(file,size_t(statBuffer.st_size));
+		file.seekSet(contentsStart);
+		
+		/* Check that the file was compiled from the given source files in their current state: */
+		bool upToDate=int(file.read<unsigned int>())==numSourceFiles;
+		for(int i=0;i<numSourceFiles&&upToDate;++i)
+			{
+			upToDate=readCppString(file)==sourceFileNames[i];
+			UInt64 compiledStamp[5],sourceStamp[5];
+			file.read(compiledStamp,5);
+			getSourceStamp(sourceFileNames[i],sourceStamp);
+			for(int j=0;j<5;++j)
+				upToDate=upToDate&&compiledStamp[j]==sourceStamp[j];
+			}
+		
+		if(upToDate)
+			{
+			/* Read the file name and root section: */
+			std::string newFileName=readCppString(file);
+			newRootSection=new Section(0,file);
+			if(!file.eof())
+				throw std::runtime_error("Extra data in compiled configuration file");
+			
+			/* Install the new configuration: */
+			delete rootSection;
+			rootSection=newRootSection;
+			newRootSection=0;
+			fileName=newFileName;
+			rootSection->clearEditFlag();
+			result=true;
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Treat corrupted compiled files as out of date: */
+		delete newRootSection;
+		}
+	
+	munmap(map,size_t(statBuffer.st_size));
+	return result;
+	}
+
+void ConfigurationFileBase::saveCompiled(const char* compiledFileName,int numSourceFiles,const char* const sourceFileNames[]) const
+	{
+	/* Write to a temporary file first, so that concurrent readers never see a partial file: */
+	std::string tempFileName=compiledFileName;
+	tempFileName.append(".");
+	tempFileName.append(ValueCoder<int>::encode(int(getpid())));
+	try
+		{
+		File file(tempFileName.c_str(),"wb",File::LittleEndian);
+		
+		/* Write the file header: */
+		file.writeRaw(compiledFileHeader,compiledFileHeaderSize);
+		
+		/* Write the names and stamps of the source files: */
+		file.write<unsigned int>(numSourceFiles);
+		for(int i=0;i<numSourceFiles;++i)
+			{
+			writeCppString(std::string(sourceFileNames[i]),file);
+			UInt64 sourceStamp[5];
+			getSourceStamp(sourceFileNames[i],sourceStamp);
+			file.write(sourceStamp,5);
+			}
+		
+		/* Write the configuration in the same format used to send it through pipes: */
+		writeToPipe(file);
+		}
+	catch(...)
+		{
+		/* Remove the partial temporary file and re-throw the exception: */
+		unlink(tempFileName.c_str());
+		throw;
+		}
+	
+	/* Replace the compiled file: */
+	if(rename(tempFileName.c_str(),compiledFileName)!=0)
+		{
+		unlink(tempFileName.c_str());
+		throw File::OpenError(compiledFileName,"wb");
+		}
+	}
+
 /*****************************************
 Methods of class ConfigurationFileSection:
 *****************************************/
@@ -733,6 +1047,17 @@ void ConfigurationFile::load(const char* newFileName)
 	baseSection=rootSection;
 	}
 
+bool ConfigurationFile::loadCompiled(const char* compiledFileName,int numSourceFiles,const char* const sourceFileNames[])
+	{
+	/* Call base class method: */
+	if(!ConfigurationFileBase::loadCompiled(compiledFileName,numSourceFiles,sourceFileNames))
+		return false;
+	
+	/* Reset the current section pointer to the root section: */
+	baseSection=rootSection;
+	return true;
+	}
+
 std::string ConfigurationFile::getCurrentPath(void) const
 	{
 	return baseSection->getPath();
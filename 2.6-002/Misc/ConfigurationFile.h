@@ -1,7 +1,7 @@
 /***********************************************************************
 ConfigurationFile - Class to handle permanent storage of configuration
 data in human-readable text files.
-Copyright (c) 2002-2012 Oliver Kreylos
+Copyright (c) 2002-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -27,6 +27,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <list>
 #include <stdexcept>
 #include <string>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/OpenHashTable.h>
 #include <Misc/ValueCoder.h>
 
 /* Forward declarations: */
@@ -85,13 +87,20 @@ class ConfigurationFileBase
 				}
 			};
 		
+		typedef OpenHashTable<std::string,Section*> SubsectionMap; // Hash table type to find subsections by name
+		typedef OpenHashTable<std::string,std::list<TagValue>::iterator> TagMap; // Hash table type to find tag/value pairs by tag name
+		
 		/* Elements: */
 		Section* parent; // Pointer to parent section (null if root section)
 		std::string name; // Section name
 		Section* sibling; // Pointer to next section under common parent
 		Section* firstSubsection; // Pointer to first subsection
 		Section* lastSubsection; // Pointer to last subsection
+		unsigned int numSubsections; // Number of subsections
+		SubsectionMap* subsectionMap; // Map from subsection names to subsections; created when a section gains many subsections, so that lookups never modify the section
 		std::list<TagValue> values; // List of values in this section
+		unsigned int numValues; // Number of tag/value pairs in the value list
+		TagMap* tagMap; // Map from tag names to tag/value pairs in the value list; created when a section gains many tag/value pairs
 		bool edited; // Flag if the section has been changed since the last save
 		
 		/* Constructors and destructors: */
@@ -100,7 +109,16 @@ class ConfigurationFileBase
 		Section(Section* sParent,PipeParam& pipe); // Reads a section and its subsections from a pipe
 		~Section(void);
 		
+		/* Private methods: */
+		void indexSubsections(void); // Creates the subsection map
+		void indexTags(void); // Creates the tag map
+		
 		/* Methods: */
+		Section* findSubsection(const std::string& subsectionName) const; // Returns the subsection of the given name, or null
+		std::list<TagValue>::iterator findTag(const std::string& tag); // Returns an iterator to the tag/value pair of the given tag name, or the end of the value list
+		const TagValue* findTagValue(const std::string& tag) const; // Returns the tag/value pair of the given tag name, or null
+		void linkSubsection(Section* newSubsection); // Appends a new subsection to the section's subsection list
+		void appendTagValue(const std::string& newTag,const std::string& newValue); // Appends a tag/value pair whose tag does not exist yet to the section's value list
 		void clear(void); // Removes all subsections and tag/value pairs from the section
 		Section* addSubsection(const std::string& subsectionName); // Adds a subsection to a section
 		void removeSubsection(const std::string& subsectionName); // Removes the given subsection from the section; does nothing if subsection does not exist
@@ -362,6 +380,8 @@ class ConfigurationFileBase
 	void readFromPipe(PipeParam& pipe); // Reads a configuration file from a pipe
 	template <class PipeParam>
 	void writeToPipe(PipeParam& pipe) const; // Writes the in-memory representation of the configuration file to a pipe
+	bool loadCompiled(const char* compiledFileName,int numSourceFiles,const char* const sourceFileNames[]); // Replaces the configuration with the contents of a compiled configuration file if that file was compiled from the given source files in their current state; returns false and leaves the configuration unchanged otherwise
+	void saveCompiled(const char* compiledFileName,int numSourceFiles,const char* const sourceFileNames[]) const; // Saves the current in-memory state in compiled binary form, stamped with the current state of the given source files
 	
 	/* Section iterator management methods: */
 	SectionIterator getRootSection(void) // Returns iterator to root section
@@ -426,6 +446,7 @@ class ConfigurationFile:public ConfigurationFileBase,public ConfigurationFileBas
 	
 	/* Overloaded methods from ConfigurationFileBase: */
 	void load(const char* newFileName); // Loads contents of given configuration file, and resets current section to new root section
+	bool loadCompiled(const char* compiledFileName,int numSourceFiles,const char* const sourceFileNames[]); // Loads contents of given compiled configuration file if it is up to date, and resets current section to new root section
 	void reload(void) // Reloads contents of original configuration file, and resets current section to root section
 		{
 		load(fileName.c_str());
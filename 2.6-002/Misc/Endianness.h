@@ -1,7 +1,7 @@
 /***********************************************************************
 Endianness - Helper functions to deal with endianness conversion of
 basic data types (extensible via template specialization mechanism).
-Copyright (c) 2001-2005 Oliver Kreylos
+Copyright (c) 2001-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -25,6 +25,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define MISC_ENDIANNESS_INCLUDED
 
 #include <stddef.h>
+#include <string.h>
+#include <Misc/SizedTypes.h>
 #ifdef __APPLE__
 #include <machine/endian.h>
 #define __BIG_ENDIAN __DARWIN_BIG_ENDIAN
@@ -44,6 +46,181 @@ enum Endianness // Enumerated type to select endianness types
 	BigEndian // Data has big endianness
 	};
 
+/***********************************************************************
+Helper classes to reverse the byte order of arrays of values of a given
+size. Values are accessed through memcpy, so that arrays do not have to
+be aligned, and the loops for 2, 4, and 8-byte values compile to one
+byte swap instruction per value or to vector code.
+***********************************************************************/
+
+template <size_t sizeParam>
+class ByteReverser
+	{
+	/* Methods: */
+	public:
+	static void reverse(void* values,size_t numValues) // Reverses the byte order of an array of values in-place
+		{
+		unsigned char* vPtr=static_cast<unsigned char*>(values);
+		for(size_t i=0;i<numValues;++i,vPtr+=sizeParam)
+			{
+			/* Swap value byte by byte: */
+			size_t i1,i2;
+			for(i1=0,i2=sizeParam-1;i1<i2;++i1,--i2)
+				{
+				unsigned char temp=vPtr[i1];
+				vPtr[i1]=vPtr[i2];
+				vPtr[i2]=temp;
+				}
+			}
+		}
+	static void copyReverse(const void* source,void* dest,size_t numValues) // Copies an array of values to a non-overlapping destination while reversing their byte order
+		{
+		const unsigned char* sPtr=static_cast<const unsigned char*>(source);
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numValues;++i,sPtr+=sizeParam,dPtr+=sizeParam)
+			for(size_t j=0;j<sizeParam;++j)
+				dPtr[j]=sPtr[sizeParam-1-j];
+		}
+	};
+
+template <>
+class ByteReverser<1>
+	{
+	/* Methods: */
+	public:
+	static void reverse(void*,size_t)
+		{
+		/* Dummy function - no need to swap bytes! */
+		}
+	static void copyReverse(const void* source,void* dest,size_t numValues)
+		{
+		memcpy(dest,source,numValues);
+		}
+	};
+
+template <>
+class ByteReverser<2>
+	{
+	/* Private methods: */
+	private:
+	static UInt16 reverseValue(UInt16 value)
+		{
+		return UInt16((value>>8)|(value<<8));
+		}
+	
+	/* Methods: */
+	public:
+	static void reverse(void* values,size_t numValues)
+		{
+		unsigned char* vPtr=static_cast<unsigned char*>(values);
+		for(size_t i=0;i<numValues;++i)
+			{
+			UInt16 value;
+			memcpy(&value,vPtr+i*2,2);
+			value=reverseValue(value);
+			memcpy(vPtr+i*2,&value,2);
+			}
+		}
+	static void copyReverse(const void* source,void* dest,size_t numValues)
+		{
+		const unsigned char* sPtr=static_cast<const unsigned char*>(source);
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numValues;++i)
+			{
+			UInt16 value;
+			memcpy(&value,sPtr+i*2,2);
+			value=reverseValue(value);
+			memcpy(dPtr+i*2,&value,2);
+			}
+		}
+	};
+
+template <>
+class ByteReverser<4>
+	{
+	/* Private methods: */
+	private:
+	static UInt32 reverseValue(UInt32 value)
+		{
+		#if defined(__GNUC__)&&(__GNUC__>4||(__GNUC__==4&&__GNUC_MINOR__>=3))
+		return __builtin_bswap32(value);
+		#else
+		return (value>>24)|((value>>8)&0x0000ff00U)|((value<<8)&0x00ff0000U)|(value<<24);
+		#endif
+		}
+	
+	/* Methods: */
+	public:
+	static void reverse(void* values,size_t numValues)
+		{
+		unsigned char* vPtr=static_cast<unsigned char*>(values);
+		for(size_t i=0;i<numValues;++i)
+			{
+			UInt32 value;
+			memcpy(&value,vPtr+i*4,4);
+			value=reverseValue(value);
+			memcpy(vPtr+i*4,&value,4);
+			}
+		}
+	static void copyReverse(const void* source,void* dest,size_t numValues)
+		{
+		const unsigned char* sPtr=static_cast<const unsigned char*>(source);
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numValues;++i)
+			{
+			UInt32 value;
+			memcpy(&value,sPtr+i*4,4);
+			value=reverseValue(value);
+			memcpy(dPtr+i*4,&value,4);
+			}
+		}
+	};
+
+template <>
+class ByteReverser<8>
+	{
+	/* Private methods: */
+	private:
+	static UInt64 reverseValue(UInt64 value)
+		{
+		#if defined(__GNUC__)&&(__GNUC__>4||(__GNUC__==4&&__GNUC_MINOR__>=3))
+		return __builtin_bswap64(value);
+		#else
+		UInt32 low=UInt32(value);
+		UInt32 high=UInt32(value>>32);
+		low=(low>>24)|((low>>8)&0x0000ff00U)|((low<<8)&0x00ff0000U)|(low<<24);
+		high=(high>>24)|((high>>8)&0x0000ff00U)|((high<<8)&0x00ff0000U)|(high<<24);
+		return (UInt64(low)<<32)|UInt64(high);
+		#endif
+		}
+	
+	/* Methods: */
+	public:
+	static void reverse(void* values,size_t numValues)
+		{
+		unsigned char* vPtr=static_cast<unsigned char*>(values);
+		for(size_t i=0;i<numValues;++i)
+			{
+			UInt64 value;
+			memcpy(&value,vPtr+i*8,8);
+			value=reverseValue(value);
+			memcpy(vPtr+i*8,&value,8);
+			}
+		}
+	static void copyReverse(const void* source,void* dest,size_t numValues)
+		{
+		const unsigned char* sPtr=static_cast<const unsigned char*>(source);
+		unsigned char* dPtr=static_cast<unsigned char*>(dest);
+		for(size_t i=0;i<numValues;++i)
+			{
+			UInt64 value;
+			memcpy(&value,sPtr+i*8,8);
+			value=reverseValue(value);
+			memcpy(dPtr+i*8,&value,8);
+			}
+		}
+	};
+
 /****************************************************************
 Helper class to allow partial specialization of endianness
 swapper:
@@ -56,34 +233,18 @@ class EndiannessSwapper
 	public:
 	static void swap(ValueParam& value)
 		{
-		/* Treat value as array of bytes: */
-		unsigned char* bytes=reinterpret_cast<unsigned char*>(&value);
-		
-		/* Swap value byte by byte: */
-		size_t i1,i2;
-		for(i1=0,i2=sizeof(ValueParam)-1;i1<i2;++i1,--i2)
-			{
-			unsigned char temp=bytes[i1];
-			bytes[i1]=bytes[i2];
-			bytes[i2]=temp;
-			}
+		/* Reverse the value's bytes: */
+		ByteReverser<sizeof(ValueParam)>::reverse(&value,1);
 		}
 	static void swap(ValueParam* values,size_t numValues)
 		{
-		for(size_t i=0;i<numValues;++i)
-			{
-			/* Treat value as array of bytes: */
-			unsigned char* bytes=reinterpret_cast<unsigned char*>(values+i);
-			
-			/* Swap value byte by byte: */
-			size_t i1,i2;
-			for(i1=0,i2=sizeof(ValueParam)-1;i1<i2;++i1,--i2)
-				{
-				unsigned char temp=bytes[i1];
-				bytes[i1]=bytes[i2];
-				bytes[i2]=temp;
-				}
-			}
+		/* Reverse the bytes of all values: */
+		ByteReverser<sizeof(ValueParam)>::reverse(values,numValues);
+		}
+	static void copySwap(const ValueParam* values,size_t numValues,void* dest)
+		{
+		/* Reverse the bytes of all values while copying them: */
+		ByteReverser<sizeof(ValueParam)>::copyReverse(values,dest,numValues);
 		}
 	};
 
@@ -171,6 +332,22 @@ swapEndianness(
 	/* Dummy function - no need to swap bytes! */
 	}
 
+/****************************************************************
+Generic function to copy arrays of basic data types to a possibly
+unaligned destination while swapping their endianness:
+****************************************************************/
+
+template <class ValueParam>
+inline
+void
+copySwapEndianness(
+	const ValueParam* values,
+	size_t numValues,
+	void* dest)
+	{
+	EndiannessSwapper<ValueParam>::copySwap(values,numValues,dest);
+	}
+
 }
 
 #endif
@@ -1,7 +1,7 @@
 /***********************************************************************
 File - Wrapper class for the stdio FILE interface with exception safety,
 typed data I/O, and automatic endianness conversion.
-Copyright (c) 2002-2010 Oliver Kreylos
+Copyright (c) 2002-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -255,12 +255,15 @@ class File
 		size_t numBytesWritten;
 		if(mustSwapEndianness)
 			{
+			/* Swap the items in chunks through a temporary buffer: */
+			const size_t chunkSize=sizeof(DataParam)<=1024?4096/sizeof(DataParam):1;
+			unsigned char buffer[chunkSize*sizeof(DataParam)];
 			numBytesWritten=0;
-			for(size_t i=0;i<numItems;++i)
+			for(size_t i=0;i<numItems;i+=chunkSize)
 				{
-				DataParam temp=data[i];
-				swapEndianness(temp);
-				numBytesWritten+=fwrite(&temp,1,sizeof(DataParam),filePtr);
+				size_t numChunkItems=numItems-i<chunkSize?numItems-i:chunkSize;
+				copySwapEndianness(data+i,numChunkItems,buffer);
+				numBytesWritten+=fwrite(buffer,1,numChunkItems*sizeof(DataParam),filePtr);
 				}
 			}
 		else
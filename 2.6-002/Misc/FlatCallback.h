@@ -0,0 +1,223 @@
+/***********************************************************************
+FlatCallback - Class to store a callable object of arbitrary type by
+value and invoke it without virtual function calls. Callables that fit
+into a small inline buffer are stored in place; larger ones are
+allocated on the heap.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Miscellaneous Support Library (Misc).
+
+The Miscellaneous Support Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Miscellaneous Support Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Miscellaneous Support Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef MISC_FLATCALLBACK_INCLUDED
+#define MISC_FLATCALLBACK_INCLUDED
+
+#include <stddef.h>
+#include <string.h>
+#include <new>
+#include <typeinfo>
+
+namespace Misc {
+
+template <class ArgumentParam>
+class FlatCallback
+	{
+	/* Embedded classes: */
+	public:
+	typedef ArgumentParam Argument; // Type of the argument passed to callables
+	static const size_t inlineSize=6*sizeof(void*); // Maximum size of callables stored in place; fits an object pointer, a method pointer, and a small parameter
+	
+	private:
+	union Storage // Type for inline callable storage with sufficient alignment for typical callables
+		{
+		/* Elements: */
+		public:
+		char buffer[inlineSize]; // Raw storage
+		void* alignPointer; // Forces pointer alignment
+		double alignDouble; // Forces double alignment
+		long long alignLongLong; // Forces 64-bit integer alignment
+		};
+	
+	struct Operations // Structure holding the type-specific operations of a stored callable
+		{
+		/* Elements: */
+		public:
+		const char* typeName; // Mangled name of the callable's type to compare callables across shared objects
+		void (*call)(const Storage& storage,Argument argument); // Invokes the callable
+		bool (*equal)(const Storage& storage1,const Storage& storage2); // Compares two callables of the same type
+		void (*copy)(Storage& dest,const Storage& source); // Copy-constructs a callable into uninitialized storage, or null if the callable can be copied bitwise
+		void (*destroy)(Storage& storage); // Destroys a callable, or null if the callable does not need to be destroyed
+		};
+	
+	template <class CallableParam,bool inlineParam>
+	struct Manager // Structure implementing the operations for callables stored in place
+		{
+		/* Methods: */
+		public:
+		static const CallableParam& get(const Storage& storage)
+			{
+			return *reinterpret_cast<const CallableParam*>(storage.buffer);
+			}
+		static void create(Storage& storage,const CallableParam& callable)
+			{
+			new(storage.buffer) CallableParam(callable);
+			}
+		static void call(const Storage& storage,Argument argument)
+			{
+			get(storage).call(argument);
+			}
+		static bool equal(const Storage& storage1,const Storage& storage2)
+			{
+			return get(storage1)==get(storage2);
+			}
+		static void copy(Storage& dest,const Storage& source)
+			{
+			new(dest.buffer) CallableParam(get(source));
+			}
+		static void destroy(Storage& storage)
+			{
+			reinterpret_cast<CallableParam*>(storage.buffer)->~CallableParam();
+			}
+		static const Operations& getOperations(void)
+			{
+			static const Operations operations={typeid(CallableParam).name(),&Manager::call,&Manager::equal,
+			                                    __has_trivial_copy(CallableParam)?0:&Manager::copy,
+			                                    __has_trivial_destructor(CallableParam)?0:&Manager::destroy};
+			return operations;
+			}
+		};
+	
+	template <class CallableParam>
+	struct Manager<CallableParam,false> // Structure implementing the operations for callables stored on the heap
+		{
+		/* Methods: */
+		public:
+		static const CallableParam& get(const Storage& storage)
+			{
+			return *static_cast<const CallableParam*>(storage.alignPointer);
+			}
+		static void create(Storage& storage,const CallableParam& callable)
+			{
+			storage.alignPointer=new CallableParam(callable);
+			}
+		static void call(const Storage& storage,Argument argument)
+			{
+			get(storage).call(argument);
+			}
+		static bool equal(const Storage& storage1,const Storage& storage2)
+			{
+			return get(storage1)==get(storage2);
+			}
+		static void copy(Storage& dest,const Storage& source)
+			{
+			dest.alignPointer=new CallableParam(get(source));
+			}
+		static void destroy(Storage& storage)
+			{
+			delete static_cast<CallableParam*>(storage.alignPointer);
+			}
+		static const Operations& getOperations(void)
+			{
+			static const Operations operations={typeid(CallableParam).name(),&Manager::call,&Manager::equal,&Manager::copy,&Manager::destroy};
+			return operations;
+			}
+		};
+	
+	template <class CallableParam>
+	struct Placement // Structure to select the storage of a callable type
+		{
+		/* Elements: */
+		public:
+		static const bool isInline=sizeof(CallableParam)<=inlineSize&&__alignof__(CallableParam)<=__alignof__(Storage); // Flag whether callables of the type are stored in place
+		};
+	
+	/* Elements: */
+	const Operations* operations; // Operations of the stored callable, or null if the callback is empty
+	Storage storage; // Storage for the callable, or a pointer to it
+	
+	/* Private methods: */
+	void copyStorage(const FlatCallback& source) // Copies the source's callable into this callback's uninitialized storage; assumes operations were already copied
+		{
+		if(operations!=0&&operations->copy!=0)
+			operations->copy(storage,source.storage);
+		else
+			storage=source.storage;
+		}
+	void destroyStorage(void) // Destroys the stored callable
+		{
+		if(operations!=0&&operations->destroy!=0)
+			operations->destroy(storage);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FlatCallback(void) // Creates an empty callback
+		:operations(0)
+		{
+		}
+	template <class CallableParam>
+	explicit FlatCallback(const CallableParam& callable) // Creates a callback storing a copy of the given callable; callable must provide a call(Argument) const method and an equality operator
+		:operations(&Manager<CallableParam,Placement<CallableParam>::isInline>::getOperations())
+		{
+		Manager<CallableParam,Placement<CallableParam>::isInline>::create(storage,callable);
+		}
+	FlatCallback(const FlatCallback& source) // Copy constructor
+		:operations(source.operations)
+		{
+		copyStorage(source);
+		}
+	FlatCallback& operator=(const FlatCallback& source) // Assignment operator
+		{
+		if(this!=&source)
+			{
+			destroyStorage();
+			operations=source.operations;
+			copyStorage(source);
+			}
+		return *this;
+		}
+	~FlatCallback(void)
+		{
+		destroyStorage();
+		}
+	
+	/* Methods: */
+	bool isValid(void) const // Returns true if the callback stores a callable
+		{
+		return operations!=0;
+		}
+	friend bool operator==(const FlatCallback& cb1,const FlatCallback& cb2) // Returns true if the two callbacks store equal callables of the same type
+		{
+		if(cb1.operations==cb2.operations)
+			return cb1.operations==0||cb1.operations->equal(cb1.storage,cb2.storage);
+		
+		/* Operations of the same type instantiated in different shared objects might have different addresses: */
+		return cb1.operations!=0&&cb2.operations!=0&&strcmp(cb1.operations->typeName,cb2.operations->typeName)==0&&cb1.operations->equal(cb1.storage,cb2.storage);
+		}
+	friend bool operator!=(const FlatCallback& cb1,const FlatCallback& cb2)
+		{
+		return !(cb1==cb2);
+		}
+	void operator()(Argument argument) const // Invokes the stored callable; callback must not be empty
+		{
+		operations->call(storage,argument);
+		}
+	};
+
+}
+
+#endif
@@ -2,7 +2,7 @@
 MemMappedFile - Wrapper class to provide a file-like interface for
 blocks of memory or memory-mapped files with exception safety, typed
 data I/O, and automatic endianness conversion.
-Copyright (c) 2007-2010 Oliver Kreylos
+Copyright (c) 2007-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -274,12 +274,18 @@ class MemMappedFile
 		{
 		if(mustSwapEndianness)
 			{
-			for(size_t i=0;i<numItems;++i)
-				{
-				DataParam temp=data[i];
-				swapEndianness(temp);
-				writeRaw(&temp,sizeof(DataParam));
-				}
+			/* Check if writing is allowed: */
+			size_t size=sizeof(DataParam)*numItems;
+			if(!writeProtected)
+				throw WriteError(size,0);
+			
+			/* Check if the memory block can hold enough data: */
+			if(ioPtr+size>blockEnd)
+				throw WriteError(size,blockEnd-ioPtr);
+			
+			/* Swap the data directly into the memory block: */
+			copySwapEndianness(data,numItems,ioPtr);
+			ioPtr+=size;
 			}
 		else
 			writeRaw(data,sizeof(DataParam)*numItems);
@@ -0,0 +1,467 @@
+/***********************************************************************
+OpenHashTable - Class for storing and finding values (open addressing
+version using Robin Hood hashing). Stores entries in a single flat array
+instead of in individually allocated bucket items, which makes lookups
+and iteration considerably more cache-friendly than in HashTable.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Miscellaneous Support Library (Misc).
+
+The Miscellaneous Support Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Miscellaneous Support Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Miscellaneous Support Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef MISC_OPENHASHTABLE_INCLUDED
+#define MISC_OPENHASHTABLE_INCLUDED
+
+#include <new>
+#include <stdexcept>
+#include <Misc/StandardHashFunction.h>
+#include <Misc/HashTable.h>
+
+namespace Misc {
+
+/***********************************************************************
+Usage prerequisites:
+- class Source must provide operator!=
+- class HashFunction must provide static size_t hash(const Source&
+  source,size_t tableSize)
+- classes Source and Dest must be copy-constructible and assignable
+Differences to HashTable:
+- Inserting an entry can move other entries inside the table, which
+  invalidates all iterators and pointers/references to entries.
+- Removing an entry can move other entries, which invalidates all
+  iterators and pointers/references to entries.
+***********************************************************************/
+
+template <class Source,class Dest,class HashFunction =StandardHashFunction<Source> >
+class OpenHashTable
+	{
+	/* Embedded classes: */
+	public:
+	typedef HashTableEntry<Source,Dest> Entry; // Type for hash table entries
+	
+	class EntryNotFoundError:public std::runtime_error // Class for exceptions when requested hash table entry does not exist
+		{
+		/* Elements: */
+		public:
+		Source entrySource; // Requested non-existent entry source value
+		
+		/* Constructors and destructors: */
+		EntryNotFoundError(const Source& sEntrySource)
+			:std::runtime_error("Requested entry not found in hash table"),
+			 entrySource(sEntrySource)
+			{
+			}
+		virtual ~EntryNotFoundError(void) throw()
+			{
+			}
+		};
+	
+	class Iterator
+		{
+		friend class OpenHashTable;
+		
+		/* Elements: */
+		private:
+		OpenHashTable* table; // Pointer to table this iterator is pointing into
+		size_t index; // Index of current table slot
+		
+		/* Constructors and destructors: */
+		public:
+		Iterator(void) // Creates invalid iterator
+			:table(0),index(0)
+			{
+			}
+		private:
+		Iterator(OpenHashTable* sTable,size_t sIndex) // Creates iterator to first used slot at or after the given index
+			:table(sTable),index(sIndex)
+			{
+			while(index<table->tableSize&&table->distances[index]==0)
+				++index;
+			}
+		
+		/* Methods: */
+		public:
+		bool isFinished(void) const
+			{
+			return index>=table->tableSize;
+			}
+		friend bool operator==(const Iterator& it1,const Iterator& it2)
+			{
+			return it1.index==it2.index;
+			}
+		friend bool operator!=(const Iterator& it1,const Iterator& it2)
+			{
+			return it1.index!=it2.index;
+			}
+		Entry& operator*(void) const
+			{
+			return table->entries[index];
+			}
+		Entry* operator->(void) const
+			{
+			return table->entries+index;
+			}
+		Iterator& operator++(void)
+			{
+			/* Go to next used table slot: */
+			do
+				{
+				++index;
+				}
+			while(index<table->tableSize&&table->distances[index]==0);
+			return *this;
+			}
+		};
+	
+	class ConstIterator
+		{
+		friend class OpenHashTable;
+		
+		/* Elements: */
+		private:
+		const OpenHashTable* table; // Pointer to table this iterator is pointing into
+		size_t index; // Index of current table slot
+		
+		/* Constructors and destructors: */
+		public:
+		ConstIterator(void) // Creates invalid iterator
+			:table(0),index(0)
+			{
+			}
+		private:
+		ConstIterator(const OpenHashTable* sTable,size_t sIndex) // Creates iterator to first used slot at or after the given index
+			:table(sTable),index(sIndex)
+			{
+			while(index<table->tableSize&&table->distances[index]==0)
+				++index;
+			}
+		
+		/* Methods: */
+		public:
+		bool isFinished(void) const
+			{
+			return index>=table->tableSize;
+			}
+		friend bool operator==(const ConstIterator& it1,const ConstIterator& it2)
+			{
+			return it1.index==it2.index;
+			}
+		friend bool operator!=(const ConstIterator& it1,const ConstIterator& it2)
+			{
+			return it1.index!=it2.index;
+			}
+		const Entry& operator*(void) const
+			{
+			return table->entries[index];
+			}
+		const Entry* operator->(void) const
+			{
+			return table->entries+index;
+			}
+		ConstIterator& operator++(void)
+			{
+			/* Go to next used table slot: */
+			do
+				{
+				++index;
+				}
+			while(index<table->tableSize&&table->distances[index]==0);
+			return *this;
+			}
+		};
+	
+	friend class Iterator;
+	friend class ConstIterator;
+	
+	/* Elements: */
+	private:
+	size_t tableSize; // Current table size
+	float waterMark; // Maximum table usage ratio
+	float growRate; // Rate the table grows at
+	unsigned int* distances; // Array of probe distances of the entries in each slot plus one, or zero for empty slots
+	Entry* entries; // Array of uninitialized memory holding the entries of used slots
+	size_t usedEntries; // Number of entries currently used
+	size_t maxEntries; // Maximum number of entries at current table size
+	
+	/* Private methods: */
+	void allocateTable(size_t newTableSize) // Allocates empty slot arrays of the given size
+		{
+		tableSize=newTableSize;
+		distances=new unsigned int[tableSize];
+		for(size_t i=0;i<tableSize;++i)
+			distances[i]=0;
+		entries=static_cast<Entry*>(::operator new(tableSize*sizeof(Entry)));
+		maxEntries=(size_t)(tableSize*waterMark);
+		if(maxEntries>=tableSize)
+			maxEntries=tableSize-1;
+		}
+	void destroyEntries(void) // Destroys all used hash table entries
+		{
+		for(size_t i=0;i<tableSize;++i)
+			if(distances[i]!=0)
+				{
+				entries[i].~Entry();
+				distances[i]=0;
+				}
+		usedEntries=0;
+		}
+	size_t findIndex(const Source& findSource) const // Returns the slot index of the given source, or the table size if the source is not found
+		{
+		/* Probe from the source's home slot until a slot holding an entry closer to its own home slot is found: */
+		size_t index=HashFunction::hash(findSource,tableSize);
+		for(unsigned int distance=1;distances[index]>=distance;++distance)
+			{
+			/* Only compare entries that share the searched source's home slot: */
+			if(distances[index]==distance&&!(entries[index].getSource()!=findSource))
+				return index;
+			if(++index==tableSize)
+				index=0;
+			}
+		
+		return tableSize;
+		}
+	size_t insertNewEntry(const Entry& newEntry) // Inserts an entry whose source is not yet in the table, assuming there is a free slot; returns the new entry's slot index
+		{
+		size_t result=tableSize;
+		
+		/* Probe from the new entry's home slot, displacing entries that are closer to their own home slots: */
+		Entry carry(newEntry);
+		unsigned int carryDistance=1;
+		size_t index=HashFunction::hash(newEntry.getSource(),tableSize);
+		while(distances[index]!=0)
+			{
+			if(distances[index]<carryDistance)
+				{
+				/* Store the carried entry here and carry on with the displaced entry: */
+				Entry displaced(entries[index]);
+				entries[index]=carry;
+				carry=displaced;
+				unsigned int displacedDistance=distances[index];
+				distances[index]=carryDistance;
+				carryDistance=displacedDistance;
+				if(result==tableSize)
+					result=index;
+				}
+			++carryDistance;
+			if(++index==tableSize)
+				index=0;
+			}
+		
+		/* Store the carried entry in the free slot: */
+		new(entries+index) Entry(carry);
+		distances[index]=carryDistance;
+		if(result==tableSize)
+			result=index;
+		++usedEntries;
+		
+		return result;
+		}
+	void removeIndex(size_t index) // Removes the entry in the given used slot
+		{
+		/* Destroy the entry: */
+		entries[index].~Entry();
+		--usedEntries;
+		
+		/* Shift all following entries that are not in their home slots back by one slot: */
+		size_t next=index+1;
+		if(next==tableSize)
+			next=0;
+		while(distances[next]>1)
+			{
+			new(entries+index) Entry(entries[next]);
+			entries[next].~Entry();
+			distances[index]=distances[next]-1;
+			index=next;
+			if(++next==tableSize)
+				next=0;
+			}
+		distances[index]=0;
+		}
+	void growTable(size_t newTableSize) // Grows the table without deleting current entries
+		{
+		/* Allocate new slot arrays: */
+		size_t oldTableSize=tableSize;
+		unsigned int* oldDistances=distances;
+		Entry* oldEntries=entries;
+		allocateTable(newTableSize);
+		
+		/* Move all entries to the new table: */
+		usedEntries=0;
+		for(size_t i=0;i<oldTableSize;++i)
+			if(oldDistances[i]!=0)
+				{
+				insertNewEntry(oldEntries[i]);
+				oldEntries[i].~Entry();
+				}
+		
+		/* Delete the old slot arrays: */
+		delete[] oldDistances;
+		::operator delete(oldEntries);
+		}
+	void prepareInsertion(void) // Grows the table if it has no room for another entry
+		{
+		if(usedEntries>=maxEntries)
+			{
+			/* Grow the table until it has room for one more entry: */
+			size_t newTableSize=tableSize;
+			do
+				{
+				newTableSize=(size_t)(newTableSize*growRate)+1;
+				}
+			while((size_t)(newTableSize*waterMark)<=usedEntries);
+			growTable(newTableSize);
+			}
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	OpenHashTable(size_t sTableSize,float sWaterMark =0.8f,float sGrowRate =1.7312543)
+		:waterMark(sWaterMark),growRate(sGrowRate),
+		 usedEntries(0)
+		{
+		allocateTable(sTableSize>1?sTableSize:2);
+		}
+	private:
+	OpenHashTable(const OpenHashTable& source); // Prohibit copy constructor
+	OpenHashTable& operator=(const OpenHashTable& source); // Prohibit assignment operator
+	public:
+	~OpenHashTable(void)
+		{
+		/* Destroy all used hash table entries: */
+		destroyEntries();
+		
+		/* Delete the slot arrays: */
+		delete[] distances;
+		::operator delete(entries);
+		}
+	
+	/* Methods: */
+	void setTableSize(size_t newTableSize)
+		{
+		/* Never shrink the table below its current number of entries: */
+		if(newTableSize<2)
+			newTableSize=2;
+		while((size_t)(newTableSize*waterMark)<usedEntries)
+			newTableSize=(size_t)(newTableSize*growRate)+1;
+		growTable(newTableSize);
+		}
+	void clear(void)
+		{
+		/* Destroy all used hash table entries: */
+		destroyEntries();
+		}
+	size_t getNumEntries(void) const // Returns the number of entries currently in the hash table
+		{
+		return usedEntries;
+		}
+	bool setEntry(const Entry& newEntry)
+		{
+		size_t index=findIndex(newEntry.getSource());
+		if(index<tableSize)
+			{
+			/* Set value of existing entry: */
+			entries[index]=newEntry;
+			return true;
+			}
+		else
+			{
+			/* Insert new entry: */
+			prepareInsertion();
+			insertNewEntry(newEntry);
+			return false;
+			}
+		}
+	void removeEntry(const Source& findSource) // Removes entry
+		{
+		size_t index=findIndex(findSource);
+		if(index<tableSize)
+			removeIndex(index);
+		}
+	bool isEntry(const Source& findSource) const
+		{
+		return findIndex(findSource)<tableSize;
+		}
+	bool isEntry(const Entry& entry) const // Wrapper for isEntry function
+		{
+		return isEntry(entry.getSource());
+		}
+	const Entry& getEntry(const Source& findSource) const // Returns reference to entry; throws exception if entry is not found
+		{
+		size_t index=findIndex(findSource);
+		
+		/* Throw an exception if the requested entry does not exist: */
+		if(index>=tableSize)
+			throw EntryNotFoundError(findSource);
+		
+		return entries[index];
+		}
+	Entry& getEntry(const Source& findSource) // Ditto
+		{
+		size_t index=findIndex(findSource);
+		
+		/* Throw an exception if the requested entry does not exist: */
+		if(index>=tableSize)
+			throw EntryNotFoundError(findSource);
+		
+		return entries[index];
+		}
+	Entry& operator[](const Source& source) // Returns reference to entry; inserts new entry if source is not found
+		{
+		size_t index=findIndex(source);
+		if(index>=tableSize)
+			{
+			/* Insert new entry with default destination: */
+			prepareInsertion();
+			index=insertNewEntry(Entry(source));
+			}
+		
+		return entries[index];
+		}
+	Iterator begin(void)
+		{
+		return Iterator(this,0); // Create iterator to first entry
+		}
+	ConstIterator begin(void) const
+		{
+		return ConstIterator(this,0); // Create iterator to first entry
+		}
+	Iterator end(void)
+		{
+		return Iterator(this,tableSize); // Create iterator past end of table
+		}
+	ConstIterator end(void) const
+		{
+		return ConstIterator(this,tableSize); // Create iterator past end of table
+		}
+	Iterator findEntry(const Source& findSource)
+		{
+		return Iterator(this,findIndex(findSource)); // Returns end iterator if entry is not found
+		}
+	ConstIterator findEntry(const Source& findSource) const
+		{
+		return ConstIterator(this,findIndex(findSource)); // Returns end iterator if entry is not found
+		}
+	void removeEntry(const Iterator& it) // Removes entry pointed to by iterator
+		{
+		if(it.table==this&&it.index<tableSize&&distances[it.index]!=0)
+			removeIndex(it.index);
+		}
+	};
+
+}
+
+#endif
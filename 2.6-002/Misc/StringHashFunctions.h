@@ -39,14 +39,14 @@ class StandardHashFunction<std::string>
 	{
 	/* Static methods: */
 	public:
-	static size_t rawHash(std::string source)
+	static size_t rawHash(const std::string& source)
 		{
 		size_t result=0;
 		for(std::string::const_iterator sIt=source.begin();sIt!=source.end();++sIt)
 			result=result*37+size_t(*sIt);
 		return result;
 		}
-	static size_t hash(std::string source,size_t tableSize)
+	static size_t hash(const std::string& source,size_t tableSize)
 		{
 		return rawHash(source)%tableSize;
 		}
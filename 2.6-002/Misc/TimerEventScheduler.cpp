@@ -1,7 +1,7 @@
 /***********************************************************************
 TimerEventScheduler - Base class for schedulers that allow clients to
 register timer event callbacks.
-Copyright (c) 2008 Oliver Kreylos
+Copyright (c) 2008-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -21,37 +21,72 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 02111-1307 USA
 ***********************************************************************/
 
-#include <typeinfo>
 #include <Misc/Time.h>
 
 #include <Misc/TimerEventScheduler.h>
 
 namespace Misc {
 
-/******************************************************
-Methods of class TimerEventScheduler::FunctionCallback:
-******************************************************/
+/************************************
+Methods of class TimerEventScheduler:
+************************************/
 
-bool TimerEventScheduler::FunctionCallback::operator==(const TimerEventScheduler::Callback& other) const
+void TimerEventScheduler::siftUp(unsigned int heapIndex,TimerEventScheduler::Timer timer)
 	{
-	if(typeid(other)!=typeid(FunctionCallback))
-		return false;
-	const FunctionCallback* other2=static_cast<const FunctionCallback*>(&other);
-	return callbackFunction==other2->callbackFunction&&userData==other2->userData;
+	while(heapIndex>0)
+		{
+		unsigned int parentIndex=(heapIndex-1)/2;
+		if(timers[parentIndex].time<=timer.time)
+			break;
+		setTimer(heapIndex,timers[parentIndex]);
+		heapIndex=parentIndex;
+		}
+	setTimer(heapIndex,timer);
 	}
 
-void TimerEventScheduler::FunctionCallback::call(CallbackData* callbackData) const
+void TimerEventScheduler::siftDown(unsigned int heapIndex,TimerEventScheduler::Timer timer)
 	{
-	/* Call the callback function: */
-	callbackFunction(callbackData,userData);
+	unsigned int numTimers=timers.size();
+	while(true)
+		{
+		/* Find the earlier of the two children: */
+		unsigned int childIndex=2*heapIndex+1;
+		if(childIndex>=numTimers)
+			break;
+		if(childIndex+1<numTimers&&timers[childIndex+1].time<timers[childIndex].time)
+			++childIndex;
+		if(timer.time<=timers[childIndex].time)
+			break;
+		setTimer(heapIndex,timers[childIndex]);
+		heapIndex=childIndex;
+		}
+	setTimer(heapIndex,timer);
 	}
 
-/************************************
-Methods of class TimerEventScheduler:
-************************************/
+void TimerEventScheduler::removeTimer(unsigned int heapIndex)
+	{
+	/* Release the timer's slot: */
+	unsigned int slotIndex=timers[heapIndex].slotIndex;
+	EventSlot& slot=slots[slotIndex];
+	slot.callback=Callback();
+	slot.heapIndex=firstFreeSlot;
+	++slot.generation;
+	firstFreeSlot=slotIndex;
+	
+	/* Replace the timer with the last timer in the heap and restore the heap property: */
+	Timer last=timers.back();
+	timers.pop_back();
+	if(heapIndex<timers.size())
+		{
+		if(heapIndex>0&&last.time<timers[(heapIndex-1)/2].time)
+			siftUp(heapIndex,last);
+		else
+			siftDown(heapIndex,last);
+		}
+	}
 
 TimerEventScheduler::TimerEventScheduler(void)
-	:timers(10)
+	:firstFreeSlot(0)
 	{
 	/* Initialize the timer to the current time-of-day: */
 	Misc::Time time=Misc::Time::now();
@@ -60,26 +95,53 @@ TimerEventScheduler::TimerEventScheduler(void)
 
 TimerEventScheduler::~TimerEventScheduler(void)
 	{
-	/* Delete the callback structures of all pending timer events: */
-	for(TimerQueue::Iterator tIt=timers.begin();tIt!=timers.end();++tIt)
-		delete tIt->callback;
 	}
 
-void TimerEventScheduler::scheduleEvent(double eventTime,TimerEventScheduler::Callback* callback)
+TimerEventScheduler::EventId TimerEventScheduler::scheduleEvent(double eventTime,const TimerEventScheduler::Callback& callback)
+	{
+	/* Get an unused slot for the new event's callback: */
+	if(firstFreeSlot==slots.size())
+		{
+		EventSlot newSlot;
+		newSlot.heapIndex=firstFreeSlot+1;
+		newSlot.generation=1;
+		slots.push_back(newSlot);
+		}
+	unsigned int slotIndex=firstFreeSlot;
+	EventSlot& slot=slots[slotIndex];
+	firstFreeSlot=slot.heapIndex;
+	slot.callback=callback;
+	
+	/* Insert the new timer event into the heap: */
+	Timer timer;
+	timer.time=eventTime;
+	timer.slotIndex=slotIndex;
+	timers.push_back(timer);
+	siftUp(timers.size()-1,timer);
+	
+	return (EventId(slot.generation)<<32)|EventId(slotIndex);
+	}
+
+bool TimerEventScheduler::removeEvent(TimerEventScheduler::EventId eventId)
 	{
-	/* Insert the new timer event into the queue: */
-	timers.insert(Timer(eventTime,callback));
+	/* Check if the identifier refers to a pending event: */
+	unsigned int slotIndex=(unsigned int)(eventId&EventId(0xffffffffU));
+	if(slotIndex>=slots.size()||slots[slotIndex].generation!=(unsigned int)(eventId>>32))
+		return false;
+	
+	/* Remove the timer event: */
+	removeTimer(slots[slotIndex].heapIndex);
+	return true;
 	}
 
 void TimerEventScheduler::removeEvent(double eventTime,const TimerEventScheduler::Callback& callback)
 	{
-	/* Find a matching event in the timer queue: */
-	for(TimerQueue::Iterator tIt=timers.begin();tIt!=timers.end();++tIt)
-		if(tIt->time==eventTime&&*tIt->callback==callback)
+	/* Find a matching event in the timer heap: */
+	for(unsigned int i=0;i<timers.size();++i)
+		if(timers[i].time==eventTime&&slots[timers[i].slotIndex].callback==callback)
 			{
 			/* Remove the timer event: */
-			delete tIt->callback;
-			timers.remove(tIt);
+			removeTimer(i);
 			
 			/* Bail out: */
 			break;
@@ -88,54 +150,24 @@ void TimerEventScheduler::removeEvent(double eventTime,const TimerEventScheduler
 
 void TimerEventScheduler::removeAllEvents(const TimerEventScheduler::Callback& callback)
 	{
-	/* Keep scanning through the heap until no more matching timer events are found: */
-	bool removedOne;
-	do
-		{
-		/* Assume there won't be a match on this pass through: */
-		removedOne=false;
-		
-		/* Scan for a matching timer event: */
-		for(TimerQueue::Iterator tIt=timers.begin();tIt!=timers.end();++tIt)
-			if(*tIt->callback==callback)
-				{
-				/* Remove the timer event: */
-				delete tIt->callback;
-				timers.remove(tIt);
-				
-				/* Bail out, but do another pass: */
-				removedOne=true;
-				break;
-				}
-		}
-	while(removedOne);
+	/* Find all matching events first, as removing events reorders the heap: */
+	std::vector<unsigned int> matchingSlots;
+	for(std::vector<Timer>::iterator tIt=timers.begin();tIt!=timers.end();++tIt)
+		if(slots[tIt->slotIndex].callback==callback)
+			matchingSlots.push_back(tIt->slotIndex);
+	
+	/* Remove all matching events: */
+	for(std::vector<unsigned int>::iterator msIt=matchingSlots.begin();msIt!=matchingSlots.end();++msIt)
+		removeTimer(slots[*msIt].heapIndex);
 	}
 
 void TimerEventScheduler::triggerEvents(void)
 	{
 	/* Update the current time: */
 	Misc::Time time=Misc::Time::now();
-	currentTime=double(time.tv_sec)+double(time.tv_nsec)/1000000000.0;
-	
-	if(timers.isEmpty())
-		return;
-	
-	/* Create the callback data structure: */
-	CallbackData cbData(currentTime);
 	
-	/* Process expired timer events from the head of the queue: */
-	while(timers.getSmallest().time<=currentTime)
-		{
-		/* Call the callback: */
-		timers.getSmallest().callback->call(&cbData);
-		
-		/* Remove the callback from the queue: */
-		delete timers.getSmallest().callback;
-		timers.removeSmallest();
-		
-		if(timers.isEmpty())
-			break;
-		}
+	/* Trigger all expired events: */
+	triggerEvents(double(time.tv_sec)+double(time.tv_nsec)/1000000000.0);
 	}
 
 void TimerEventScheduler::triggerEvents(double time)
@@ -143,24 +175,21 @@ void TimerEventScheduler::triggerEvents(double time)
 	/* Update the current time: */
 	currentTime=time;
 	
-	if(timers.isEmpty())
+	if(timers.empty())
 		return;
 	
 	/* Create the callback data structure: */
 	CallbackData cbData(currentTime);
 	
-	/* Process expired timer events from the head of the queue: */
-	while(timers.getSmallest().time<=currentTime)
+	/* Process expired timer events from the root of the heap: */
+	while(!timers.empty()&&timers.front().time<=currentTime)
 		{
-		/* Call the callback: */
-		timers.getSmallest().callback->call(&cbData);
+		/* Remove the event before calling its callback, as the callback might schedule or remove events: */
+		Callback callback=slots[timers.front().slotIndex].callback;
+		removeTimer(0);
 		
-		/* Remove the callback from the queue: */
-		delete timers.getSmallest().callback;
-		timers.removeSmallest();
-		
-		if(timers.isEmpty())
-			break;
+		/* Call the callback: */
+		callback(&cbData);
 		}
 	}
 
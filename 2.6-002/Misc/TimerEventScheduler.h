@@ -1,7 +1,7 @@
 /***********************************************************************
 TimerEventScheduler - Base class for schedulers that allow clients to
 register timer event callbacks.
-Copyright (c) 2008 Oliver Kreylos
+Copyright (c) 2008-2013 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -24,8 +24,9 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef MISC_TIMEREVENTSCHEDULER_INCLUDED
 #define MISC_TIMEREVENTSCHEDULER_INCLUDED
 
-#include <typeinfo>
-#include <Misc/PriorityHeap.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/FlatCallback.h>
 #include <Misc/CallbackData.h>
 
 namespace Misc {
@@ -47,25 +48,11 @@ class TimerEventScheduler
 			}
 		};
 	
-	/* Abstract base class for callbacks: */
-	private:
-	class Callback
-		{
-		friend class TimerEventScheduler;
-		
-		/* Constructors and destructors: */
-		public:
-		virtual ~Callback(void) // Virtual destructor
-			{
-			}
-		
-		/* Methods: */
-		virtual bool operator==(const Callback& other) const =0; // Virtual method to compare callbacks
-		virtual void call(CallbackData* callbackData) const =0; // Virtual method to invoke callback
-		};
+	typedef Misc::UInt64 EventId; // Type for identifiers of scheduled events; identifiers of past events become invalid, and 0 is never a valid identifier
 	
 	/* Class to call C functions with an additional void* parameter (traditional C-style callback): */
-	class FunctionCallback:public Callback
+	private:
+	struct FunctionCallback
 		{
 		/* Elements: */
 		private:
@@ -80,13 +67,20 @@ class TimerEventScheduler
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const Callback& other) const;
-		virtual void call(CallbackData* cbData) const;
+		bool operator==(const FunctionCallback& other) const
+			{
+			return callbackFunction==other.callbackFunction&&userData==other.userData;
+			}
+		void call(CallbackData* callbackData) const
+			{
+			/* Call the callback function: */
+			callbackFunction(callbackData,userData);
+			}
 		};
 	
 	/* Class to call arbitrary methods on objects of arbitrary type: */
 	template <class CallbackClassParam>
-	class MethodCallback:public Callback
+	struct MethodCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -106,14 +100,11 @@ class TimerEventScheduler
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const Callback& other) const
+		bool operator==(const MethodCallback& other) const
 			{
-			if(typeid(other)!=typeid(MethodCallback))
-				return false;
-			const MethodCallback* other2=static_cast<const MethodCallback*>(&other);
-			return callbackObject==other2->callbackObject&&callbackMethod==other2->callbackMethod;
+			return callbackObject==other.callbackObject&&callbackMethod==other.callbackMethod;
 			}
-		virtual void call(CallbackData* callbackData) const
+		void call(CallbackData* callbackData) const
 			{
 			/* Call the callback method on the callback object: */
 			(callbackObject->*callbackMethod)(callbackData);
@@ -122,7 +113,7 @@ class TimerEventScheduler
 	
 	/* Class to call arbitrary methods taking a parameter derived from CallbackData on objects of arbitrary type: */
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
-	class MethodCastCallback:public Callback
+	struct MethodCastCallback
 		{
 		/* Embedded classes: */
 		public:
@@ -143,47 +134,53 @@ class TimerEventScheduler
 			}
 		
 		/* Methods: */
-		virtual bool operator==(const Callback& other) const
+		bool operator==(const MethodCastCallback& other) const
 			{
-			if(typeid(other)!=typeid(MethodCastCallback))
-				return false;
-			const MethodCastCallback* other2=static_cast<const MethodCastCallback*>(&other);
-			return callbackObject==other2->callbackObject&&callbackMethod==other2->callbackMethod;
+			return callbackObject==other.callbackObject&&callbackMethod==other.callbackMethod;
 			}
-		virtual void call(CallbackData* callbackData) const
+		void call(CallbackData* callbackData) const
 			{
 			/* Call the callback method on the callback object with downcasted callback data: */
 			(callbackObject->*callbackMethod)(static_cast<DerivedCallbackData*>(callbackData));
 			}
 		};
 	
-	struct Timer // Structure to store a time point and its associated callback
+	typedef FlatCallback<CallbackData*> Callback; // Type for callbacks stored by value
+	
+	struct Timer // Structure for entries in the timer heap
 		{
 		/* Elements: */
 		public:
 		double time; // Time at which the callback is supposed to happen
-		Callback* callback; // The callback to call when the time comes
-		
-		/* Constructors and destructors: */
-		Timer(double sTime,Callback* sCallback) // Elementwise initialization
-			:time(sTime),callback(sCallback)
-			{
-			}
-		
-		/* Methods: */
-		static bool lessEqual(const Timer& t1,const Timer& t2) // Comparison function required for PriorityHeap
-			{
-			return t1.time<=t2.time;
-			}
+		unsigned int slotIndex; // Index of the event slot holding the callback
 		};
 	
-	typedef PriorityHeap<Timer,Timer> TimerQueue; // Type for ordered queues of timer events
+	struct EventSlot // Structure holding the callback of a scheduled event, or a link in the list of free slots
+		{
+		/* Elements: */
+		public:
+		Callback callback; // The callback to call when the time comes
+		unsigned int heapIndex; // Index of the event's timer in the heap, or index of the next free slot if the slot is unused
+		unsigned int generation; // Generation of the slot; incremented when the slot is released to invalidate event identifiers
+		};
 	
 	/* Elements: */
 	private:
-	TimerQueue timers; // List of pending timer events, in increasing order of time
+	std::vector<Timer> timers; // Binary min-heap of pending timer events
+	std::vector<EventSlot> slots; // Slots holding the callbacks of pending timer events
+	unsigned int firstFreeSlot; // Index of the first unused slot, or slots.size() if there are none
 	double currentTime; // The current time; actually the last time point for which events were triggered
 	
+	/* Private methods: */
+	void setTimer(unsigned int heapIndex,const Timer& timer) // Stores a timer in the heap and updates its slot's heap index
+		{
+		timers[heapIndex]=timer;
+		slots[timer.slotIndex].heapIndex=heapIndex;
+		}
+	void siftUp(unsigned int heapIndex,Timer timer); // Moves the given timer from the given heap position towards the root
+	void siftDown(unsigned int heapIndex,Timer timer); // Moves the given timer from the given heap position towards the leaves
+	void removeTimer(unsigned int heapIndex); // Removes the timer at the given heap position and releases its slot
+	
 	/* Constructors and destructors: */
 	public:
 	TimerEventScheduler(void); // Creates an empty event scheduler
@@ -196,55 +193,62 @@ class TimerEventScheduler
 	/* Methods: */
 	
 	/* Methods to schedule events for different types of callbacks: */
-	void scheduleEvent(double eventTime,CallbackType newCallbackFunction,void* newUserData) // Schedules an event for a C-style callback at the given time
+	EventId scheduleEvent(double eventTime,CallbackType newCallbackFunction,void* newUserData) // Schedules an event for a C-style callback at the given time
 		{
-		scheduleEvent(eventTime,new FunctionCallback(newCallbackFunction,newUserData));
+		return scheduleEvent(eventTime,Callback(FunctionCallback(newCallbackFunction,newUserData)));
 		}
 	template <class CallbackClassParam>
-	void scheduleEvent(double eventTime,CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(CallbackData*)) // Schedules an event for a method callback at the given time
+	EventId scheduleEvent(double eventTime,CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(CallbackData*)) // Schedules an event for a method callback at the given time
 		{
-		scheduleEvent(eventTime,new MethodCallback<CallbackClassParam>(newCallbackObject,newCallbackMethod));
+		return scheduleEvent(eventTime,Callback(MethodCallback<CallbackClassParam>(newCallbackObject,newCallbackMethod)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
-	void scheduleEvent(double eventTime,CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(DerivedCallbackDataParam*)) // Schedules an event for a method callback with downcast at the given time
+	EventId scheduleEvent(double eventTime,CallbackClassParam* newCallbackObject,void (CallbackClassParam::*newCallbackMethod)(DerivedCallbackDataParam*)) // Schedules an event for a method callback with downcast at the given time
 		{
-		scheduleEvent(eventTime,new MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(newCallbackObject,newCallbackMethod));
+		return scheduleEvent(eventTime,Callback(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(newCallbackObject,newCallbackMethod)));
 		}
-	void scheduleEvent(double eventTime,Callback* callback); // The actual scheduling method
+	private:
+	EventId scheduleEvent(double eventTime,const Callback& callback); // The actual scheduling method
+	public:
 	
 	/* Methods to remove previously scheduled events: */
+	bool removeEvent(EventId eventId); // Removes the event of the given identifier in O(log n); returns false if the event already happened or was removed
 	void removeEvent(double eventTime,CallbackType callbackFunction,void* userData) // Removes a previously scheduled event for a C-style callback
 		{
-		removeEvent(eventTime,FunctionCallback(callbackFunction,userData));
+		removeEvent(eventTime,Callback(FunctionCallback(callbackFunction,userData)));
 		}
 	template <class CallbackClassParam>
 	void removeEvent(double eventTime,CallbackClassParam* callbackObject,void (CallbackClassParam::*callbackMethod)(CallbackData*)) // Removes a previously scheduled event for a method callback
 		{
-		removeEvent(eventTime,MethodCallback<CallbackClassParam>(callbackObject,callbackMethod));
+		removeEvent(eventTime,Callback(MethodCallback<CallbackClassParam>(callbackObject,callbackMethod)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
 	void removeEvent(double eventTime,CallbackClassParam* callbackObject,void (CallbackClassParam::*callbackMethod)(DerivedCallbackDataParam*)) // Removes a previously scheduled event for a method callback with downcast
 		{
-		removeEvent(eventTime,MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(callbackObject,callbackMethod));
+		removeEvent(eventTime,Callback(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(callbackObject,callbackMethod)));
 		}
+	private:
 	void removeEvent(double eventTime,const Callback& callback); // The actual event removal method
+	public:
 	
 	/* Methods to remove all previously scheduled events for a given callback (to clean up before callback recipient's deletion): */
 	void removeAllEvents(CallbackType callbackFunction,void* userData) // Removes all previously scheduled events for a C-style callback
 		{
-		removeAllEvents(FunctionCallback(callbackFunction,userData));
+		removeAllEvents(Callback(FunctionCallback(callbackFunction,userData)));
 		}
 	template <class CallbackClassParam>
 	void removeAllEvents(CallbackClassParam* callbackObject,void (CallbackClassParam::*callbackMethod)(CallbackData*)) // Removes all previously scheduled events for a method callback
 		{
-		removeAllEvents(MethodCallback<CallbackClassParam>(callbackObject,callbackMethod));
+		removeAllEvents(Callback(MethodCallback<CallbackClassParam>(callbackObject,callbackMethod)));
 		}
 	template <class CallbackClassParam,class DerivedCallbackDataParam>
 	void removeAllEvents(double eventTime,CallbackClassParam* callbackObject,void (CallbackClassParam::*callbackMethod)(DerivedCallbackDataParam*)) // Removes all previously scheduled events for a method callback with downcast
 		{
-		removeAllEvents(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(callbackObject,callbackMethod));
+		removeAllEvents(Callback(MethodCastCallback<CallbackClassParam,DerivedCallbackDataParam>(callbackObject,callbackMethod)));
 		}
+	private:
 	void removeAllEvents(const Callback& callback); // The actual event removal method
+	public:
 	
 	/* Methods to query and trigger scheduled timer events: */
 	double getCurrentTime(void) const // Returns the scheduler's current time
@@ -253,11 +257,11 @@ class TimerEventScheduler
 		}
 	bool hasPendingEvents(void) const // Returns true if the scheduler has any scheduled events
 		{
-		return !timers.isEmpty();
+		return !timers.empty();
 		}
 	double getNextEventTime(void) const // Returns the time of the next scheduled event
 		{
-		return timers.getSmallest().time;
+		return timers.front().time;
 		}
 	void triggerEvents(void); // Triggers all timer events that were scheduled before or on the current time-of-day
 	void triggerEvents(double time); // Triggers all timer events that were scheduled before or on the given time
@@ -1,7 +1,7 @@
 /***********************************************************************
 VRMLFile - Class to represent a VRML 2.0 file and state required to
 parse its contents.
-Copyright (c) 2009-2011 Oliver Kreylos
+Copyright (c) 2009-2013 Oliver Kreylos
 
 This file is part of the Simple Scene Graph Renderer (SceneGraph).
 
@@ -26,7 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <stdexcept>
 #include <Misc/StringHashFunctions.h>
-#include <Misc/HashTable.h>
+#include <Misc/OpenHashTable.h>
 #include <IO/File.h>
 #include <IO/TokenSource.h>
 #include <SceneGraph/FieldTypes.h>
@@ -47,7 +47,7 @@ class VRMLFile:public IO::TokenSource
 	{
 	/* Embedded classes: */
 	private:
-	typedef Misc::HashTable<std::string,NodePointer> NodeMap; // Hash table type to store named nodes
+	typedef Misc::OpenHashTable<std::string,NodePointer> NodeMap; // Hash table type to store named nodes
 	
 	public:
 	class ParseError:public std::runtime_error // Exception class to signal errors while parsing a VRML file
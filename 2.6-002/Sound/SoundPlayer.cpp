@@ -34,6 +34,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/FileNameExtensions.h>
 #include <IO/SeekableFile.h>
 #include <IO/OpenFile.h>
+#if SOUND_CONFIG_HAVE_ALSA
+#include <Threads/PlacementPolicy.h>
+#endif
 #ifdef __APPLE__
 #include <CoreFoundation/CFURL.h>
 #endif
@@ -372,6 +375,9 @@ void* SoundPlayer::playingThreadMethod(void)
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
 	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
 	
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("Sound");
+	
 	/* Read buffers worth of sound data from the input file until interrupted or at end of file: */
 	while(!inputFile->eof())
 		{
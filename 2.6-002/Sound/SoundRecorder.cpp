@@ -35,6 +35,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <iostream>
 #include <stdexcept>
 #include <Misc/ThrowStdErr.h>
+#if SOUND_CONFIG_HAVE_ALSA
+#include <Threads/PlacementPolicy.h>
+#endif
 #ifdef __APPLE__
 #include <CoreFoundation/CFURL.h>
 #endif
@@ -307,6 +310,9 @@ void* SoundRecorder::recordingThreadMethod(void)
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
 	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
 	
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("Sound");
+	
 	/* Read buffers worth of sound data from the PCM device until interrupted: */
 	while(true)
 		{
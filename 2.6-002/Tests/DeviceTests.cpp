@@ -0,0 +1,1013 @@
+/***********************************************************************
+DeviceTests - Correctness tests for the per-sample tracker filters,
+calibrators, and DTrack message parser of the VR device driver daemon,
+checking their results against known ground truth.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StringPrintf.h>
+#include <Misc/ConfigurationFile.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <VRDeviceDaemon/VRFilter.h>
+#include <VRDeviceDaemon/VRCalibrator.h>
+#include <VRDeviceDaemon/VRDevices/ArtDTrackParser.h>
+
+#include "Test.h"
+#include "TestRunner.h"
+
+/* Forward declarations: */
+template <class BaseClassParam>
+class VRFactory;
+template <class BaseClassParam>
+class VRFactoryManager;
+
+/*******************************************************************
+Object creation/destruction functions of the statically linked
+filter and calibrator plug-ins:
+*******************************************************************/
+
+extern "C" VRFilter* createObjectOneEuroFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectOneEuroFilter(VRFilter* filter,VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager);
+extern "C" VRFilter* createObjectKalmanFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectKalmanFilter(VRFilter* filter,VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager);
+extern "C" VRFilter* createObjectDoubleExponentialFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectDoubleExponentialFilter(VRFilter* filter,VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>* factoryManager);
+extern "C" VRCalibrator* createObjectGridCalibrator(VRFactory<VRCalibrator>* factory,VRFactoryManager<VRCalibrator>* factoryManager,Misc::ConfigurationFile& configFile);
+extern "C" void destroyObjectGridCalibrator(VRCalibrator* calibrator,VRFactory<VRCalibrator>* factory,VRFactoryManager<VRCalibrator>* factoryManager);
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef Vrui::VRDeviceState::TrackerState TrackerState;
+typedef TrackerState::PositionOrientation PositionOrientation;
+typedef PositionOrientation::Scalar Scalar;
+typedef PositionOrientation::Point Point;
+typedef PositionOrientation::Vector Vector;
+typedef PositionOrientation::Rotation Rotation;
+typedef Vrui::VRDeviceState::TimeStamp TimeStamp;
+
+class RandomSource // Simple deterministic pseudo-random number generator to create reproducible inputs
+	{
+	/* Elements: */
+	private:
+	Misc::UInt32 state; // Generator state
+	
+	/* Constructors and destructors: */
+	public:
+	RandomSource(Misc::UInt32 sState =1)
+		:state(sState)
+		{
+		}
+	
+	/* Methods: */
+	double operator()(void) // Returns a number uniformly distributed in [0, 1)
+		{
+		state=state*1664525U+1013904223U;
+		return double(state>>8)/16777216.0;
+		}
+	double gaussian(double stdDev) // Returns a normally distributed number of zero mean and the given standard deviation
+		{
+		/* Use the Box-Muller transform on two uniform numbers in (0, 1]: */
+		double u1=1.0-(*this)();
+		double u2=(*this)();
+		return Math::sqrt(-2.0*Math::log(u1))*Math::cos(2.0*Math::Constants<double>::pi*u2)*stdDev;
+		}
+	Vector gaussianVector(double stdDev) // Returns a vector of independent normally distributed components
+		{
+		Vector result;
+		for(int i=0;i<3;++i)
+			result[i]=Scalar(gaussian(stdDev));
+		return result;
+		}
+	};
+
+class ConfigurationFixture // Class to create a configuration file for plug-in objects
+	{
+	/* Elements: */
+	private:
+	std::string fileName; // Name of the temporary configuration file
+	
+	/* Constructors and destructors: */
+	public:
+	ConfigurationFixture(const std::string& sFileName,const std::string& sectionContents)
+		:fileName(sFileName)
+		{
+		std::string contents="section Test\n";
+		contents.append(sectionContents);
+		contents.append("endsection\n");
+		IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly);
+		file->writeRaw(contents.data(),contents.size());
+		}
+	~ConfigurationFixture(void)
+		{
+		unlink(fileName.c_str());
+		}
+	
+	/* Methods: */
+	const std::string& getFileName(void) const // Returns the configuration file's name
+		{
+		return fileName;
+		}
+	};
+
+double angle(const Rotation& from,const Rotation& to) // Returns the angle of the rotation from one rotation to another in degrees, even if the rotations are not normalized
+	{
+	Rotation delta=to*Geometry::invert(from);
+	const Scalar* q=delta.getQuaternion();
+	double axisLength=Math::sqrt(double(q[0])*double(q[0])+double(q[1])*double(q[1])+double(q[2])*double(q[2]));
+	return Math::deg(2.0*Math::atan2(axisLength,Math::abs(double(q[3]))));
+	}
+
+double normError(const Rotation& rotation) // Returns how far the given rotation's quaternion is from unit length
+	{
+	const Scalar* q=rotation.getQuaternion();
+	double sqrNorm=0.0;
+	for(int i=0;i<4;++i)
+		sqrNorm+=double(q[i])*double(q[i]);
+	return Math::abs(Math::sqrt(sqrNorm)-1.0);
+	}
+
+/*************
+Filter tests:
+*************/
+
+struct FilterType // Structure describing a tracker filter plug-in and its settings
+	{
+	/* Embedded classes: */
+	public:
+	typedef VRFilter* (*CreateFunction)(VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*,Misc::ConfigurationFile&);
+	typedef void (*DestroyFunction)(VRFilter*,VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*);
+	
+	/* Elements: */
+	const char* name; // Name of the filter class
+	const char* parameters; // Test parameters describing the filter settings
+	const char* settings; // Configuration file settings for the filter
+	CreateFunction createFunction; // Function to create the filter
+	DestroyFunction destroyFunction; // Function to destroy the filter
+	};
+
+class FilterTest:public Test // Base class for tests feeding a trace with known ground truth through a tracker filter
+	{
+	/* Elements: */
+	private:
+	const FilterType& type; // Type of the tested filter
+	VRFilter* filter; // The tested filter
+	
+	/* Protected methods: */
+	protected:
+	void createFilter(void) // Creates a single-tracker filter from a temporary configuration file
+		{
+		ConfigurationFixture fixture(getTempFileName(".cfg"),type.settings);
+		Misc::ConfigurationFile configFile(fixture.getFileName().c_str());
+		configFile.setCurrentSection("/Test");
+		filter=(*type.createFunction)(0,0,configFile);
+		filter->setNumTrackers(1);
+		}
+	TrackerState filterSample(const Point& position,const Rotation& orientation,double time) // Filters a raw sample taken at the given time in seconds and returns the filtered state
+		{
+		TrackerState state;
+		state.positionOrientation=PositionOrientation(position-Point::origin,orientation);
+		state.linearVelocity=Vector::zero;
+		state.angularVelocity=Vector::zero;
+		return filter->filter(0,state,TimeStamp(time*1.0e6+0.5));
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FilterTest(const char* sName,const FilterType& sType)
+		:Test(sType.name,sName,sType.parameters),
+		 type(sType),filter(0)
+		{
+		}
+	virtual ~FilterTest(void)
+		{
+		if(filter!=0)
+			(*type.destroyFunction)(filter,0,0);
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		/* Create a fresh filter, and run the trace: */
+		if(filter!=0)
+			(*type.destroyFunction)(filter,0,0);
+		filter=0;
+		createFilter();
+		runTrace();
+		}
+	virtual void runTrace(void) =0; // Feeds the test's trace through the filter and checks the results
+	};
+
+class FilterNoiseTest:public FilterTest // Test checking how much a filter reduces measurement noise on a stationary tracker
+	{
+	/* Elements: */
+	private:
+	double maxPositionNoise; // Largest acceptable ratio of filtered to raw RMS position noise
+	double maxOrientationNoise; // Largest acceptable ratio of filtered to raw RMS orientation noise
+	double maxVelocityNoise; // Largest acceptable RMS linear velocity in mm/s
+	
+	/* Constructors and destructors: */
+	public:
+	FilterNoiseTest(const FilterType& sType,double sMaxPositionNoise,double sMaxOrientationNoise,double sMaxVelocityNoise)
+		:FilterTest("StationaryNoise",sType),
+		 maxPositionNoise(sMaxPositionNoise),maxOrientationNoise(sMaxOrientationNoise),maxVelocityNoise(sMaxVelocityNoise)
+		{
+		}
+	
+	/* Methods: */
+	virtual void runTrace(void)
+		{
+		/* Sample a stationary tracker at 120Hz for ten seconds, with 0.5mm and 0.2 degrees of Gaussian noise: */
+		const Point truePosition(100,-50,600);
+		const Rotation trueOrientation=Rotation::rotateAxis(Vector(1,1,0),Scalar(0.5));
+		const int numSamples=1200;
+		const int numSettleSamples=120; // Samples during which the filter settles and errors are not measured
+		RandomSource random(23);
+		double rawPositionSqrSum=0.0,positionSqrSum=0.0;
+		double rawOrientationSqrSum=0.0,orientationSqrSum=0.0;
+		double velocitySqrSum=0.0;
+		for(int i=0;i<numSamples;++i)
+			{
+			Point rawPosition=truePosition+random.gaussianVector(0.5);
+			Rotation rawOrientation=Rotation(random.gaussianVector(Math::rad(0.2)))*trueOrientation;
+			TrackerState result=filterSample(rawPosition,rawOrientation,double(i)/120.0);
+			if(i>=numSettleSamples)
+				{
+				rawPositionSqrSum+=double(Geometry::sqrDist(rawPosition,truePosition));
+				positionSqrSum+=double(Geometry::sqrDist(result.positionOrientation.getOrigin(),truePosition));
+				rawOrientationSqrSum+=Math::sqr(angle(trueOrientation,rawOrientation));
+				orientationSqrSum+=Math::sqr(angle(trueOrientation,result.positionOrientation.getRotation()));
+				velocitySqrSum+=double(Geometry::sqr(result.linearVelocity));
+				}
+			}
+		
+		/* Check the noise ratios and the velocity noise: */
+		double numMeasured=double(numSamples-numSettleSamples);
+		checkMax("position noise ratio",Math::sqrt(positionSqrSum/rawPositionSqrSum),maxPositionNoise,"");
+		checkMax("orientation noise ratio",Math::sqrt(orientationSqrSum/rawOrientationSqrSum),maxOrientationNoise,"");
+		checkMax("velocity noise",Math::sqrt(velocitySqrSum/numMeasured),maxVelocityNoise,"mm/s");
+		}
+	};
+
+class FilterStepTest:public FilterTest // Test checking how quickly a filter follows a sudden jump of a noise-free tracker
+	{
+	/* Elements: */
+	private:
+	double maxSettleTime; // Largest acceptable time after the jump until the filtered position stays within 1mm of the new position, in ms
+	double maxOvershoot; // Largest acceptable overshoot past the new position in mm
+	
+	/* Constructors and destructors: */
+	public:
+	FilterStepTest(const FilterType& sType,double sMaxSettleTime,double sMaxOvershoot)
+		:FilterTest("Step",sType),
+		 maxSettleTime(sMaxSettleTime),maxOvershoot(sMaxOvershoot)
+		{
+		}
+	
+	/* Methods: */
+	virtual void runTrace(void)
+		{
+		/* Hold the tracker for one second, then jump by 100mm and hold for two seconds, sampled at 120Hz: */
+		const Point start(0,0,600);
+		const Point end(100,0,600);
+		const int stepSample=120;
+		const int numSamples=360;
+		double settleTime=0.0;
+		double overshoot=0.0;
+		for(int i=0;i<numSamples;++i)
+			{
+			Point rawPosition=i<stepSample?start:end;
+			TrackerState result=filterSample(rawPosition,Rotation::identity,double(i)/120.0);
+			if(i>=stepSample)
+				{
+				/* Remember the last time at which the filtered position was not settled: */
+				Point position=result.positionOrientation.getOrigin();
+				if(Geometry::dist(position,end)>Scalar(1))
+					settleTime=double(i-stepSample+1)*1000.0/120.0;
+				if(overshoot<double(position[0]-end[0]))
+					overshoot=double(position[0]-end[0]);
+				}
+			}
+		
+		checkMax("settle time",settleTime,maxSettleTime,"ms");
+		checkMax("overshoot",overshoot,maxOvershoot,"mm");
+		}
+	};
+
+class FilterMotionTest:public FilterTest // Test checking how closely a filter follows hand-like motion sampled at irregular intervals
+	{
+	/* Elements: */
+	private:
+	double maxPositionError; // Largest acceptable RMS position error in mm
+	double maxVelocityError; // Largest acceptable RMS linear velocity error in mm/s
+	double minLag,maxLag; // Range of acceptable lag in ms
+	
+	/* Private methods: */
+	static void getTruth(double time,Point& position,Vector& velocity) // Returns the ground truth position and velocity at the given time in seconds
+		{
+		/* Superimpose slow reaching motions, faster gestures, and tremor: */
+		static const double amplitudes[3]={150.0,60.0,5.0}; // Amplitudes in mm
+		static const double frequencies[3]={0.4,1.1,2.7}; // Frequencies in Hz
+		position=Point(0,0,600);
+		velocity=Vector::zero;
+		for(int i=0;i<3;++i)
+			{
+			double omega=2.0*Math::Constants<double>::pi*frequencies[i];
+			for(int j=0;j<3;++j)
+				{
+				double phase=omega*time+double(i*3+j);
+				position[j]+=Scalar(amplitudes[i]*Math::sin(phase));
+				velocity[j]+=Scalar(amplitudes[i]*omega*Math::cos(phase));
+				}
+			}
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FilterMotionTest(const FilterType& sType,double sMaxPositionError,double sMaxVelocityError,double sMinLag,double sMaxLag)
+		:FilterTest("HandMotion",sType),
+		 maxPositionError(sMaxPositionError),maxVelocityError(sMaxVelocityError),minLag(sMinLag),maxLag(sMaxLag)
+		{
+		}
+	
+	/* Methods: */
+	virtual void runTrace(void)
+		{
+		/*****************************************************************
+		Sample the motion for eight seconds at nominally 120Hz with +-2ms
+		of jitter, 0.5mm of Gaussian noise, 5% dropped samples, and a one-
+		second tracking loss after four seconds that must restart the
+		filter:
+		*****************************************************************/
+		
+		const double duration=8.0;
+		const double lossStart=4.0,lossEnd=5.0;
+		const double settleTime=0.5; // Time after the start and after the tracking loss during which errors are not measured
+		RandomSource random(31);
+		double positionSqrSum=0.0;
+		double velocitySqrSum=0.0;
+		double lagNumerator=0.0,lagDenominator=0.0;
+		double restartError=0.0;
+		bool restarted=false;
+		int numMeasured=0;
+		for(double time=0.0;time<duration;time+=(8.333+(random()-0.5)*4.0)*1.0e-3)
+			{
+			/* Skip dropped samples and samples during the tracking loss: */
+			if(random()<0.05||(time>=lossStart&&time<lossEnd))
+				continue;
+			
+			/* Filter a noisy measurement of the ground truth: */
+			Point truePosition;
+			Vector trueVelocity;
+			getTruth(time,truePosition,trueVelocity);
+			Point rawPosition=truePosition+random.gaussianVector(0.5);
+			TrackerState result=filterSample(rawPosition,Rotation::identity,time);
+			Point position=result.positionOrientation.getOrigin();
+			
+			if(time>=lossEnd&&!restarted)
+				{
+				/* The first sample after the tracking loss must restart the filter: */
+				restartError=double(Geometry::dist(position,rawPosition));
+				restarted=true;
+				}
+			
+			if(time>=settleTime&&(time<lossStart||time>=lossEnd+settleTime))
+				{
+				/* Accumulate the position and velocity errors, and the lag along the direction of motion: */
+				Vector positionDelta=position-truePosition;
+				positionSqrSum+=double(Geometry::sqr(positionDelta));
+				velocitySqrSum+=double(Geometry::sqr(result.linearVelocity-trueVelocity));
+				lagNumerator-=double(positionDelta*trueVelocity);
+				lagDenominator+=double(Geometry::sqr(trueVelocity));
+				++numMeasured;
+				}
+			}
+		
+		checkMax("restart error",restartError,1.0e-3,"mm");
+		checkMax("position error",Math::sqrt(positionSqrSum/double(numMeasured)),maxPositionError,"mm");
+		checkMax("velocity error",Math::sqrt(velocitySqrSum/double(numMeasured)),maxVelocityError,"mm/s");
+		check("lag",lagNumerator*1000.0/lagDenominator,minLag,maxLag,"ms");
+		}
+	};
+
+class FilterRotationTest:public FilterTest // Test checking how closely a filter follows a rotating tracker
+	{
+	/* Elements: */
+	private:
+	double maxOrientationError; // Largest acceptable RMS orientation error in degrees
+	double maxAngularVelocityError; // Largest acceptable RMS angular velocity error in degrees/s
+	
+	/* Constructors and destructors: */
+	public:
+	FilterRotationTest(const FilterType& sType,double sMaxOrientationError,double sMaxAngularVelocityError)
+		:FilterTest("Rotation",sType),
+		 maxOrientationError(sMaxOrientationError),maxAngularVelocityError(sMaxAngularVelocityError)
+		{
+		}
+	
+	/* Methods: */
+	virtual void runTrace(void)
+		{
+		/* Rotate the tracker around a tilted axis at 90 degrees/s plus a 0.7Hz wobble, sampled at 120Hz for four seconds with 0.2 degrees of Gaussian noise: */
+		const Vector axis=Geometry::normalize(Vector(1,2,3));
+		const Rotation initialOrientation=Rotation::rotateX(Scalar(0.3));
+		const double baseSpeed=Math::rad(90.0);
+		const double wobbleAmplitude=0.5;
+		const double wobbleOmega=2.0*Math::Constants<double>::pi*0.7;
+		const int numSamples=480;
+		const int numSettleSamples=120; // Samples during which the filter settles and errors are not measured
+		RandomSource random(37);
+		double orientationSqrSum=0.0;
+		double angularVelocitySqrSum=0.0;
+		double maxNormError=0.0;
+		for(int i=0;i<numSamples;++i)
+			{
+			/* Calculate the ground truth orientation and world-space angular velocity at the sample time: */
+			double time=double(i)/120.0;
+			double rotationAngle=baseSpeed*time+wobbleAmplitude*Math::sin(wobbleOmega*time);
+			Rotation trueOrientation=Rotation::rotateAxis(axis,Scalar(rotationAngle))*initialOrientation;
+			Vector trueAngularVelocity=axis*Scalar(baseSpeed+wobbleAmplitude*wobbleOmega*Math::cos(wobbleOmega*time));
+			
+			/* Filter a noisy measurement of the ground truth: */
+			Rotation rawOrientation=Rotation(random.gaussianVector(Math::rad(0.2)))*trueOrientation;
+			TrackerState result=filterSample(Point(0,0,600),rawOrientation,time);
+			if(maxNormError<normError(result.positionOrientation.getRotation()))
+				maxNormError=normError(result.positionOrientation.getRotation());
+			if(i>=numSettleSamples)
+				{
+				orientationSqrSum+=Math::sqr(angle(trueOrientation,result.positionOrientation.getRotation()));
+				angularVelocitySqrSum+=double(Geometry::sqr(result.angularVelocity-trueAngularVelocity));
+				}
+			}
+		
+		double numMeasured=double(numSamples-numSettleSamples);
+		checkMax("quaternion norm error",maxNormError,1.0e-4,"");
+		checkMax("orientation error",Math::sqrt(orientationSqrSum/numMeasured),maxOrientationError,"deg");
+		checkMax("angular velocity error",Math::deg(Math::sqrt(angularVelocitySqrSum/numMeasured)),maxAngularVelocityError,"deg/s");
+		}
+	};
+
+/* Tested filter plug-ins and settings: */
+const FilterType oneEuroFilter={"OneEuroFilter","","",createObjectOneEuroFilter,destroyObjectOneEuroFilter};
+const FilterType kalmanFilter={"KalmanFilter","","",createObjectKalmanFilter,destroyObjectKalmanFilter};
+const FilterType doubleExponentialFilter={"DoubleExponentialFilter","","",createObjectDoubleExponentialFilter,destroyObjectDoubleExponentialFilter};
+const FilterType predictingDoubleExponentialFilter={"DoubleExponentialFilter","predictionTime=0.01","predictionTime 0.01\n",createObjectDoubleExponentialFilter,destroyObjectDoubleExponentialFilter};
+
+/****************
+Calibrator tests:
+****************/
+
+class CalibrationGridFixture // Class to create a calibration data file for a distorted curvilinear grid
+	{
+	/* Elements: */
+	private:
+	std::string fileName; // Name of the temporary calibration data file
+	int gridSize; // Number of grid vertices in each dimension
+	bool linearOffsets; // Flag whether the calibration offsets are linear functions of position, which the grid interpolates exactly
+	
+	/* Constructors and destructors: */
+	public:
+	CalibrationGridFixture(const std::string& sFileName,int sGridSize,bool sLinearOffsets)
+		:fileName(sFileName),gridSize(sGridSize),linearOffsets(sLinearOffsets)
+		{
+		IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly);
+		file->setEndianness(Misc::LittleEndian);
+		for(int i=0;i<3;++i)
+			file->write<int>(gridSize);
+		for(int x=0;x<gridSize;++x)
+			for(int y=0;y<gridSize;++y)
+				for(int z=0;z<gridSize;++z)
+					{
+					/* Write the vertex position: */
+					Point pos=getPosition(Scalar(x),Scalar(y),Scalar(z));
+					float posf[3];
+					for(int i=0;i<3;++i)
+						posf[i]=float(pos[i]);
+					file->write(posf,3);
+					
+					/* Write the unused raw orientation: */
+					float quat[4]={0.0f,0.0f,0.0f,1.0f};
+					file->write(quat,4);
+					
+					/* Write the position and orientation offsets at the position as stored in the file: */
+					Vector positionOffset,orientationOffset;
+					getOffsets(Point(posf[0],posf[1],posf[2]),positionOffset,orientationOffset);
+					float offsets[6];
+					for(int i=0;i<3;++i)
+						{
+						offsets[i]=float(positionOffset[i]);
+						offsets[3+i]=float(orientationOffset[i]);
+						}
+					file->write(offsets,6);
+					}
+		}
+	~CalibrationGridFixture(void)
+		{
+		unlink(fileName.c_str());
+		}
+	
+	/* Methods: */
+	const std::string& getFileName(void) const // Returns the calibration data file's name
+		{
+		return fileName;
+		}
+	Point getPosition(Scalar x,Scalar y,Scalar z) const // Returns the position of the grid at the given fractional vertex index; grid covers roughly [-60, 60]^2 x [0, 120]
+		{
+		Scalar cellSize=Scalar(120)/Scalar(gridSize-1);
+		Point result;
+		result[0]=x*cellSize-Scalar(60)+Math::sin(y*Scalar(0.3))*cellSize*Scalar(0.2);
+		result[1]=y*cellSize-Scalar(60)+Math::sin(z*Scalar(0.4))*cellSize*Scalar(0.2);
+		result[2]=z*cellSize+Math::sin(x*Scalar(0.5))*cellSize*Scalar(0.2);
+		return result;
+		}
+	void getOffsets(const Point& p,Vector& positionOffset,Vector& orientationOffset) const // Returns the true calibration offsets at the given position
+		{
+		if(linearOffsets)
+			{
+			positionOffset=Vector(Scalar(0.01)*p[0]+Scalar(0.002)*p[1]+Scalar(0.5),Scalar(-0.003)*p[0]+Scalar(0.02)*p[2],Scalar(0.001)*p[1]-Scalar(0.01)*p[2]+Scalar(1));
+			orientationOffset=Vector(Scalar(0.0001)*p[0],Scalar(0.0002)*p[1],Scalar(-0.0001)*p[2]+Scalar(0.01));
+			}
+		else
+			{
+			positionOffset=Vector(Math::sin(p[0]*Scalar(0.02))*Scalar(1),Math::cos(p[1]*Scalar(0.015))*Scalar(1),Math::sin((p[0]+p[2])*Scalar(0.01))*Scalar(1));
+			orientationOffset=Vector(Math::sin(p[1]*Scalar(0.01))*Scalar(0.01),Math::cos(p[2]*Scalar(0.02))*Scalar(0.01),Math::sin((p[0]-p[1])*Scalar(0.01))*Scalar(0.01));
+			}
+		}
+	};
+
+class GridCalibratorTest:public Test // Base class for tests calibrating random tracker states with grid calibrators
+	{
+	/* Elements: */
+	protected:
+	RandomSource random; // Source of random tracker states
+	
+	/* Protected methods: */
+	static VRCalibrator* createCalibrator(const std::string& calibrationFileName,int lookupGridSize,const std::string& extraSettings =std::string()) // Creates a single-tracker grid calibrator with the given lookup grid size, or exact evaluation if the size is zero
+		{
+		std::string settings=Misc::stringPrintf("calibrationFileName %s\n",calibrationFileName.c_str());
+		settings.append(Misc::stringPrintf("lookupGridSize (%d, %d, %d)\n",lookupGridSize,lookupGridSize,lookupGridSize));
+		settings.append(extraSettings);
+		ConfigurationFixture fixture(getTempFileName(".cfg"),settings);
+		Misc::ConfigurationFile configFile(fixture.getFileName().c_str());
+		configFile.setCurrentSection("/Test");
+		VRCalibrator* result=createObjectGridCalibrator(0,0,configFile);
+		result->setNumTrackers(1);
+		return result;
+		}
+	TrackerState createState(const Point& position) // Returns a tracker state at the given position with a random orientation
+		{
+		TrackerState result;
+		Vector axis(Scalar(random()-0.5),Scalar(random()-0.5),Scalar(random()-0.5));
+		result.positionOrientation=PositionOrientation(position-Point::origin,Rotation::rotateAxis(axis,Scalar(random()*3.0)));
+		result.linearVelocity=Vector::zero;
+		result.angularVelocity=Vector::zero;
+		return result;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	GridCalibratorTest(const char* sName,const std::string& sParameters,Misc::UInt32 randomSeed)
+		:Test("GridCalibrator",sName,sParameters),
+		 random(randomSeed)
+		{
+		}
+	};
+
+class GridCalibratorExactTest:public GridCalibratorTest // Test checking calibration results against offsets that are linear functions of position
+	{
+	/* Elements: */
+	private:
+	int lookupGridSize; // Number of lookup grid vertices in each dimension, or zero to evaluate the calibration grid exactly
+	
+	/* Constructors and destructors: */
+	public:
+	GridCalibratorExactTest(int sLookupGridSize)
+		:GridCalibratorTest("LinearOffsets",sLookupGridSize>=2?Misc::stringPrintf("lookup=%d",sLookupGridSize):std::string("lookup=none"),41),
+		 lookupGridSize(sLookupGridSize)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		/* Trilinear interpolation in a curvilinear grid reproduces linear functions exactly, even in distorted cells: */
+		const int gridSize=16;
+		CalibrationGridFixture grid(getTempFileName(".dat"),gridSize,true);
+		VRCalibrator* calibrator=createCalibrator(grid.getFileName(),lookupGridSize);
+		
+		/* Calibrate random states inside the grid, avoiding the outermost half cell whose boundary is curved: */
+		double maxPositionError=0.0;
+		double maxOrientationError=0.0;
+		for(int i=0;i<10000;++i)
+			{
+			Scalar index[3];
+			for(int j=0;j<3;++j)
+				index[j]=Scalar(0.5+random()*double(gridSize-2));
+			Point rawPosition=grid.getPosition(index[0],index[1],index[2]);
+			TrackerState state=createState(rawPosition);
+			Rotation rawOrientation=state.positionOrientation.getRotation();
+			calibrator->calibrate(0,state);
+			
+			/* Compare against the known offsets: */
+			Vector positionOffset,orientationOffset;
+			grid.getOffsets(rawPosition,positionOffset,orientationOffset);
+			double positionError=double(Geometry::dist(state.positionOrientation.getOrigin(),rawPosition+positionOffset));
+			if(maxPositionError<positionError)
+				maxPositionError=positionError;
+			double orientationError=angle(Rotation(orientationOffset)*rawOrientation,state.positionOrientation.getRotation());
+			if(maxOrientationError<orientationError)
+				maxOrientationError=orientationError;
+			}
+		destroyObjectGridCalibrator(calibrator,0,0);
+		
+		checkMax("maximum position error",maxPositionError,1.0e-3,"mm");
+		checkMax("maximum orientation error",maxOrientationError,1.0e-3,"deg");
+		}
+	};
+
+class GridCalibratorLookupTest:public GridCalibratorTest // Test comparing a calibrator's resampled lookup grid against exact evaluation of the calibration grid at random positions
+	{
+	/* Elements: */
+	private:
+	int lookupGridSize; // Number of lookup grid vertices in each dimension
+	double positionTolerance; // Lookup position tolerance in mm
+	double orientationTolerance; // Lookup orientation tolerance in radians
+	bool expectLookup; // Flag whether the lookup grid is expected to meet the tolerances; otherwise, the calibrator must fall back to exact evaluation
+	
+	/* Constructors and destructors: */
+	public:
+	GridCalibratorLookupTest(int sLookupGridSize,double sPositionTolerance,double sOrientationTolerance,bool sExpectLookup)
+		:GridCalibratorTest("LookupVsExact",Misc::stringPrintf("lookup=%d,positionTolerance=%g,orientationTolerance=%g",sLookupGridSize,sPositionTolerance,sOrientationTolerance),43),
+		 lookupGridSize(sLookupGridSize),
+		 positionTolerance(sPositionTolerance),orientationTolerance(sOrientationTolerance),
+		 expectLookup(sExpectLookup)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		/* Create an exact and a lookup calibrator for the same smoothly varying offsets: */
+		const int gridSize=16;
+		CalibrationGridFixture grid(getTempFileName(".dat"),gridSize,false);
+		VRCalibrator* exact=createCalibrator(grid.getFileName(),0);
+		VRCalibrator* lookup=createCalibrator(grid.getFileName(),lookupGridSize,Misc::stringPrintf("lookupPositionTolerance %g\nlookupOrientationTolerance %g\n",positionTolerance,orientationTolerance));
+		
+		/*****************************************************************
+		Calibrate random states spread over the grid's bounding box, which
+		includes positions outside the curved grid boundary, and random
+		states concentrated within one calibration cell of the boundary,
+		where lookup cells are only partially covered:
+		*****************************************************************/
+		
+		const int numStates=40000;
+		double maxPositionError=0.0;
+		double maxOrientationError=0.0;
+		int numDifferent=0;
+		for(int i=0;i<numStates;++i)
+			{
+			Point rawPosition;
+			if(i%2==0)
+				{
+				for(int j=0;j<3;++j)
+					rawPosition[j]=Scalar(-70.0+random()*140.0);
+				rawPosition[2]+=Scalar(60);
+				}
+			else
+				{
+				Scalar index[3];
+				for(int j=0;j<3;++j)
+					index[j]=Scalar(random()*double(gridSize-1));
+				int face=int(random()*6.0);
+				index[face/2]=Scalar(face%2==0?random():double(gridSize-1)-random());
+				rawPosition=grid.getPosition(index[0],index[1],index[2]);
+				}
+			TrackerState exactState=createState(rawPosition);
+			TrackerState lookupState=exactState;
+			exact->calibrate(0,exactState);
+			lookup->calibrate(0,lookupState);
+			
+			/* Compare the calibrated states: */
+			double positionError=double(Geometry::dist(exactState.positionOrientation.getOrigin(),lookupState.positionOrientation.getOrigin()));
+			if(maxPositionError<positionError)
+				maxPositionError=positionError;
+			double orientationError=angle(exactState.positionOrientation.getRotation(),lookupState.positionOrientation.getRotation());
+			if(maxOrientationError<orientationError)
+				maxOrientationError=orientationError;
+			if(positionError!=0.0)
+				++numDifferent;
+			}
+		destroyObjectGridCalibrator(exact,0,0);
+		destroyObjectGridCalibrator(lookup,0,0);
+		
+		/* Check whether the lookup grid was used, and that it met the tolerances everywhere, not only where the calibrator checked it: */
+		if(expectLookup)
+			check("lookup use",double(numDifferent)*100.0/double(numStates),25.0,100.0,"%");
+		else
+			check("lookup use",double(numDifferent)*100.0/double(numStates),0.0,0.0,"%");
+		checkMax("maximum position deviation",maxPositionError,positionTolerance,"mm");
+		checkMax("maximum orientation deviation",maxOrientationError,Math::deg(orientationTolerance),"deg");
+		}
+	};
+
+/****************************
+DTrack message parser tests:
+****************************/
+
+class DTrackParserTest:public Test // Test replaying hand-written DTrack messages, including malformed ones, and checking the parsed tracker batches
+	{
+	/* Embedded classes: */
+	private:
+	struct Message // Structure for a hand-written DTrack data message and the device states it must produce
+		{
+		/* Elements: */
+		public:
+		std::string contents; // Contents of the message
+		std::vector<int> trackerIndices; // Expected device indices of the reported trackers, in order
+		std::vector<Point> positions; // Expected positions of the reported trackers
+		};
+	
+	static const size_t maxMessageSize=8192; // Maximum size of a replayed message
+	static const size_t overrunSize=128; // Size of buffer space after the sentinel characters reserved for overrun detection text
+	
+	/* Elements: */
+	bool binary; // Flag whether the replayed messages are in binary format
+	std::vector<Message> messages; // Messages replayed by the test
+	
+	/* Private methods: */
+	static void appendAsciiBody(std::string& message,int id,const Point& pos,bool withMatrix =true) // Appends a 6d body record to an ASCII message
+		{
+		message.append(Misc::stringPrintf("[%d 1.000][%.3f %.3f %.3f 0.0 0.0 90.0]",id,double(pos[0]),double(pos[1]),double(pos[2])));
+		if(withMatrix)
+			message.append("[0.000 1.000 0.000 -1.000 0.000 0.000 0.000 0.000 1.000]");
+		}
+	template <class DataParam>
+	static void appendBinary(std::string& message,DataParam value) // Appends a value to a binary message in DTrack's little-endian byte order
+		{
+		#if __BYTE_ORDER==__BIG_ENDIAN
+		Misc::swapEndianness(value);
+		#endif
+		message.append(reinterpret_cast<const char*>(&value),sizeof(DataParam));
+		}
+	static void appendBinaryBody(std::string& message,unsigned int id,const Point& pos) // Appends a body record to a binary message
+		{
+		appendBinary<unsigned int>(message,id);
+		appendBinary<float>(message,1.0f);
+		for(int i=0;i<3;++i)
+			appendBinary<float>(message,float(pos[i]));
+		float angles[3]={0.0f,0.0f,90.0f};
+		for(int i=0;i<3;++i)
+			appendBinary<float>(message,angles[i]);
+		float matrix[9]={0.0f,1.0f,0.0f,-1.0f,0.0f,0.0f,0.0f,0.0f,1.0f};
+		for(int i=0;i<9;++i)
+			appendBinary<float>(message,matrix[i]);
+		}
+	void addMessage(const std::string& contents,int numTrackers,const int* trackerIndices,const Point* positions) // Adds a message and its expected tracker batch
+		{
+		messages.push_back(Message());
+		Message& m=messages.back();
+		m.contents=contents;
+		for(int i=0;i<numTrackers;++i)
+			{
+			m.trackerIndices.push_back(trackerIndices[i]);
+			m.positions.push_back(positions[i]);
+			}
+		}
+	void createAsciiMessages(void) // Creates the replayed ASCII messages
+		{
+		Point p[5]={Point(326.848,-187.216,109.231),Point(12.5,-3.25,1500.0),Point(-410.0,220.5,980.75),Point(1.0,2.0,3.0),Point(4.0,5.0,6.0)};
+		
+		/* A complete frame with two 6d bodies and one 6df2 flystick pressing its second button: */
+		std::string m="fr 21753\n6d 2 ";
+		appendAsciiBody(m,0,p[0]);
+		appendAsciiBody(m,1,p[1]);
+		m.append("\n6df2 1 1 [0 1.000 2 1][-410.000 220.500 980.750][0.000 1.000 0.000 -1.000 0.000 0.000 0.000 0.000 1.000][2 0.500]\n");
+		int complete[3]={0,1,2};
+		addMessage(m,3,complete,p);
+		
+		/* A frame with body IDs that are negative or not configured: */
+		m="fr 21754\n6d 3 ";
+		appendAsciiBody(m,5,p[3]);
+		appendAsciiBody(m,-1,p[4]);
+		appendAsciiBody(m,1,p[1]);
+		m.push_back('\n');
+		int unknown[1]={1};
+		addMessage(m,1,unknown,&p[1]);
+		
+		/* A frame truncated in the middle of its second body: */
+		m="fr 21755\n6d 2 ";
+		appendAsciiBody(m,0,p[0]);
+		m.append("[1 1.000][12.500 -3");
+		int truncated[1]={0};
+		addMessage(m,1,truncated,&p[0]);
+		
+		/* A frame truncated before the first body's rotation matrix: */
+		m="fr 21756\n6d 1 ";
+		appendAsciiBody(m,0,p[0],false);
+		addMessage(m,0,0,0);
+		
+		/* A frame reporting the same bodies repeatedly; the last report of each body must win without using up another device's place in the batch: */
+		m="fr 21757\n6d 5 ";
+		for(int i=0;i<5;++i)
+			appendAsciiBody(m,i%2,p[i]);
+		m.append("\n6df2 1 1 [0 1.000 2 1][-410.000 220.500 980.750][0.000 1.000 0.000 -1.000 0.000 0.000 0.000 0.000 1.000][2 0.500]\n");
+		int repeated[3]={0,1,2};
+		Point repeatedPos[3]={p[4],p[3],p[2]};
+		addMessage(m,3,repeated,repeatedPos);
+		}
+	void createBinaryMessages(void) // Creates the replayed binary messages
+		{
+		Point p[5]={Point(326.848,-187.216,109.231),Point(12.5,-3.25,1500.0),Point(-410.0,220.5,980.75),Point(1.0,2.0,3.0),Point(4.0,5.0,6.0)};
+		
+		/* A complete frame with three bodies: */
+		std::string m;
+		appendBinary<unsigned int>(m,21753U);
+		appendBinary<int>(m,3);
+		for(int i=0;i<3;++i)
+			appendBinaryBody(m,i,p[i]);
+		int complete[3]={0,1,2};
+		addMessage(m,3,complete,p);
+		
+		/* A frame with body IDs that are out of range: */
+		m.clear();
+		appendBinary<unsigned int>(m,21754U);
+		appendBinary<int>(m,3);
+		appendBinaryBody(m,7U,p[3]);
+		appendBinaryBody(m,0xffffffffU,p[4]);
+		appendBinaryBody(m,2U,p[2]);
+		int unknown[1]={2};
+		addMessage(m,1,unknown,&p[2]);
+		
+		/* A frame claiming more bodies than it contains, truncated in the middle of its third body: */
+		m.clear();
+		appendBinary<unsigned int>(m,21755U);
+		appendBinary<int>(m,1000);
+		for(int i=0;i<3;++i)
+			appendBinaryBody(m,i,p[i]);
+		m.resize(m.size()-20);
+		int truncated[2]={0,1};
+		addMessage(m,2,truncated,p);
+		
+		/* A frame with a negative body count: */
+		m.clear();
+		appendBinary<unsigned int>(m,21756U);
+		appendBinary<int>(m,-5);
+		appendBinaryBody(m,0,p[0]);
+		addMessage(m,0,0,0);
+		
+		/* A frame truncated in the middle of its header: */
+		m.clear();
+		appendBinary<unsigned int>(m,21757U);
+		addMessage(m,0,0,0);
+		
+		/* A frame reporting the first bodies repeatedly: */
+		m.clear();
+		appendBinary<unsigned int>(m,21758U);
+		appendBinary<int>(m,5);
+		for(int i=0;i<5;++i)
+			appendBinaryBody(m,i%3,p[i]);
+		int repeated[3]={0,1,2};
+		Point repeatedPos[3]={p[3],p[4],p[2]};
+		addMessage(m,3,repeated,repeatedPos);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	DTrackParserTest(bool sBinary)
+		:Test("ArtDTrackParser","ReplayMessages",sBinary?"format=binary":"format=ascii"),
+		 binary(sBinary)
+		{
+		if(binary)
+			createBinaryMessages();
+		else
+			createAsciiMessages();
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		/* Configure two 6d bodies and a 6df2 flystick with two buttons and one valuator: */
+		ArtDTrackParser::Device devices[3];
+		for(int i=0;i<3;++i)
+			{
+			devices[i].reportFormat=i<2?ArtDTrackParser::DRF_6D:ArtDTrackParser::DRF_6DF2;
+			devices[i].id=i<2?i:0;
+			devices[i].numButtons=i<2?0:2;
+			devices[i].firstButtonIndex=0;
+			devices[i].numValuators=i<2?0:1;
+			devices[i].firstValuatorIndex=0;
+			}
+		ArtDTrackParser parser(3,devices);
+		
+		/* Replay all messages and check the resulting tracker batches: */
+		std::vector<char> buffer(maxMessageSize+2+overrunSize);
+		char* messageBuffer=&buffer[0];
+		for(size_t messageIndex=0;messageIndex<messages.size();++messageIndex)
+			{
+			const Message& m=messages[messageIndex];
+			
+			/* Copy the message into a buffer filled with digits to catch parsing past the end of the message: */
+			memset(messageBuffer,'7',buffer.size());
+			memcpy(messageBuffer,m.contents.data(),m.contents.size());
+			if(binary)
+				parser.parseBinaryMessage(messageBuffer,m.contents.size());
+			else
+				{
+				/* Follow the sentinel newline with text completing a truncated body record, to catch parsing past the sentinel: */
+				static const char overrun[]="1500.000 0.0 0.0 90.0][0.000 1.000 0.000 -1.000 0.000 0.000 0.000 0.000 1.000]";
+				memcpy(messageBuffer+m.contents.size()+1,overrun,sizeof(overrun));
+				parser.parseAsciiMessage(messageBuffer,m.contents.size());
+				}
+			
+			/* Check the batch's size and tracker indices: */
+			if(parser.getNumFrameTrackers()!=int(m.trackerIndices.size()))
+				Misc::throwStdErr("Message %u produced %d tracker states instead of %u",(unsigned int)messageIndex,parser.getNumFrameTrackers(),(unsigned int)m.trackerIndices.size());
+			for(int i=0;i<parser.getNumFrameTrackers();++i)
+				{
+				if(parser.getFrameTrackerIndices()[i]!=m.trackerIndices[i])
+					Misc::throwStdErr("Message %u reported tracker %d as device %d instead of %d",(unsigned int)messageIndex,i,parser.getFrameTrackerIndices()[i],m.trackerIndices[i]);
+				
+				/* Check the tracker's position and its orientation of 90 degrees around the z axis: */
+				const PositionOrientation& po=parser.getFrameTrackerStates()[i].positionOrientation;
+				if(Geometry::dist(po.getOrigin(),m.positions[i])>Scalar(1.0e-3))
+					Misc::throwStdErr("Message %u reported a wrong position for tracker %d",(unsigned int)messageIndex,i);
+				if((po.getRotation().transform(Vector(1,0,0))-Vector(0,1,0)).mag()>Scalar(1.0e-3))
+					Misc::throwStdErr("Message %u reported a wrong orientation for tracker %d",(unsigned int)messageIndex,i);
+				}
+			}
+		if(!binary&&(parser.getButtonState(0)||!parser.getButtonState(1)||Math::abs(parser.getValuatorState(0)-0.5f)>1.0e-6f))
+			throw std::runtime_error("Flystick button or valuator states were parsed incorrectly");
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	TestRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Tracker filters, with bounds on noise reduction, step response, and tracking errors on hand-like and rotational motion: */
+	runner.addTest(new FilterNoiseTest(oneEuroFilter,0.3,0.3,10.0));
+	runner.addTest(new FilterStepTest(oneEuroFilter,60.0,0.5));
+	runner.addTest(new FilterMotionTest(oneEuroFilter,6.0,600.0,0.0,8.0));
+	runner.addTest(new FilterRotationTest(oneEuroFilter,14.0,80.0));
+	runner.addTest(new FilterNoiseTest(kalmanFilter,1.0,1.0,150.0));
+	runner.addTest(new FilterStepTest(kalmanFilter,40.0,12.0));
+	runner.addTest(new FilterMotionTest(kalmanFilter,1.2,150.0,-1.0,1.0));
+	runner.addTest(new FilterRotationTest(kalmanFilter,0.5,60.0));
+	runner.addTest(new FilterNoiseTest(doubleExponentialFilter,0.9,0.9,45.0));
+	runner.addTest(new FilterStepTest(doubleExponentialFilter,90.0,9.0));
+	runner.addTest(new FilterMotionTest(doubleExponentialFilter,1.4,150.0,-1.0,1.0));
+	runner.addTest(new FilterRotationTest(doubleExponentialFilter,0.45,25.0));
+	runner.addTest(new FilterNoiseTest(predictingDoubleExponentialFilter,1.3,1.3,45.0));
+	runner.addTest(new FilterStepTest(predictingDoubleExponentialFilter,100.0,40.0));
+	runner.addTest(new FilterMotionTest(predictingDoubleExponentialFilter,10.0,150.0,-11.0,-8.5));
+	runner.addTest(new FilterRotationTest(predictingDoubleExponentialFilter,2.0,25.0));
+	
+	/* Grid calibrators, with lookup tolerances just above the errors the lookup grids reach, and below them to force exact evaluation: */
+	runner.addTest(new GridCalibratorExactTest(0));
+	runner.addTest(new GridCalibratorExactTest(64));
+	runner.addTest(new GridCalibratorLookupTest(64,0.002,2.0e-5,true));
+	runner.addTest(new GridCalibratorLookupTest(128,0.001,1.0e-5,true));
+	runner.addTest(new GridCalibratorLookupTest(64,0.0005,5.0e-6,false));
+	
+	/* DTrack message parser, replaying well-formed and malformed messages in both formats: */
+	runner.addTest(new DTrackParserTest(false));
+	runner.addTest(new DTrackParserTest(true));
+	
+	return runner.run();
+	}
@@ -0,0 +1,277 @@
+/***********************************************************************
+IOTests - Correctness tests for the file filters of the I/O support
+library, checking the data read through them against known contents.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StringPrintf.h>
+#include <IO/File.h>
+#include <IO/StandardFile.h>
+#include <IO/ReadAheadFilter.h>
+#include <IO/OpenFile.h>
+
+#include "Test.h"
+#include "TestRunner.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+inline unsigned char patternByte(size_t offset) // Returns the byte at the given offset of the test data pattern, which does not repeat with power-of-two periods
+	{
+	return (unsigned char)((offset*7U)^(offset>>8)^(offset/251U));
+	}
+
+class DataFileFixture // Class to create a temporary file filled with the test data pattern
+	{
+	/* Elements: */
+	private:
+	std::string fileName; // Name of the temporary file
+	
+	/* Constructors and destructors: */
+	public:
+	DataFileFixture(const std::string& sFileName,size_t size)
+		:fileName(sFileName)
+		{
+		std::vector<unsigned char> data(size);
+		for(size_t i=0;i<size;++i)
+			data[i]=patternByte(i);
+		IO::StandardFile file(fileName.c_str(),IO::File::WriteOnly);
+		file.writeRaw(&data[0],size);
+		}
+	~DataFileFixture(void)
+		{
+		unlink(fileName.c_str());
+		}
+	
+	/* Methods: */
+	const std::string& getFileName(void) const // Returns the file's name
+		{
+		return fileName;
+		}
+	};
+
+class FailingFile:public IO::File // Class for a source that delivers the test data pattern up to a given offset, and then fails
+	{
+	/* Elements: */
+	private:
+	size_t failOffset; // Offset at which reading fails
+	size_t offset; // Offset of the next delivered byte
+	
+	/* Protected methods from IO::File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize)
+		{
+		if(offset>=failOffset)
+			throw Error("FailingFile: Simulated read error");
+		
+		/* Deliver at most 1000 bytes at a time to exercise partial reads: */
+		size_t readSize=failOffset-offset;
+		if(readSize>bufferSize)
+			readSize=bufferSize;
+		if(readSize>1000)
+			readSize=1000;
+		for(size_t i=0;i<readSize;++i,++offset)
+			buffer[i]=patternByte(offset);
+		return readSize;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FailingFile(size_t sFailOffset)
+		:IO::File(ReadOnly),
+		 failOffset(sFailOffset),offset(0)
+		{
+		}
+	};
+
+size_t readAndCompare(IO::File& file,size_t startOffset,size_t maxSize) // Reads up to the given amount of data from the file in irregular chunks and compares it against the test data pattern; returns the amount of data read
+	{
+	std::vector<unsigned char> chunk(7919);
+	size_t offset=startOffset;
+	size_t chunkSize=1;
+	while(offset-startOffset<maxSize)
+		{
+		/* Read the next chunk: */
+		if(chunkSize>maxSize-(offset-startOffset))
+			chunkSize=maxSize-(offset-startOffset);
+		size_t readSize=file.readUpTo(&chunk[0],chunkSize);
+		if(readSize==0)
+			break;
+		
+		/* Compare the chunk: */
+		for(size_t i=0;i<readSize;++i)
+			if(chunk[i]!=patternByte(offset+i))
+				Misc::throwStdErr("Wrong data at offset %u",(unsigned int)(offset+i));
+		offset+=readSize;
+		
+		/* Vary the chunk size: */
+		chunkSize=(chunkSize*37U+11U)%chunk.size()+1;
+		}
+	return offset-startOffset;
+	}
+
+/************************
+Read-ahead filter tests:
+************************/
+
+class ReadAheadFilterTest:public Test // Test reading a file through a read-ahead filter after part of it was already read directly
+	{
+	/* Elements: */
+	private:
+	unsigned int numThreads; // Number of read-ahead threads
+	unsigned int numBuffers; // Number of ring buffer slots
+	size_t bufferSize; // Size of each ring buffer slot
+	size_t skipSize; // Amount of data read from the file before the filter is attached
+	
+	/* Constructors and destructors: */
+	public:
+	ReadAheadFilterTest(unsigned int sNumThreads,unsigned int sNumBuffers,size_t sBufferSize,size_t sSkipSize)
+		:Test("ReadAheadFilter","PartlyReadFile",Misc::stringPrintf("threads=%u,buffers=%u,bufferSize=%u,skip=%u",sNumThreads,sNumBuffers,(unsigned int)sBufferSize,(unsigned int)sSkipSize)),
+		 numThreads(sNumThreads),numBuffers(sNumBuffers),bufferSize(sBufferSize),skipSize(sSkipSize)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		/* Create a file whose size is not a multiple of the buffer size: */
+		const size_t fileSize=3*1024*1024+4321;
+		DataFileFixture data(getTempFileName(".dat"),fileSize);
+		
+		/* Read the beginning of the file directly, leaving unread data in the file's buffer: */
+		IO::FilePtr file=new IO::StandardFile(data.getFileName().c_str());
+		size_t numSkipped=readAndCompare(*file,0,skipSize);
+		
+		/* Read the rest of the file through a read-ahead filter: */
+		IO::ReadAheadFilter filter(file,numBuffers,bufferSize,numThreads);
+		size_t numRead=readAndCompare(filter,numSkipped,fileSize);
+		check("bytes read",double(numSkipped+numRead),double(fileSize),double(fileSize),"");
+		}
+	};
+
+class ReadAheadFilterErrorTest:public Test // Test checking that a read error in the source is reported to the reader instead of ending the file
+	{
+	/* Constructors and destructors: */
+	public:
+	ReadAheadFilterErrorTest(void)
+		:Test("ReadAheadFilter","SourceError")
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		const size_t failOffset=100000;
+		IO::ReadAheadFilter filter(new FailingFile(failOffset),4,8192);
+		size_t numRead=0;
+		try
+			{
+			numRead=readAndCompare(filter,0,failOffset*2);
+			}
+		catch(IO::File::Error err)
+			{
+			/* This is the expected outcome: */
+			return;
+			}
+		Misc::throwStdErr("Read error was reported as end-of-file after %u bytes",(unsigned int)numRead);
+		}
+	};
+
+/****************
+Gzip filter tests:
+****************/
+
+class GzipRoundTripTest:public Test // Test writing a gzip-compressed file and reading it back through openFile
+	{
+	/* Elements: */
+	private:
+	unsigned int numWriteThreads; // Number of compression threads, or zero for a single-threaded gzip filter
+	unsigned int numReadThreads; // Number of decompression threads, or zero for a single-threaded gzip filter
+	
+	/* Constructors and destructors: */
+	public:
+	GzipRoundTripTest(unsigned int sNumWriteThreads,unsigned int sNumReadThreads)
+		:Test("GzipFilter","RoundTrip",Misc::stringPrintf("writeThreads=%u,readThreads=%u",sNumWriteThreads,sNumReadThreads)),
+		 numWriteThreads(sNumWriteThreads),numReadThreads(sNumReadThreads)
+		{
+		}
+	
+	/* Methods: */
+	virtual void run(void)
+		{
+		/* Write a file large enough to be split into several gzip members by a parallel filter: */
+		const size_t fileSize=5*1024*1024+1234;
+		std::string fileName=getTempFileName(".gz");
+		try
+			{
+			{
+			std::vector<unsigned char> data(fileSize);
+			for(size_t i=0;i<fileSize;++i)
+				data[i]=patternByte(i);
+			IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::WriteOnly,numWriteThreads);
+			file->writeRaw(&data[0],fileSize);
+			}
+			
+			/* Read the file back: */
+			IO::FilePtr file=IO::openFile(fileName.c_str(),IO::File::ReadOnly,numReadThreads);
+			size_t numRead=readAndCompare(*file,0,fileSize+1);
+			check("bytes read",double(numRead),double(fileSize),double(fileSize),"");
+			}
+		catch(...)
+			{
+			unlink(fileName.c_str());
+			throw;
+			}
+		unlink(fileName.c_str());
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	TestRunner runner(argv[0]);
+	if(!runner.parseCommandLine(argc,argv))
+		return 1;
+	
+	/* Read-ahead filters reading sequentially and with concurrent positional reads, with and without unread data in the source's buffer: */
+	runner.addTest(new ReadAheadFilterTest(1,2,0,0));
+	runner.addTest(new ReadAheadFilterTest(1,4,65536,1000));
+	runner.addTest(new ReadAheadFilterTest(4,8,65536,0));
+	runner.addTest(new ReadAheadFilterTest(4,8,65536,1000));
+	runner.addTest(new ReadAheadFilterTest(3,5,10000,20000));
+	runner.addTest(new ReadAheadFilterErrorTest);
+	
+	/* Gzip filters reading files written by single-threaded and parallel gzip filters: */
+	runner.addTest(new GzipRoundTripTest(0,0));
+	runner.addTest(new GzipRoundTripTest(4,0));
+	runner.addTest(new GzipRoundTripTest(0,4));
+	runner.addTest(new GzipRoundTripTest(4,4));
+	
+	return runner.run();
+	}
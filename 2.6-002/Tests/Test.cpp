@@ -0,0 +1,77 @@
+/***********************************************************************
+Test - Base class for correctness tests checking the results of Vrui
+core library and VR device daemon components against known answers.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include "Test.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StringPrintf.h>
+
+/*********************
+Methods of class Test:
+*********************/
+
+void Test::check(const char* quantity,double value,double min,double max,const char* unit)
+	{
+	/* Record the measured quantity: */
+	if(!results.empty())
+		results.append(", ");
+	results.append(Misc::stringPrintf("%s %.4g",quantity,value));
+	if(unit[0]!='\0')
+		{
+		results.push_back(' ');
+		results.append(unit);
+		}
+	
+	/* Fail if the quantity is out of bounds; the negated test also catches NaN: */
+	if(!(value>=min&&value<=max))
+		{
+		const char* space=unit[0]!='\0'?" ":"";
+		if(min>-1.0e300)
+			Misc::throwStdErr("%s of %g%s%s is outside the range [%g, %g]%s%s",quantity,value,space,unit,min,max,space,unit);
+		else
+			Misc::throwStdErr("%s of %g%s%s exceeds the bound of %g%s%s",quantity,value,space,unit,max,space,unit);
+		}
+	}
+
+std::string Test::getTempFileName(const char* suffix)
+	{
+	/* Create a file name in the temporary directory that is unique between processes and between calls: */
+	static unsigned int nextIndex=0;
+	const char* tempDir=getenv("TMPDIR");
+	if(tempDir==0||tempDir[0]=='\0')
+		tempDir="/tmp";
+	std::string result=Misc::stringPrintf("%s/VruiTest-%d-%u%s",tempDir,int(getpid()),nextIndex,suffix);
+	++nextIndex;
+	return result;
+	}
+
+Test::Test(const char* sSuite,const char* sName,const std::string& sParameters)
+	:suite(sSuite),name(sName),parameters(sParameters)
+	{
+	}
+
+Test::~Test(void)
+	{
+	}
@@ -0,0 +1,80 @@
+/***********************************************************************
+Test - Base class for correctness tests checking the results of Vrui
+core library and VR device daemon components against known answers.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef TEST_INCLUDED
+#define TEST_INCLUDED
+
+#include <string>
+
+class Test
+	{
+	/* Elements: */
+	private:
+	std::string suite; // Name of the library or component under test
+	std::string name; // Name of the test
+	std::string parameters; // Parameters distinguishing variants of the same test, as comma-separated name=value pairs
+	std::string results; // Measured values checked by the last run, for progress messages
+	
+	/* Protected methods: */
+	protected:
+	void check(const char* quantity,double value,double min,double max,const char* unit); // Records a measured quantity; throws an exception if it is outside [min, max]
+	void checkMax(const char* quantity,double value,double max,const char* unit) // Ditto, for quantities that only have an upper bound
+		{
+		check(quantity,value,-1.0e300,max,unit);
+		}
+	static std::string getTempFileName(const char* suffix); // Returns a unique name for a temporary file with the given suffix
+	
+	/* Constructors and destructors: */
+	public:
+	Test(const char* sSuite,const char* sName,const std::string& sParameters =std::string()); // Creates a test of the given suite, name, and parameters
+	private:
+	Test(const Test& source); // Prohibit copy constructor
+	Test& operator=(const Test& source); // Prohibit assignment operator
+	public:
+	virtual ~Test(void);
+	
+	/* Methods: */
+	const std::string& getSuite(void) const // Returns the test's suite name
+		{
+		return suite;
+		}
+	const std::string& getName(void) const // Returns the test's name
+		{
+		return name;
+		}
+	const std::string& getParameters(void) const // Returns the test's parameters
+		{
+		return parameters;
+		}
+	const std::string& getResults(void) const // Returns the quantities checked by the last run
+		{
+		return results;
+		}
+	void clearResults(void) // Clears the checked quantities
+		{
+		results.clear();
+		}
+	virtual void run(void) =0; // Runs the test; throws an exception describing the first failed check
+	};
+
+#endif
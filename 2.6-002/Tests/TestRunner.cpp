@@ -0,0 +1,152 @@
+/***********************************************************************
+TestRunner - Class to select and run a set of correctness tests, and to
+report which of them failed.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include "TestRunner.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdexcept>
+
+#include "Test.h"
+
+/***************************
+Methods of class TestRunner:
+***************************/
+
+std::string TestRunner::getFullName(const Test* test) const
+	{
+	std::string result=test->getSuite();
+	result.push_back('/');
+	result.append(test->getName());
+	if(!test->getParameters().empty())
+		{
+		result.push_back('/');
+		result.append(test->getParameters());
+		}
+	return result;
+	}
+
+bool TestRunner::isSelected(const Test* test) const
+	{
+	if(filters.empty())
+		return true;
+	
+	/* Match the filters against the test's full name: */
+	std::string fullName=getFullName(test);
+	for(std::vector<std::string>::const_iterator fIt=filters.begin();fIt!=filters.end();++fIt)
+		if(fullName.find(*fIt)!=std::string::npos)
+			return true;
+	return false;
+	}
+
+TestRunner::TestRunner(const char* sProgramName)
+	:programName(sProgramName),
+	 listOnly(false),verbose(true)
+	{
+	/* Strip the directory from the program name: */
+	std::string::size_type slashPos=programName.rfind('/');
+	if(slashPos!=std::string::npos)
+		programName.erase(0,slashPos+1);
+	}
+
+TestRunner::~TestRunner(void)
+	{
+	for(std::vector<Test*>::iterator tIt=tests.begin();tIt!=tests.end();++tIt)
+		delete *tIt;
+	}
+
+bool TestRunner::parseCommandLine(int argc,char* argv[])
+	{
+	bool printUsage=false;
+	for(int i=1;i<argc&&!printUsage;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i],"-filter")==0&&i+1<argc)
+				{
+				++i;
+				filters.push_back(argv[i]);
+				}
+			else if(strcasecmp(argv[i],"-list")==0)
+				listOnly=true;
+			else if(strcasecmp(argv[i],"-quiet")==0)
+				verbose=false;
+			else
+				printUsage=true;
+			}
+		else
+			filters.push_back(argv[i]);
+		}
+	
+	if(printUsage)
+		{
+		fprintf(stderr,"Usage: %s [-filter <substring>] [-list] [-quiet] [<substring> ...]\n",programName.c_str());
+		fprintf(stderr,"  Runs all tests whose suite/test/parameters name contains any of the given substrings, or all tests if none are given\n");
+		return false;
+		}
+	
+	return true;
+	}
+
+void TestRunner::addTest(Test* newTest)
+	{
+	tests.push_back(newTest);
+	}
+
+int TestRunner::run(void)
+	{
+	if(listOnly)
+		{
+		/* Print the names of all selected tests: */
+		for(std::vector<Test*>::iterator tIt=tests.begin();tIt!=tests.end();++tIt)
+			if(isSelected(*tIt))
+				printf("%s\n",getFullName(*tIt).c_str());
+		return 0;
+		}
+	
+	/* Run all selected tests, and keep going after failed tests: */
+	unsigned int numRun=0;
+	unsigned int numFailed=0;
+	for(std::vector<Test*>::iterator tIt=tests.begin();tIt!=tests.end();++tIt)
+		if(isSelected(*tIt))
+			{
+			++numRun;
+			std::string fullName=getFullName(*tIt);
+			(*tIt)->clearResults();
+			try
+				{
+				(*tIt)->run();
+				if(verbose)
+					printf("%s: passed%s%s\n",fullName.c_str(),(*tIt)->getResults().empty()?"":": ",(*tIt)->getResults().c_str());
+				}
+			catch(std::runtime_error err)
+				{
+				printf("%s: FAILED: %s\n",fullName.c_str(),err.what());
+				++numFailed;
+				}
+			fflush(stdout);
+			}
+	
+	printf("%s: %u of %u tests passed\n",programName.c_str(),numRun-numFailed,numRun);
+	return numFailed!=0?1:0;
+	}
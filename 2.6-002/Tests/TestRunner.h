@@ -0,0 +1,62 @@
+/***********************************************************************
+TestRunner - Class to select and run a set of correctness tests, and to
+report which of them failed.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef TESTRUNNER_INCLUDED
+#define TESTRUNNER_INCLUDED
+
+#include <string>
+#include <vector>
+
+/* Forward declarations: */
+class Test;
+
+class TestRunner
+	{
+	/* Elements: */
+	private:
+	std::string programName; // Name of the test program
+	std::vector<Test*> tests; // List of registered tests
+	std::vector<std::string> filters; // List of substrings of which test names have to contain at least one to be run; runs all tests if empty
+	bool listOnly; // Flag whether to list the selected tests instead of running them
+	bool verbose; // Flag whether to print the results of passed tests
+	
+	/* Private methods: */
+	std::string getFullName(const Test* test) const; // Returns the full suite/name/parameters name of the given test
+	bool isSelected(const Test* test) const; // Returns true if the given test passes the test filters
+	
+	/* Constructors and destructors: */
+	public:
+	TestRunner(const char* sProgramName); // Creates a test runner for the test program of the given name
+	private:
+	TestRunner(const TestRunner& source); // Prohibit copy constructor
+	TestRunner& operator=(const TestRunner& source); // Prohibit assignment operator
+	public:
+	~TestRunner(void); // Destroys the runner and all registered tests
+	
+	/* Methods: */
+	bool parseCommandLine(int argc,char* argv[]); // Reads runner options from the given command line; prints usage and returns false on errors or if help was requested
+	void addTest(Test* newTest); // Registers a test; runner inherits the test object
+	int run(void); // Runs all selected tests; returns the program's exit code, which is non-zero if any test failed
+	};
+
+#endif
@@ -1,7 +1,7 @@
 /***********************************************************************
 Cond - Wrapper class for pthreads condition variables, mostly providing
 "resource allocation as creation" paradigm.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2013 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -86,16 +86,30 @@ class Cond
 		}
 	void wait(Mutex& mutex) // Waits on condition variable; calling thread must hold lock on given mutex
 		{
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		/* The mutex is not held while waiting: */
+		mutex.profiler.released();
+		#endif
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_cond_wait(&cond,&mutex.mutex)!=0)
 			std::cerr<<"Error in Threads::Cond::wait"<<std::endl;
 		#else
 		pthread_cond_wait(&cond,&mutex.mutex);
 		#endif
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		mutex.profiler.resumed();
+		#endif
 		}
 	bool timedWait(Mutex& mutex,const Misc::Time& abstime) // Waits on condition variable; returns true if signal occurred; returns false if time expires
 		{
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		/* The mutex is not held while waiting: */
+		mutex.profiler.released();
+		#endif
 		int result=pthread_cond_timedwait(&cond,&mutex.mutex,&abstime);
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		mutex.profiler.resumed();
+		#endif
 		#if THREADS_CONFIG_DEBUG
 		if(result!=0&&result!=ETIMEDOUT)
 			std::cerr<<"Error in Threads::Cond::timedWait"<<std::endl;
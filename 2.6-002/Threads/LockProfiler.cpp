@@ -0,0 +1,337 @@
+/***********************************************************************
+LockProfiler - Class to collect acquisition and contention statistics
+for a single mutex, spinlock, or mutex-protected condition variable in
+instrumented builds, and a global registry to aggregate statistics by
+lock name and report them at exit or on request.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Threads/LockProfiler.h>
+
+#include <signal.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace Threads {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+/* The registry is protected by a plain pthread mutex, as a Threads::Mutex would profile itself: */
+pthread_mutex_t registryMutex=PTHREAD_MUTEX_INITIALIZER;
+
+struct Registry // Structure holding the statistics of all live and destroyed locks
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::map<std::string,LockProfiler::Statistics> DestroyedLockMap; // Map from lock type and name to accumulated statistics of destroyed locks
+	
+	/* Elements: */
+	std::vector<LockProfiler*> liveLocks; // Profilers of all live locks
+	DestroyedLockMap destroyedLocks; // Accumulated statistics of destroyed locks
+	};
+
+Registry* registry=0; // The registry; created on first use and never destroyed to allow locks to unregister during static destruction
+int reportSignal=0; // Signal requesting a report
+bool reportAtExit=true; // Flag whether to print a report at program exit
+
+void reportSignalHandler(int) // Signal handler requesting a report from the next thread releasing a profiled lock
+	{
+	LockProfiler::requestReport();
+	}
+
+void printExitReport(void) // Prints a report at program exit
+	{
+	if(reportAtExit)
+		{
+		std::cerr<<"Threads::LockProfiler: Lock contention report at exit:"<<std::endl;
+		LockProfiler::printReport(std::cerr);
+		}
+	}
+
+Registry& getRegistry(void) // Returns the registry; must be called with the registry mutex locked
+	{
+	if(registry==0)
+		{
+		registry=new Registry;
+		
+		/* Request a report on SIGUSR2 unless the application handles that signal itself: */
+		struct sigaction oldAction;
+		if(sigaction(SIGUSR2,0,&oldAction)==0&&oldAction.sa_handler==SIG_DFL)
+			{
+			struct sigaction action;
+			action.sa_handler=reportSignalHandler;
+			sigemptyset(&action.sa_mask);
+			action.sa_flags=SA_RESTART;
+			sigaction(SIGUSR2,&action,0);
+			reportSignal=SIGUSR2;
+			}
+		
+		/* Print a report at exit: */
+		atexit(printExitReport);
+		}
+	return *registry;
+	}
+
+std::string getKey(const LockProfiler::Statistics& statistics) // Returns the key identifying locks of the same type and name
+	{
+	return std::string(statistics.typeName)+'\0'+statistics.name;
+	}
+
+bool compareWaitTime(const LockProfiler::Statistics& s1,const LockProfiler::Statistics& s2) // Orders statistics by descending total wait time, then by descending number of contended acquisitions
+	{
+	if(s1.waitTime!=s2.waitTime)
+		return s1.waitTime>s2.waitTime;
+	if(s1.numContendedAcquisitions!=s2.numContendedAcquisitions)
+		return s1.numContendedAcquisitions>s2.numContendedAcquisitions;
+	return s1.numAcquisitions>s2.numAcquisitions;
+	}
+
+void printDuration(std::ostream& os,double duration) // Prints the given duration in nanoseconds using a suitable unit
+	{
+	if(duration>=1.0e9)
+		os<<duration*1.0e-9<<" s";
+	else if(duration>=1.0e6)
+		os<<duration*1.0e-6<<" ms";
+	else if(duration>=1.0e3)
+		os<<duration*1.0e-3<<" us";
+	else
+		os<<duration<<" ns";
+	}
+
+void printHistogram(std::ostream& os,const char* label,const Misc::UInt64 histogram[]) // Prints all non-empty bins of the given histogram on one line
+	{
+	os<<"  "<<label<<" histogram:";
+	for(int i=0;i<LockProfiler::numHistogramBins;++i)
+		if(histogram[i]!=0)
+			{
+			if(i<LockProfiler::numHistogramBins-1)
+				{
+				os<<" <";
+				printDuration(os,double(Misc::UInt64(2)<<i));
+				}
+			else
+				{
+				/* The last bin is open-ended: */
+				os<<" >=";
+				printDuration(os,double(Misc::UInt64(1)<<i));
+				}
+			os<<": "<<histogram[i];
+			}
+	os<<std::endl;
+	}
+
+}
+
+/*****************************************
+Methods of class LockProfiler::Statistics:
+*****************************************/
+
+LockProfiler::Statistics::Statistics(const char* sTypeName,const char* sName)
+	:name(sName!=0?sName:""),typeName(sTypeName),numLocks(1),
+	 numAcquisitions(0),numContendedAcquisitions(0),numFailedTryLocks(0),
+	 waitTime(0),maxWaitTime(0),holdTime(0),maxHoldTime(0)
+	{
+	for(int i=0;i<numHistogramBins;++i)
+		{
+		waitHistogram[i]=0;
+		holdHistogram[i]=0;
+		}
+	}
+
+LockProfiler::Statistics& LockProfiler::Statistics::operator+=(const LockProfiler::Statistics& other)
+	{
+	numLocks+=other.numLocks;
+	numAcquisitions+=other.numAcquisitions;
+	numContendedAcquisitions+=other.numContendedAcquisitions;
+	numFailedTryLocks+=other.numFailedTryLocks;
+	waitTime+=other.waitTime;
+	if(maxWaitTime<other.maxWaitTime)
+		maxWaitTime=other.maxWaitTime;
+	holdTime+=other.holdTime;
+	if(maxHoldTime<other.maxHoldTime)
+		maxHoldTime=other.maxHoldTime;
+	for(int i=0;i<numHistogramBins;++i)
+		{
+		waitHistogram[i]+=other.waitHistogram[i];
+		holdHistogram[i]+=other.holdHistogram[i];
+		}
+	return *this;
+	}
+
+void LockProfiler::Statistics::print(std::ostream& os) const
+	{
+	os<<(name.empty()?"<unnamed>":name.c_str())<<" ("<<typeName<<", "<<numLocks<<(numLocks==1?" lock):":" locks):")<<std::endl;
+	os<<"  "<<numAcquisitions<<" acquisitions, "<<numContendedAcquisitions<<" contended ("<<double(numContendedAcquisitions)*100.0/double(numAcquisitions)<<"%)";
+	if(numFailedTryLocks!=0)
+		os<<", "<<numFailedTryLocks<<" failed tryLocks";
+	os<<std::endl;
+	if(numContendedAcquisitions!=0)
+		{
+		os<<"  wait: total ";
+		printDuration(os,double(waitTime));
+		os<<", average ";
+		printDuration(os,double(waitTime)/double(numContendedAcquisitions));
+		os<<", max ";
+		printDuration(os,double(maxWaitTime));
+		os<<std::endl;
+		}
+	os<<"  hold: total ";
+	printDuration(os,double(holdTime));
+	os<<", average ";
+	printDuration(os,double(holdTime)/double(numAcquisitions));
+	os<<", max ";
+	printDuration(os,double(maxHoldTime));
+	os<<std::endl;
+	if(numContendedAcquisitions!=0)
+		printHistogram(os,"wait",waitHistogram);
+	printHistogram(os,"hold",holdHistogram);
+	}
+
+/*************************************
+Static elements of class LockProfiler:
+*************************************/
+
+volatile int LockProfiler::reportRequested=0;
+
+/*****************************
+Methods of class LockProfiler:
+*****************************/
+
+void LockProfiler::printRequestedReport(void)
+	{
+	/* Make sure only one thread prints the report: */
+	if(__sync_bool_compare_and_swap(&reportRequested,1,0))
+		{
+		std::cerr<<"Threads::LockProfiler: Lock contention report:"<<std::endl;
+		printReport(std::cerr);
+		}
+	}
+
+LockProfiler::LockProfiler(const char* sTypeName,const char* sName)
+	:statistics(sTypeName,sName),
+	 acquireTime(0)
+	{
+	/* Register the profiler: */
+	pthread_mutex_lock(&registryMutex);
+	getRegistry().liveLocks.push_back(this);
+	pthread_mutex_unlock(&registryMutex);
+	}
+
+LockProfiler::~LockProfiler(void)
+	{
+	pthread_mutex_lock(&registryMutex);
+	Registry& reg=getRegistry();
+	
+	/* Remove the profiler from the list of live locks: */
+	std::vector<LockProfiler*>::iterator llIt=std::find(reg.liveLocks.begin(),reg.liveLocks.end(),this);
+	if(llIt!=reg.liveLocks.end())
+		{
+		*llIt=reg.liveLocks.back();
+		reg.liveLocks.pop_back();
+		}
+	
+	/* Accumulate the profiler's statistics into the destroyed locks of the same type and name if the lock was ever used: */
+	if(statistics.numAcquisitions!=0||statistics.numFailedTryLocks!=0)
+		{
+		std::string key=getKey(statistics);
+		Registry::DestroyedLockMap::iterator dlIt=reg.destroyedLocks.find(key);
+		if(dlIt==reg.destroyedLocks.end())
+			reg.destroyedLocks.insert(Registry::DestroyedLockMap::value_type(key,statistics));
+		else
+			dlIt->second+=statistics;
+		}
+	
+	pthread_mutex_unlock(&registryMutex);
+	}
+
+void LockProfiler::requestReport(void)
+	{
+	reportRequested=1;
+	}
+
+void LockProfiler::setReportSignal(int newReportSignal)
+	{
+	pthread_mutex_lock(&registryMutex);
+	getRegistry();
+	
+	/* Restore the default action of the previous report signal: */
+	if(reportSignal!=0)
+		signal(reportSignal,SIG_DFL);
+	
+	/* Install the signal handler for the new report signal: */
+	reportSignal=newReportSignal;
+	if(reportSignal!=0)
+		{
+		struct sigaction action;
+		action.sa_handler=reportSignalHandler;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags=SA_RESTART;
+		sigaction(reportSignal,&action,0);
+		}
+	
+	pthread_mutex_unlock(&registryMutex);
+	}
+
+void LockProfiler::setReportAtExit(bool newReportAtExit)
+	{
+	reportAtExit=newReportAtExit;
+	}
+
+void LockProfiler::printReport(std::ostream& os)
+	{
+	/* Take a snapshot of the registry, aggregating live and destroyed locks by type and name; statistics of locks used by other threads might be slightly inconsistent: */
+	typedef std::map<std::string,Statistics> StatisticsMap;
+	StatisticsMap aggregated;
+	pthread_mutex_lock(&registryMutex);
+	Registry& reg=getRegistry();
+	aggregated=reg.destroyedLocks;
+	for(std::vector<LockProfiler*>::iterator llIt=reg.liveLocks.begin();llIt!=reg.liveLocks.end();++llIt)
+		{
+		Statistics s=(*llIt)->statistics;
+		if(s.numAcquisitions!=0||s.numFailedTryLocks!=0)
+			{
+			std::string key=getKey(s);
+			StatisticsMap::iterator aIt=aggregated.find(key);
+			if(aIt==aggregated.end())
+				aggregated.insert(StatisticsMap::value_type(key,s));
+			else
+				aIt->second+=s;
+			}
+		}
+	pthread_mutex_unlock(&registryMutex);
+	
+	/* Print the locks with the longest total wait times first: */
+	std::vector<Statistics> ranked;
+	for(StatisticsMap::iterator aIt=aggregated.begin();aIt!=aggregated.end();++aIt)
+		ranked.push_back(aIt->second);
+	std::sort(ranked.begin(),ranked.end(),compareWaitTime);
+	std::streamsize oldPrecision=os.precision(4);
+	for(std::vector<Statistics>::iterator rIt=ranked.begin();rIt!=ranked.end();++rIt)
+		rIt->print(os);
+	os.precision(oldPrecision);
+	}
+
+}
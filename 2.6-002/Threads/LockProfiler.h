@@ -0,0 +1,206 @@
+/***********************************************************************
+LockProfiler - Class to collect acquisition and contention statistics
+for a single mutex, spinlock, or mutex-protected condition variable in
+instrumented builds, and a global registry to aggregate statistics by
+lock name and report them at exit or on request.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_LOCKPROFILER_INCLUDED
+#define THREADS_LOCKPROFILER_INCLUDED
+
+#include <time.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <string>
+#include <iosfwd>
+#include <Misc/SizedTypes.h>
+#include <Threads/Config.h>
+
+namespace Threads {
+
+class LockProfiler
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::UInt64 Time; // Type for time stamps and durations in nanoseconds
+	static const int numHistogramBins=32; // Number of histogram bins; bin i counts durations in [2^i,2^(i+1)) ns, and the last bin counts all durations of at least 2^31 ns
+	
+	struct Statistics // Structure holding the accumulated statistics of one or more locks
+		{
+		/* Elements: */
+		public:
+		std::string name; // Name of the lock(s)
+		const char* typeName; // Name of the lock class
+		unsigned int numLocks; // Number of locks whose statistics were accumulated into this object
+		Misc::UInt64 numAcquisitions; // Number of times the lock(s) were acquired
+		Misc::UInt64 numContendedAcquisitions; // Number of acquisitions that had to wait for another thread to release the lock
+		Misc::UInt64 numFailedTryLocks; // Number of tryLock calls that found the lock held
+		Time waitTime; // Total time spent waiting for contended acquisitions
+		Time maxWaitTime; // Longest time spent waiting for a single acquisition
+		Time holdTime; // Total time the lock(s) were held
+		Time maxHoldTime; // Longest time the lock(s) were held at once
+		Misc::UInt64 waitHistogram[numHistogramBins]; // Histogram of wait times of contended acquisitions
+		Misc::UInt64 holdHistogram[numHistogramBins]; // Histogram of hold times
+		
+		/* Constructors and destructors: */
+		Statistics(const char* sTypeName,const char* sName); // Creates zeroed statistics for the given lock type and name
+		
+		/* Methods: */
+		Statistics& operator+=(const Statistics& other); // Accumulates the statistics of the given object into this one
+		void print(std::ostream& os) const; // Prints a human-readable summary of the statistics
+		};
+	
+	/* Elements: */
+	private:
+	static volatile int reportRequested; // Flag set by the report signal handler; the next thread releasing a profiled lock prints the report
+	Statistics statistics; // Statistics of this lock
+	Time acquireTime; // Time at which the current holder acquired the lock
+	
+	/* Private methods: */
+	static int getBin(Time duration) // Returns the histogram bin for the given duration
+		{
+		int bin=duration!=0?63-__builtin_clzll(duration):0;
+		return bin<numHistogramBins?bin:numHistogramBins-1;
+		}
+	static void printRequestedReport(void); // Prints the report requested by a signal
+	void acquired(void) // Records an uncontended acquisition; called by the thread that acquired the lock
+		{
+		++statistics.numAcquisitions;
+		acquireTime=getTime();
+		}
+	void acquired(Time waitStart) // Records a contended acquisition after waiting since the given time; called by the thread that acquired the lock
+		{
+		++statistics.numAcquisitions;
+		++statistics.numContendedAcquisitions;
+		acquireTime=getTime();
+		Time waitTime=acquireTime-waitStart;
+		statistics.waitTime+=waitTime;
+		if(statistics.maxWaitTime<waitTime)
+			statistics.maxWaitTime=waitTime;
+		++statistics.waitHistogram[getBin(waitTime)];
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	LockProfiler(const char* sTypeName,const char* sName); // Creates and registers a profiler for a lock of the given type and name; name may be null
+	private:
+	LockProfiler(const LockProfiler& source); // Prohibit copy constructor
+	LockProfiler& operator=(const LockProfiler& source); // Prohibit assignment operator
+	public:
+	~LockProfiler(void); // Accumulates the profiler's statistics by lock name and unregisters it
+	
+	/* Methods: */
+	static Time getTime(void) // Returns the current time from a monotonic clock
+		{
+		#ifdef CLOCK_MONOTONIC
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC,&now);
+		return Time(now.tv_sec)*Time(1000000000)+Time(now.tv_nsec);
+		#else
+		struct timeval now;
+		gettimeofday(&now,0);
+		return Time(now.tv_sec)*Time(1000000000)+Time(now.tv_usec)*Time(1000);
+		#endif
+		}
+	void lock(pthread_mutex_t* mutex) // Locks the given mutex and records the acquisition
+		{
+		if(pthread_mutex_trylock(mutex)==0)
+			acquired();
+		else
+			{
+			Time waitStart=getTime();
+			pthread_mutex_lock(mutex);
+			acquired(waitStart);
+			}
+		}
+	bool tryLock(pthread_mutex_t* mutex) // Tries locking the given mutex and records the result
+		{
+		if(pthread_mutex_trylock(mutex)!=0)
+			{
+			__sync_add_and_fetch(&statistics.numFailedTryLocks,Misc::UInt64(1));
+			return false;
+			}
+		acquired();
+		return true;
+		}
+	void unlock(pthread_mutex_t* mutex) // Records the release of the given mutex and unlocks it
+		{
+		released();
+		pthread_mutex_unlock(mutex);
+		if(reportRequested)
+			printRequestedReport();
+		}
+	#if THREADS_CONFIG_HAVE_SPINLOCKS
+	void lock(pthread_spinlock_t* spinlock) // Locks the given spinlock and records the acquisition
+		{
+		if(pthread_spin_trylock(spinlock)==0)
+			acquired();
+		else
+			{
+			Time waitStart=getTime();
+			pthread_spin_lock(spinlock);
+			acquired(waitStart);
+			}
+		}
+	bool tryLock(pthread_spinlock_t* spinlock) // Tries locking the given spinlock and records the result
+		{
+		if(pthread_spin_trylock(spinlock)!=0)
+			{
+			__sync_add_and_fetch(&statistics.numFailedTryLocks,Misc::UInt64(1));
+			return false;
+			}
+		acquired();
+		return true;
+		}
+	void unlock(pthread_spinlock_t* spinlock) // Records the release of the given spinlock and unlocks it
+		{
+		released();
+		pthread_spin_unlock(spinlock);
+		if(reportRequested)
+			printRequestedReport();
+		}
+	#endif
+	void released(void) // Records the end of the current hold; called by the lock holder before releasing the lock or waiting on a condition variable
+		{
+		Time holdTime=getTime()-acquireTime;
+		statistics.holdTime+=holdTime;
+		if(statistics.maxHoldTime<holdTime)
+			statistics.maxHoldTime=holdTime;
+		++statistics.holdHistogram[getBin(holdTime)];
+		}
+	void resumed(void) // Records the start of a new hold after waiting on a condition variable; not counted as an acquisition
+		{
+		acquireTime=getTime();
+		}
+	const Statistics& getStatistics(void) const // Returns the lock's statistics; might be slightly inconsistent if read while other threads use the lock
+		{
+		return statistics;
+		}
+	
+	/* Registry methods: */
+	static void requestReport(void); // Requests a report from the next thread releasing a profiled lock; can be called from signal handlers
+	static void setReportSignal(int newReportSignal); // Sets the signal that requests a report; 0 disables reports on request; default is SIGUSR2 if not otherwise handled
+	static void setReportAtExit(bool newReportAtExit); // Enables or disables printing a report to stderr at program exit; enabled by default
+	static void printReport(std::ostream& os); // Prints statistics of all live and destroyed locks aggregated by name, ordered by total wait time
+	};
+
+}
+
+#endif
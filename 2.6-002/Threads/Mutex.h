@@ -1,7 +1,7 @@
 /***********************************************************************
 Mutex - Wrapper class for pthreads mutual exclusion semaphores, mostly
 providing "resource allocation as creation" paradigm and lock objects.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2013 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -30,6 +30,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <errno.h>
 #include <iostream>
 #endif
+#if THREADS_CONFIG_PROFILE_LOCKS
+#include <Threads/LockProfiler.h>
+#endif
 
 /* Forward declarations: */
 namespace Threads {
@@ -47,14 +50,22 @@ class Mutex
 		/* Elements: */
 		private:
 		pthread_mutex_t* mutexPtr; // Pointer to mutex that was locked
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		LockProfiler* profilerPtr; // Pointer to the locked mutex's contention profiler
+		#endif
 		
 		/* Constructors and destructors: */
 		public:
 		Lock(Mutex& mutex) // Locks the given mutex
 			:mutexPtr(&mutex.mutex)
+			 #if THREADS_CONFIG_PROFILE_LOCKS
+			 ,profilerPtr(&mutex.profiler)
+			 #endif
 			{
 			/* Lock the mutex: */
-			#if THREADS_CONFIG_DEBUG
+			#if THREADS_CONFIG_PROFILE_LOCKS
+			profilerPtr->lock(mutexPtr);
+			#elif THREADS_CONFIG_DEBUG
 			if(pthread_mutex_lock(mutexPtr)!=0)
 				std::cerr<<"Error in Threads::Mutex::Lock::Lock"<<std::endl;
 			#else
@@ -68,7 +79,9 @@ class Mutex
 		~Lock(void)
 			{
 			/* Unlock the mutex: */
-			#if THREADS_CONFIG_DEBUG
+			#if THREADS_CONFIG_PROFILE_LOCKS
+			profilerPtr->unlock(mutexPtr);
+			#elif THREADS_CONFIG_DEBUG
 			if(pthread_mutex_unlock(mutexPtr)!=0)
 				std::cerr<<"Error in Threads::Mutex::Lock::~Lock"<<std::endl;
 			#else
@@ -83,10 +96,28 @@ class Mutex
 	/* Elements: */
 	private:
 	pthread_mutex_t mutex; // Low-level pthread mutex handle
+	#if THREADS_CONFIG_PROFILE_LOCKS
+	LockProfiler profiler; // Profiler collecting contention statistics
+	#endif
 	
 	/* Constructors and destructors: */
 	public:
 	Mutex(const pthread_mutexattr_t* mutexAttribute =0) // Creates mutex with given attributes (or default mutex)
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::Mutex",0)
+		#endif
+		{
+		#if THREADS_CONFIG_DEBUG
+		if(pthread_mutex_init(&mutex,mutexAttribute)!=0)
+			std::cerr<<"Error in Threads::Mutex::Mutex"<<std::endl;
+		#else
+		pthread_mutex_init(&mutex,mutexAttribute);
+		#endif
+		}
+	Mutex(const char* name,const pthread_mutexattr_t* mutexAttribute =0) // Creates mutex with given attributes (or default mutex) and a name identifying it in lock profiles
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::Mutex",name)
+		#endif
 		{
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_mutex_init(&mutex,mutexAttribute)!=0)
@@ -112,7 +143,9 @@ class Mutex
 	/* Methods: */
 	void lock(void) // Locks mutex; blocks until lock is held
 		{
-		#if THREADS_CONFIG_DEBUG
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		profiler.lock(&mutex);
+		#elif THREADS_CONFIG_DEBUG
 		if(pthread_mutex_lock(&mutex)!=0)
 			std::cerr<<"Error in Threads::Mutex::lock"<<std::endl;
 		#else
@@ -121,16 +154,22 @@ class Mutex
 		}
 	bool tryLock(void) // Locks mutex and returns true if currently unlocked; returns false otherwise
 		{
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		return profiler.tryLock(&mutex);
+		#else
 		int result=pthread_mutex_trylock(&mutex);
 		#if THREADS_CONFIG_DEBUG
 		if(result!=0&&result!=EBUSY)
 			std::cerr<<"Error in Threads::Mutex::tryLock"<<std::endl;
 		#endif
 		return result==0;
+		#endif
 		}
 	void unlock(void) // Unlocks mutex
 		{
-		#if THREADS_CONFIG_DEBUG
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		profiler.unlock(&mutex);
+		#elif THREADS_CONFIG_DEBUG
 		if(pthread_mutex_unlock(&mutex)!=0)
 			std::cerr<<"Error in Threads::Mutex::unlock"<<std::endl;
 		#else
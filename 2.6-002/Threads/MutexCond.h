@@ -1,7 +1,7 @@
 /***********************************************************************
 MutexCond - Convenience class for condition variables that are protected
 by their own mutual exclusion semaphores.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2013 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -31,6 +31,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <errno.h>
 #include <iostream>
 #endif
+#if THREADS_CONFIG_PROFILE_LOCKS
+#include <Threads/LockProfiler.h>
+#endif
 
 namespace Threads {
 
@@ -45,14 +48,22 @@ class MutexCond
 		/* Elements: */
 		private:
 		pthread_mutex_t* mutexPtr; // Pointer to mutex that was locked
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		LockProfiler* profilerPtr; // Pointer to the locked mutex's contention profiler
+		#endif
 		
 		/* Constructors and destructors: */
 		public:
 		Lock(MutexCond& mutexCond) // Locks the given mutex-protected condition variable
 			:mutexPtr(&mutexCond.mutex)
+			 #if THREADS_CONFIG_PROFILE_LOCKS
+			 ,profilerPtr(&mutexCond.profiler)
+			 #endif
 			{
 			/* Lock the mutex: */
-			#if THREADS_CONFIG_DEBUG
+			#if THREADS_CONFIG_PROFILE_LOCKS
+			profilerPtr->lock(mutexPtr);
+			#elif THREADS_CONFIG_DEBUG
 			if(pthread_mutex_lock(mutexPtr)!=0)
 				std::cerr<<"Error in Threads::MutexCond::Lock::Lock"<<std::endl;
 			#else
@@ -66,7 +77,9 @@ class MutexCond
 		~Lock(void)
 			{
 			/* Unlock the mutex: */
-			#if THREADS_CONFIG_DEBUG
+			#if THREADS_CONFIG_PROFILE_LOCKS
+			profilerPtr->unlock(mutexPtr);
+			#elif THREADS_CONFIG_DEBUG
 			if(pthread_mutex_unlock(mutexPtr)!=0)
 				std::cerr<<"Error in Threads::MutexCond::Lock::~Lock"<<std::endl;
 			#else
@@ -81,10 +94,29 @@ class MutexCond
 	private:
 	pthread_mutex_t mutex; // Low-level pthread mutex handle
 	pthread_cond_t cond; // Low-level pthread condition variable handle
+	#if THREADS_CONFIG_PROFILE_LOCKS
+	LockProfiler profiler; // Profiler collecting contention statistics of the mutex
+	#endif
 	
 	/* Constructors and destructors: */
 	public:
 	MutexCond(void) // Creates default mutex and default condition variable
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::MutexCond",0)
+		#endif
+		{
+		#if THREADS_CONFIG_DEBUG
+		if(pthread_mutex_init(&mutex,0)!=0||pthread_cond_init(&cond,0)!=0)
+			std::cerr<<"Error in Threads::MutexCond::MutexCond"<<std::endl;
+		#else
+		pthread_mutex_init(&mutex,0);
+		pthread_cond_init(&cond,0);
+		#endif
+		}
+	MutexCond(const char* name) // Creates default mutex and default condition variable with a name identifying them in lock profiles
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::MutexCond",name)
+		#endif
 		{
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_mutex_init(&mutex,0)!=0||pthread_cond_init(&cond,0)!=0)
@@ -95,6 +127,9 @@ class MutexCond
 		#endif
 		}
 	MutexCond(pthread_mutexattr_t* mutexAttributes) // Creates mutex with given attributes and default condition variable
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::MutexCond",0)
+		#endif
 		{
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_mutex_init(&mutex,mutexAttributes)!=0||pthread_cond_init(&cond,0)!=0)
@@ -105,6 +140,9 @@ class MutexCond
 		#endif
 		}
 	MutexCond(pthread_mutexattr_t* mutexAttributes,pthread_condattr_t* condAttributes) // Creates mutex and condition variable with given attributes
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::MutexCond",0)
+		#endif
 		{
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_mutex_init(&mutex,mutexAttributes)!=0||pthread_cond_init(&cond,condAttributes)!=0)
@@ -151,17 +189,31 @@ class MutexCond
 	void wait(void) // Waits on condition variable; automatically obtains lock on mutex
 		{
 		Lock lock(*this);
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		/* The mutex is not held while waiting: */
+		profiler.released();
+		#endif
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_cond_wait(&cond,&mutex)!=0)
 			std::cerr<<"Error in Threads::MutexCond::wait"<<std::endl;
 		#else
 		pthread_cond_wait(&cond,&mutex);
 		#endif
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		profiler.resumed();
+		#endif
 		}
 	bool timedWait(const Misc::Time& abstime) // Waits on condition variable; automatically obtains lock on mutex; returns true if signal occurred; returns false if time expires
 		{
 		Lock lock(*this);
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		/* The mutex is not held while waiting: */
+		profiler.released();
+		#endif
 		int result=pthread_cond_timedwait(&cond,&mutex,&abstime);
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		profiler.resumed();
+		#endif
 		#if THREADS_CONFIG_DEBUG
 		if(result!=0&&result!=ETIMEDOUT)
 			std::cerr<<"Error in Threads::MutexCond::timedWait"<<std::endl;
@@ -170,16 +222,30 @@ class MutexCond
 		}
 	void wait(const Lock& lock) // Waits on condition variable when lock is already established
 		{
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		/* The mutex is not held while waiting: */
+		lock.profilerPtr->released();
+		#endif
 		#if THREADS_CONFIG_DEBUG
 		if(pthread_cond_wait(&cond,lock.mutexPtr)!=0)
 			std::cerr<<"Error in Threads::MutexCond::wait"<<std::endl;
 		#else
 		pthread_cond_wait(&cond,lock.mutexPtr);
 		#endif
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		lock.profilerPtr->resumed();
+		#endif
 		}
 	bool timedWait(const Lock& lock,const Misc::Time& abstime) // Waits on condition variable when lock is already established; returns true if signal occurred; returns false if time expires
 		{
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		/* The mutex is not held while waiting: */
+		lock.profilerPtr->released();
+		#endif
 		int result=pthread_cond_timedwait(&cond,lock.mutexPtr,&abstime);
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		lock.profilerPtr->resumed();
+		#endif
 		#if THREADS_CONFIG_DEBUG
 		if(result!=0&&result!=ETIMEDOUT)
 			std::cerr<<"Error in Threads::MutexCond::timedWait"<<std::endl;
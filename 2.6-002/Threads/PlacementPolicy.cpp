@@ -0,0 +1,356 @@
+/***********************************************************************
+PlacementPolicy - Class to place threads of named roles onto CPU sets
+and NUMA nodes, and to assign them real-time scheduling priorities,
+based on a configuration file section.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Threads/PlacementPolicy.h>
+
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <iostream>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/CompoundValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Threads/Mutex.h>
+
+namespace Threads {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+#ifdef __linux__
+const int maxNumCpus=CPU_SETSIZE; // Number of CPUs that can be represented in a CPU affinity set
+#else
+const int maxNumCpus=1024;
+#endif
+
+struct Role // Structure describing the placement of all threads of a role
+	{
+	/* Elements: */
+	public:
+	std::vector<int> cpus; // CPUs on which threads of the role may run; empty to leave affinity unchanged
+	bool pinThreads; // Flag whether each thread of the role is pinned to a single CPU from the role's CPU set, in order of placement
+	int numaNode; // NUMA node from which threads of the role preferably allocate memory; -1 to leave memory policy unchanged
+	int priority; // SCHED_FIFO priority of threads of the role; 0 to leave scheduling unchanged
+	};
+
+struct PlacedThread // Structure describing a thread that was assigned to a role
+	{
+	/* Elements: */
+	public:
+	pthread_t thread; // The thread
+	std::string roleName; // Name of the thread's role
+	unsigned int index; // Index of the thread among all threads of the same role
+	std::string error; // Description of placement requests that failed
+	};
+
+struct Registry // Structure holding the configured roles and all live placed threads
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::map<std::string,Role> RoleMap; // Map from role names to role placements
+	typedef std::map<std::string,unsigned int> RoleCountMap; // Map from role names to numbers of threads placed in that role
+	
+	/* Elements: */
+	Threads::Mutex mutex; // Mutex serializing access to the registry
+	bool configured; // Flag whether a placement policy has been configured
+	RoleMap roles; // Map of configured roles
+	RoleCountMap roleCounts; // Number of threads placed in each role so far
+	pthread_key_t placedThreadKey; // Thread-local storage key pointing to a thread's placement record; removes the record when the thread terminates
+	std::vector<PlacedThread*> placedThreads; // Records of all live placed threads
+	
+	/* Constructors and destructors: */
+	Registry(void);
+	};
+
+void removePlacedThread(void* placedThreadPtr); // Removes the given placed thread record when its thread terminates
+
+Registry::Registry(void)
+	:configured(false)
+	{
+	pthread_key_create(&placedThreadKey,removePlacedThread);
+	}
+
+Registry& getRegistry(void) // Returns the registry; never destroyed to allow threads to terminate during static destruction
+	{
+	static Registry* registry=new Registry;
+	return *registry;
+	}
+
+void removePlacedThread(void* placedThreadPtr)
+	{
+	PlacedThread* pt=static_cast<PlacedThread*>(placedThreadPtr);
+	Registry& registry=getRegistry();
+	{
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	std::vector<PlacedThread*>::iterator ptIt=std::find(registry.placedThreads.begin(),registry.placedThreads.end(),pt);
+	if(ptIt!=registry.placedThreads.end())
+		{
+		*ptIt=registry.placedThreads.back();
+		registry.placedThreads.pop_back();
+		}
+	}
+	delete pt;
+	}
+
+std::vector<int> getNodeCpus(int numaNode) // Returns the list of CPUs belonging to the given NUMA node; empty if the node does not exist
+	{
+	std::vector<int> result;
+	
+	/* Read the node's CPU list from sysfs, which has the form 0-3,8-11: */
+	char cpuListName[128];
+	snprintf(cpuListName,sizeof(cpuListName),"/sys/devices/system/node/node%d/cpulist",numaNode);
+	FILE* cpuListFile=fopen(cpuListName,"r");
+	if(cpuListFile!=0)
+		{
+		int first;
+		while(fscanf(cpuListFile,"%d",&first)==1)
+			{
+			int last=first;
+			int separator=fgetc(cpuListFile);
+			if(separator=='-')
+				{
+				if(fscanf(cpuListFile,"%d",&last)!=1)
+					break;
+				separator=fgetc(cpuListFile);
+				}
+			for(int cpu=first;cpu<=last&&cpu<maxNumCpus;++cpu)
+				result.push_back(cpu);
+			if(separator!=',')
+				break;
+			}
+		fclose(cpuListFile);
+		}
+	
+	return result;
+	}
+
+void addError(PlacedThread& pt,const char* request,int errorCode) // Records a failed placement request
+	{
+	if(!pt.error.empty())
+		pt.error.append("; ");
+	pt.error.append(request);
+	pt.error.append(": ");
+	pt.error.append(strerror(errorCode));
+	}
+
+void applyPlacement(PlacedThread& pt,const Role& role,bool callingThread) // Applies the given role's placement to the given thread; memory policies can only be applied to the calling thread
+	{
+	pt.error.clear();
+	
+	#ifdef __linux__
+	/* Set the thread's CPU affinity: */
+	if(!role.cpus.empty())
+		{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		if(role.pinThreads)
+			CPU_SET(role.cpus[pt.index%role.cpus.size()],&cpuSet);
+		else
+			for(std::vector<int>::const_iterator cIt=role.cpus.begin();cIt!=role.cpus.end();++cIt)
+				CPU_SET(*cIt,&cpuSet);
+		int result=pthread_setaffinity_np(pt.thread,sizeof(cpu_set_t),&cpuSet);
+		if(result!=0)
+			addError(pt,"CPU affinity",result);
+		}
+	
+	/* Prefer allocating the thread's memory from its NUMA node: */
+	if(role.numaNode>=0&&callingThread)
+		{
+		const int mpolPreferred=1; // MPOL_PREFERRED from numaif.h, which is not available without libnuma
+		unsigned long nodeMask[4]={0,0,0,0};
+		if(role.numaNode<int(sizeof(nodeMask)*8))
+			{
+			nodeMask[role.numaNode/(sizeof(unsigned long)*8)]|=1UL<<(role.numaNode%(sizeof(unsigned long)*8));
+			if(syscall(SYS_set_mempolicy,mpolPreferred,nodeMask,sizeof(nodeMask)*8)!=0)
+				addError(pt,"NUMA memory policy",errno);
+			}
+		else
+			addError(pt,"NUMA memory policy",EINVAL);
+		}
+	#endif
+	
+	/* Set the thread's scheduling policy: */
+	if(role.priority>0)
+		{
+		struct sched_param param;
+		param.sched_priority=std::max(std::min(role.priority,sched_get_priority_max(SCHED_FIFO)),sched_get_priority_min(SCHED_FIFO));
+		int result=pthread_setschedparam(pt.thread,SCHED_FIFO,&param);
+		if(result!=0)
+			addError(pt,"SCHED_FIFO priority",result);
+		}
+	
+	if(!pt.error.empty())
+		std::cerr<<"Threads::PlacementPolicy: Unable to place thread "<<pt.index<<" of role "<<pt.roleName<<" due to "<<pt.error<<std::endl;
+	}
+
+}
+
+/********************************
+Methods of class PlacementPolicy:
+********************************/
+
+void PlacementPolicy::configure(const Misc::ConfigurationFileSection& configFileSection)
+	{
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	
+	/* Read the placements of all roles: */
+	registry.roles.clear();
+	for(Misc::ConfigurationFileSection rIt=configFileSection.beginSubsections();rIt!=configFileSection.endSubsections();++rIt)
+		{
+		Role role;
+		
+		/* Read the role's CPU set, ignoring CPU indices that can not be represented in a CPU affinity set: */
+		std::vector<int> cpus=rIt.retrieveValue<std::vector<int> >("./cpus",std::vector<int>());
+		for(std::vector<int>::iterator cIt=cpus.begin();cIt!=cpus.end();++cIt)
+			{
+			if(*cIt>=0&&*cIt<maxNumCpus)
+				role.cpus.push_back(*cIt);
+			else
+				std::cerr<<"Threads::PlacementPolicy: Ignoring invalid CPU index "<<*cIt<<" in role "<<rIt.getName()<<std::endl;
+			}
+		
+		role.pinThreads=rIt.retrieveValue<bool>("./pinThreads",false);
+		role.numaNode=rIt.retrieveValue<int>("./numaNode",-1);
+		role.priority=rIt.retrieveValue<int>("./priority",0);
+		
+		/* Restrict threads to the CPUs of their NUMA node if no explicit CPU set is given: */
+		if(role.cpus.empty()&&role.numaNode>=0)
+			role.cpus=getNodeCpus(role.numaNode);
+		
+		registry.roles[rIt.getName()]=role;
+		}
+	registry.configured=true;
+	
+	/* Apply the placements to all threads that were placed before the policy was configured: */
+	PlacedThread* self=static_cast<PlacedThread*>(pthread_getspecific(registry.placedThreadKey));
+	for(std::vector<PlacedThread*>::iterator ptIt=registry.placedThreads.begin();ptIt!=registry.placedThreads.end();++ptIt)
+		{
+		Registry::RoleMap::iterator rIt=registry.roles.find((*ptIt)->roleName);
+		if(rIt!=registry.roles.end())
+			applyPlacement(**ptIt,rIt->second,*ptIt==self);
+		}
+	}
+
+bool PlacementPolicy::isConfigured(void)
+	{
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	return registry.configured;
+	}
+
+void PlacementPolicy::placeThread(const char* roleName)
+	{
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	
+	/* Get or create the calling thread's placement record: */
+	PlacedThread* pt=static_cast<PlacedThread*>(pthread_getspecific(registry.placedThreadKey));
+	if(pt==0)
+		{
+		pt=new PlacedThread;
+		pt->thread=pthread_self();
+		registry.placedThreads.push_back(pt);
+		pthread_setspecific(registry.placedThreadKey,pt);
+		}
+	
+	/* Assign the thread to the role: */
+	pt->roleName=roleName;
+	pt->index=registry.roleCounts[pt->roleName]++;
+	pt->error.clear();
+	
+	/* Apply the role's placement: */
+	Registry::RoleMap::iterator rIt=registry.roles.find(pt->roleName);
+	if(rIt!=registry.roles.end())
+		applyPlacement(*pt,rIt->second,true);
+	}
+
+void PlacementPolicy::printPlacement(std::ostream& os)
+	{
+	Registry& registry=getRegistry();
+	Threads::Mutex::Lock registryLock(registry.mutex);
+	for(std::vector<PlacedThread*>::iterator ptIt=registry.placedThreads.begin();ptIt!=registry.placedThreads.end();++ptIt)
+		{
+		PlacedThread& pt=**ptIt;
+		os<<pt.roleName<<' '<<pt.index<<':';
+		
+		#ifdef __linux__
+		/* Print the thread's effective CPU affinity as a list of CPU ranges: */
+		cpu_set_t cpuSet;
+		if(pthread_getaffinity_np(pt.thread,sizeof(cpu_set_t),&cpuSet)==0)
+			{
+			os<<" CPUs ";
+			const char* separator="";
+			for(int cpu=0;cpu<CPU_SETSIZE;++cpu)
+				if(CPU_ISSET(cpu,&cpuSet))
+					{
+					int last=cpu;
+					while(last+1<CPU_SETSIZE&&CPU_ISSET(last+1,&cpuSet))
+						++last;
+					os<<separator<<cpu;
+					if(last>cpu)
+						os<<'-'<<last;
+					separator=",";
+					cpu=last;
+					}
+			}
+		#endif
+		
+		/* Print the thread's requested NUMA node: */
+		Registry::RoleMap::iterator rIt=registry.roles.find(pt.roleName);
+		if(rIt!=registry.roles.end()&&rIt->second.numaNode>=0)
+			os<<", NUMA node "<<rIt->second.numaNode;
+		
+		/* Print the thread's effective scheduling policy: */
+		int policy;
+		struct sched_param param;
+		if(pthread_getschedparam(pt.thread,&policy,&param)==0)
+			{
+			if(policy==SCHED_FIFO)
+				os<<", SCHED_FIFO priority "<<param.sched_priority;
+			else if(policy==SCHED_RR)
+				os<<", SCHED_RR priority "<<param.sched_priority;
+			else
+				os<<", default scheduling";
+			}
+		
+		if(!pt.error.empty())
+			os<<" (failed: "<<pt.error<<")";
+		os<<std::endl;
+		}
+	}
+
+}
@@ -0,0 +1,48 @@
+/***********************************************************************
+PlacementPolicy - Class to place threads of named roles onto CPU sets
+and NUMA nodes, and to assign them real-time scheduling priorities,
+based on a configuration file section.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_PLACEMENTPOLICY_INCLUDED
+#define THREADS_PLACEMENTPOLICY_INCLUDED
+
+#include <iosfwd>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFileSection;
+}
+
+namespace Threads {
+
+class PlacementPolicy
+	{
+	/* Methods: */
+	public:
+	static void configure(const Misc::ConfigurationFileSection& configFileSection); // Reads the placements of thread roles from the subsections of the given section, and applies them to already placed threads
+	static bool isConfigured(void); // Returns true if a placement policy has been configured
+	static void placeThread(const char* roleName); // Assigns the calling thread to the given role and applies the role's placement, if any
+	static void printPlacement(std::ostream& os); // Prints the effective placement of all live threads that were assigned to roles
+	};
+
+}
+
+#endif
@@ -0,0 +1,494 @@
+/***********************************************************************
+PoolAllocator - Thread-safe version of Misc::PoolAllocator. Each thread
+allocates from and frees into a private cache of two magazines of free
+slots, and only exchanges full or empty magazines with a shared depot
+when its cache runs empty or overflows. Memory chunks that become
+completely unused are released to the system.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_POOLALLOCATOR_INCLUDED
+#define THREADS_POOLALLOCATOR_INCLUDED
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <new>
+#include <Threads/Mutex.h>
+
+namespace Threads {
+
+/***********************************************************************
+Usage prerequisites:
+- pageSizeParam must be a power of two; memory chunks are aligned to
+  their size to find the chunk containing a freed slot.
+- Slots can be freed by any thread, not only by the thread that
+  allocated them.
+- No thread may use the allocator while it is being destroyed.
+***********************************************************************/
+
+template <class ContentParam,size_t pageSizeParam =8192,unsigned int magazineSizeParam =64>
+class PoolAllocator
+	{
+	/* Embedded classes: */
+	public:
+	typedef ContentParam Content; // Type of allocated object
+	static const size_t pageSize=pageSizeParam; // Size of memory page in bytes
+	static const unsigned int magazineSize=magazineSizeParam; // Number of free slots cached in a magazine
+	
+	struct Statistics // Structure reporting the state of the allocator
+		{
+		/* Elements: */
+		public:
+		size_t numChunks; // Number of memory chunks currently allocated
+		size_t maxNumChunks; // Largest number of memory chunks allocated at any time
+		size_t numChunkAllocations; // Number of memory chunks allocated from the system
+		size_t numChunkReleases; // Number of empty memory chunks released to the system
+		size_t numUsedSlots; // Number of slots taken out of memory chunks, including free slots cached in magazines
+		size_t numDepotExchanges; // Number of times a per-thread cache had to access the shared depot
+		size_t numThreadCaches; // Number of threads currently holding a per-thread cache
+		};
+	
+	private:
+	struct AllocationSlot // Structure representing free memory allocation slots inside a memory chunk
+		{
+		/* Elements: */
+		public:
+		AllocationSlot* succ;
+		};
+	
+	struct Chunk // Structure for headers at the beginning of page-aligned memory chunks
+		{
+		/* Elements: */
+		public:
+		Chunk* pred; // Pointer to previous chunk in the same chunk list
+		Chunk* succ; // Pointer to next chunk in the same chunk list
+		size_t numUsedSlots; // Number of slots taken out of this chunk
+		AllocationSlot* firstSlot; // Pointer to head of this chunk's free allocation slot list
+		};
+	
+	struct ChunkList // Structure for doubly-linked lists of memory chunks
+		{
+		/* Elements: */
+		public:
+		Chunk* head; // Pointer to first chunk in the list
+		
+		/* Constructors and destructors: */
+		ChunkList(void)
+			:head(0)
+			{
+			}
+		
+		/* Methods: */
+		void link(Chunk* chunk) // Adds a chunk to the front of the list
+			{
+			chunk->pred=0;
+			chunk->succ=head;
+			if(head!=0)
+				head->pred=chunk;
+			head=chunk;
+			}
+		void unlink(Chunk* chunk) // Removes a chunk from the list
+			{
+			if(chunk->pred!=0)
+				chunk->pred->succ=chunk->succ;
+			else
+				head=chunk->succ;
+			if(chunk->succ!=0)
+				chunk->succ->pred=chunk->pred;
+			}
+		};
+	
+	struct Magazine // Structure for arrays of free slots
+		{
+		/* Elements: */
+		public:
+		Magazine* succ; // Pointer to next magazine in the depot
+		unsigned int numSlots; // Number of free slots currently in the magazine
+		void* slots[magazineSize]; // Stack of free slots
+		
+		/* Constructors and destructors: */
+		Magazine(void)
+			:succ(0),numSlots(0)
+			{
+			}
+		};
+	
+	struct ThreadCache // Structure for a thread's private cache of free slots
+		{
+		/* Elements: */
+		public:
+		PoolAllocator* allocator; // Pointer to the allocator owning this cache
+		ThreadCache* pred; // Pointer to previous cache in the allocator's list
+		ThreadCache* succ; // Pointer to next cache in the allocator's list
+		Magazine* loaded; // Magazine from which slots are allocated and into which slots are freed
+		Magazine* previous; // Backup magazine to avoid thrashing between the cache and the depot
+		};
+	
+	/* Elements: */
+	size_t slotSize; // Size of an allocation slot
+	size_t slotOffset; // Offset of the first allocation slot from the beginning of a memory chunk
+	size_t numSlotsPerChunk; // Number of allocation slots per memory chunk
+	unsigned int maxNumFullMagazines; // Maximum number of full magazines kept in the depot before freed slots are returned to their chunks
+	pthread_key_t threadCacheKey; // Process-wide key for per-thread caches
+	Mutex depotMutex; // Mutex serializing access to the depot, the memory chunks, and the list of per-thread caches
+	Magazine* fullMagazines; // List of full magazines in the depot
+	unsigned int numFullMagazines; // Number of full magazines in the depot
+	Magazine* emptyMagazines; // List of empty magazines in the depot
+	ChunkList partialChunks; // List of memory chunks with free slots
+	ChunkList fullChunks; // List of memory chunks without free slots
+	ThreadCache* threadCaches; // List of all per-thread caches
+	Statistics statistics; // Current allocator statistics
+	
+	/* Private methods: */
+	Chunk* getChunk(void* slot) const // Returns the memory chunk containing the given slot
+		{
+		return reinterpret_cast<Chunk*>(reinterpret_cast<size_t>(slot)&~(pageSize-1));
+		}
+	void growPool(void) // Allocates a new memory chunk; depot mutex must be locked
+		{
+		/* Allocate a new page-aligned chunk: */
+		void* mem;
+		if(posix_memalign(&mem,pageSize,pageSize)!=0)
+			throw std::bad_alloc();
+		Chunk* newChunk=static_cast<Chunk*>(mem);
+		newChunk->numUsedSlots=0;
+		
+		/* Create a linked list of free allocation slots in the new chunk: */
+		char* slotPtr=static_cast<char*>(mem)+slotOffset;
+		newChunk->firstSlot=reinterpret_cast<AllocationSlot*>(slotPtr);
+		for(size_t i=0;i<numSlotsPerChunk-1;++i,slotPtr+=slotSize)
+			reinterpret_cast<AllocationSlot*>(slotPtr)->succ=reinterpret_cast<AllocationSlot*>(slotPtr+slotSize);
+		reinterpret_cast<AllocationSlot*>(slotPtr)->succ=0;
+		partialChunks.link(newChunk);
+		
+		/* Update the statistics: */
+		++statistics.numChunks;
+		if(statistics.maxNumChunks<statistics.numChunks)
+			statistics.maxNumChunks=statistics.numChunks;
+		++statistics.numChunkAllocations;
+		}
+	void fillMagazine(Magazine* magazine) // Fills the given magazine with free slots from memory chunks; depot mutex must be locked
+		{
+		while(magazine->numSlots<magazineSize)
+			{
+			if(partialChunks.head==0) // We ran out of memory
+				growPool(); // Grow the pool
+			
+			/* Take the first free slot from the first chunk that has any: */
+			Chunk* chunk=partialChunks.head;
+			magazine->slots[magazine->numSlots]=chunk->firstSlot;
+			++magazine->numSlots;
+			chunk->firstSlot=chunk->firstSlot->succ;
+			++chunk->numUsedSlots;
+			++statistics.numUsedSlots;
+			if(chunk->firstSlot==0)
+				{
+				/* Move the exhausted chunk to the full list: */
+				partialChunks.unlink(chunk);
+				fullChunks.link(chunk);
+				}
+			}
+		}
+	void drainMagazine(Magazine* magazine) // Returns all slots in the given magazine to their memory chunks, and releases empty chunks; depot mutex must be locked
+		{
+		while(magazine->numSlots>0)
+			{
+			--magazine->numSlots;
+			AllocationSlot* slot=static_cast<AllocationSlot*>(magazine->slots[magazine->numSlots]);
+			Chunk* chunk=getChunk(slot);
+			if(chunk->firstSlot==0)
+				{
+				/* Move the chunk back to the partial list: */
+				fullChunks.unlink(chunk);
+				partialChunks.link(chunk);
+				}
+			
+			/* Put the slot back into its chunk: */
+			slot->succ=chunk->firstSlot;
+			chunk->firstSlot=slot;
+			--statistics.numUsedSlots;
+			if(--chunk->numUsedSlots==0)
+				{
+				/* Release the empty chunk: */
+				partialChunks.unlink(chunk);
+				::free(chunk);
+				--statistics.numChunks;
+				++statistics.numChunkReleases;
+				}
+			}
+		}
+	Magazine* getEmptyMagazine(void) // Returns an empty magazine from the depot or a new one; depot mutex must be locked
+		{
+		Magazine* result=emptyMagazines;
+		if(result!=0)
+			emptyMagazines=result->succ;
+		else
+			result=new Magazine;
+		return result;
+		}
+	void putEmptyMagazine(Magazine* magazine) // Puts an empty magazine into the depot; depot mutex must be locked
+		{
+		magazine->succ=emptyMagazines;
+		emptyMagazines=magazine;
+		}
+	void storeMagazine(Magazine* magazine) // Stores a non-empty magazine in the depot, or drains it if the depot is full; depot mutex must be locked
+		{
+		if(magazine->numSlots==magazineSize&&numFullMagazines<maxNumFullMagazines)
+			{
+			magazine->succ=fullMagazines;
+			fullMagazines=magazine;
+			++numFullMagazines;
+			}
+		else
+			{
+			drainMagazine(magazine);
+			putEmptyMagazine(magazine);
+			}
+		}
+	ThreadCache* getThreadCache(void) // Returns the calling thread's cache, creating it if necessary
+		{
+		ThreadCache* result=static_cast<ThreadCache*>(pthread_getspecific(threadCacheKey));
+		if(result==0)
+			{
+			/* Create a new cache with two empty magazines: */
+			result=new ThreadCache;
+			result->allocator=this;
+			{
+			Mutex::Lock depotLock(depotMutex);
+			result->loaded=getEmptyMagazine();
+			result->previous=getEmptyMagazine();
+			result->pred=0;
+			result->succ=threadCaches;
+			if(threadCaches!=0)
+				threadCaches->pred=result;
+			threadCaches=result;
+			++statistics.numThreadCaches;
+			}
+			pthread_setspecific(threadCacheKey,result);
+			}
+		return result;
+		}
+	void refillCache(ThreadCache* cache) // Loads a full magazine into the given cache, whose magazines are both empty
+		{
+		Mutex::Lock depotLock(depotMutex);
+		++statistics.numDepotExchanges;
+		if(fullMagazines!=0)
+			{
+			/* Exchange an empty magazine for a full one from the depot: */
+			putEmptyMagazine(cache->previous);
+			cache->previous=cache->loaded;
+			cache->loaded=fullMagazines;
+			fullMagazines=fullMagazines->succ;
+			--numFullMagazines;
+			}
+		else
+			{
+			/* Fill the loaded magazine from the memory chunks: */
+			fillMagazine(cache->loaded);
+			}
+		}
+	void spillCache(ThreadCache* cache) // Unloads a full magazine from the given cache, whose magazines are both full
+		{
+		Mutex::Lock depotLock(depotMutex);
+		++statistics.numDepotExchanges;
+		
+		/* Exchange the backup magazine for an empty one from the depot: */
+		Magazine* full=cache->previous;
+		cache->previous=cache->loaded;
+		cache->loaded=getEmptyMagazine();
+		storeMagazine(full);
+		}
+	void destroyCache(ThreadCache* cache) // Returns a cache's slots to the depot and destroys the cache; depot mutex must be locked
+		{
+		/* Return the cache's magazines to the depot: */
+		storeMagazine(cache->loaded);
+		storeMagazine(cache->previous);
+		
+		/* Unlink and destroy the cache: */
+		if(cache->pred!=0)
+			cache->pred->succ=cache->succ;
+		else
+			threadCaches=cache->succ;
+		if(cache->succ!=0)
+			cache->succ->pred=cache->pred;
+		delete cache;
+		--statistics.numThreadCaches;
+		}
+	static void threadCacheDestructor(void* value) // Called when a thread holding a cache terminates
+		{
+		ThreadCache* cache=static_cast<ThreadCache*>(value);
+		PoolAllocator* allocator=cache->allocator;
+		Mutex::Lock depotLock(allocator->depotMutex);
+		allocator->destroyCache(cache);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	PoolAllocator(unsigned int sMaxNumFullMagazines =16) // Creates an empty memory pool keeping at most the given number of full magazines in its depot
+		:maxNumFullMagazines(sMaxNumFullMagazines),
+		 fullMagazines(0),numFullMagazines(0),emptyMagazines(0),
+		 threadCaches(0)
+		{
+		/* Determine size of an allocation slot (allow for very small or oddly-sized content types): */
+		slotSize=sizeof(Content);
+		if(slotSize<sizeof(AllocationSlot)) // Pad slot size for contents smaller than link
+			slotSize=sizeof(AllocationSlot);
+		else if(slotSize%sizeof(AllocationSlot)!=0) // Pad slot size to properly align links
+			slotSize+=sizeof(AllocationSlot)-slotSize%sizeof(AllocationSlot);
+		
+		/* Place the first allocation slot behind the chunk header, aligned to 16 bytes: */
+		slotOffset=(sizeof(Chunk)+15)&~size_t(15);
+		
+		/* Calculate number of allocation slots per memory chunk: */
+		numSlotsPerChunk=(pageSize-slotOffset)/slotSize;
+		
+		/* Initialize the statistics: */
+		statistics.numChunks=0;
+		statistics.maxNumChunks=0;
+		statistics.numChunkAllocations=0;
+		statistics.numChunkReleases=0;
+		statistics.numUsedSlots=0;
+		statistics.numDepotExchanges=0;
+		statistics.numThreadCaches=0;
+		
+		/* Create the process-wide key for per-thread caches: */
+		pthread_key_create(&threadCacheKey,threadCacheDestructor);
+		}
+	private:
+	PoolAllocator(const PoolAllocator& source); // Prohibit copy constructor
+	PoolAllocator& operator=(const PoolAllocator& source); // Prohibit assignment operator
+	public:
+	~PoolAllocator(void) // Destroys pool and releases all allocated memory chunks
+		{
+		/* Delete the key first so that terminating threads no longer touch the allocator: */
+		pthread_key_delete(threadCacheKey);
+		
+		/* Destroy all per-thread caches and magazines: */
+		while(threadCaches!=0)
+			{
+			ThreadCache* succ=threadCaches->succ;
+			delete threadCaches->loaded;
+			delete threadCaches->previous;
+			delete threadCaches;
+			threadCaches=succ;
+			}
+		while(fullMagazines!=0)
+			{
+			Magazine* succ=fullMagazines->succ;
+			delete fullMagazines;
+			fullMagazines=succ;
+			}
+		while(emptyMagazines!=0)
+			{
+			Magazine* succ=emptyMagazines->succ;
+			delete emptyMagazines;
+			emptyMagazines=succ;
+			}
+		
+		/* Release all memory chunks: */
+		ChunkList* lists[2]={&partialChunks,&fullChunks};
+		for(int i=0;i<2;++i)
+			while(lists[i]->head!=0)
+				{
+				Chunk* succ=lists[i]->head->succ;
+				::free(lists[i]->head);
+				lists[i]->head=succ;
+				}
+		}
+	
+	/* Methods: */
+	void* allocate(void)
+		{
+		ThreadCache* cache=getThreadCache();
+		if(cache->loaded->numSlots==0)
+			{
+			/* Switch to the backup magazine if it has free slots, or go to the depot: */
+			if(cache->previous->numSlots>0)
+				{
+				Magazine* temp=cache->loaded;
+				cache->loaded=cache->previous;
+				cache->previous=temp;
+				}
+			else
+				refillCache(cache);
+			}
+		
+		/* Return the last free slot in the loaded magazine: */
+		--cache->loaded->numSlots;
+		return cache->loaded->slots[cache->loaded->numSlots];
+		}
+	void free(void* item)
+		{
+		ThreadCache* cache=getThreadCache();
+		if(cache->loaded->numSlots==magazineSize)
+			{
+			/* Switch to the backup magazine if it has room, or go to the depot: */
+			if(cache->previous->numSlots<magazineSize)
+				{
+				Magazine* temp=cache->loaded;
+				cache->loaded=cache->previous;
+				cache->previous=temp;
+				}
+			else
+				spillCache(cache);
+			}
+		
+		/* Put the freed slot into the loaded magazine: */
+		cache->loaded->slots[cache->loaded->numSlots]=item;
+		++cache->loaded->numSlots;
+		}
+	void trim(void) // Returns the calling thread's cached slots and all slots in the depot to their memory chunks, and releases empty chunks to the system
+		{
+		Mutex::Lock depotLock(depotMutex);
+		
+		/* Drain the calling thread's cache: */
+		ThreadCache* cache=static_cast<ThreadCache*>(pthread_getspecific(threadCacheKey));
+		if(cache!=0)
+			{
+			drainMagazine(cache->loaded);
+			drainMagazine(cache->previous);
+			}
+		
+		/* Drain and delete all magazines in the depot: */
+		while(fullMagazines!=0)
+			{
+			Magazine* succ=fullMagazines->succ;
+			drainMagazine(fullMagazines);
+			delete fullMagazines;
+			fullMagazines=succ;
+			}
+		numFullMagazines=0;
+		while(emptyMagazines!=0)
+			{
+			Magazine* succ=emptyMagazines->succ;
+			delete emptyMagazines;
+			emptyMagazines=succ;
+			}
+		}
+	Statistics getStatistics(void) // Returns a snapshot of the allocator's statistics
+		{
+		Mutex::Lock depotLock(depotMutex);
+		return statistics;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,430 @@
+/***********************************************************************
+SPSCRingBuffer - Lock-free ring buffer to stream data from a single
+producer thread to a single consumer thread, with the same region
+locking interface as RingBuffer. Threads only block in the kernel when
+the buffer is empty or full.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_SPSCRINGBUFFER_INCLUDED
+#define THREADS_SPSCRINGBUFFER_INCLUDED
+
+#include <stddef.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+namespace Threads {
+
+template <class ValueParam>
+class SPSCRingBuffer
+	{
+	/* Embedded classes: */
+	public:
+	typedef ValueParam Value; // Type of communicated data
+	
+	class ReadLock // Helper class to lock a region in the ring buffer for reading
+		{
+		friend class SPSCRingBuffer;
+		
+		/* Elements: */
+		private:
+		const Value* values; // Base pointer in ring buffer
+		size_t numValues; // Number of locked values
+		
+		/* Constructors and destructors: */
+		public:
+		ReadLock(void) // Creates invalid lock
+			:values(0),numValues(0)
+			{
+			}
+		private:
+		ReadLock(const Value* sValues,size_t sNumValues) // Creates valid lock for the given buffer and value region
+			:values(sValues),numValues(sNumValues)
+			{
+			}
+		
+		/* Methods: */
+		public:
+		const Value* getValues(void) const
+			{
+			return values;
+			}
+		size_t getNumValues(void) const
+			{
+			return numValues;
+			}
+		};
+	
+	class WriteLock // Helper class to lock a region in the ring buffer for writing
+		{
+		friend class SPSCRingBuffer;
+		
+		/* Elements: */
+		private:
+		Value* values; // Base pointer in ring buffer
+		size_t numValues; // Number of locked values
+		
+		/* Constructors and destructors: */
+		public:
+		WriteLock(void) // Creates invalid lock
+			:values(0),numValues(0)
+			{
+			}
+		private:
+		WriteLock(Value* sValues,size_t sNumValues) // Creates valid lock for the given buffer and value region
+			:values(sValues),numValues(sNumValues)
+			{
+			}
+		
+		/* Methods: */
+		public:
+		Value* getValues(void) const
+			{
+			return values;
+			}
+		size_t getNumValues(void) const
+			{
+			return numValues;
+			}
+		};
+	
+	private:
+	static const size_t cacheLineSize=64; // Assumed size of a CPU cache line, to keep the producer's and consumer's state apart
+	
+	struct ProducerState // Structure for state written by the producer
+		{
+		/* Elements: */
+		public:
+		volatile size_t writeCount; // Total number of values published to the consumer
+		volatile int writeSequence; // Futex word incremented whenever a blocked consumer must be woken up
+		size_t localWriteCount; // Total number of values written by the producer, including unpublished ones
+		size_t writeIndex; // Index of the next value to be written in the ring buffer, kept separately because the free-running counts do not wrap at the buffer size
+		size_t cachedReadCount; // Last read count seen by the producer
+		};
+	
+	struct ConsumerState // Structure for state written by the consumer
+		{
+		/* Elements: */
+		public:
+		volatile size_t readCount; // Total number of values released to the producer
+		volatile int readSequence; // Futex word incremented whenever a blocked producer must be woken up
+		size_t localReadCount; // Total number of values read by the consumer, including unreleased ones
+		size_t readIndex; // Index of the next value to be read in the ring buffer
+		size_t cachedWriteCount; // Last write count seen by the consumer
+		};
+	
+	/* Elements: */
+	size_t bufferSize; // Size of the ring buffer
+	Value* buffer; // The ring buffer
+	char pad0[cacheLineSize];
+	ProducerState producer; // State written by the producer
+	volatile int producerWaiting; // Flag whether the producer is blocked because the buffer is full; set by the producer and cleared by the consumer when waking it up
+	char pad1[cacheLineSize];
+	ConsumerState consumer; // State written by the consumer
+	volatile int consumerWaiting; // Flag whether the consumer is blocked because the buffer is empty; set by the consumer and cleared by the producer when waking it up
+	char pad2[cacheLineSize];
+	#ifndef __linux__
+	pthread_mutex_t mutex; // Mutex protecting the condition variable on systems without futexes
+	pthread_cond_t cond; // Condition variable to wake up a blocked thread on systems without futexes
+	#endif
+	
+	/* Private methods: */
+	#ifdef __linux__
+	void wait(volatile int& sequence,int currentSequence) // Blocks until the given futex word changes from the given value or a wake-up occurs
+		{
+		/* Wait on the futex word, waking up periodically to act on cancellation requests: */
+		struct timespec timeout;
+		timeout.tv_sec=0;
+		timeout.tv_nsec=100000000;
+		while(sequence==currentSequence)
+			{
+			pthread_testcancel();
+			syscall(SYS_futex,&sequence,FUTEX_WAIT_PRIVATE,currentSequence,&timeout,0,0);
+			}
+		}
+	void wake(volatile int& sequence) // Changes the given futex word and wakes up a thread waiting on it
+		{
+		__sync_add_and_fetch(&sequence,1);
+		syscall(SYS_futex,&sequence,FUTEX_WAKE_PRIVATE,1,0,0,0);
+		}
+	#else
+	static void unlockMutex(void* mutexPtr) // Cancellation clean-up handler for blocked threads
+		{
+		pthread_mutex_unlock(static_cast<pthread_mutex_t*>(mutexPtr));
+		}
+	void wait(volatile int& sequence,int currentSequence)
+		{
+		pthread_mutex_lock(&mutex);
+		pthread_cleanup_push(unlockMutex,&mutex);
+		while(sequence==currentSequence)
+			pthread_cond_wait(&cond,&mutex);
+		pthread_cleanup_pop(1);
+		}
+	void wake(volatile int& sequence)
+		{
+		pthread_mutex_lock(&mutex);
+		__sync_add_and_fetch(&sequence,1);
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+		}
+	#endif
+	size_t waitForData(void) // Blocks the consumer until data is available; returns the number of readable values
+		{
+		while(true)
+			{
+			/* Check for published data: */
+			consumer.cachedWriteCount=producer.writeCount;
+			size_t numValues=consumer.cachedWriteCount-consumer.localReadCount;
+			if(numValues!=0)
+				return numValues;
+			
+			/* Release consumed values so that the producer can not block on a full buffer forever: */
+			publishReads();
+			
+			/* Announce that the consumer is about to block, then check again before blocking: */
+			int currentSequence=producer.writeSequence;
+			consumerWaiting=1;
+			__sync_synchronize();
+			if(producer.writeCount==consumer.localReadCount)
+				wait(producer.writeSequence,currentSequence);
+			consumerWaiting=0;
+			}
+		}
+	size_t waitForSpace(void) // Blocks the producer until space is available; returns the number of writable values
+		{
+		while(true)
+			{
+			/* Check for released space: */
+			producer.cachedReadCount=consumer.readCount;
+			size_t numValues=bufferSize-(producer.localWriteCount-producer.cachedReadCount);
+			if(numValues!=0)
+				return numValues;
+			
+			/* Publish written values so that the consumer can not block on an empty buffer forever: */
+			publishWrites();
+			
+			/* Announce that the producer is about to block, then check again before blocking: */
+			int currentSequence=consumer.readSequence;
+			producerWaiting=1;
+			__sync_synchronize();
+			if(producer.localWriteCount-consumer.readCount==bufferSize)
+				wait(consumer.readSequence,currentSequence);
+			producerWaiting=0;
+			}
+		}
+	void reset(void) // Resets the buffer to the empty state
+		{
+		producer.writeCount=0;
+		producer.writeSequence=0;
+		producer.localWriteCount=0;
+		producer.writeIndex=0;
+		producer.cachedReadCount=0;
+		producerWaiting=0;
+		consumer.readCount=0;
+		consumer.readSequence=0;
+		consumer.localReadCount=0;
+		consumer.readIndex=0;
+		consumer.cachedWriteCount=0;
+		consumerWaiting=0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	SPSCRingBuffer(size_t sBufferSize) // Creates empty ring buffer of given size
+		:bufferSize(sBufferSize),buffer(new Value[bufferSize])
+		{
+		reset();
+		#ifndef __linux__
+		pthread_mutex_init(&mutex,0);
+		pthread_cond_init(&cond,0);
+		#endif
+		}
+	private:
+	SPSCRingBuffer(const SPSCRingBuffer& source); // Prohibit copy constructor
+	SPSCRingBuffer& operator=(const SPSCRingBuffer& source); // Prohibit assignment operator
+	public:
+	~SPSCRingBuffer(void) // Destroys the ring buffer
+		{
+		delete[] buffer;
+		#ifndef __linux__
+		pthread_mutex_destroy(&mutex);
+		pthread_cond_destroy(&cond);
+		#endif
+		}
+	
+	/* Methods: */
+	void resize(size_t newBufferSize) // Resizes the buffer, discarding all data; must not be called while the producer or consumer are accessing the buffer
+		{
+		delete[] buffer;
+		bufferSize=newBufferSize;
+		buffer=new Value[bufferSize];
+		reset();
+		}
+	bool empty(void) const // Returns true if there is no published data to be read in the ring buffer
+		{
+		return producer.writeCount==consumer.readCount;
+		}
+	bool full(void) const // Returns true if there is no released room to write data in the ring buffer
+		{
+		return producer.writeCount-consumer.readCount==bufferSize;
+		}
+	
+	/* Consumer interface: */
+	ReadLock getReadLock(size_t maxNumValues) // Blocks until at least one value can be read from the buffer; returns lock on number of values
+		{
+		/* Determine the number of readable values, blocking if there are none: */
+		size_t numValues=consumer.cachedWriteCount-consumer.localReadCount;
+		if(numValues==0)
+			numValues=waitForData();
+		
+		/* Adjust the result value for ring buffer wrap-around and requested number of values: */
+		size_t readIndex=consumer.readIndex;
+		if(numValues>bufferSize-readIndex)
+			numValues=bufferSize-readIndex;
+		if(numValues>maxNumValues)
+			numValues=maxNumValues;
+		
+		/* Return a read lock: */
+		return ReadLock(buffer+readIndex,numValues);
+		}
+	void releaseReadLock(const ReadLock& readLock,bool publish =true) // Releases a read lock; assumes that all data in the locked region has been read; defers handing the space back to the producer until the next call to publishReads if publish is false
+		{
+		consumer.localReadCount+=readLock.numValues;
+		
+		/* Advance the read index; read locks never extend past the end of the buffer: */
+		consumer.readIndex+=readLock.numValues;
+		if(consumer.readIndex==bufferSize)
+			consumer.readIndex=0;
+		if(publish)
+			publishReads();
+		}
+	void publishReads(void) // Hands the space of all released read locks back to the producer
+		{
+		if(consumer.readCount!=consumer.localReadCount)
+			{
+			/* Publish the read count after the consumer is done with the values: */
+			__sync_synchronize();
+			consumer.readCount=consumer.localReadCount;
+			__sync_synchronize();
+			
+			/* Wake up the producer if it is blocked, but only once per blocking: */
+			if(producerWaiting&&__sync_bool_compare_and_swap(&producerWaiting,1,0))
+				wake(consumer.readSequence);
+			}
+		}
+	size_t read(Value* values,size_t numValues) // Reads between one and numValues from buffer; returns number read; blocks if no data is available
+		{
+		size_t numRead=0;
+		while(numRead<numValues)
+			{
+			/* Stop once some values were read and no more are available without blocking: */
+			if(numRead!=0&&consumer.cachedWriteCount==consumer.localReadCount&&(consumer.cachedWriteCount=producer.writeCount)==consumer.localReadCount)
+				break;
+			
+			/* Copy the next region: */
+			ReadLock readLock=getReadLock(numValues-numRead);
+			for(size_t i=0;i<readLock.numValues;++i,++values)
+				*values=readLock.values[i];
+			releaseReadLock(readLock,false);
+			numRead+=readLock.numValues;
+			}
+		publishReads();
+		
+		return numRead;
+		}
+	void blockingRead(Value* values,size_t numValues) // Reads the given array from buffer; blocks until everything is read
+		{
+		while(numValues>0)
+			{
+			/* Copy the next region: */
+			ReadLock readLock=getReadLock(numValues);
+			for(size_t i=0;i<readLock.numValues;++i,++values)
+				*values=readLock.values[i];
+			releaseReadLock(readLock,false);
+			numValues-=readLock.numValues;
+			}
+		publishReads();
+		}
+	
+	/* Producer interface: */
+	WriteLock getWriteLock(size_t maxNumValues) // Blocks until at least one value can be written to the buffer; returns lock on number of values
+		{
+		/* Determine the number of writable values, blocking if there are none: */
+		size_t numValues=bufferSize-(producer.localWriteCount-producer.cachedReadCount);
+		if(numValues==0)
+			numValues=waitForSpace();
+		
+		/* Adjust the result value for ring buffer wrap-around and requested number of values: */
+		size_t writeIndex=producer.writeIndex;
+		if(numValues>bufferSize-writeIndex)
+			numValues=bufferSize-writeIndex;
+		if(numValues>maxNumValues)
+			numValues=maxNumValues;
+		
+		/* Return a write lock: */
+		return WriteLock(buffer+writeIndex,numValues);
+		}
+	void releaseWriteLock(const WriteLock& writeLock,bool publish =true) // Releases a write lock; assumes that all data in the locked region has been written; defers handing the data to the consumer until the next call to publishWrites if publish is false
+		{
+		producer.localWriteCount+=writeLock.numValues;
+		
+		/* Advance the write index; write locks never extend past the end of the buffer: */
+		producer.writeIndex+=writeLock.numValues;
+		if(producer.writeIndex==bufferSize)
+			producer.writeIndex=0;
+		if(publish)
+			publishWrites();
+		}
+	void publishWrites(void) // Hands the data of all released write locks to the consumer
+		{
+		if(producer.writeCount!=producer.localWriteCount)
+			{
+			/* Publish the write count after the values are written: */
+			__sync_synchronize();
+			producer.writeCount=producer.localWriteCount;
+			__sync_synchronize();
+			
+			/* Wake up the consumer if it is blocked, but only once per blocking: */
+			if(consumerWaiting&&__sync_bool_compare_and_swap(&consumerWaiting,1,0))
+				wake(producer.writeSequence);
+			}
+		}
+	void blockingWrite(const Value* values,size_t numValues) // Writes the given array into buffer; blocks until everything is written
+		{
+		while(numValues>0)
+			{
+			/* Copy the next region: */
+			WriteLock writeLock=getWriteLock(numValues);
+			for(size_t i=0;i<writeLock.numValues;++i,++values)
+				writeLock.values[i]=*values;
+			releaseWriteLock(writeLock,false);
+			numValues-=writeLock.numValues;
+			}
+		publishWrites();
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+/***********************************************************************
+SpinBarrier - Class implementing synchronization points where a fixed
+number of threads have to come together before any can proceed, using
+adaptive spinning followed by blocking on a futex to reduce wake-up
+latency.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_SPINBARRIER_INCLUDED
+#define THREADS_SPINBARRIER_INCLUDED
+
+#include <unistd.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#include <Threads/Barrier.h>
+
+namespace Threads {
+
+class SpinBarrier
+	{
+	/* Elements: */
+	private:
+	volatile unsigned int numSynchronizingThreads; // Number of threads that have to synchronize before they can proceed
+	volatile unsigned int numWaitingThreads; // Number of threads that already entered the current synchronization
+	volatile int generation; // Number of completed synchronizations; waiting threads watch it for changes instead of a sense flag
+	volatile unsigned int numSleepingThreads; // Number of threads blocked in the kernel waiting for the current synchronization
+	unsigned int requestedMaxSpinCount; // Maximum number of spin iterations requested by the caller
+	unsigned int maxSpinCount; // Maximum number of spin iterations before a waiting thread blocks; zero if there are more synchronizing threads than CPUs
+	volatile unsigned int spinCount; // Current number of spin iterations, adapted to recent waiting times
+	#ifndef __linux__
+	pthread_mutex_t mutex; // Mutex protecting the condition variable on systems without futexes
+	pthread_cond_t cond; // Condition variable to wake up blocked threads on systems without futexes
+	#endif
+	
+	/* Private methods: */
+	static void pause(void) // Tells the CPU that the calling thread is spinning
+		{
+		#if defined(__i386__)||defined(__x86_64__)
+		__asm__ __volatile__("pause");
+		#endif
+		}
+	void updateMaxSpinCount(void) // Updates the maximum spin count; disables spinning if there are more synchronizing threads than CPUs
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		maxSpinCount=numCpus>0&&numSynchronizingThreads>(unsigned int)(numCpus)?0:requestedMaxSpinCount;
+		spinCount=maxSpinCount;
+		}
+	#ifdef __linux__
+	void sleep(int currentGeneration) // Blocks the calling thread until the given synchronization is complete
+		{
+		/* Wait on the generation counter, waking up periodically to act on cancellation requests: */
+		struct timespec timeout;
+		timeout.tv_sec=0;
+		timeout.tv_nsec=100000000;
+		while(generation==currentGeneration)
+			{
+			pthread_testcancel();
+			syscall(SYS_futex,&generation,FUTEX_WAIT_PRIVATE,currentGeneration,&timeout,0,0);
+			}
+		}
+	void wakeAll(void) // Wakes up all blocked threads
+		{
+		syscall(SYS_futex,&generation,FUTEX_WAKE_PRIVATE,0x7fffffff,0,0,0);
+		}
+	#else
+	static void unlockMutex(void* mutexPtr) // Cancellation clean-up handler for blocked threads
+		{
+		pthread_mutex_unlock(static_cast<pthread_mutex_t*>(mutexPtr));
+		}
+	void sleep(int currentGeneration)
+		{
+		pthread_mutex_lock(&mutex);
+		pthread_cleanup_push(unlockMutex,&mutex);
+		while(generation==currentGeneration)
+			pthread_cond_wait(&cond,&mutex);
+		pthread_cleanup_pop(1);
+		}
+	void wakeAll(void)
+		{
+		pthread_mutex_lock(&mutex);
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+		}
+	#endif
+	
+	/* Constructors and destructors: */
+	public:
+	SpinBarrier(unsigned int sNumSynchronizingThreads =1,unsigned int sMaxSpinCount =20000) // Creates a barrier to synchronize the given number of threads, spinning for at most the given number of iterations before blocking
+		:numSynchronizingThreads(sNumSynchronizingThreads),
+		 numWaitingThreads(0),generation(0),numSleepingThreads(0),
+		 requestedMaxSpinCount(sMaxSpinCount)
+		{
+		updateMaxSpinCount();
+		#ifndef __linux__
+		pthread_mutex_init(&mutex,0);
+		pthread_cond_init(&cond,0);
+		#endif
+		}
+	private:
+	SpinBarrier(const SpinBarrier& source); // Prohibit copy constructor
+	SpinBarrier& operator=(const SpinBarrier& source); // Prohibit assignment operator
+	public:
+	~SpinBarrier(void)
+		{
+		#ifndef __linux__
+		pthread_mutex_destroy(&mutex);
+		pthread_cond_destroy(&cond);
+		#endif
+		}
+	
+	/* Methods: */
+	unsigned int getNumSynchronizingThreads(void) const // Returns the number of threads that have to synchronize
+		{
+		return numSynchronizingThreads;
+		}
+	void setNumSynchronizingThreads(unsigned int newNumSynchronizingThreads) // Sets the number of threads that have to synchronize; must not be called while threads are waiting at the barrier
+		{
+		/* Check if the barrier is in the middle of a synchronization: */
+		if(numWaitingThreads!=0)
+			throw Barrier::BarrierBusy();
+		
+		/* Set the number of synchronizing threads: */
+		numSynchronizingThreads=newNumSynchronizingThreads;
+		updateMaxSpinCount();
+		}
+	unsigned int getMaxSpinCount(void) const // Returns the maximum number of spin iterations before blocking
+		{
+		return requestedMaxSpinCount;
+		}
+	void setMaxSpinCount(unsigned int newMaxSpinCount) // Sets the maximum number of spin iterations before blocking; zero makes waiting threads block immediately
+		{
+		requestedMaxSpinCount=newMaxSpinCount;
+		updateMaxSpinCount();
+		}
+	bool synchronize(void) // Enters the synchronization point; blocks the calling thread until synchronization is complete; returns true for exactly one of the callers upon wakeup
+		{
+		/* Remember the current synchronization before entering it: */
+		int currentGeneration=generation;
+		__sync_synchronize();
+		
+		/* Enter the synchronization point: */
+		if(__sync_add_and_fetch(&numWaitingThreads,1U)==numSynchronizingThreads)
+			{
+			/* Reset the barrier for the next synchronization, then release the waiting threads: */
+			numWaitingThreads=0;
+			__sync_add_and_fetch(&generation,1);
+			
+			/* Wake up any blocked threads: */
+			if(numSleepingThreads!=0)
+				wakeAll();
+			
+			/* This is the one call returning true: */
+			return true;
+			}
+		
+		/* Spin for a while, hoping that the synchronization completes soon: */
+		unsigned int currentSpinCount=spinCount;
+		for(unsigned int i=0;i<currentSpinCount;++i)
+			{
+			if(generation!=currentGeneration)
+				{
+				/* Spinning succeeded; allow longer spins next time: */
+				if(currentSpinCount<maxSpinCount)
+					spinCount=currentSpinCount+currentSpinCount/8+16<maxSpinCount?currentSpinCount+currentSpinCount/8+16:maxSpinCount;
+				return false;
+				}
+			pause();
+			}
+		
+		/* Spinning failed; spin for a shorter time next time, but keep spinning a little to detect shorter waits: */
+		spinCount=currentSpinCount/2>maxSpinCount/64?currentSpinCount/2:maxSpinCount/64;
+		
+		/* Block until the synchronization is complete: */
+		__sync_add_and_fetch(&numSleepingThreads,1U);
+		sleep(currentGeneration);
+		__sync_sub_and_fetch(&numSleepingThreads,1U);
+		
+		return false;
+		}
+	};
+
+}
+
+#endif
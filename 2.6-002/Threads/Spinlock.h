@@ -3,7 +3,7 @@ Spinlock - Wrapper class for pthreads spinlocks, mostly providing
 "resource allocation as creation" paradigm and lock objects. If the
 host's pthreads library does not provide spinlocks, this class simulates
 them using mutexes instead.
-Copyright (c) 2011-2012 Oliver Kreylos
+Copyright (c) 2011-2013 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -32,6 +32,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <errno.h>
 #include <iostream>
 #endif
+#if THREADS_CONFIG_PROFILE_LOCKS
+#include <Threads/LockProfiler.h>
+#endif
 
 #if THREADS_CONFIG_HAVE_SPINLOCKS
 
@@ -64,14 +67,22 @@ class Spinlock
 		/* Elements: */
 		private:
 		ThreadsSpinlockType* spinlockPtr; // Pointer to spinlock that was locked
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		LockProfiler* profilerPtr; // Pointer to the locked spinlock's contention profiler
+		#endif
 		
 		/* Constructors and destructors: */
 		public:
 		Lock(Spinlock& spinlock) // Locks the given mutex
 			:spinlockPtr(&spinlock.spinlock)
+			 #if THREADS_CONFIG_PROFILE_LOCKS
+			 ,profilerPtr(&spinlock.profiler)
+			 #endif
 			{
 			/* Lock the spinlock: */
-			#if THREADS_CONFIG_DEBUG
+			#if THREADS_CONFIG_PROFILE_LOCKS
+			profilerPtr->lock(spinlockPtr);
+			#elif THREADS_CONFIG_DEBUG
 			if(ThreadsSpinlockLockFunc(spinlockPtr)!=0)
 				std::cerr<<"Error in Threads::Spinlock::Lock::Lock"<<std::endl;
 			#else
@@ -85,7 +96,9 @@ class Spinlock
 		~Lock(void)
 			{
 			/* Unlock the spinlock: */
-			#if THREADS_CONFIG_DEBUG
+			#if THREADS_CONFIG_PROFILE_LOCKS
+			profilerPtr->unlock(spinlockPtr);
+			#elif THREADS_CONFIG_DEBUG
 			if(ThreadsSpinlockUnlockFunc(spinlockPtr)!=0)
 				std::cerr<<"Error in Threads::Spinlock::Lock::~Lock"<<std::endl;
 			#else
@@ -99,10 +112,37 @@ class Spinlock
 	/* Elements: */
 	private:
 	ThreadsSpinlockType spinlock; // Low-level pthread spinlock (or mutex) handle
+	#if THREADS_CONFIG_PROFILE_LOCKS
+	LockProfiler profiler; // Profiler collecting contention statistics
+	#endif
 	
 	/* Constructors and destructors: */
 	public:
 	Spinlock(bool processShared =false) // Creates spinlock with given share flag
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::Spinlock",0)
+		#endif
+		{
+		#if THREADS_CONFIG_HAVE_SPINLOCKS
+		#if THREADS_CONFIG_DEBUG
+		if(pthread_spin_init(&spinlock,processShared)!=0)
+			std::cerr<<"Error in Threads::Spinlock::Spinlock"<<std::endl;
+		#else
+		pthread_spin_init(&spinlock,processShared);
+		#endif
+		#else
+		#if THREADS_CONFIG_DEBUG
+		if(pthread_mutex_init(&spinlock,0)!=0)
+			std::cerr<<"Error in Threads::Spinlock::Spinlock"<<std::endl;
+		#else
+		pthread_mutex_init(&spinlock,0);
+		#endif
+		#endif
+		}
+	Spinlock(const char* name,bool processShared =false) // Creates spinlock with given share flag and a name identifying it in lock profiles
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		:profiler("Threads::Spinlock",name)
+		#endif
 		{
 		#if THREADS_CONFIG_HAVE_SPINLOCKS
 		#if THREADS_CONFIG_DEBUG
@@ -137,7 +177,9 @@ class Spinlock
 	/* Methods: */
 	void lock(void) // Locks spinlock; blocks until lock is held
 		{
-		#if THREADS_CONFIG_DEBUG
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		profiler.lock(&spinlock);
+		#elif THREADS_CONFIG_DEBUG
 		if(ThreadsSpinlockLockFunc(&spinlock)!=0)
 			std::cerr<<"Error in Threads::Spinlock::lock"<<std::endl;
 		#else
@@ -146,16 +188,22 @@ class Spinlock
 		}
 	bool tryLock(void) // Locks spinlock and returns true if currently unlocked; returns false otherwise
 		{
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		return profiler.tryLock(&spinlock);
+		#else
 		int result=ThreadsSpinlockTrylockFunc(&spinlock);
 		#if THREADS_CONFIG_DEBUG
 		if(result!=0&&result!=EBUSY)
 			std::cerr<<"Error in Threads::Spinlock::tryLock"<<std::endl;
 		#endif
 		return result==0;
+		#endif
 		}
 	void unlock(void) // Unlocks spinlock
 		{
-		#if THREADS_CONFIG_DEBUG
+		#if THREADS_CONFIG_PROFILE_LOCKS
+		profiler.unlock(&spinlock);
+		#elif THREADS_CONFIG_DEBUG
 		if(ThreadsSpinlockUnlockFunc(&spinlock)!=0)
 			std::cerr<<"Error in Threads::Spinlock::unlock"<<std::endl;
 		#else
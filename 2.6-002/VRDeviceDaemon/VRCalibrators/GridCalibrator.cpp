@@ -23,8 +23,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <VRDeviceDaemon/VRCalibrators/GridCalibrator.h>
 
+#include <stdio.h>
+#include <Misc/FixedArray.h>
 #include <Misc/File.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ArrayValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
 
 /* Forward declarations: */
 template <class BaseClassParam>
@@ -34,9 +39,96 @@ class VRFactoryManager;
 Methods of class GridCalibrator:
 *******************************/
 
+void GridCalibrator::createLookupGrid(const GridCalibrator::Grid::Index& newLookupSize,GridCalibrator::Scalar positionTolerance,GridCalibrator::Scalar orientationTolerance)
+	{
+	/* Cover the calibration grid's domain with a regular grid: */
+	lookupBox=calibrationGrid->getDomainBox();
+	lookupSize=newLookupSize;
+	for(int i=0;i<3;++i)
+		lookupCellScale[i]=Scalar(lookupSize[i]-1)/(lookupBox.max[i]-lookupBox.min[i]);
+	lookupStrides[2]=1;
+	lookupStrides[1]=lookupSize[2];
+	lookupStrides[0]=lookupSize[1]*lookupSize[2];
+	int numLookupVertices=lookupSize[0]*lookupSize[1]*lookupSize[2];
+	lookupValues=new CalibrationData[numLookupVertices];
+	lookupCellValid=new bool[numLookupVertices];
+	
+	/* Resample the calibration data, walking the lookup grid in memory order to exploit locator coherence: */
+	bool* vertexValid=new bool[numLookupVertices];
+	Locator locator=calibrationGrid->getLocator();
+	int vertexIndex=0;
+	for(Grid::Index index(0);index[0]<lookupSize[0];index.preInc(lookupSize),++vertexIndex)
+		{
+		Point p;
+		for(int i=0;i<3;++i)
+			p[i]=lookupBox.min[i]+Scalar(index[i])/lookupCellScale[i];
+		vertexValid[vertexIndex]=locator.locatePoint(p,true);
+		if(vertexValid[vertexIndex])
+			lookupValues[vertexIndex]=locator.calcValue();
+		}
+	
+	/* Mark all cells whose vertices are all inside the calibration grid: */
+	vertexIndex=0;
+	for(Grid::Index index(0);index[0]<lookupSize[0];index.preInc(lookupSize),++vertexIndex)
+		{
+		bool valid=index[0]<lookupSize[0]-1&&index[1]<lookupSize[1]-1&&index[2]<lookupSize[2]-1;
+		for(int corner=0;corner<8&&valid;++corner)
+			{
+			int cornerIndex=vertexIndex;
+			for(int i=0;i<3;++i)
+				if(corner&(0x4>>i))
+					cornerIndex+=lookupStrides[i];
+			valid=vertexValid[cornerIndex];
+			}
+		lookupCellValid[vertexIndex]=valid;
+		}
+	delete[] vertexValid;
+	
+	/* Compare the lookup grid against the exact result at all cell centers, where the interpolation error is largest: */
+	Scalar maxPositionError(0);
+	Scalar maxOrientationError(0);
+	int numCoveredCells=0;
+	vertexIndex=0;
+	for(Grid::Index index(0);index[0]<lookupSize[0];index.preInc(lookupSize),++vertexIndex)
+		if(lookupCellValid[vertexIndex])
+			{
+			Point p;
+			for(int i=0;i<3;++i)
+				p[i]=lookupBox.min[i]+(Scalar(index[i])+Scalar(0.5))/lookupCellScale[i];
+			CalibrationData approx;
+			if(lookup(p,approx)&&locator.locatePoint(p,true))
+				{
+				CalibrationData exact=locator.calcValue();
+				Scalar positionError=Geometry::mag(approx.positionOffset-exact.positionOffset);
+				if(maxPositionError<positionError)
+					maxPositionError=positionError;
+				Scalar orientationError=Geometry::mag(approx.orientationOffset-exact.orientationOffset);
+				if(maxOrientationError<orientationError)
+					maxOrientationError=orientationError;
+				++numCoveredCells;
+				}
+			}
+	
+	#ifdef VERBOSE
+	printf("GridCalibrator: Lookup grid of %d x %d x %d vertices covers %d cells; maximum errors %g (position), %g (orientation)\n",lookupSize[0],lookupSize[1],lookupSize[2],numCoveredCells,double(maxPositionError),double(maxOrientationError));
+	fflush(stdout);
+	#endif
+	
+	if(maxPositionError>positionTolerance||maxOrientationError>orientationTolerance)
+		{
+		/* Fall back to exact evaluation: */
+		fprintf(stderr,"GridCalibrator: Lookup grid exceeds error tolerance; disabling lookup acceleration\n");
+		delete[] lookupValues;
+		lookupValues=0;
+		delete[] lookupCellValid;
+		lookupCellValid=0;
+		}
+	}
+
 GridCalibrator::GridCalibrator(VRCalibrator::Factory* sFactory,Misc::ConfigurationFile& configFile)
 	:VRCalibrator(sFactory,configFile),
-	 numDeviceTrackers(0),calibrationGrid(0),trackerLocators(0)
+	 numDeviceTrackers(0),calibrationGrid(0),trackerLocators(0),
+	 lookupValues(0),lookupCellValid(0)
 	{
 	/* Load the calibration data from file: */
 	Misc::File calibrationFile(configFile.retrieveString("./calibrationFileName").c_str(),"rb",Misc::File::LittleEndian);
@@ -56,10 +148,21 @@ GridCalibrator::GridCalibrator(VRCalibrator::Factory* sFactory,Misc::Configurati
 		calibrationFile.read(v.value.orientationOffset.getComponents(),3);
 		}
 	calibrationGrid->finalizeGrid();
+	
+	/* Create the lookup grid: */
+	Misc::FixedArray<int,3> lookupGridSize=configFile.retrieveValue<Misc::FixedArray<int,3> >("./lookupGridSize",Misc::FixedArray<int,3>(64));
+	if(lookupGridSize[0]>=2&&lookupGridSize[1]>=2&&lookupGridSize[2]>=2)
+		{
+		Scalar positionTolerance=configFile.retrieveValue<Scalar>("./lookupPositionTolerance",Scalar(0.01));
+		Scalar orientationTolerance=configFile.retrieveValue<Scalar>("./lookupOrientationTolerance",Scalar(0.001));
+		createLookupGrid(Grid::Index(lookupGridSize[0],lookupGridSize[1],lookupGridSize[2]),positionTolerance,orientationTolerance);
+		}
 	}
 
 GridCalibrator::~GridCalibrator(void)
 	{
+	delete[] lookupValues;
+	delete[] lookupCellValid;
 	delete[] trackerLocators;
 	delete calibrationGrid;
 	}
@@ -84,9 +187,13 @@ Vrui::VRDeviceState::TrackerState& GridCalibrator::calibrate(int deviceTrackerIn
 	Point rawPosition=rawState.positionOrientation.getOrigin();
 	Rotation rawOrientation=rawState.positionOrientation.getRotation();
 	
-	/* Calculate the correction values at the raw tracker position: */
-	trackerLocators[deviceTrackerIndex].locatePoint(rawPosition,true);
-	CalibrationData correction=trackerLocators[deviceTrackerIndex].calcValue();
+	/* Calculate the correction values at the raw tracker position, using the exact curvilinear grid where the lookup grid does not apply: */
+	CalibrationData correction;
+	if(lookupValues==0||!lookup(rawPosition,correction))
+		{
+		trackerLocators[deviceTrackerIndex].locatePoint(rawPosition,true);
+		correction=trackerLocators[deviceTrackerIndex].calcValue();
+		}
 	Rotation orientationOffset(correction.orientationOffset);
 	
 	/* Calibrate position/orientation: */
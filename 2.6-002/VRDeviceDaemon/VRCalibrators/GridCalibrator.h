@@ -65,11 +65,47 @@ class GridCalibrator:public VRCalibrator
 	private:
 	typedef Visualization::Curvilinear<Scalar,3,CalibrationData,CalibrationData> Grid; // Data type for grids of calibration data
 	typedef Grid::Locator Locator; // Data type for locators in the calibration grid
+	typedef Grid::Box Box; // Data type for axis-aligned boxes
 	
 	/* Elements: */
 	int numDeviceTrackers; // Number of trackers on the associated device
 	Grid* calibrationGrid; // Grid of calibration data
 	Locator* trackerLocators; // Array of one locator for each tracker on the associated device
+	Box lookupBox; // Domain of the regular lookup grid
+	Grid::Index lookupSize; // Number of vertices of the regular lookup grid in each dimension
+	Vector lookupCellScale; // Scale factors from domain coordinates to lookup grid cell coordinates
+	int lookupStrides[3]; // Strides of the lookup grid arrays in each dimension
+	CalibrationData* lookupValues; // Array of calibration data resampled to the regular lookup grid, or null if lookup is disabled
+	bool* lookupCellValid; // Array of flags whether a lookup grid cell lies entirely inside the calibration grid, indexed by base vertex
+	
+	/* Private methods: */
+	void createLookupGrid(const Grid::Index& newLookupSize,Scalar positionTolerance,Scalar orientationTolerance); // Resamples the calibration grid to a regular lookup grid; disables lookup if it deviates from the exact result by more than the given tolerances
+	bool lookup(const Point& position,CalibrationData& correction) const // Calculates the correction values at the given position from the lookup grid; returns false if the position is not covered
+		{
+		/* Calculate the lookup cell containing the position: */
+		int cellIndex=0;
+		Scalar w[3];
+		for(int i=0;i<3;++i)
+			{
+			Scalar c=(position[i]-lookupBox.min[i])*lookupCellScale[i];
+			if(!(c>=Scalar(0)&&c<Scalar(lookupSize[i]-1)))
+				return false;
+			int ci=int(c);
+			w[i]=c-Scalar(ci);
+			cellIndex+=ci*lookupStrides[i];
+			}
+		if(!lookupCellValid[cellIndex])
+			return false;
+		
+		/* Interpolate the correction values trilinearly: */
+		const CalibrationData* base=lookupValues+cellIndex;
+		CalibrationData v00=CalibrationData::interpolate(base[0],base[lookupStrides[0]],w[0]);
+		CalibrationData v10=CalibrationData::interpolate(base[lookupStrides[1]],base[lookupStrides[1]+lookupStrides[0]],w[0]);
+		CalibrationData v01=CalibrationData::interpolate(base[lookupStrides[2]],base[lookupStrides[2]+lookupStrides[0]],w[0]);
+		CalibrationData v11=CalibrationData::interpolate(base[lookupStrides[2]+lookupStrides[1]],base[lookupStrides[2]+lookupStrides[1]+lookupStrides[0]],w[0]);
+		correction=CalibrationData::interpolate(CalibrationData::interpolate(v00,v10,w[1]),CalibrationData::interpolate(v01,v11,w[1]),w[2]);
+		return true;
+		}
 	
 	/* Constructors and destructors: */
 	public:
@@ -30,6 +30,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <VRDeviceDaemon/VRFactory.h>
 #include <VRDeviceDaemon/VRCalibrator.h>
+#include <VRDeviceDaemon/VRFilter.h>
 #include <VRDeviceDaemon/VRDeviceManager.h>
 
 /*************************
@@ -55,9 +56,13 @@ void VRDevice::setNumTrackers(int newNumTrackers,const Misc::ConfigurationFile&
 		{
 		delete[] trackerIndices;
 		delete[] trackerPostTransformations;
+		delete[] batchTrackerIndices;
+		delete[] batchTrackerStates;
 		numTrackers=newNumTrackers;
 		trackerIndices=new int[numTrackers];
 		trackerPostTransformations=new TrackerPostTransformation[numTrackers];
+		batchTrackerIndices=new int[numTrackers];
+		batchTrackerStates=new Vrui::VRDeviceState::TrackerState[numTrackers];
 		}
 	
 	/* Initialize tracker post transformations: */
@@ -75,6 +80,12 @@ void VRDevice::setNumTrackers(int newNumTrackers,const Misc::ConfigurationFile&
 		calibrator->setNumTrackers(numTrackers);
 		}
 	
+	if(filter!=0)
+		{
+		/* Set the number of trackers in the filter: */
+		filter->setNumTrackers(numTrackers);
+		}
+	
 	/* Add the trackers to the device daemon's namespace: */
 	for(int i=0;i<numTrackers;++i)
 		trackerIndices[i]=deviceManager->addTracker(trackerNames!=0?trackerNames[i].c_str():0);
@@ -136,12 +147,40 @@ void VRDevice::setNumValuators(int newNumValuators,const Misc::ConfigurationFile
 	}
 
 void VRDevice::setTrackerState(int deviceTrackerIndex,const Vrui::VRDeviceState::TrackerState& state)
+	{
+	/* Time-stamp the state with the current time: */
+	setTrackerState(deviceTrackerIndex,state,Vrui::VRDeviceState::getCurrentTimeStamp());
+	}
+
+void VRDevice::setTrackerState(int deviceTrackerIndex,const Vrui::VRDeviceState::TrackerState& state,Vrui::VRDeviceState::TimeStamp sampleTimeStamp)
 	{
 	Vrui::VRDeviceState::TrackerState calibratedState=state;
 	if(calibrator!=0)
 		calibrator->calibrate(deviceTrackerIndex,calibratedState);
 	calibratedState.positionOrientation*=trackerPostTransformations[deviceTrackerIndex];
-	deviceManager->setTrackerState(trackerIndices[deviceTrackerIndex],calibratedState);
+	if(filter!=0)
+		filter->filter(deviceTrackerIndex,calibratedState,sampleTimeStamp);
+	deviceManager->setTrackerState(trackerIndices[deviceTrackerIndex],calibratedState,sampleTimeStamp);
+	}
+
+void VRDevice::setTrackerStates(int numStates,const int* deviceTrackerIndices,const Vrui::VRDeviceState::TrackerState* states,Vrui::VRDeviceState::TimeStamp sampleTimeStamp)
+	{
+	/* Calibrate and filter all states into the batch arrays: */
+	for(int i=0;i<numStates;++i)
+		{
+		int deviceTrackerIndex=deviceTrackerIndices[i];
+		Vrui::VRDeviceState::TrackerState& calibratedState=batchTrackerStates[i];
+		calibratedState=states[i];
+		if(calibrator!=0)
+			calibrator->calibrate(deviceTrackerIndex,calibratedState);
+		calibratedState.positionOrientation*=trackerPostTransformations[deviceTrackerIndex];
+		if(filter!=0)
+			filter->filter(deviceTrackerIndex,calibratedState,sampleTimeStamp);
+		batchTrackerIndices[i]=trackerIndices[deviceTrackerIndex];
+		}
+	
+	/* Hand the batch to the device manager: */
+	deviceManager->setTrackerStates(numStates,batchTrackerIndices,batchTrackerStates,sampleTimeStamp);
 	}
 
 void VRDevice::setButtonState(int deviceButtonIndex,Vrui::VRDeviceState::ButtonState newState)
@@ -201,7 +240,8 @@ VRDevice::VRDevice(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,M
 	 valuatorIndices(0),valuatorThresholds(0),valuatorExponents(0),
 	 active(false),
 	 deviceManager(sDeviceManager),
-	 calibrator(0)
+	 calibrator(0),filter(0),
+	 batchTrackerIndices(0),batchTrackerStates(0)
 	{
 	/* Check if the device has an attached calibrator: */
 	std::string calibratorType=configFile.retrieveString("./calibratorType","None");
@@ -212,16 +252,32 @@ VRDevice::VRDevice(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,M
 		calibrator=deviceManager->createCalibrator(calibratorType,configFile);
 		configFile.setCurrentSection("..");
 		}
+	
+	/* Check if the device has an attached filter: */
+	std::string filterType=configFile.retrieveString("./filterType","None");
+	if(filterType!="None")
+		{
+		/* Create the filter: */
+		configFile.setCurrentSection(configFile.retrieveString("./filterName").c_str());
+		filter=deviceManager->createFilter(filterType,configFile);
+		configFile.setCurrentSection("..");
+		}
 	}
 
 VRDevice::~VRDevice(void)
 	{
+	/* Delete filter: */
+	if(filter!=0)
+		VRFilter::destroy(filter);
+	
 	/* Delete calibrator: */
 	if(calibrator!=0)
 		VRCalibrator::destroy(calibrator);
 	
-	/* Delete tracker post transformations: */
+	/* Delete tracker post transformations and batch arrays: */
 	delete[] trackerPostTransformations;
+	delete[] batchTrackerIndices;
+	delete[] batchTrackerStates;
 	
 	/* Delete valuator thresholds and exponents: */
 	delete[] valuatorThresholds;
@@ -35,6 +35,7 @@ class ConfigurationFile;
 template <class BaseClassParam>
 class VRFactory;
 class VRCalibrator;
+class VRFilter;
 class VRDeviceManager;
 
 class VRDevice
@@ -63,6 +64,9 @@ class VRDevice
 	Threads::Thread deviceThread; // Device communication thread
 	VRDeviceManager* deviceManager; // Manager gathering data from VR devices
 	VRCalibrator* calibrator; // Calibrator for tracker measurements
+	VRFilter* filter; // Filter to smooth calibrated tracker measurements and estimate velocities
+	int* batchTrackerIndices; // Array of logical tracker indices of a batched tracker update
+	Vrui::VRDeviceState::TrackerState* batchTrackerStates; // Array of calibrated tracker states of a batched tracker update
 	
 	/* Private methods: */
 	void* deviceThreadMethodWrapper(void); // Wrapper method for the virtual device thread
@@ -73,7 +77,9 @@ class VRDevice
 	void setNumButtons(int newNumButtons,const Misc::ConfigurationFile& configFile,const std::string* buttonNames =0); // Sets number of buttons
 	void setNumValuators(int newNumValuators,const Misc::ConfigurationFile& configFile,const std::string* valuatorNames =0); // Sets number of valuators
 	void calcVelocities(int deviceTrackerIndex,Vrui::VRDeviceState::TrackerState& newState); // Calculates tracker velocities based on elapsed time since last measurement
-	void setTrackerState(int deviceTrackerIndex,const Vrui::VRDeviceState::TrackerState& state); // Sets (and calibrates) a tracker (device index given)
+	void setTrackerState(int deviceTrackerIndex,const Vrui::VRDeviceState::TrackerState& state); // Sets (and calibrates and filters) a tracker (device index given); time-stamps the state with the current time
+	void setTrackerState(int deviceTrackerIndex,const Vrui::VRDeviceState::TrackerState& state,Vrui::VRDeviceState::TimeStamp sampleTimeStamp); // Ditto, with the time stamp at which the state was sampled
+	void setTrackerStates(int numStates,const int* deviceTrackerIndices,const Vrui::VRDeviceState::TrackerState* states,Vrui::VRDeviceState::TimeStamp sampleTimeStamp); // Sets (and calibrates and filters) several trackers sampled at the same time in a single atomic update
 	void setButtonState(int deviceButtonIndex,Vrui::VRDeviceState::ButtonState newState); // Sets a button state (device index given)
 	void setValuatorState(int deviceValuatorIndex,Vrui::VRDeviceState::ValuatorState newState); // Sets a valuator state (device index given)
 	void updateState(void); // Notifies the device manager that this device's state can be sent to clients
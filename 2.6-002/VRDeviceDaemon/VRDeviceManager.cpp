@@ -34,6 +34,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <VRDeviceDaemon/VRFactory.h>
 #include <VRDeviceDaemon/VRDevice.h>
 #include <VRDeviceDaemon/VRCalibrator.h>
+#include <VRDeviceDaemon/VRFilter.h>
 
 /********************************
 Methods of class VRDeviceManager:
@@ -42,8 +43,10 @@ Methods of class VRDeviceManager:
 VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 	:deviceFactories(configFile.retrieveString("./deviceDirectory",SYSVRDEVICEDIRECTORY),this),
 	 calibratorFactories(configFile.retrieveString("./calibratorDirectory",SYSVRCALIBRATORDIRECTORY)),
+	 filterFactories(configFile.retrieveString("./filterDirectory",SYSVRFILTERDIRECTORY)),
 	 numDevices(0),
 	 devices(0),trackerIndexBases(0),buttonIndexBases(0),valuatorIndexBases(0),
+	 stateMutex("VRDeviceManager::stateMutex"),
 	 fullTrackerReportMask(0x0),trackerReportMask(0x0),trackerUpdateNotificationEnabled(false),
 	 trackerUpdateCompleteCond(0)
 	{
@@ -235,21 +238,51 @@ VRCalibrator* VRDeviceManager::createCalibrator(const std::string& calibratorTyp
 	return calibratorFactory->createObject(configFile);
 	}
 
-void VRDeviceManager::setTrackerState(int trackerIndex,const Vrui::VRDeviceState::TrackerState& newTrackerState)
+VRFilter* VRDeviceManager::createFilter(const std::string& filterType,Misc::ConfigurationFile& configFile)
+	{
+	FilterFactoryManager::Factory* filterFactory=filterFactories.getFactory(filterType);
+	return filterFactory->createObject(configFile);
+	}
+
+void VRDeviceManager::checkTrackerReportMask(void)
+	{
+	if(trackerReportMask==fullTrackerReportMask)
+		{
+		/* Wake up all client threads in stream mode: */
+		trackerUpdateCompleteCond->broadcast();
+		trackerReportMask=0x0;
+		}
+	}
+
+void VRDeviceManager::setTrackerState(int trackerIndex,const Vrui::VRDeviceState::TrackerState& newTrackerState,Vrui::VRDeviceState::TimeStamp newTrackerTimeStamp)
 	{
 	Threads::Mutex::Lock stateLock(stateMutex);
 	state.setTrackerState(trackerIndex,newTrackerState);
+	state.setTrackerTimeStamp(trackerIndex,newTrackerTimeStamp);
 	
 	if(trackerUpdateNotificationEnabled)
 		{
 		/* Update tracker report mask: */
 		trackerReportMask|=1<<trackerIndex;
-		if(trackerReportMask==fullTrackerReportMask)
-			{
-			/* Wake up all client threads in stream mode: */
-			trackerUpdateCompleteCond->broadcast();
-			trackerReportMask=0x0;
-			}
+		checkTrackerReportMask();
+		}
+	}
+
+void VRDeviceManager::setTrackerStates(int numTrackers,const int* trackerIndices,const Vrui::VRDeviceState::TrackerState* newTrackerStates,Vrui::VRDeviceState::TimeStamp newTrackerTimeStamp)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	for(int i=0;i<numTrackers;++i)
+		{
+		state.setTrackerState(trackerIndices[i],newTrackerStates[i]);
+		state.setTrackerTimeStamp(trackerIndices[i],newTrackerTimeStamp);
+		}
+	
+	if(trackerUpdateNotificationEnabled)
+		{
+		/* Update tracker report mask with the entire batch: */
+		for(int i=0;i<numTrackers;++i)
+			trackerReportMask|=1<<trackerIndices[i];
+		checkTrackerReportMask();
 		}
 	}
 
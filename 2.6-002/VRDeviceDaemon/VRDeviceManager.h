@@ -42,6 +42,7 @@ class VRDeviceDescriptor;
 }
 class VRDevice;
 class VRCalibrator;
+class VRFilter;
 
 class VRDeviceManager
 	{
@@ -69,11 +70,13 @@ class VRDeviceManager
 		};
 	
 	typedef VRFactoryManager<VRCalibrator> CalibratorFactoryManager;
+	typedef VRFactoryManager<VRFilter> FilterFactoryManager;
 	
 	/* Elements: */
 	private:
 	DeviceFactoryManager deviceFactories; // Factory manager to load VR device classes
 	CalibratorFactoryManager calibratorFactories; // Factory manager to load VR calibrator classes
+	FilterFactoryManager filterFactories; // Factory manager to load VR filter classes
 	int numDevices; // Number of managed devices
 	VRDevice** devices; // Array of pointers to VR devices
 	int* trackerIndexBases; // Array of base tracker indices for each VR device
@@ -90,6 +93,9 @@ class VRDeviceManager
 	bool trackerUpdateNotificationEnabled; // Flag if update notification is enabled
 	Threads::MutexCond* trackerUpdateCompleteCond; // Condition variable to notify client threads that all tracker states has been updated
 	
+	/* Private methods: */
+	void checkTrackerReportMask(void); // Notifies client threads and resets the tracker report mask if all trackers have reported; must be called with state locked
+	
 	/* Constructors and destructors: */
 	public:
 	VRDeviceManager(Misc::ConfigurationFile& configFile); // Creates device manager by reading current section of configuration file
@@ -100,6 +106,7 @@ class VRDeviceManager
 	int addButton(const char* name =0); // Adds a new button to the manager's namespace; returns button index
 	int addValuator(const char* name =0); // Adds a new valuator to the manager's namespace; returns valuator index
 	VRCalibrator* createCalibrator(const std::string& calibratorType,Misc::ConfigurationFile& configFile); // Loads calibrator of given type from current section in configuration file
+	VRFilter* createFilter(const std::string& filterType,Misc::ConfigurationFile& configFile); // Loads filter of given type from current section in configuration file
 	void addVirtualDevice(Vrui::VRDeviceDescriptor* newVirtualDevice); // Adds a virtual device; is adopted by device manager
 	void lockState(void) // Locks current device states
 		{
@@ -113,7 +120,8 @@ class VRDeviceManager
 		{
 		return state;
 		};
-	void setTrackerState(int trackerIndex,const Vrui::VRDeviceState::TrackerState& newTrackerState); // Updates state of single tracker
+	void setTrackerState(int trackerIndex,const Vrui::VRDeviceState::TrackerState& newTrackerState,Vrui::VRDeviceState::TimeStamp newTrackerTimeStamp); // Updates state of single tracker sampled at the given time
+	void setTrackerStates(int numTrackers,const int* trackerIndices,const Vrui::VRDeviceState::TrackerState* newTrackerStates,Vrui::VRDeviceState::TimeStamp newTrackerTimeStamp); // Atomically updates the states of several trackers sampled at the same time
 	void setButtonState(int buttonIndex,Vrui::VRDeviceState::ButtonState newButtonState); // Updates state of single button
 	void setValuatorState(int valuatorIndex,Vrui::VRDeviceState::ValuatorState newValuatorState); // Updates state of single valuator
 	void enableTrackerUpdateNotification(Threads::MutexCond* sTrackerUpdateCompleteCond); // Sets a condition variable to be signalled when all trackers have updated
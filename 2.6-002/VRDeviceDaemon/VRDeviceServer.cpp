@@ -34,6 +34,38 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 Methods of class VRDeviceServer:
 *******************************/
 
+void VRDeviceServer::writePacketReply(VRDeviceServer::ClientData* clientData)
+	{
+	/* Send packet reply message: */
+	clientData->pipe.writeMessage(Vrui::VRDevicePipe::PACKET_REPLY);
+	
+	/* Send server state: */
+	if(clientData->protocolVersion>=2U)
+		{
+		/* Send the server state including tracker time stamps, followed by the server's sending time stamp: */
+		deviceManager->getState().write(clientData->pipe,true);
+		clientData->pipe.write<Vrui::VRDeviceState::TimeStamp>(Vrui::VRDeviceState::getCurrentTimeStamp());
+		}
+	else
+		deviceManager->getState().write(clientData->pipe);
+	clientData->pipe.flush();
+	}
+
+void VRDeviceServer::sendTimeStampReply(VRDeviceServer::ClientData* clientData)
+	{
+	/* Read the client's time stamp: */
+	Vrui::VRDeviceState::TimeStamp clientTimeStamp=clientData->pipe.read<Vrui::VRDeviceState::TimeStamp>();
+	
+	/* Lock the pipe for writing: */
+	Threads::Mutex::Lock pipeLock(clientData->pipeMutex);
+	
+	/* Send time stamp reply message: */
+	clientData->pipe.writeMessage(Vrui::VRDevicePipe::TIMESTAMP_REPLY);
+	clientData->pipe.write<Vrui::VRDeviceState::TimeStamp>(clientTimeStamp);
+	clientData->pipe.write<Vrui::VRDeviceState::TimeStamp>(Vrui::VRDeviceState::getCurrentTimeStamp());
+	clientData->pipe.flush();
+	}
+
 void* VRDeviceServer::listenThreadMethod(void)
 	{
 	/* Enable immediate cancellation of this thread: */
@@ -105,6 +137,7 @@ void* VRDeviceServer::clientCommunicationThreadMethod(VRDeviceServer::ClientData
 							if(clientProtocolVersion>Vrui::VRDevicePipe::protocolVersionNumber)
 								clientProtocolVersion=Vrui::VRDevicePipe::protocolVersionNumber;
 							pipe.write<unsigned int>(clientProtocolVersion);
+							clientData->protocolVersion=clientProtocolVersion;
 							
 							/* Send server layout: */
 							deviceManager->getState().writeLayout(pipe);
@@ -123,6 +156,10 @@ void* VRDeviceServer::clientCommunicationThreadMethod(VRDeviceServer::ClientData
 				case CONNECTED:
 					switch(message)
 						{
+						case Vrui::VRDevicePipe::TIMESTAMP_REQUEST:
+							sendTimeStampReply(clientData);
+							break;
+						
 						case Vrui::VRDevicePipe::ACTIVATE_REQUEST:
 							{
 							/* Lock the client list: */
@@ -149,6 +186,10 @@ void* VRDeviceServer::clientCommunicationThreadMethod(VRDeviceServer::ClientData
 				case ACTIVE:
 					switch(message)
 						{
+						case Vrui::VRDevicePipe::TIMESTAMP_REQUEST:
+							sendTimeStampReply(clientData);
+							break;
+						
 						case Vrui::VRDevicePipe::PACKET_REQUEST:
 						case Vrui::VRDevicePipe::STARTSTREAM_REQUEST:
 							deviceManager->lockState();
@@ -164,11 +205,7 @@ void* VRDeviceServer::clientCommunicationThreadMethod(VRDeviceServer::ClientData
 									}
 								
 								/* Send packet reply message: */
-								pipe.writeMessage(Vrui::VRDevicePipe::PACKET_REPLY);
-								
-								/* Send server state: */
-								deviceManager->getState().write(pipe);
-								pipe.flush();
+								writePacketReply(clientData);
 								}
 							catch(...)
 								{
@@ -213,6 +250,11 @@ void* VRDeviceServer::clientCommunicationThreadMethod(VRDeviceServer::ClientData
 							/* Ignore message: */
 							break;
 						
+						case Vrui::VRDevicePipe::TIMESTAMP_REQUEST:
+							/* Answer periodic clock offset estimation requests between stream packets: */
+							sendTimeStampReply(clientData);
+							break;
+						
 						case Vrui::VRDevicePipe::STOPSTREAM_REQUEST:
 							{
 							/* Lock the pipe for writing: */
@@ -316,11 +358,7 @@ void* VRDeviceServer::streamingThreadMethod(void)
 				try
 					{
 					/* Send packet reply message: */
-					(*clIt)->pipe.writeMessage(Vrui::VRDevicePipe::PACKET_REPLY);
-					
-					/* Send server state: */
-					deviceManager->getState().write((*clIt)->pipe);
-					(*clIt)->pipe.flush();
+					writePacketReply(*clIt);
 					}
 				catch(std::runtime_error err)
 					{
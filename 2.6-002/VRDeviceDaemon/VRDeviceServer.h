@@ -47,10 +47,11 @@ class VRDeviceServer
 		Threads::Thread communicationThread; // Client communication thread
 		volatile bool active; // Flag if the client is active
 		volatile bool streaming; // Flag if the client is streaming
+		unsigned int protocolVersion; // Version of the client/server protocol negotiated with the client
 		
 		/* Constructors and destructors: */
 		ClientData(Comm::ListeningTCPSocket& listenSocket) // Accepts next incoming connection on given listening socket and establishes VR device connection
-			:pipe(listenSocket),active(false),streaming(false)
+			:pipe(listenSocket),active(false),streaming(false),protocolVersion(1)
 			{
 			};
 		};
@@ -69,6 +70,8 @@ class VRDeviceServer
 	Threads::MutexCond trackerUpdateCompleteCond; // Tracker update notification condition variable
 	
 	/* Private methods: */
+	void writePacketReply(ClientData* clientData); // Sends the device manager's current state to the given client; device manager's state and client's pipe must be locked
+	void sendTimeStampReply(ClientData* clientData); // Reads a time stamp request's client time stamp and replies with the server's current time stamp
 	void* listenThreadMethod(void); // Connection initiating thread method
 	void* clientCommunicationThreadMethod(ClientData* clientData); // Client communication thread method
 	void* streamingThreadMethod(void); // Method to stream device states to all clients who are currently streaming
@@ -26,49 +26,27 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Comm/UDPSocket.h>
 
 #include <VRDeviceDaemon/VRDevice.h>
+#include <VRDeviceDaemon/VRDevices/ArtDTrackParser.h>
 
 class ArtDTrack:public VRDevice
 	{
 	/* Embedded classes: */
-	private:
-	typedef Vrui::VRDeviceState::TrackerState::PositionOrientation PositionOrientation;
-	typedef PositionOrientation::Vector Vector;
-	typedef Vector::Scalar VScalar;
-	typedef PositionOrientation::Rotation Rotation;
-	typedef Rotation::Scalar RScalar;
-	
 	public:
 	enum DataFormat // Enumerated type for data formats
 		{
 		ASCII,BINARY
 		};
 	
-	enum DeviceReportFormat // Enumerated type for device tracking data reporting formats
-		{
-		DRF_6D=0,DRF_6DF,DRF_6DF2,DRF_6DMT,DRF_GL,DRF_3D,DRF_NUMFORMATS
-		};
-	
-	private:
-	struct Device // Structure describing DTrack devices
-		{
-		/* Elements: */
-		public:
-		DeviceReportFormat reportFormat; // Device's report format
-		int id; // Device's DTrack ID
-		int numButtons; // Number of buttons associated with the device
-		int firstButtonIndex; // Index of first button on device
-		int numValuators; // Number of valuators associated with the device
-		int firstValuatorIndex; // Index of first valuator on device
-		};
+	typedef ArtDTrackParser::DeviceReportFormat DeviceReportFormat; // Type for device tracking data reporting formats
 	
 	/* Elements: */
+	private:
 	bool useRemoteControl; // Flag whether to remote control the A.R.T. server to start/stop when Vrui applications start/stop
 	Comm::UDPSocket* controlSocket; // DTrack control socket
 	Comm::UDPSocket dataSocket; // DTrack data socket
 	DataFormat dataFormat; // Format of tracking data stream
-	Device* devices; // Array of tracked devices
-	int maxDeviceId[DRF_NUMFORMATS]; // Largest ID of any configured tracked device for each report format
-	int* deviceIdToIndex[DRF_NUMFORMATS]; // Arrays mapping from device IDs for each report format to device indices
+	ArtDTrackParser* parser; // Parser converting DTrack data messages into batches of device states for the tracked devices
+	unsigned int numDroppedFrames; // Number of stale frames discarded because a newer frame was already pending
 	
 	/* Private methods: */
 	void processAsciiData(void); // Processes tracking data in ASCII format
@@ -0,0 +1,599 @@
+/***********************************************************************
+ArtDTrackParser - Class to parse ART DTrack data messages into batches
+of device states, independent of the network connection to the DTrack
+server.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRDevices/ArtDTrackParser.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <Misc/Endianness.h>
+#include <Math/Math.h>
+#include <Geometry/Matrix.h>
+
+namespace {
+
+/***************************************************************
+Helper functions to extract data from DTrack ASCII message body:
+***************************************************************/
+
+inline bool expectChar(char expect,const char*& mPtr)
+	{
+	/* Skip whitespace: */
+	while(*mPtr!='\n'&&isspace(*mPtr))
+		++mPtr;
+	bool result=*mPtr==expect;
+	if(result)
+		++mPtr;
+	return result;
+	}
+
+inline int readInt(const char*& mPtr)
+	{
+	/* Parse an integer: */
+	char* intEnd;
+	int result=int(strtol(mPtr,&intEnd,10));
+	mPtr=intEnd;
+	return result;
+	}
+
+inline unsigned int readUint(const char*& mPtr)
+	{
+	/* Parse an integer: */
+	char* uintEnd;
+	unsigned int result=(unsigned int)(strtoul(mPtr,&uintEnd,10));
+	mPtr=uintEnd;
+	return result;
+	}
+
+inline double readFloat(const char*& mPtr)
+	{
+	/* Parse a float: */
+	char* floatEnd;
+	double result=strtod(mPtr,&floatEnd);
+	mPtr=floatEnd;
+	return result;
+	}
+
+/****************************************************************
+Helper functions to extract data from DTrack binary message body:
+****************************************************************/
+
+template <class DataParam>
+inline
+DataParam
+extractData(
+	const char*& dataPtr)
+	{
+	/* Extract data item: */
+	DataParam result=*reinterpret_cast<const DataParam*>(dataPtr);
+	
+	#if __BYTE_ORDER==__BIG_ENDIAN
+	/* Convert endianness of data item: */
+	Misc::swapEndianness(result);
+	#endif
+	
+	/* Advance data pointer: */
+	dataPtr+=sizeof(DataParam);
+	
+	/* Return data item: */
+	return result;
+	}
+
+template <class DataParam>
+inline
+void
+skipData(
+	const char*& dataPtr)
+	{
+	/* Advance data pointer: */
+	dataPtr+=sizeof(DataParam);
+	}
+
+}
+
+/********************************
+Methods of class ArtDTrackParser:
+********************************/
+
+void ArtDTrackParser::startFrame(void)
+	{
+	/* Remove the previous frame's devices from the frame: */
+	for(int i=0;i<numFrameTrackers;++i)
+		frameTrackerSlots[frameTrackerIndices[i]]=-1;
+	numFrameTrackers=0;
+	}
+
+void ArtDTrackParser::setFrameTracker(int deviceIndex,const ArtDTrackParser::PositionOrientation& positionOrientation)
+	{
+	/* Add the device to the frame unless it has already been reported in this message: */
+	int& slot=frameTrackerSlots[deviceIndex];
+	if(slot<0)
+		{
+		slot=numFrameTrackers;
+		frameTrackerIndices[slot]=deviceIndex;
+		++numFrameTrackers;
+		}
+	frameTrackerStates[slot].positionOrientation=positionOrientation;
+	}
+
+ArtDTrackParser::ArtDTrackParser(int sNumDevices,const ArtDTrackParser::Device* sDevices)
+	:numDevices(sNumDevices),devices(new Device[numDevices]),
+	 numButtons(0),numValuators(0),
+	 numFrameTrackers(0),frameTrackerIndices(new int[numDevices]),frameTrackerStates(new TrackerState[numDevices]),frameTrackerSlots(new int[numDevices]),
+	 buttonStates(0),valuatorStates(0)
+	{
+	/* Copy the device array and count the number of buttons and valuators: */
+	for(int reportFormat=0;reportFormat<DRF_NUMFORMATS;++reportFormat)
+		maxDeviceId[reportFormat]=0;
+	for(int i=0;i<numDevices;++i)
+		{
+		devices[i]=sDevices[i];
+		if(maxDeviceId[devices[i].reportFormat]<devices[i].id)
+			maxDeviceId[devices[i].reportFormat]=devices[i].id;
+		if(numButtons<devices[i].firstButtonIndex+devices[i].numButtons)
+			numButtons=devices[i].firstButtonIndex+devices[i].numButtons;
+		if(numValuators<devices[i].firstValuatorIndex+devices[i].numValuators)
+			numValuators=devices[i].firstValuatorIndex+devices[i].numValuators;
+		}
+	
+	/* Create the device ID to index mapping: */
+	for(int reportFormat=0;reportFormat<DRF_NUMFORMATS;++reportFormat)
+		{
+		deviceIdToIndex[reportFormat]=new int[maxDeviceId[reportFormat]+1];
+		for(int i=0;i<=maxDeviceId[reportFormat];++i)
+			deviceIdToIndex[reportFormat][i]=-1;
+		}
+	for(int i=0;i<numDevices;++i)
+		deviceIdToIndex[devices[i].reportFormat][devices[i].id]=i;
+	
+	/* Initialize the frame's tracker states and the button and valuator states: */
+	for(int i=0;i<numDevices;++i)
+		{
+		frameTrackerStates[i].linearVelocity=TrackerState::LinearVelocity::zero;
+		frameTrackerStates[i].angularVelocity=TrackerState::AngularVelocity::zero;
+		frameTrackerSlots[i]=-1;
+		}
+	buttonStates=new bool[numButtons];
+	for(int i=0;i<numButtons;++i)
+		buttonStates[i]=false;
+	valuatorStates=new float[numValuators];
+	for(int i=0;i<numValuators;++i)
+		valuatorStates[i]=0.0f;
+	}
+
+ArtDTrackParser::~ArtDTrackParser(void)
+	{
+	delete[] devices;
+	for(int reportFormat=0;reportFormat<DRF_NUMFORMATS;++reportFormat)
+		delete[] deviceIdToIndex[reportFormat];
+	delete[] frameTrackerIndices;
+	delete[] frameTrackerStates;
+	delete[] frameTrackerSlots;
+	delete[] buttonStates;
+	delete[] valuatorStates;
+	}
+
+ArtDTrackParser::DeviceReportFormat ArtDTrackParser::parseDeviceReportFormat(const char* start,const char* end,const char** parseEnd)
+	{
+	DeviceReportFormat result=DRF_NUMFORMATS;
+	const char* cPtr=start;
+	int state=0;
+	while(cPtr!=end&&state>=0)
+		{
+		switch(state)
+			{
+			case 0: // Start state
+				if(*cPtr=='6')
+					state=1;
+				else if(*cPtr=='3')
+					state=5;
+				else if(*cPtr=='g'||*cPtr=='G')
+					state=6;
+				else
+					state=-1;
+				break;
+			
+			case 1: // "6" read
+				if(*cPtr=='d'||*cPtr=='D')
+					{
+					result=DRF_6D;
+					state=2;
+					}
+				else
+					state=-1;
+				break;
+			
+			case 2: // "6d" read
+				if(*cPtr=='f'||*cPtr=='F')
+					{
+					result=DRF_6DF;
+					state=3;
+					}
+				else if(*cPtr=='m'||*cPtr=='M')
+					state=4;
+				else
+					{
+					if(isalnum(*cPtr)||*cPtr=='_')
+						result=DRF_NUMFORMATS;
+					state=-1;
+					}
+				break;
+			
+			case 3: // "6df" read
+				if(*cPtr=='2')
+					{
+					result=DRF_6DF2;
+					state=7;
+					}
+				else
+					{
+					if(isalnum(*cPtr)||*cPtr=='_')
+						result=DRF_NUMFORMATS;
+					state=-1;
+					}
+				break;
+			
+			case 4: // "6dm" read
+				if(*cPtr=='t'||*cPtr=='T')
+					{
+					result=DRF_6DMT;
+					state=7;
+					}
+				else
+					state=-1;
+				break;
+			
+			case 5: // "3" read
+				if(*cPtr=='d'||*cPtr=='D')
+					{
+					result=DRF_3D;
+					state=7;
+					}
+				else
+					state=-1;
+				break;
+			
+			case 6: // "g" read
+				if(*cPtr=='l'||*cPtr=='L')
+					{
+					result=DRF_GL;
+					state=7;
+					}
+				else
+					state=-1;
+				break;
+			
+			case 7: // Valid word read; check for end-of-word
+				if(isalnum(*cPtr)||*cPtr=='_')
+					result=DRF_NUMFORMATS;
+				state=-1;
+				break;
+			}
+		
+		if(state>=0)
+			{
+			/* Go to next character: */
+			++cPtr;
+			}
+		}
+	
+	/* Set the decode end and return the parsed word: */
+	*parseEnd=cPtr;
+	return result;
+	}
+
+void ArtDTrackParser::parseAsciiMessage(char* message,size_t messageSize)
+	{
+	/* Newline-terminate the message as a sentinel, followed by a NUL character to keep number parsing from skipping past the sentinel: */
+	message[messageSize]='\n';
+	message[messageSize+1]='\0';
+	
+	/* Parse the message into the frame's tracker state batch: */
+	startFrame();
+	const char* mPtr=message;
+	const char* mEnd=message+(messageSize+1);
+	while(mPtr!=mEnd)
+		{
+		/* Skip whitespace, but not the line terminator: */
+		while(*mPtr!='\n'&&isspace(*mPtr))
+			++mPtr;
+		
+		/* Get the line's device report format: */
+		DeviceReportFormat drf=parseDeviceReportFormat(mPtr,0,&mPtr);
+		
+		/* Process the line: */
+		if(drf!=DRF_NUMFORMATS)
+			{
+			if(drf==DRF_6DF2)
+				{
+				/* Skip the number of defined flysticks: */
+				readInt(mPtr);
+				}
+			
+			/* Read the number of bodies in this report: */
+			int numBodies=readInt(mPtr);
+			
+			/* Parse all body reports: */
+			for(int body=0;body<numBodies;++body)
+				{
+				/* Check for opening bracket: */
+				if(!expectChar('[',mPtr))
+					break;
+				
+				/* Read the body's ID and find the corresponding device structure: */
+				int id=readInt(mPtr);
+				int deviceIndex=id>=0&&id<=maxDeviceId[drf]?deviceIdToIndex[drf][id]:-1;
+				Device* device=deviceIndex>=0?&devices[deviceIndex]:0;
+				
+				/* Read the quality value: */
+				float quality=float(readFloat(mPtr));
+				
+				/* Read button/valuator or finger data depending on report format: */
+				int numButtons=0;
+				int numValuators=0;
+				int numFingers=0;
+				
+				if(drf==DRF_6DF)
+					{
+					/* Read the button bit mask: */
+					unsigned int buttonBits=readUint(mPtr);
+					
+					if(device!=0)
+						{
+						/* Update the device's button states: */
+						for(int i=0;i<32&&i<device->numButtons;++i,buttonBits>>=1)
+							buttonStates[device->firstButtonIndex+i]=(buttonBits&0x1)!=0x0;
+						}
+					}
+				if(drf==DRF_6DF2||drf==DRF_6DMT)
+					{
+					/* Read the number of buttons: */
+					numButtons=readInt(mPtr);
+					if(drf==DRF_6DF2)
+						{
+						/* Read the number of valuators: */
+						numValuators=readInt(mPtr);
+						}
+					}
+				if(drf==DRF_GL)
+					{
+					/* Skip the glove's handedness: */
+					readInt(mPtr);
+					
+					/* Read the number of fingers: */
+					numFingers=readInt(mPtr);
+					}
+				
+				/* Check for closing bracket followed by opening bracket: */
+				if(!expectChar(']',mPtr)||!expectChar('[',mPtr))
+					break;
+				
+				Vector pos;
+				Rotation orient=Rotation::identity;
+				
+				/* Read the body's 3D position: */
+				for(int i=0;i<3;++i)
+					pos[i]=VScalar(readFloat(mPtr));
+				
+				if(drf!=DRF_3D)
+					{
+					/* Read the body's 3D orientation: */
+					if(drf==DRF_6D||drf==DRF_6DF)
+						{
+						/* Read the body's orientation angles: */
+						VScalar angles[3];
+						for(int i=0;i<3;++i)
+							angles[i]=VScalar(readFloat(mPtr));
+						
+						/* Convert the orientation angles to a 3D rotation: */
+						orient*=Rotation::rotateX(Math::rad(angles[0]));
+						orient*=Rotation::rotateY(Math::rad(angles[1]));
+						orient*=Rotation::rotateZ(Math::rad(angles[2]));
+						}
+				
+					/* Check for closing bracket followed by opening bracket: */
+					if(!expectChar(']',mPtr)||!expectChar('[',mPtr))
+						break;
+					
+					if(drf==DRF_6DF2||drf==DRF_6DMT||drf==DRF_GL)
+						{
+						/* Read the body's orientation matrix (yuck!): */
+						Geometry::Matrix<VScalar,3,3> matrix;
+						for(int j=0;j<3;++j)
+							for(int i=0;i<3;++i)
+								matrix(i,j)=VScalar(readFloat(mPtr));
+						
+						if(quality>0.0f)
+							{
+							/* Calculate the body's orientation quaternion (YUCK!): */
+							orient=Rotation::fromMatrix(matrix);
+							}
+						}
+					else
+						{
+						/* Skip the body's orientation matrix: */
+						for(int i=0;i<9;++i)
+							readFloat(mPtr);
+						}
+					}
+				
+				/* Check for closing bracket: */
+				if(!expectChar(']',mPtr))
+					break;
+				
+				if(drf==DRF_6DF2)
+					{
+					/* Check for opening bracket: */
+					if(!expectChar('[',mPtr))
+						break;
+					
+					/* Read button states: */
+					for(int bitIndex=0;bitIndex<numButtons;bitIndex+=32)
+						{
+						/* Read the next button bit mask: */
+						unsigned int buttonBits=readUint(mPtr);
+						
+						if(device!=0)
+							{
+							/* Update the device's button states: */
+							for(int i=0;i<32&&bitIndex+i<device->numButtons;++i,buttonBits>>=1)
+								buttonStates[device->firstButtonIndex+bitIndex+i]=(buttonBits&0x1)!=0x0;
+							}
+						}
+					
+					/* Read valuator states: */
+					for(int i=0;i<numValuators;++i)
+						{
+						/* Read the next valuator value: */
+						float value=float(readFloat(mPtr));
+						
+						/* Update the valuator value if the valuator is valid: */
+						if(device!=0&&i<device->numValuators)
+							valuatorStates[device->firstValuatorIndex+i]=value;
+						}
+					
+					/* Check for closing bracket: */
+					if(!expectChar(']',mPtr))
+						break;
+					}
+				
+				if(drf==DRF_GL)
+					{
+					/* Skip all finger data for now: */
+					bool error=false;
+					for(int finger=0;finger<numFingers;++finger)
+						{
+						/* Check for opening bracket: */
+						if(!expectChar('[',mPtr))
+							{
+							error=true;
+							break;
+							}
+						
+						/* Skip finger position: */
+						for(int i=0;i<3;++i)
+							readFloat(mPtr);
+						
+						/* Check for closing followed by opening bracket: */
+						if(!expectChar(']',mPtr)||!expectChar('[',mPtr))
+							{
+							error=true;
+							break;
+							}
+						
+						/* Skip finger orientation: */
+						for(int i=0;i<9;++i)
+							readFloat(mPtr);
+						
+						/* Check for closing followed by opening bracket: */
+						if(!expectChar(']',mPtr)||!expectChar('[',mPtr))
+							{
+							error=true;
+							break;
+							}
+						
+						/* Skip finger bending parameters: */
+						for(int i=0;i<6;++i)
+							readFloat(mPtr);
+						
+						/* Check for closing bracket: */
+						if(!expectChar(']',mPtr))
+							{
+							error=true;
+							break;
+							}
+						}
+					
+					/* Stop parsing the packet on syntax error: */
+					if(error)
+						break;
+					}
+				
+				/* Check if this body has a valid position/orientation and has been configured as a device: */
+				if(quality>0.0f&&device!=0)
+					{
+					/* Set the device's tracker state in the frame: */
+					setFrameTracker(deviceIndex,PositionOrientation(pos,orient));
+					}
+				}
+			}
+		
+		/* Skip the rest of the line: */
+		while(*mPtr!='\n')
+			++mPtr;
+		
+		/* Go to the next line: */
+		++mPtr;
+		}
+	}
+
+void ArtDTrackParser::parseBinaryMessage(const char* message,size_t messageSize)
+	{
+	/* Size of a body record: ID, quality, position, Euler angles, and rotation matrix: */
+	const size_t bodySize=sizeof(unsigned int)+sizeof(float)*(1+3+3+9);
+	
+	/* Parse the message into the frame's tracker state batch: */
+	startFrame();
+	const char* mPtr=message;
+	if(messageSize<sizeof(unsigned int)+sizeof(int))
+		return;
+	// unsigned int frameNr=extractData<unsigned int>(mPtr);
+	skipData<unsigned int>(mPtr); // Skip frame number
+	int numBodies=extractData<int>(mPtr);
+	
+	/* Ignore truncated body records: */
+	int maxNumBodies=int((messageSize-sizeof(unsigned int)-sizeof(int))/bodySize);
+	if(numBodies>maxNumBodies)
+		numBodies=maxNumBodies;
+	for(int i=0;i<numBodies;++i)
+		{
+		/* Read body's ID and measurement quality: */
+		int trackerId=int(extractData<unsigned int>(mPtr));
+		// float quality=extractData<float>(mPtr);
+		skipData<float>(mPtr); // Skip measurement quality
+		
+		/* Read body's position: */
+		Vector pos;
+		for(int j=0;j<3;++j)
+			pos[j]=VScalar(extractData<float>(mPtr));
+		
+		/* Read body's orientation as Euler angles: */
+		RScalar angles[3];
+		for(int j=0;j<3;++j)
+			angles[j]=Math::rad(extractData<float>(mPtr));
+		
+		/* Convert Euler angles to rotation: */
+		Rotation o=Rotation::identity;
+		o*=Rotation::rotateX(angles[0]);
+		o*=Rotation::rotateY(angles[1]);
+		o*=Rotation::rotateZ(angles[2]);
+		
+		/* Skip body's orientation as rotation matrix: */
+		for(int j=0;j<9;++j)
+			skipData<float>(mPtr);
+		
+		/* Set the tracker's position and orientation in the frame: */
+		if(trackerId>=0&&trackerId<numDevices)
+			setFrameTracker(trackerId,PositionOrientation(pos,o));
+		}
+	}
@@ -0,0 +1,122 @@
+/***********************************************************************
+ArtDTrackParser - Class to parse ART DTrack data messages into batches
+of device states, independent of the network connection to the DTrack
+server.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef ARTDTRACKPARSER_INCLUDED
+#define ARTDTRACKPARSER_INCLUDED
+
+#include <stddef.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+class ArtDTrackParser
+	{
+	/* Embedded classes: */
+	public:
+	typedef Vrui::VRDeviceState::TrackerState TrackerState;
+	
+	enum DeviceReportFormat // Enumerated type for device tracking data reporting formats
+		{
+		DRF_6D=0,DRF_6DF,DRF_6DF2,DRF_6DMT,DRF_GL,DRF_3D,DRF_NUMFORMATS
+		};
+	
+	struct Device // Structure describing DTrack devices
+		{
+		/* Elements: */
+		public:
+		DeviceReportFormat reportFormat; // Device's report format
+		int id; // Device's DTrack ID
+		int numButtons; // Number of buttons associated with the device
+		int firstButtonIndex; // Index of first button on device
+		int numValuators; // Number of valuators associated with the device
+		int firstValuatorIndex; // Index of first valuator on device
+		};
+	
+	private:
+	typedef TrackerState::PositionOrientation PositionOrientation;
+	typedef PositionOrientation::Vector Vector;
+	typedef Vector::Scalar VScalar;
+	typedef PositionOrientation::Rotation Rotation;
+	typedef Rotation::Scalar RScalar;
+	
+	/* Elements: */
+	int numDevices; // Number of configured devices
+	Device* devices; // Array of configured devices
+	int maxDeviceId[DRF_NUMFORMATS]; // Largest ID of any configured tracked device for each report format
+	int* deviceIdToIndex[DRF_NUMFORMATS]; // Arrays mapping from device IDs for each report format to device indices
+	int numButtons; // Total number of buttons on all devices
+	int numValuators; // Total number of valuators on all devices
+	int numFrameTrackers; // Number of tracker states reported in the most recently parsed message
+	int* frameTrackerIndices; // Array of device indices of the trackers reported in the most recently parsed message
+	TrackerState* frameTrackerStates; // Array of tracker states reported in the most recently parsed message
+	int* frameTrackerSlots; // Array of positions of each device's state in the frame's tracker state arrays, or -1 if the device has not been reported in the current message
+	bool* buttonStates; // Array of current states of all buttons
+	float* valuatorStates; // Array of current states of all valuators
+	
+	/* Private methods: */
+	void startFrame(void); // Clears the frame's tracker states before parsing a new message
+	void setFrameTracker(int deviceIndex,const PositionOrientation& positionOrientation); // Sets the given device's tracker state in the current frame; a repeated report of the same device replaces the earlier one
+	
+	/* Constructors and destructors: */
+	public:
+	ArtDTrackParser(int sNumDevices,const Device* sDevices); // Creates a parser for the given array of devices with assigned button and valuator indices
+	private:
+	ArtDTrackParser(const ArtDTrackParser& source); // Prohibit copy constructor
+	ArtDTrackParser& operator=(const ArtDTrackParser& source); // Prohibit assignment operator
+	public:
+	~ArtDTrackParser(void);
+	
+	/* Methods: */
+	static DeviceReportFormat parseDeviceReportFormat(const char* start,const char* end,const char** parseEnd); // Parses a report format keyword; returns DRF_NUMFORMATS if the word is not a report format
+	void parseAsciiMessage(char* message,size_t messageSize); // Parses a message in ASCII format; message buffer must have room for two sentinel characters after the message
+	void parseBinaryMessage(const char* message,size_t messageSize); // Parses a message in binary format
+	int getNumFrameTrackers(void) const // Returns the number of tracker states reported in the most recently parsed message
+		{
+		return numFrameTrackers;
+		}
+	const int* getFrameTrackerIndices(void) const // Returns the device indices of the trackers reported in the most recently parsed message
+		{
+		return frameTrackerIndices;
+		}
+	const TrackerState* getFrameTrackerStates(void) const // Returns the tracker states reported in the most recently parsed message
+		{
+		return frameTrackerStates;
+		}
+	int getNumButtons(void) const // Returns the total number of buttons
+		{
+		return numButtons;
+		}
+	bool getButtonState(int buttonIndex) const // Returns the current state of the given button
+		{
+		return buttonStates[buttonIndex];
+		}
+	int getNumValuators(void) const // Returns the total number of valuators
+		{
+		return numValuators;
+		}
+	float getValuatorState(int valuatorIndex) const // Returns the current state of the given valuator
+		{
+		return valuatorStates[valuatorIndex];
+		}
+	};
+
+#endif
@@ -0,0 +1,330 @@
+/***********************************************************************
+LoadGenerator - Class for synthetic devices reporting deterministic
+tracker, button, and valuator states at configurable high rates, or
+replaying recorded device state streams, to benchmark the VR device
+daemon without tracking hardware.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRDevices/LoadGenerator.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdexcept>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+
+#include <VRDeviceDaemon/VRDeviceManager.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline void sleepUntil(Vrui::VRDeviceState::TimeStamp wakeupTime) // Blocks until the given time on the monotonic clock
+	{
+	struct timespec wakeup;
+	wakeup.tv_sec=time_t(wakeupTime/Vrui::VRDeviceState::TimeStamp(1000000));
+	wakeup.tv_nsec=long(wakeupTime%Vrui::VRDeviceState::TimeStamp(1000000))*1000L;
+	
+	/* Restart the sleep if it was interrupted by a signal; clock_nanosleep returns the error code instead of setting errno: */
+	while(clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&wakeup,0)==EINTR)
+		;
+	}
+
+}
+
+/******************************
+Methods of class LoadGenerator:
+******************************/
+
+void LoadGenerator::generateState(double time)
+	{
+	typedef Vrui::VRDeviceState::TrackerState TrackerState;
+	typedef TrackerState::PositionOrientation PositionOrientation;
+	typedef PositionOrientation::Scalar Scalar;
+	typedef PositionOrientation::Vector Vector;
+	typedef PositionOrientation::Rotation Rotation;
+	
+	/* Calculate all tracker states: */
+	double omega=2.0*Math::Constants<double>::pi*motionFrequency;
+	for(int i=0;i<state.getNumTrackers();++i)
+		{
+		TrackerState ts;
+		
+		/* Spread the trackers out along the x axis and shift their motion phases: */
+		Vector center(Scalar(i)*Scalar(motionRadius*2.5),0,0);
+		double phase=omega*time+double(i)*0.5;
+		switch(motionPattern)
+			{
+			case STATIC:
+				ts.positionOrientation=PositionOrientation(center,Rotation::identity);
+				ts.linearVelocity=TrackerState::LinearVelocity::zero;
+				ts.angularVelocity=TrackerState::AngularVelocity::zero;
+				break;
+			
+			case CIRCLE:
+				{
+				/* Move on a circle in the x-z plane while rotating around the y axis: */
+				Vector pos=center+Vector(Scalar(motionRadius*Math::cos(phase)),0,Scalar(motionRadius*Math::sin(phase)));
+				ts.positionOrientation=PositionOrientation(pos,Rotation::rotateY(Scalar(-phase)));
+				ts.linearVelocity=TrackerState::LinearVelocity(Scalar(-motionRadius*omega*Math::sin(phase)),0,Scalar(motionRadius*omega*Math::cos(phase)));
+				ts.angularVelocity=TrackerState::AngularVelocity(0,Scalar(-omega),0);
+				break;
+				}
+			
+			case LISSAJOUS:
+				{
+				/* Move on a 3D Lissajous figure with frequency ratios 1:2:3 while rotating around the z axis: */
+				Vector pos=center+Vector(Scalar(motionRadius*Math::sin(phase)),Scalar(motionRadius*Math::sin(2.0*phase)),Scalar(motionRadius*Math::sin(3.0*phase)));
+				ts.positionOrientation=PositionOrientation(pos,Rotation::rotateZ(Scalar(phase)));
+				ts.linearVelocity=TrackerState::LinearVelocity(Scalar(motionRadius*omega*Math::cos(phase)),Scalar(2.0*motionRadius*omega*Math::cos(2.0*phase)),Scalar(3.0*motionRadius*omega*Math::cos(3.0*phase)));
+				ts.angularVelocity=TrackerState::AngularVelocity(0,0,Scalar(omega));
+				break;
+				}
+			}
+		state.setTrackerState(i,ts);
+		}
+	
+	/* Toggle all buttons with increasing periods: */
+	for(int i=0;i<state.getNumButtons();++i)
+		state.setButtonState(i,(long(Math::floor(time/(buttonPeriod*double(i+1))))&0x1L)!=0);
+	
+	/* Move all valuators on sine waves of increasing frequency: */
+	for(int i=0;i<state.getNumValuators();++i)
+		state.setValuatorState(i,Vrui::VRDeviceState::ValuatorState(Math::sin(omega*double(i+1)*time)));
+	}
+
+void LoadGenerator::runSynthetic(void)
+	{
+	/* Calculate the update interval in microseconds: */
+	Vrui::VRDeviceState::TimeStamp interval=Vrui::VRDeviceState::TimeStamp(1.0e6/updateRate+0.5);
+	if(interval<Vrui::VRDeviceState::TimeStamp(1))
+		interval=Vrui::VRDeviceState::TimeStamp(1);
+	
+	/* Emit states on a fixed schedule to avoid accumulating drift: */
+	Vrui::VRDeviceState::TimeStamp startTime=Vrui::VRDeviceState::getCurrentTimeStamp();
+	Vrui::VRDeviceState::TimeStamp nextUpdate=startTime;
+	while(true)
+		{
+		/* Calculate and report the current state: */
+		generateState(double(nextUpdate-startTime)*1.0e-6);
+		for(int i=0;i<state.getNumButtons();++i)
+			setButtonState(i,state.getButtonState(i));
+		for(int i=0;i<state.getNumValuators();++i)
+			setValuatorState(i,state.getValuatorState(i));
+		Vrui::VRDeviceState::TimeStamp now=Vrui::VRDeviceState::getCurrentTimeStamp();
+		for(int i=0;i<state.getNumTrackers();++i)
+			setTrackerState(i,state.getTrackerState(i),now);
+		updateState();
+		
+		/* Wait for the next update; skip updates if the daemon fell behind: */
+		nextUpdate+=interval;
+		now=Vrui::VRDeviceState::getCurrentTimeStamp();
+		if(nextUpdate<now)
+			nextUpdate=now;
+		else
+			sleepUntil(nextUpdate);
+		}
+	}
+
+void LoadGenerator::runReplay(void)
+	{
+	/* Calculate the minimum delay between replay passes in microseconds: */
+	Vrui::VRDeviceState::TimeStamp interval=Vrui::VRDeviceState::TimeStamp(1.0e6/updateRate+0.5);
+	if(interval<Vrui::VRDeviceState::TimeStamp(1))
+		interval=Vrui::VRDeviceState::TimeStamp(1);
+	
+	Vrui::VRDeviceState::TimeStamp replayStartTime=Vrui::VRDeviceState::getCurrentTimeStamp();
+	while(true)
+		{
+		/* Replay all recorded states with their original relative timing: */
+		unsigned int numRecords=0;
+		Vrui::VRDeviceState::TimeStamp firstRecordTime=0;
+		Vrui::VRDeviceState::TimeStamp lastRecordTime=0;
+		try
+			{
+			/* Open the recorded stream and check its header: */
+			IO::FilePtr streamFile=IO::openFile(replayFileName.c_str());
+			streamFile->setEndianness(Misc::LittleEndian);
+			if(!Vrui::VRDeviceState::readStreamHeader(*streamFile))
+				{
+				fprintf(stderr,"LoadGenerator: %s is not a device state stream file\n",replayFileName.c_str());
+				return;
+				}
+			
+			/* Skip the stream's layout, which was checked in the constructor: */
+			Vrui::VRDeviceState streamState;
+			streamState.readLayout(*streamFile);
+			
+			while(!streamFile->eof())
+				{
+				/* Read the next recorded state: */
+				Vrui::VRDeviceState::TimeStamp recordTime=streamFile->read<Vrui::VRDeviceState::TimeStamp>();
+				state.read(*streamFile,true);
+				if(numRecords==0)
+					firstRecordTime=recordTime;
+				lastRecordTime=recordTime;
+				++numRecords;
+				
+				/* Wait until the state is due: */
+				Vrui::VRDeviceState::TimeStamp due=replayStartTime+(recordTime-firstRecordTime);
+				if(Vrui::VRDeviceState::getCurrentTimeStamp()<due)
+					sleepUntil(due);
+				
+				/* Report the recorded state: */
+				for(int i=0;i<state.getNumButtons();++i)
+					setButtonState(i,state.getButtonState(i));
+				for(int i=0;i<state.getNumValuators();++i)
+					setValuatorState(i,state.getValuatorState(i));
+				Vrui::VRDeviceState::TimeStamp now=Vrui::VRDeviceState::getCurrentTimeStamp();
+				for(int i=0;i<state.getNumTrackers();++i)
+					setTrackerState(i,state.getTrackerState(i),now);
+				updateState();
+				}
+			}
+		catch(std::runtime_error err)
+			{
+			/* End the replay on a truncated or unreadable stream: */
+			fprintf(stderr,"LoadGenerator: Ending replay of %s after %u states due to exception %s\n",replayFileName.c_str(),numRecords,err.what());
+			return;
+			}
+		
+		/* Stop if the stream did not contain any states, or if looping is disabled: */
+		if(numRecords==0)
+			{
+			fprintf(stderr,"LoadGenerator: %s does not contain any device states\n",replayFileName.c_str());
+			return;
+			}
+		if(!replayLoop)
+			break;
+		
+		/* Start the next pass one update interval after the last recorded state: */
+		replayStartTime+=(lastRecordTime-firstRecordTime)+interval;
+		Vrui::VRDeviceState::TimeStamp now=Vrui::VRDeviceState::getCurrentTimeStamp();
+		if(replayStartTime<now)
+			replayStartTime=now;
+		else
+			sleepUntil(replayStartTime);
+		}
+	}
+
+void LoadGenerator::deviceThreadMethod(void)
+	{
+	if(replayFileName.empty())
+		runSynthetic();
+	else
+		runReplay();
+	}
+
+LoadGenerator::LoadGenerator(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,Misc::ConfigurationFile& configFile)
+	:VRDevice(sFactory,sDeviceManager,configFile),
+	 motionPattern(CIRCLE),
+	 updateRate(configFile.retrieveValue<double>("./updateRate",1000.0)),
+	 motionRadius(configFile.retrieveValue<double>("./motionRadius",6.0)),
+	 motionFrequency(configFile.retrieveValue<double>("./motionFrequency",0.5)),
+	 buttonPeriod(configFile.retrieveValue<double>("./buttonPeriod",1.0)),
+	 replayFileName(configFile.retrieveString("./replayFileName","")),
+	 replayLoop(configFile.retrieveValue<bool>("./replayLoop",true))
+	{
+	/* Read the motion pattern: */
+	std::string motionPatternName=configFile.retrieveString("./motionPattern","Circle");
+	if(strcasecmp(motionPatternName.c_str(),"Static")==0)
+		motionPattern=STATIC;
+	else if(strcasecmp(motionPatternName.c_str(),"Circle")==0)
+		motionPattern=CIRCLE;
+	else if(strcasecmp(motionPatternName.c_str(),"Lissajous")==0)
+		motionPattern=LISSAJOUS;
+	else
+		Misc::throwStdErr("LoadGenerator: Unknown motion pattern %s",motionPatternName.c_str());
+	if(updateRate<=0.0)
+		Misc::throwStdErr("LoadGenerator: Invalid update rate %f",updateRate);
+	
+	/* Read the device layout: */
+	int numTrackers=configFile.retrieveValue<int>("./numTrackers",1);
+	int numButtons=configFile.retrieveValue<int>("./numButtons",0);
+	int numValuators=configFile.retrieveValue<int>("./numValuators",0);
+	if(!replayFileName.empty())
+		{
+		/* Take the device layout from the recorded stream: */
+		IO::FilePtr streamFile=IO::openFile(replayFileName.c_str());
+		streamFile->setEndianness(Misc::LittleEndian);
+		if(!Vrui::VRDeviceState::readStreamHeader(*streamFile))
+			Misc::throwStdErr("LoadGenerator: %s is not a device state stream file",replayFileName.c_str());
+		Vrui::VRDeviceState streamState;
+		streamState.readLayout(*streamFile);
+		numTrackers=streamState.getNumTrackers();
+		numButtons=streamState.getNumButtons();
+		numValuators=streamState.getNumValuators();
+		}
+	#ifdef VERBOSE
+	printf("LoadGenerator: Generating %d trackers, %d buttons, %d valuators",numTrackers,numButtons,numValuators);
+	if(replayFileName.empty())
+		printf(" at %f Hz\n",updateRate);
+	else
+		printf(" from %s\n",replayFileName.c_str());
+	fflush(stdout);
+	#endif
+	setNumTrackers(numTrackers,configFile);
+	setNumButtons(numButtons,configFile);
+	setNumValuators(numValuators,configFile);
+	state.setLayout(numTrackers,numButtons,numValuators);
+	}
+
+LoadGenerator::~LoadGenerator(void)
+	{
+	if(isActive())
+		stop();
+	}
+
+void LoadGenerator::start(void)
+	{
+	/* Start device update thread: */
+	startDeviceThread();
+	}
+
+void LoadGenerator::stop(void)
+	{
+	/* Stop device update thread: */
+	stopDeviceThread();
+	}
+
+/*************************************
+Object creation/destruction functions:
+*************************************/
+
+extern "C" VRDevice* createObjectLoadGenerator(VRFactory<VRDevice>* factory,VRFactoryManager<VRDevice>* factoryManager,Misc::ConfigurationFile& configFile)
+	{
+	VRDeviceManager* deviceManager=static_cast<VRDeviceManager::DeviceFactoryManager*>(factoryManager)->getDeviceManager();
+	return new LoadGenerator(factory,deviceManager,configFile);
+	}
+
+extern "C" void destroyObjectLoadGenerator(VRDevice* device,VRFactory<VRDevice>* factory,VRFactoryManager<VRDevice>* factoryManager)
+	{
+	delete device;
+	}
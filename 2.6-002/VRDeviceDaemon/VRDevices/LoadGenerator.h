@@ -0,0 +1,71 @@
+/***********************************************************************
+LoadGenerator - Class for synthetic devices reporting deterministic
+tracker, button, and valuator states at configurable high rates, or
+replaying recorded device state streams, to benchmark the VR device
+daemon without tracking hardware.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef LOADGENERATOR_INCLUDED
+#define LOADGENERATOR_INCLUDED
+
+#include <string>
+#include <Vrui/Internal/VRDeviceState.h>
+
+#include <VRDeviceDaemon/VRDevice.h>
+
+class LoadGenerator:public VRDevice
+	{
+	/* Embedded classes: */
+	private:
+	enum MotionPattern // Enumerated type for synthetic tracker motion patterns
+		{
+		STATIC,CIRCLE,LISSAJOUS
+		};
+	
+	/* Elements: */
+	MotionPattern motionPattern; // Motion pattern for synthetic trackers
+	double updateRate; // Number of state updates per second
+	double motionRadius; // Radius of synthetic tracker motion in physical units
+	double motionFrequency; // Frequency of synthetic tracker motion in Hz
+	double buttonPeriod; // Toggle period of the first synthetic button in seconds; button i toggles with period (i+1)*buttonPeriod
+	std::string replayFileName; // Name of a recorded device state stream to replay instead of synthetic data, or empty
+	bool replayLoop; // Flag whether to restart the replay at the end of the recorded stream
+	Vrui::VRDeviceState state; // State of all simulated devices
+	
+	/* Private methods: */
+	void generateState(double time); // Calculates the synthetic device state at the given time since start
+	void runSynthetic(void); // Emits synthetic states at the configured update rate
+	void runReplay(void); // Replays the recorded device state stream
+	
+	/* Protected methods: */
+	virtual void deviceThreadMethod(void);
+	
+	/* Constructors and destructors: */
+	public:
+	LoadGenerator(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,Misc::ConfigurationFile& configFile);
+	virtual ~LoadGenerator(void);
+	
+	/* Methods: */
+	virtual void start(void);
+	virtual void stop(void);
+	};
+
+#endif
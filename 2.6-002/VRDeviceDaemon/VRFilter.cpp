@@ -0,0 +1,51 @@
+/***********************************************************************
+VRFilter - Abstract base class for classes smoothing tracker positions
+and orientations and estimating tracker velocities.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRFilter.h>
+
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+
+#include <VRDeviceDaemon/VRFactory.h>
+
+/*************************
+Methods of class VRFilter:
+*************************/
+
+VRFilter::VRFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile)
+	:factory(sFactory),
+	 filterPositions(configFile.retrieveValue<bool>("./filterPositions",true)),
+	 filterOrientations(configFile.retrieveValue<bool>("./filterOrientations",true)),
+	 estimateVelocities(configFile.retrieveValue<bool>("./estimateVelocities",true)),
+	 maxInterval(configFile.retrieveValue<Scalar>("./maxInterval",Scalar(0.5)))
+	{
+	}
+
+VRFilter::~VRFilter(void)
+	{
+	}
+
+void VRFilter::destroy(VRFilter* object)
+	{
+	object->factory->destroyObject(object);
+	}
@@ -0,0 +1,88 @@
+/***********************************************************************
+VRFilter - Abstract base class for classes smoothing tracker positions
+and orientations and estimating tracker velocities.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRFILTER_INCLUDED
+#define VRFILTER_INCLUDED
+
+#include <Math/Math.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFile;
+}
+template <class BaseClassParam>
+class VRFactory;
+
+class VRFilter
+	{
+	/* Embedded classes: */
+	public:
+	typedef VRFactory<VRFilter> Factory;
+	typedef Vrui::VRDeviceState::TrackerState TrackerState;
+	typedef TrackerState::PositionOrientation PositionOrientation;
+	typedef PositionOrientation::Scalar Scalar;
+	typedef PositionOrientation::Point Point;
+	typedef PositionOrientation::Vector Vector;
+	typedef PositionOrientation::Rotation Rotation;
+	typedef Vrui::VRDeviceState::TimeStamp TimeStamp;
+	
+	/* Elements: */
+	private:
+	Factory* factory; // Pointer to factory that created this object
+	protected:
+	bool filterPositions; // Enable flag for position smoothing
+	bool filterOrientations; // Enable flag for orientation smoothing
+	bool estimateVelocities; // Flag whether to replace reported velocities with the filter's estimates
+	Scalar maxInterval; // Maximum time between samples in seconds; filters reset if a tracker was lost for longer
+	
+	/* Protected methods: */
+	static Vector rotationVector(const Rotation& from,const Rotation& to) // Returns the scaled axis of the rotation from one rotation to another along the shortest arc, in world space
+		{
+		/* Calculate the rotation angle from the quaternion's vector part, which unlike its scalar part keeps full precision for small angles: */
+		Rotation delta=to*Geometry::invert(from);
+		const Scalar* q=delta.getQuaternion();
+		Vector axis(q[0],q[1],q[2]);
+		Scalar axisLength=Geometry::mag(axis);
+		if(axisLength==Scalar(0))
+			return Vector::zero;
+		Scalar angle=Scalar(2)*Math::atan2(axisLength,Math::abs(q[3]));
+		return q[3]>=Scalar(0)?axis*(angle/axisLength):axis*(-angle/axisLength);
+		}
+	static Rotation interpolate(const Rotation& from,const Rotation& to,Scalar weight) // Interpolates between two rotations along the shortest arc
+		{
+		return Rotation(rotationVector(from,to)*weight)*from;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	VRFilter(Factory* sFactory,Misc::ConfigurationFile& configFile);
+	virtual ~VRFilter(void);
+	static void destroy(VRFilter* object); // Destroys an object
+	
+	/* Methods: */
+	virtual void setNumTrackers(int newNumTrackers) =0; // Sets the number of trackers on the associated device; allocates all per-tracker filter state
+	virtual TrackerState& filter(int deviceTrackerIndex,TrackerState& state,TimeStamp sampleTimeStamp) =0; // Filters a calibrated tracker measurement sampled at the given time; must not allocate memory
+	};
+
+#endif
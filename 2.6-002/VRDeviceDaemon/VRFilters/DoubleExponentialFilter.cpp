@@ -0,0 +1,145 @@
+/***********************************************************************
+DoubleExponentialFilter - Class to smooth tracker measurements with
+double exponential smoothing, which tracks trends to reduce lag, and
+optionally to predict tracker states ahead of time to hide latency.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+
+#include <VRDeviceDaemon/VRFilters/DoubleExponentialFilter.h>
+
+#include <Misc/ThrowStdErr.h>
+#include <Misc/ConfigurationFile.h>
+#include <Misc/StandardValueCoders.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+/* Forward declarations: */
+template <class BaseClassParam>
+class VRFactoryManager;
+
+/****************************************
+Methods of class DoubleExponentialFilter:
+****************************************/
+
+DoubleExponentialFilter::DoubleExponentialFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile)
+	:VRFilter(sFactory,configFile),
+	 positionSmoothing(configFile.retrieveValue<Scalar>("./positionSmoothing",Scalar(0.5))),
+	 orientationSmoothing(configFile.retrieveValue<Scalar>("./orientationSmoothing",Scalar(0.5))),
+	 predictionTime(configFile.retrieveValue<Scalar>("./predictionTime",Scalar(0))),
+	 numTrackers(0),states(0)
+	{
+	/* Check the smoothing factors: */
+	if(positionSmoothing<=Scalar(0)||positionSmoothing>=Scalar(1))
+		Misc::throwStdErr("DoubleExponentialFilter: Position smoothing factor %f not in (0, 1)",double(positionSmoothing));
+	if(orientationSmoothing<=Scalar(0)||orientationSmoothing>=Scalar(1))
+		Misc::throwStdErr("DoubleExponentialFilter: Orientation smoothing factor %f not in (0, 1)",double(orientationSmoothing));
+	}
+
+DoubleExponentialFilter::~DoubleExponentialFilter(void)
+	{
+	delete[] states;
+	}
+
+void DoubleExponentialFilter::setNumTrackers(int newNumTrackers)
+	{
+	/* Reallocate and reset the per-tracker filter states: */
+	if(numTrackers!=newNumTrackers)
+		{
+		delete[] states;
+		numTrackers=newNumTrackers;
+		states=new TrackerFilterState[numTrackers];
+		}
+	for(int i=0;i<numTrackers;++i)
+		states[i].valid=false;
+	}
+
+VRFilter::TrackerState& DoubleExponentialFilter::filter(int deviceTrackerIndex,VRFilter::TrackerState& state,VRFilter::TimeStamp sampleTimeStamp)
+	{
+	TrackerFilterState& tfs=states[deviceTrackerIndex];
+	Point rawPosition=state.positionOrientation.getOrigin();
+	const Rotation& rawOrientation=state.positionOrientation.getRotation();
+	
+	/* Calculate the sampling interval: */
+	Scalar dt=Scalar(sampleTimeStamp-tfs.lastTimeStamp)*Scalar(1.0e-6);
+	if(!tfs.valid||dt>maxInterval)
+		{
+		/* Restart the filter with the raw measurement: */
+		tfs.valid=true;
+		tfs.lastTimeStamp=sampleTimeStamp;
+		tfs.meanInterval=Scalar(0);
+		tfs.position1=tfs.position2=rawPosition;
+		tfs.orientation1=tfs.orientation2=rawOrientation;
+		}
+	else if(dt>Scalar(0))
+		{
+		tfs.lastTimeStamp=sampleTimeStamp;
+		
+		/* Update the average sampling interval, which converts per-sample trends to velocities: */
+		if(tfs.meanInterval==Scalar(0))
+			tfs.meanInterval=dt;
+		else
+			tfs.meanInterval+=(dt-tfs.meanInterval)*Scalar(0.1);
+		
+		/* Update the smoothed positions and orientations: */
+		tfs.position1+=(rawPosition-tfs.position1)*positionSmoothing;
+		tfs.position2+=(tfs.position1-tfs.position2)*positionSmoothing;
+		tfs.orientation1=interpolate(tfs.orientation1,rawOrientation,orientationSmoothing);
+		tfs.orientation2=interpolate(tfs.orientation2,tfs.orientation1,orientationSmoothing);
+		}
+	
+	/* Calculate the current trends: */
+	Vector positionTrend=tfs.position1-tfs.position2;
+	Vector orientationTrend=rotationVector(tfs.orientation2,tfs.orientation1);
+	Vector linearVelocity=Vector::zero;
+	Vector angularVelocity=Vector::zero;
+	if(tfs.meanInterval>Scalar(0))
+		{
+		linearVelocity=positionTrend*(positionSmoothing/((Scalar(1)-positionSmoothing)*tfs.meanInterval));
+		angularVelocity=orientationTrend*(orientationSmoothing/((Scalar(1)-orientationSmoothing)*tfs.meanInterval));
+		}
+	
+	/* Report the trend-corrected and extrapolated state: */
+	Point position=filterPositions?tfs.position1+positionTrend+linearVelocity*predictionTime:rawPosition;
+	Rotation orientation=filterOrientations?Rotation(angularVelocity*predictionTime)*Rotation(orientationTrend)*tfs.orientation1:rawOrientation;
+	orientation.renormalize();
+	state.positionOrientation=PositionOrientation(position-Point::origin,orientation);
+	if(estimateVelocities)
+		{
+		state.linearVelocity=linearVelocity;
+		state.angularVelocity=angularVelocity;
+		}
+	
+	return state;
+	}
+
+/*************************************
+Object creation/destruction functions:
+*************************************/
+
+extern "C" VRFilter* createObjectDoubleExponentialFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>*,Misc::ConfigurationFile& configFile)
+	{
+	return new DoubleExponentialFilter(factory,configFile);
+	}
+
+extern "C" void destroyObjectDoubleExponentialFilter(VRFilter* filter,VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*)
+	{
+	delete filter;
+	}
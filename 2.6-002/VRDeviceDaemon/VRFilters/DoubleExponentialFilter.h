@@ -0,0 +1,68 @@
+/***********************************************************************
+DoubleExponentialFilter - Class to smooth tracker measurements with
+double exponential smoothing, which tracks trends to reduce lag, and
+optionally to predict tracker states ahead of time to hide latency.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+
+#ifndef DOUBLEEXPONENTIALFILTER_INCLUDED
+#define DOUBLEEXPONENTIALFILTER_INCLUDED
+
+#include <VRDeviceDaemon/VRFilter.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFile;
+}
+
+class DoubleExponentialFilter:public VRFilter
+	{
+	/* Embedded classes: */
+	private:
+	struct TrackerFilterState // Structure holding the filter state of a single tracker
+		{
+		/* Elements: */
+		public:
+		bool valid; // Flag if the tracker has reported a measurement recently
+		TimeStamp lastTimeStamp; // Sampling time of the most recent measurement
+		Scalar meanInterval; // Running average of the tracker's sampling interval in seconds
+		Point position1,position2; // Singly- and doubly-smoothed positions
+		Rotation orientation1,orientation2; // Singly- and doubly-smoothed orientations
+		};
+	
+	/* Elements: */
+	Scalar positionSmoothing; // Weight of new position measurements in (0, 1); smaller values smooth more
+	Scalar orientationSmoothing; // Weight of new orientation measurements in (0, 1); smaller values smooth more
+	Scalar predictionTime; // Time in seconds by which to extrapolate reported states to compensate for latency
+	int numTrackers; // Number of trackers on the associated device
+	TrackerFilterState* states; // Array of per-tracker filter states
+	
+	/* Constructors and destructors: */
+	public:
+	DoubleExponentialFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile);
+	virtual ~DoubleExponentialFilter(void);
+	
+	/* Methods: */
+	virtual void setNumTrackers(int newNumTrackers);
+	virtual TrackerState& filter(int deviceTrackerIndex,TrackerState& state,TimeStamp sampleTimeStamp);
+	};
+
+#endif
@@ -0,0 +1,133 @@
+/***********************************************************************
+KalmanFilter - Class to smooth tracker measurements and estimate
+velocities with constant-velocity Kalman filters on positions and
+orientations.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+
+#include <VRDeviceDaemon/VRFilters/KalmanFilter.h>
+
+#include <Misc/ConfigurationFile.h>
+#include <Misc/StandardValueCoders.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+/* Forward declarations: */
+template <class BaseClassParam>
+class VRFactoryManager;
+
+/*****************************
+Methods of class KalmanFilter:
+*****************************/
+
+KalmanFilter::KalmanFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile)
+	:VRFilter(sFactory,configFile),
+	 positionProcessNoise(configFile.retrieveValue<double>("./positionProcessNoise",1000.0)),
+	 positionMeasurementNoise(configFile.retrieveValue<double>("./positionMeasurementNoise",1.0e-4)),
+	 orientationProcessNoise(configFile.retrieveValue<double>("./orientationProcessNoise",100.0)),
+	 orientationMeasurementNoise(configFile.retrieveValue<double>("./orientationMeasurementNoise",1.0e-5)),
+	 numTrackers(0),states(0)
+	{
+	}
+
+KalmanFilter::~KalmanFilter(void)
+	{
+	delete[] states;
+	}
+
+void KalmanFilter::setNumTrackers(int newNumTrackers)
+	{
+	/* Reallocate and reset the per-tracker filter states: */
+	if(numTrackers!=newNumTrackers)
+		{
+		delete[] states;
+		numTrackers=newNumTrackers;
+		states=new TrackerFilterState[numTrackers];
+		}
+	for(int i=0;i<numTrackers;++i)
+		states[i].valid=false;
+	}
+
+VRFilter::TrackerState& KalmanFilter::filter(int deviceTrackerIndex,VRFilter::TrackerState& state,VRFilter::TimeStamp sampleTimeStamp)
+	{
+	TrackerFilterState& tfs=states[deviceTrackerIndex];
+	Point rawPosition=state.positionOrientation.getOrigin();
+	const Rotation& rawOrientation=state.positionOrientation.getRotation();
+	
+	/* Calculate the sampling interval: */
+	Scalar dt=Scalar(sampleTimeStamp-tfs.lastTimeStamp)*Scalar(1.0e-6);
+	if(!tfs.valid||dt>maxInterval)
+		{
+		/* Restart the filter with the raw measurement: */
+		tfs.valid=true;
+		tfs.lastTimeStamp=sampleTimeStamp;
+		tfs.position=rawPosition;
+		tfs.linearVelocity=Vector::zero;
+		tfs.positionCovariance.reset(positionMeasurementNoise,positionProcessNoise);
+		tfs.orientation=rawOrientation;
+		tfs.angularVelocity=Vector::zero;
+		tfs.orientationCovariance.reset(orientationMeasurementNoise,orientationProcessNoise);
+		}
+	else if(dt>Scalar(0))
+		{
+		tfs.lastTimeStamp=sampleTimeStamp;
+		Scalar valueGain,rateGain;
+		
+		/* Predict the position and correct it with the measurement residual: */
+		tfs.positionCovariance.update(positionProcessNoise,positionMeasurementNoise,dt,valueGain,rateGain);
+		Point predictedPosition=tfs.position+tfs.linearVelocity*dt;
+		Vector positionResidual=rawPosition-predictedPosition;
+		tfs.position=filterPositions?predictedPosition+positionResidual*valueGain:rawPosition;
+		tfs.linearVelocity+=positionResidual*rateGain;
+		
+		/* Predict the orientation and correct it with the measurement residual: */
+		tfs.orientationCovariance.update(orientationProcessNoise,orientationMeasurementNoise,dt,valueGain,rateGain);
+		Rotation predictedOrientation=Rotation(tfs.angularVelocity*dt)*tfs.orientation;
+		Vector orientationResidual=rotationVector(predictedOrientation,rawOrientation);
+		tfs.orientation=filterOrientations?Rotation(orientationResidual*valueGain)*predictedOrientation:rawOrientation;
+		tfs.orientation.renormalize();
+		tfs.angularVelocity+=orientationResidual*rateGain;
+		}
+	
+	/* Report the filtered state: */
+	state.positionOrientation=PositionOrientation(tfs.position-Point::origin,tfs.orientation);
+	if(estimateVelocities)
+		{
+		state.linearVelocity=tfs.linearVelocity;
+		state.angularVelocity=tfs.angularVelocity;
+		}
+	
+	return state;
+	}
+
+/*************************************
+Object creation/destruction functions:
+*************************************/
+
+extern "C" VRFilter* createObjectKalmanFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>*,Misc::ConfigurationFile& configFile)
+	{
+	return new KalmanFilter(factory,configFile);
+	}
+
+extern "C" void destroyObjectKalmanFilter(VRFilter* filter,VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*)
+	{
+	delete filter;
+	}
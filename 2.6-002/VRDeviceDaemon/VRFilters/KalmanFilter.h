@@ -0,0 +1,105 @@
+/***********************************************************************
+KalmanFilter - Class to smooth tracker measurements and estimate
+velocities with constant-velocity Kalman filters on positions and
+orientations.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+
+#ifndef KALMANFILTER_INCLUDED
+#define KALMANFILTER_INCLUDED
+
+#include <VRDeviceDaemon/VRFilter.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFile;
+}
+
+class KalmanFilter:public VRFilter
+	{
+	/* Embedded classes: */
+	private:
+	struct Covariance // Structure for the symmetric 2x2 covariance of a (value, rate) state; shared by all three axes of a vector
+		{
+		/* Elements: */
+		public:
+		double pp,pv,vv; // Variance of value, covariance of value and rate, variance of rate
+		
+		/* Methods: */
+		void reset(double measurementNoise,double processNoise) // Resets the covariance after the first measurement
+			{
+			pp=measurementNoise;
+			pv=0.0;
+			vv=processNoise; // Velocity uncertainty after one second of unmodeled acceleration
+			}
+		void update(double processNoise,double measurementNoise,double dt,Scalar& valueGain,Scalar& rateGain) // Runs the prediction and correction steps and returns the Kalman gains
+			{
+			/* Predict the covariance under a white-noise acceleration model: */
+			double dt2=dt*dt;
+			pp+=2.0*dt*pv+dt2*vv+processNoise*dt2*dt/3.0;
+			pv+=dt*vv+processNoise*dt2*0.5;
+			vv+=processNoise*dt;
+			
+			/* Calculate the Kalman gains and correct the covariance: */
+			double s=pp+measurementNoise;
+			double kp=pp/s;
+			double kv=pv/s;
+			vv-=kv*pv;
+			pv*=1.0-kp;
+			pp*=1.0-kp;
+			valueGain=Scalar(kp);
+			rateGain=Scalar(kv);
+			}
+		};
+	
+	struct TrackerFilterState // Structure holding the filter state of a single tracker
+		{
+		/* Elements: */
+		public:
+		bool valid; // Flag if the tracker has reported a measurement recently
+		TimeStamp lastTimeStamp; // Sampling time of the most recent measurement
+		Point position; // Estimated position
+		Vector linearVelocity; // Estimated linear velocity
+		Covariance positionCovariance; // Covariance of position estimates
+		Rotation orientation; // Estimated orientation
+		Vector angularVelocity; // Estimated angular velocity
+		Covariance orientationCovariance; // Covariance of orientation estimates
+		};
+	
+	/* Elements: */
+	double positionProcessNoise; // Spectral density of unmodeled linear acceleration in unit^2/s^3
+	double positionMeasurementNoise; // Variance of position measurements in unit^2
+	double orientationProcessNoise; // Spectral density of unmodeled angular acceleration in rad^2/s^3
+	double orientationMeasurementNoise; // Variance of orientation measurements in rad^2
+	int numTrackers; // Number of trackers on the associated device
+	TrackerFilterState* states; // Array of per-tracker filter states
+	
+	/* Constructors and destructors: */
+	public:
+	KalmanFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile);
+	virtual ~KalmanFilter(void);
+	
+	/* Methods: */
+	virtual void setNumTrackers(int newNumTrackers);
+	virtual TrackerState& filter(int deviceTrackerIndex,TrackerState& state,TimeStamp sampleTimeStamp);
+	};
+
+#endif
@@ -0,0 +1,139 @@
+/***********************************************************************
+OneEuroFilter - Class to smooth tracker measurements with speed-adaptive
+low-pass filters ("1 Euro filter"), which suppress jitter at low speeds
+and reduce lag at high speeds.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRFilters/OneEuroFilter.h>
+
+#include <Misc/ConfigurationFile.h>
+#include <Misc/StandardValueCoders.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+/* Forward declarations: */
+template <class BaseClassParam>
+class VRFactoryManager;
+
+/******************************
+Methods of class OneEuroFilter:
+******************************/
+
+OneEuroFilter::OneEuroFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile)
+	:VRFilter(sFactory,configFile),
+	 positionMinCutoff(configFile.retrieveValue<Scalar>("./positionMinCutoff",Scalar(1))),
+	 positionBeta(configFile.retrieveValue<Scalar>("./positionBeta",Scalar(0.05))),
+	 orientationMinCutoff(configFile.retrieveValue<Scalar>("./orientationMinCutoff",Scalar(1))),
+	 orientationBeta(configFile.retrieveValue<Scalar>("./orientationBeta",Scalar(0.3))),
+	 derivativeCutoff(configFile.retrieveValue<Scalar>("./derivativeCutoff",Scalar(1))),
+	 numTrackers(0),states(0)
+	{
+	}
+
+OneEuroFilter::~OneEuroFilter(void)
+	{
+	delete[] states;
+	}
+
+void OneEuroFilter::setNumTrackers(int newNumTrackers)
+	{
+	/* Reallocate and reset the per-tracker filter states: */
+	if(numTrackers!=newNumTrackers)
+		{
+		delete[] states;
+		numTrackers=newNumTrackers;
+		states=new TrackerFilterState[numTrackers];
+		}
+	for(int i=0;i<numTrackers;++i)
+		states[i].valid=false;
+	}
+
+VRFilter::TrackerState& OneEuroFilter::filter(int deviceTrackerIndex,VRFilter::TrackerState& state,VRFilter::TimeStamp sampleTimeStamp)
+	{
+	TrackerFilterState& tfs=states[deviceTrackerIndex];
+	Point rawPosition=state.positionOrientation.getOrigin();
+	const Rotation& rawOrientation=state.positionOrientation.getRotation();
+	
+	/* Calculate the sampling interval: */
+	Scalar dt=Scalar(sampleTimeStamp-tfs.lastTimeStamp)*Scalar(1.0e-6);
+	if(!tfs.valid||dt>maxInterval)
+		{
+		/* Restart the filter with the raw measurement: */
+		tfs.valid=true;
+		tfs.lastTimeStamp=sampleTimeStamp;
+		tfs.rawPosition=rawPosition;
+		tfs.rawOrientation=rawOrientation;
+		tfs.position=rawPosition;
+		tfs.linearVelocity=Vector::zero;
+		tfs.orientation=rawOrientation;
+		tfs.angularVelocity=Vector::zero;
+		}
+	else if(dt>Scalar(0))
+		{
+		tfs.lastTimeStamp=sampleTimeStamp;
+		
+		/* Filter the linear velocity between successive raw measurements and adapt the position cutoff frequency to linear speed: */
+		tfs.linearVelocity+=((rawPosition-tfs.rawPosition)/dt-tfs.linearVelocity)*alpha(derivativeCutoff,dt);
+		tfs.rawPosition=rawPosition;
+		if(filterPositions)
+			{
+			Scalar cutoff=positionMinCutoff+positionBeta*Geometry::mag(tfs.linearVelocity);
+			tfs.position+=(rawPosition-tfs.position)*alpha(cutoff,dt);
+			}
+		else
+			tfs.position=rawPosition;
+		
+		/* Filter the angular velocity between successive raw measurements and adapt the orientation cutoff frequency to angular speed: */
+		tfs.angularVelocity+=(rotationVector(tfs.rawOrientation,rawOrientation)/dt-tfs.angularVelocity)*alpha(derivativeCutoff,dt);
+		tfs.rawOrientation=rawOrientation;
+		if(filterOrientations)
+			{
+			Scalar cutoff=orientationMinCutoff+orientationBeta*Geometry::mag(tfs.angularVelocity);
+			tfs.orientation=interpolate(tfs.orientation,rawOrientation,alpha(cutoff,dt));
+			}
+		else
+			tfs.orientation=rawOrientation;
+		}
+	
+	/* Report the filtered state: */
+	state.positionOrientation=PositionOrientation(tfs.position-Point::origin,tfs.orientation);
+	if(estimateVelocities)
+		{
+		state.linearVelocity=tfs.linearVelocity;
+		state.angularVelocity=tfs.angularVelocity;
+		}
+	
+	return state;
+	}
+
+/*************************************
+Object creation/destruction functions:
+*************************************/
+
+extern "C" VRFilter* createObjectOneEuroFilter(VRFactory<VRFilter>* factory,VRFactoryManager<VRFilter>*,Misc::ConfigurationFile& configFile)
+	{
+	return new OneEuroFilter(factory,configFile);
+	}
+
+extern "C" void destroyObjectOneEuroFilter(VRFilter* filter,VRFactory<VRFilter>*,VRFactoryManager<VRFilter>*)
+	{
+	delete filter;
+	}
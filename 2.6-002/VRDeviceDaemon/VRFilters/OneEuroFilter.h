@@ -0,0 +1,81 @@
+/***********************************************************************
+OneEuroFilter - Class to smooth tracker measurements with speed-adaptive
+low-pass filters ("1 Euro filter"), which suppress jitter at low speeds
+and reduce lag at high speeds.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef ONEEUROFILTER_INCLUDED
+#define ONEEUROFILTER_INCLUDED
+
+#include <Math/Constants.h>
+
+#include <VRDeviceDaemon/VRFilter.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFile;
+}
+
+class OneEuroFilter:public VRFilter
+	{
+	/* Embedded classes: */
+	private:
+	struct TrackerFilterState // Structure holding the filter state of a single tracker
+		{
+		/* Elements: */
+		public:
+		bool valid; // Flag if the tracker has reported a measurement recently
+		TimeStamp lastTimeStamp; // Sampling time of the most recent measurement
+		Point rawPosition; // Most recent unfiltered position, to estimate linear velocity
+		Rotation rawOrientation; // Most recent unfiltered orientation, to estimate angular velocity
+		Point position; // Filtered position
+		Vector linearVelocity; // Filtered linear velocity
+		Rotation orientation; // Filtered orientation
+		Vector angularVelocity; // Filtered angular velocity
+		};
+	
+	/* Elements: */
+	Scalar positionMinCutoff; // Cutoff frequency for positions at zero speed in Hz
+	Scalar positionBeta; // Increase of position cutoff frequency per unit of linear speed
+	Scalar orientationMinCutoff; // Cutoff frequency for orientations at zero speed in Hz
+	Scalar orientationBeta; // Increase of orientation cutoff frequency per radian/s of angular speed
+	Scalar derivativeCutoff; // Cutoff frequency for velocity estimates in Hz
+	int numTrackers; // Number of trackers on the associated device
+	TrackerFilterState* states; // Array of per-tracker filter states
+	
+	/* Private methods: */
+	static Scalar alpha(Scalar cutoff,Scalar dt) // Returns the smoothing factor of a first-order low-pass filter with the given cutoff frequency and sampling interval
+		{
+		Scalar tau=Scalar(1)/(Scalar(2)*Math::Constants<Scalar>::pi*cutoff);
+		return Scalar(1)/(Scalar(1)+tau/dt);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	OneEuroFilter(VRFilter::Factory* sFactory,Misc::ConfigurationFile& configFile);
+	virtual ~OneEuroFilter(void);
+	
+	/* Methods: */
+	virtual void setNumTrackers(int newNumTrackers);
+	virtual TrackerState& filter(int deviceTrackerIndex,TrackerState& state,TimeStamp sampleTimeStamp);
+	};
+
+#endif
@@ -36,7 +36,7 @@ InputDevice::InputDevice(void)
 	:deviceName(new char[1]),trackType(TRACK_NONE),deviceRayDirection(0,1,0),
 	 numButtons(0),numValuators(0),
 	 buttonCallbacks(0),valuatorCallbacks(0),
-	 transformation(TrackerState::identity),linearVelocity(Vector::zero),angularVelocity(Vector::zero),
+	 transformation(TrackerState::identity),linearVelocity(Vector::zero),angularVelocity(Vector::zero),timeStamp(0),
 	 buttonStates(0),valuatorValues(0),
 	 callbacksEnabled(true),
 	 savedButtonStates(0),savedValuatorValues(0)
@@ -49,7 +49,7 @@ InputDevice::InputDevice(const char* sDeviceName,int sTrackType,int sNumButtons,
 	 numButtons(sNumButtons),numValuators(sNumValuators),
 	 buttonCallbacks(numButtons>0?new Misc::CallbackList[numButtons]:0),
 	 valuatorCallbacks(numValuators>0?new Misc::CallbackList[numValuators]:0),
-	 transformation(TrackerState::identity),linearVelocity(Vector::zero),angularVelocity(Vector::zero),
+	 transformation(TrackerState::identity),linearVelocity(Vector::zero),angularVelocity(Vector::zero),timeStamp(0),
 	 buttonStates(numButtons>0?new bool[numButtons]:0),
 	 valuatorValues(numValuators>0?new double[numValuators]:0),
 	 callbacksEnabled(true),
@@ -76,7 +76,7 @@ InputDevice::InputDevice(const InputDevice& source)
 	:deviceName(new char[1]),trackType(TRACK_NONE),deviceRayDirection(0,1,0),
 	 numButtons(0),numValuators(0),
 	 buttonCallbacks(0),valuatorCallbacks(0),
-	 transformation(TrackerState::identity),linearVelocity(Vector::zero),angularVelocity(Vector::zero),
+	 transformation(TrackerState::identity),linearVelocity(Vector::zero),angularVelocity(Vector::zero),timeStamp(0),
 	 buttonStates(0),valuatorValues(0),
 	 callbacksEnabled(true),
 	 savedButtonStates(0),savedValuatorValues(0)
@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INPUTDEVICE_INCLUDED
 #define VRUI_INPUTDEVICE_INCLUDED
 
+#include <Misc/SizedTypes.h>
 #include <Misc/CallbackList.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -108,6 +109,7 @@ class InputDevice // Class for input devices
 	/* Current device state: */
 	TrackerState transformation; // Full (orthonormal) transformation of locator device
 	Vector linearVelocity,angularVelocity; // Velocities of locator device in units/second
+	Misc::SInt64 timeStamp; // Time at which the current tracking state was sampled, in microseconds on the local monotonic clock; 0 if unknown
 	bool* buttonStates; // Array of button press state(s)
 	double* valuatorValues; // Array of valuator values, normalized from -1 to 1
 	
@@ -248,6 +250,10 @@ class InputDevice // Class for input devices
 		{
 		angularVelocity=newAngularVelocity;
 		}
+	void setTimeStamp(Misc::SInt64 newTimeStamp)
+		{
+		timeStamp=newTimeStamp;
+		}
 	void clearButtonStates(void);
 	void setButtonState(int index,bool newButtonState);
 	void setSingleButtonPressed(int index);
@@ -278,6 +284,10 @@ class InputDevice // Class for input devices
 		{
 		return angularVelocity;
 		}
+	Misc::SInt64 getTimeStamp(void) const
+		{
+		return timeStamp;
+		}
 	bool getButtonState(int index) const
 		{
 		return buttonStates[index];
@@ -2,7 +2,7 @@
 InputGraphManager - Class to maintain the bipartite input device / tool
 graph formed by tools being assigned to input devices, and input devices
 in turn being grabbed by tools.
-Copyright (c) 2004-2012 Oliver Kreylos
+Copyright (c) 2004-2013 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -29,6 +29,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/PrintInteger.h>
 #include <Misc/FileTests.h>
 #include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/CompoundValueCoders.h>
 #include <Misc/ConfigurationFile.h>
@@ -703,9 +704,9 @@ void InputGraphManager::removeInputDevice(InputDevice* device)
 	for(Misc::HashTable<Tool*,void>::Iterator dtIt=destroyTools.begin();!dtIt.isFinished();++dtIt)
 		tm->destroyTool(dtIt->getSource());
 	
-	/* Remove the graph input device from its graph level and from the graph device map: */
+	/* Remove the graph input device from its graph level and from the graph device map; destroying tools might have moved the device's entry: */
 	unlinkInputDevice(gid);
-	deviceMap.removeEntry(dIt);
+	deviceMap.removeEntry(device);
 	
 	/* Delete the graph input device: */
 	delete gid;
@@ -2,7 +2,7 @@
 InputGraphManager - Class to maintain the bipartite input device / tool
 graph formed by tools being assigned to input devices, and input devices
 in turn being grabbed by tools.
-Copyright (c) 2004-2012 Oliver Kreylos
+Copyright (c) 2004-2013 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -26,7 +26,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define VRUI_INPUTGRAPHMANAGER_INCLUDED
 
 #include <vector>
-#include <Misc/HashTable.h>
+#include <Misc/OpenHashTable.h>
 #include <Geometry/OrthogonalTransformation.h>
 #include <SceneGraph/GraphNode.h>
 #include <Vrui/Geometry.h>
@@ -103,8 +103,8 @@ class InputGraphManager
 		~GraphInputDevice(void); // Destroys the graph wrapper
 		};
 	
-	typedef Misc::HashTable<InputDevice*,GraphInputDevice*> DeviceMap; // Hash table to map from input devices to graph input devices
-	typedef Misc::HashTable<Tool*,GraphTool*> ToolMap; // Hash table to map from tools to graph tools
+	typedef Misc::OpenHashTable<InputDevice*,GraphInputDevice*> DeviceMap; // Hash table to map from input devices to graph input devices
+	typedef Misc::OpenHashTable<Tool*,GraphTool*> ToolMap; // Hash table to map from tools to graph tools
 	
 	/* Elements: */
 	GlyphRenderer* glyphRenderer; // Pointer to the glyph renderer
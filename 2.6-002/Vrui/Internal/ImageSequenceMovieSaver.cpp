@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageSequenceMovieSaver - Helper class to save movies as sequences of
 image files in formats supported by the Images library.
-Copyright (c) 2010 Oliver Kreylos
+Copyright (c) 2010-2013 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -27,10 +27,12 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <stdio.h>
 #include <unistd.h>
 #include <iostream>
+#include <vector>
 #include <Misc/ThrowStdErr.h>
-#include <Misc/File.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <IO/StandardFile.h>
+#include <Threads/PlacementPolicy.h>
 
 namespace Vrui {
 
@@ -64,6 +66,9 @@ void ImageSequenceMovieSaver::frameWritingThreadMethod(void)
 
 void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 	{
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("MovieSaver");
+	
 	unsigned int frameIndex=0;
 	while(true)
 		{
@@ -83,21 +88,29 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 		char frameName[1024];
 		snprintf(frameName,sizeof(frameName),frameNameTemplate.c_str(),frameIndex);
 		++frameIndex;
-		Misc::File frameFile(frameName,"wb");
+		IO::StandardFile frameFile(frameName,IO::File::WriteOnly);
 		
 		/* Get the image from the frame buffer: */
 		int width=frame.getFrameSize()[0];
 		int height=frame.getFrameSize()[1];
 		const unsigned char* buffer=frame.getBuffer();
 		
-		/* Write the PPM header: */
-		fprintf(frameFile.getFilePtr(),"P6\n");
-		fprintf(frameFile.getFilePtr(),"%d %d\n",width,height);
-		fprintf(frameFile.getFilePtr(),"255\n");
+		/* Create the PPM header: */
+		char header[64];
+		int headerSize=snprintf(header,sizeof(header),"P6\n%d %d\n255\n",width,height);
+		
+		/* Gather the header and the frame buffer's rows in bottom-up order: */
+		std::vector<IO::File::IOVector> vectors(height+1);
+		vectors[0].data=header;
+		vectors[0].size=headerSize;
+		for(int y=0;y<height;++y)
+			{
+			vectors[y+1].data=const_cast<unsigned char*>(buffer+(height-1-y)*width*3);
+			vectors[y+1].size=width*3;
+			}
 		
-		/* Write each row of the frame buffer: */
-		for(int y=height-1;y>=0;--y)
-			frameFile.write(buffer+y*width*3,width*3);
+		/* Write the frame directly from the frame buffer: */
+		frameFile.writeVectored(&vectors[0],height+1);
 		}
 	
 	return 0;
@@ -84,11 +84,29 @@ void InputDeviceAdapterDeviceDaemon::createInputDevice(int deviceIndex,const Mis
 
 InputDeviceAdapterDeviceDaemon::InputDeviceAdapterDeviceDaemon(InputDeviceManager* sInputDeviceManager,const Misc::ConfigurationFileSection& configFileSection)
 	:InputDeviceAdapterIndexMap(sInputDeviceManager),
-	 deviceClient(configFileSection)
+	 deviceClient(configFileSection),
+	 printLatencyHistograms(configFileSection.retrieveValue<bool>("./printLatencyHistograms",false)),
+	 latencyLogFile(0)
 	{
 	/* Initialize input device adapter: */
 	InputDeviceAdapterIndexMap::initializeAdapter(deviceClient.getState().getNumTrackers(),deviceClient.getState().getNumButtons(),deviceClient.getState().getNumValuators(),configFileSection);
 	
+	/* Open the tracking latency log file if requested: */
+	std::string latencyLogFileName=configFileSection.retrieveString("./latencyLogFileName","");
+	if(!latencyLogFileName.empty())
+		{
+		latencyLogFile=fopen(latencyLogFileName.c_str(),"wt");
+		if(latencyLogFile==0)
+			Misc::throwStdErr("InputDeviceAdapterDeviceDaemon: Unable to open latency log file %s",latencyLogFileName.c_str());
+		
+		/* Write the log file's header line: */
+		fprintf(latencyLogFile,"FrameTime,PacketAge");
+		for(int deviceIndex=0;deviceIndex<numInputDevices;++deviceIndex)
+			if(trackerIndexMapping[deviceIndex]>=0)
+				fprintf(latencyLogFile,",%s",inputDevices[deviceIndex]->getDeviceName());
+		fprintf(latencyLogFile,"\n");
+		}
+	
 	/* Start VR devices: */
 	deviceClient.enablePacketNotificationCB(packetNotificationCallback,0);
 	deviceClient.activate();
@@ -101,6 +119,21 @@ InputDeviceAdapterDeviceDaemon::~InputDeviceAdapterDeviceDaemon(void)
 	deviceClient.stopStream();
 	deviceClient.deactivate();
 	deviceClient.disablePacketNotificationCB();
+	
+	if(printLatencyHistograms)
+		{
+		/* Print the tracking latency histograms: */
+		printf("InputDeviceAdapterDeviceDaemon: Tracking latencies\n");
+		deviceClient.lockState();
+		deviceClient.getDriverServerLatency().printHistogram(stdout,"Driver to server");
+		deviceClient.getServerClientLatency().printHistogram(stdout,"Server to client");
+		deviceClient.unlockState();
+		clientFrameLatency.printHistogram(stdout,"Client to frame start");
+		fflush(stdout);
+		}
+	
+	if(latencyLogFile!=0)
+		fclose(latencyLogFile);
 	}
 
 std::string InputDeviceAdapterDeviceDaemon::getFeatureName(const InputDeviceFeature& feature) const
@@ -176,6 +209,13 @@ void InputDeviceAdapterDeviceDaemon::updateInputDevices(void)
 	{
 	deviceClient.lockState();
 	const VRDeviceState& state=deviceClient.getState();
+	
+	/* Measure the age of the current state packet at the beginning of this frame: */
+	VRDeviceState::TimeStamp frameTimeStamp=VRDeviceState::getCurrentTimeStamp();
+	clientFrameLatency.addSample(frameTimeStamp-deviceClient.getPacketTimeStamp());
+	if(latencyLogFile!=0)
+		fprintf(latencyLogFile,"%lld,%lld",(long long)frameTimeStamp,(long long)(frameTimeStamp-deviceClient.getPacketTimeStamp()));
+	
 	for(int deviceIndex=0;deviceIndex<numInputDevices;++deviceIndex)
 		{
 		/* Get pointer to the input device: */
@@ -193,6 +233,12 @@ void InputDeviceAdapterDeviceDaemon::updateInputDevices(void)
 			/* Set device's linear and angular velocities: */
 			device->setLinearVelocity(Vector(ts.linearVelocity));
 			device->setAngularVelocity(Vector(ts.angularVelocity));
+			
+			/* Set device's tracking time stamp: */
+			VRDeviceState::TimeStamp timeStamp=state.getTrackerTimeStamp(trackerIndexMapping[deviceIndex]);
+			device->setTimeStamp(timeStamp);
+			if(latencyLogFile!=0)
+				fprintf(latencyLogFile,",%lld",(long long)(frameTimeStamp-timeStamp));
 			}
 		
 		/* Update button states: */
@@ -203,6 +249,8 @@ void InputDeviceAdapterDeviceDaemon::updateInputDevices(void)
 		for(int i=0;i<device->getNumValuators();++i)
 			device->setValuator(i,state.getValuatorState(valuatorIndexMapping[deviceIndex][i]));
 		}
+	if(latencyLogFile!=0)
+		fprintf(latencyLogFile,"\n");
 	
 	deviceClient.unlockState();
 	}
@@ -25,9 +25,11 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INTERNAL_INPUTDEVICEADAPTERDEVICEDAEMON_INCLUDED
 #define VRUI_INTERNAL_INPUTDEVICEADAPTERDEVICEDAEMON_INCLUDED
 
+#include <stdio.h>
 #include <string>
 #include <vector>
 #include <Vrui/Internal/VRDeviceClient.h>
+#include <Vrui/Internal/LatencyHistogram.h>
 #include <Vrui/Internal/InputDeviceAdapterIndexMap.h>
 
 /* Forward declarations: */
@@ -44,6 +46,9 @@ class InputDeviceAdapterDeviceDaemon:public InputDeviceAdapterIndexMap
 	VRDeviceClient deviceClient; // Device client delivering "raw" device state
 	std::vector<std::string> buttonNames; // Array of button names for all defined input devices
 	std::vector<std::string> valuatorNames; // Array of valuator names for all defined input devices
+	LatencyHistogram clientFrameLatency; // Histogram of latencies between arrival of state packets and the start of the frames using them
+	bool printLatencyHistograms; // Flag whether to print tracking latency histograms on shutdown
+	FILE* latencyLogFile; // File to which to log per-frame tracking latencies, or null
 	
 	/* Private methods: */
 	static void packetNotificationCallback(VRDeviceClient* client,void* userData);
@@ -0,0 +1,105 @@
+/***********************************************************************
+LatencyHistogram - Class to accumulate histograms of latencies measured
+in microseconds, to analyze the timing behavior of the tracking
+pipeline.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/LatencyHistogram.h>
+
+namespace Vrui {
+
+/*********************************
+Methods of class LatencyHistogram:
+*********************************/
+
+LatencyHistogram::LatencyHistogram(LatencyHistogram::Latency sBinSize,int sNumBins)
+	:binSize(sBinSize),numBins(sNumBins),
+	 bins(new unsigned int[numBins])
+	{
+	reset();
+	}
+
+LatencyHistogram::~LatencyHistogram(void)
+	{
+	delete[] bins;
+	}
+
+void LatencyHistogram::reset(void)
+	{
+	for(int i=0;i<numBins;++i)
+		bins[i]=0;
+	numUnderflows=0;
+	numOverflows=0;
+	numSamples=0;
+	min=max=Latency(0);
+	sum=0.0;
+	}
+
+LatencyHistogram::Latency LatencyHistogram::getPercentile(double percentile) const
+	{
+	/* Calculate the number of samples below the requested percentile: */
+	unsigned int threshold=(unsigned int)(double(numSamples)*percentile/100.0+0.5);
+	
+	/* Find the first bin where the cumulative count crosses the threshold: */
+	unsigned int count=numUnderflows;
+	if(count>=threshold)
+		return min;
+	for(int i=0;i<numBins;++i)
+		{
+		count+=bins[i];
+		if(count>=threshold)
+			return Latency(i+1)*binSize;
+		}
+	
+	/* The percentile is among the overflow samples: */
+	return max;
+	}
+
+void LatencyHistogram::printSummary(FILE* file,const char* label) const
+	{
+	if(numSamples>0)
+		{
+		fprintf(file,"%s: %u samples, min %.3f ms, mean %.3f ms, 50%% %.3f ms, 99%% %.3f ms, max %.3f ms",
+		        label,numSamples,double(min)*1.0e-3,getMean()*1.0e-3,double(getPercentile(50.0))*1.0e-3,double(getPercentile(99.0))*1.0e-3,double(max)*1.0e-3);
+		if(numUnderflows>0)
+			fprintf(file,", %u negative",numUnderflows);
+		fprintf(file,"\n");
+		}
+	else
+		fprintf(file,"%s: no samples\n",label);
+	}
+
+void LatencyHistogram::printHistogram(FILE* file,const char* label) const
+	{
+	/* Print the summary line: */
+	printSummary(file,label);
+	
+	/* Print all non-empty bins: */
+	if(numUnderflows>0)
+		fprintf(file,"         < 0.000 ms: %u\n",numUnderflows);
+	for(int i=0;i<numBins;++i)
+		if(bins[i]>0)
+			fprintf(file,"  %7.3f - %7.3f ms: %u\n",double(Latency(i)*binSize)*1.0e-3,double(Latency(i+1)*binSize)*1.0e-3,bins[i]);
+	if(numOverflows>0)
+		fprintf(file,"       >= %7.3f ms: %u\n",double(Latency(numBins)*binSize)*1.0e-3,numOverflows);
+	}
+
+}
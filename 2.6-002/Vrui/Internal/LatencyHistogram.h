@@ -0,0 +1,115 @@
+/***********************************************************************
+LatencyHistogram - Class to accumulate histograms of latencies measured
+in microseconds, to analyze the timing behavior of the tracking
+pipeline.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_LATENCYHISTOGRAM_INCLUDED
+#define VRUI_INTERNAL_LATENCYHISTOGRAM_INCLUDED
+
+#include <stdio.h>
+#include <Misc/SizedTypes.h>
+
+namespace Vrui {
+
+class LatencyHistogram
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::SInt64 Latency; // Type for latencies in microseconds
+	
+	/* Elements: */
+	private:
+	Latency binSize; // Width of a histogram bin in microseconds
+	int numBins; // Number of histogram bins
+	unsigned int* bins; // Array of bin counters
+	unsigned int numUnderflows; // Number of negative latencies, i.e., clock synchronization errors
+	unsigned int numOverflows; // Number of latencies larger than the histogram's range
+	unsigned int numSamples; // Total number of accumulated samples
+	Latency min,max; // Range of accumulated samples
+	double sum; // Sum of accumulated samples, to calculate the average
+	
+	/* Constructors and destructors: */
+	public:
+	LatencyHistogram(Latency sBinSize =100,int sNumBins =500); // Creates empty histogram with given bin size and number of bins
+	private:
+	LatencyHistogram(const LatencyHistogram& source); // Prohibit copy constructor
+	LatencyHistogram& operator=(const LatencyHistogram& source); // Prohibit assignment operator
+	public:
+	~LatencyHistogram(void);
+	
+	/* Methods: */
+	void reset(void); // Removes all accumulated samples
+	void addSample(Latency latency) // Adds a latency sample to the histogram
+		{
+		if(latency<Latency(0))
+			++numUnderflows;
+		else
+			{
+			Latency bin=latency/binSize;
+			if(bin<Latency(numBins))
+				++bins[bin];
+			else
+				++numOverflows;
+			}
+		if(numSamples==0||min>latency)
+			min=latency;
+		if(numSamples==0||max<latency)
+			max=latency;
+		sum+=double(latency);
+		++numSamples;
+		}
+	Latency getBinSize(void) const // Returns the width of a histogram bin
+		{
+		return binSize;
+		}
+	int getNumBins(void) const // Returns the number of histogram bins
+		{
+		return numBins;
+		}
+	unsigned int getBin(int binIndex) const // Returns the number of samples in the given bin
+		{
+		return bins[binIndex];
+		}
+	unsigned int getNumSamples(void) const // Returns the total number of accumulated samples
+		{
+		return numSamples;
+		}
+	Latency getMin(void) const // Returns the smallest accumulated sample
+		{
+		return min;
+		}
+	Latency getMax(void) const // Returns the largest accumulated sample
+		{
+		return max;
+		}
+	double getMean(void) const // Returns the average of all accumulated samples
+		{
+		return numSamples>0?sum/double(numSamples):0.0;
+		}
+	Latency getPercentile(double percentile) const; // Returns the approximate latency below which the given percentage (0-100) of samples fall
+	void printSummary(FILE* file,const char* label) const; // Prints a one-line summary of the histogram to the given file
+	void printHistogram(FILE* file,const char* label) const; // Prints summary and all non-empty bins to the given file
+	};
+
+}
+
+#endif
@@ -29,6 +29,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <Misc/CreateNumberedFileName.h>
+#include <Threads/PlacementPolicy.h>
 #include <Sound/SoundDataFormat.h>
 #include <Sound/SoundRecorder.h>
 #include <Vrui/Internal/ImageSequenceMovieSaver.h>
@@ -121,6 +122,9 @@ Methods of class MovieSaver:
 
 void* MovieSaver::frameWritingThreadWrapper(void)
 	{
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("MovieSaver");
+	
 	/* Start the virtual thread method: */
 	frameWritingThreadMethod();
 	return 0;
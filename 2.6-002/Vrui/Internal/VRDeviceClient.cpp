@@ -26,6 +26,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/Time.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Threads/PlacementPolicy.h>
 
 namespace Vrui {
 
@@ -33,8 +34,73 @@ namespace Vrui {
 Methods of class VRDeviceClient:
 *******************************/
 
+void VRDeviceClient::readState(void)
+	{
+	if(serverProtocolVersion>=2U)
+		{
+		/* Read the server's state including tracker time stamps, followed by the server's sending time stamp: */
+		state.read(pipe,true);
+		VRDeviceState::TimeStamp sendTimeStamp=pipe.read<VRDeviceState::TimeStamp>();
+		packetTimeStamp=VRDeviceState::getCurrentTimeStamp();
+		
+		/* Lower the clock offset estimate if the packet appears to have arrived before it was sent: */
+		if(clockOffset>packetTimeStamp-sendTimeStamp)
+			clockOffset=packetTimeStamp-sendTimeStamp;
+		
+		/* Update latency statistics: */
+		serverClientLatency.addSample(packetTimeStamp-(sendTimeStamp+clockOffset));
+		VRDeviceState::TimeStamp* tsPtr=state.getTrackerTimeStamps();
+		for(int i=0;i<state.getNumTrackers();++i,++tsPtr)
+			{
+			/* Only sample trackers that received a new measurement since the last packet: */
+			if(*tsPtr!=0&&*tsPtr!=lastTrackerTimeStamps[i])
+				{
+				driverServerLatency.addSample(sendTimeStamp-*tsPtr);
+				lastTrackerTimeStamps[i]=*tsPtr;
+				}
+			
+			/* Convert the tracker time stamp to client time: */
+			*tsPtr+=clockOffset;
+			}
+		}
+	else
+		{
+		/* Read the server's state and time-stamp all trackers with the arrival time: */
+		state.read(pipe);
+		packetTimeStamp=VRDeviceState::getCurrentTimeStamp();
+		for(int i=0;i<state.getNumTrackers();++i)
+			state.setTrackerTimeStamp(i,packetTimeStamp);
+		}
+	}
+
+void VRDeviceClient::sendTimeStampRequest(void)
+	{
+	pipe.writeMessage(VRDevicePipe::TIMESTAMP_REQUEST);
+	pipe.write<VRDeviceState::TimeStamp>(VRDeviceState::getCurrentTimeStamp());
+	pipe.flush();
+	}
+
+void VRDeviceClient::readTimeStampReply(void)
+	{
+	VRDeviceState::TimeStamp requestTimeStamp=pipe.read<VRDeviceState::TimeStamp>();
+	VRDeviceState::TimeStamp serverTimeStamp=pipe.read<VRDeviceState::TimeStamp>();
+	VRDeviceState::TimeStamp replyTimeStamp=VRDeviceState::getCurrentTimeStamp();
+	
+	/* Assume that the server sampled its clock halfway through the round trip, and keep the estimate from the shortest round trip: */
+	VRDeviceState::TimeStamp roundTrip=replyTimeStamp-requestTimeStamp;
+	if(clockSyncNumReplies==0||clockSyncBestRoundTrip>roundTrip)
+		{
+		clockSyncBestRoundTrip=roundTrip;
+		clockSyncBestOffset=(requestTimeStamp+replyTimeStamp)/2-serverTimeStamp;
+		}
+	++clockSyncNumReplies;
+	}
+
 void* VRDeviceClient::streamReceiveThreadMethod(void)
 	{
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("DeviceClient");
+	
 	while(true)
 		{
 		/* Wait for next packet reply message: */
@@ -44,7 +110,21 @@ void* VRDeviceClient::streamReceiveThreadMethod(void)
 			/* Read server's state: */
 			{
 			Threads::Mutex::Lock stateLock(stateMutex);
-			state.read(pipe);
+			readState();
+			
+			/* Start re-estimating the clock offset if it is due; the replies arrive between state packets: */
+			if(serverProtocolVersion>=2U&&clockSyncInterval>0&&packetTimeStamp>=nextClockSyncTime&&clockSyncNumReplies>=clockSyncNumRounds)
+				{
+				Threads::Mutex::Lock pipeWriteLock(pipeWriteMutex);
+				if(streaming)
+					{
+					clockSyncNumRounds=4;
+					clockSyncNumReplies=0;
+					for(int round=0;round<clockSyncNumRounds;++round)
+						sendTimeStampRequest();
+					nextClockSyncTime=packetTimeStamp+clockSyncInterval;
+					}
+				}
 			}
 			
 			/* Signal packet reception: */
@@ -57,6 +137,14 @@ void* VRDeviceClient::streamReceiveThreadMethod(void)
 				packetNotificationCB(this,packetNotificationCBData);
 			}
 			}
+		else if(message==VRDevicePipe::TIMESTAMP_REPLY)
+			{
+			/* Update the clock offset once all replies of a periodic estimation have arrived: */
+			Threads::Mutex::Lock stateLock(stateMutex);
+			readTimeStampReply();
+			if(clockSyncNumReplies==clockSyncNumRounds)
+				clockOffset=clockSyncBestOffset;
+			}
 		else if(message==VRDevicePipe::STOPSTREAM_REPLY)
 			break;
 		else
@@ -78,16 +166,28 @@ void VRDeviceClient::initClient(void)
 		throw ProtocolError("VRDeviceClient: Timeout while waiting for CONNECT_REPLY");
 	if(pipe.readMessage()!=VRDevicePipe::CONNECT_REPLY)
 		throw ProtocolError("VRDeviceClient: Mismatching message while waiting for CONNECT_REPLY");
-	unsigned int serverProtocolVersionNumber=pipe.read<unsigned int>();
-	
-	/* Check server version number or something... */
+	serverProtocolVersion=pipe.read<unsigned int>();
 	
 	/* Read server's layout and initialize current state: */
 	state.readLayout(pipe);
+	
+	/* Estimate the server's clock offset if the server supports time stamps: */
+	if(serverProtocolVersion>=2U)
+		synchronizeClocks();
+	
+	/* Initialize the last seen server time stamps of all trackers: */
+	lastTrackerTimeStamps=new VRDeviceState::TimeStamp[state.getNumTrackers()];
+	for(int i=0;i<state.getNumTrackers();++i)
+		lastTrackerTimeStamps[i]=0;
 	}
 
 VRDeviceClient::VRDeviceClient(const char* deviceServerName,int deviceServerPort)
 	:pipe(deviceServerName,deviceServerPort),
+	 serverProtocolVersion(0),clockOffset(0),
+	 clockSyncInterval(10000000),nextClockSyncTime(0),
+	 clockSyncNumRounds(0),clockSyncNumReplies(0),clockSyncBestRoundTrip(0),clockSyncBestOffset(0),
+	 stateMutex("Vrui::VRDeviceClient::stateMutex"),
+	 packetTimeStamp(0),lastTrackerTimeStamps(0),
 	 active(false),streaming(false),
 	 packetNotificationCB(0),packetNotificationCBData(0)
 	{
@@ -96,6 +196,11 @@ VRDeviceClient::VRDeviceClient(const char* deviceServerName,int deviceServerPort
 
 VRDeviceClient::VRDeviceClient(const Misc::ConfigurationFileSection& configFileSection)
 	:pipe(configFileSection.retrieveString("./serverName").c_str(),configFileSection.retrieveValue<int>("./serverPort")),
+	 serverProtocolVersion(0),clockOffset(0),
+	 clockSyncInterval(VRDeviceState::TimeStamp(configFileSection.retrieveValue<double>("./clockSyncInterval",10.0)*1.0e6+0.5)),nextClockSyncTime(0),
+	 clockSyncNumRounds(0),clockSyncNumReplies(0),clockSyncBestRoundTrip(0),clockSyncBestOffset(0),
+	 stateMutex("Vrui::VRDeviceClient::stateMutex"),
+	 packetTimeStamp(0),lastTrackerTimeStamps(0),
 	 active(false),streaming(false),
 	 packetNotificationCB(0),packetNotificationCBData(0)
 	{
@@ -115,6 +220,48 @@ VRDeviceClient::~VRDeviceClient(void)
 	/* Disconnect from server: */
 	pipe.writeMessage(VRDevicePipe::DISCONNECT_REQUEST);
 	pipe.flush();
+	
+	delete[] lastTrackerTimeStamps;
+	}
+
+void VRDeviceClient::synchronizeClocks(int numRounds)
+	{
+	if(serverProtocolVersion<2U||streaming)
+		return;
+	
+	/* Exchange time stamps with the server and keep the estimate from the round with the shortest round-trip time: */
+	clockSyncNumRounds=numRounds;
+	clockSyncNumReplies=0;
+	for(int round=0;round<numRounds;++round)
+		{
+		/* Send a time stamp request message: */
+		sendTimeStampRequest();
+		
+		/* Wait for the server's reply: */
+		if(!pipe.waitForData(Misc::Time(10,0)))
+			throw ProtocolError("VRDeviceClient: Timeout while waiting for TIMESTAMP_REPLY");
+		if(pipe.readMessage()!=VRDevicePipe::TIMESTAMP_REPLY)
+			throw ProtocolError("VRDeviceClient: Mismatching message while waiting for TIMESTAMP_REPLY");
+		readTimeStampReply();
+		}
+	
+	Threads::Mutex::Lock stateLock(stateMutex);
+	clockOffset=clockSyncBestOffset;
+	nextClockSyncTime=VRDeviceState::getCurrentTimeStamp()+clockSyncInterval;
+	}
+
+void VRDeviceClient::setClockSyncInterval(double newClockSyncInterval)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	clockSyncInterval=VRDeviceState::TimeStamp(newClockSyncInterval*1.0e6+0.5);
+	nextClockSyncTime=VRDeviceState::getCurrentTimeStamp()+clockSyncInterval;
+	}
+
+void VRDeviceClient::resetLatencyHistograms(void)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	driverServerLatency.reset();
+	serverClientLatency.reset();
 	}
 
 void VRDeviceClient::activate(void)
@@ -148,6 +295,10 @@ void VRDeviceClient::getPacket(void)
 			}
 		else
 			{
+			/* Re-estimate the clock offset with a few time stamp exchanges if it is due: */
+			if(serverProtocolVersion>=2U&&clockSyncInterval>0&&VRDeviceState::getCurrentTimeStamp()>=nextClockSyncTime)
+				synchronizeClocks(4);
+			
 			/* Send packet request message: */
 			pipe.writeMessage(VRDevicePipe::PACKET_REQUEST);
 			pipe.flush();
@@ -161,7 +312,7 @@ void VRDeviceClient::getPacket(void)
 			/* Read server's state: */
 			{
 			Threads::Mutex::Lock stateLock(stateMutex);
-			state.read(pipe);
+			readState();
 			}
 			
 			/* Invoke packet notification callback: */
@@ -187,6 +338,7 @@ void VRDeviceClient::startStream(void)
 		pipe.writeMessage(VRDevicePipe::STARTSTREAM_REQUEST);
 		pipe.flush();
 		packetSignalCond.wait(packetSignalLock);
+		Threads::Mutex::Lock pipeWriteLock(pipeWriteMutex);
 		streaming=true;
 		}
 		}
@@ -196,10 +348,13 @@ void VRDeviceClient::stopStream(void)
 	{
 	if(streaming)
 		{
-		/* Send stop streaming message: */
+		/* Send stop streaming message; no clock offset estimation can start after this point: */
+		{
+		Threads::Mutex::Lock pipeWriteLock(pipeWriteMutex);
 		streaming=false;
 		pipe.writeMessage(VRDevicePipe::STOPSTREAM_REQUEST);
 		pipe.flush();
+		}
 		
 		/* Wait for packet receiving thread to die: */
 		streamReceiveThread.join();
@@ -30,6 +30,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/MutexCond.h>
 #include <Vrui/Internal/VRDeviceState.h>
 #include <Vrui/Internal/VRDevicePipe.h>
+#include <Vrui/Internal/LatencyHistogram.h>
 
 /* Forward declarations: */
 namespace Misc {
@@ -57,8 +58,21 @@ class VRDeviceClient
 	/* Elements: */
 	private:
 	VRDevicePipe pipe; // Pipe connected to device server
+	Threads::Mutex pipeWriteMutex; // Mutex serializing writes to the pipe by the stream receiving thread and other threads while in streaming mode
+	unsigned int serverProtocolVersion; // Version of the client/server protocol negotiated with the server
+	VRDeviceState::TimeStamp clockOffset; // Estimated offset from the server's monotonic clock to the client's monotonic clock
+	VRDeviceState::TimeStamp clockSyncInterval; // Interval between re-estimations of the clock offset in microseconds, or zero to estimate the offset only when connecting
+	VRDeviceState::TimeStamp nextClockSyncTime; // Client time at which to re-estimate the clock offset next
+	int clockSyncNumRounds; // Number of time stamp exchanges in the current clock offset estimation
+	int clockSyncNumReplies; // Number of time stamp replies received during the current clock offset estimation
+	VRDeviceState::TimeStamp clockSyncBestRoundTrip; // Shortest round-trip time seen during the current clock offset estimation
+	VRDeviceState::TimeStamp clockSyncBestOffset; // Clock offset estimated from the exchange with the shortest round-trip time
 	Threads::Mutex stateMutex; // Mutex to serialize access to current state
-	VRDeviceState state; // Shadow of server's current state
+	VRDeviceState state; // Shadow of server's current state; tracker time stamps are converted to the client's clock
+	VRDeviceState::TimeStamp packetTimeStamp; // Client time at which the current state arrived
+	VRDeviceState::TimeStamp* lastTrackerTimeStamps; // Array of server time stamps of each tracker's most recent measurement seen by the client
+	LatencyHistogram driverServerLatency; // Histogram of latencies between tracker sampling and sending of state packets by the server
+	LatencyHistogram serverClientLatency; // Histogram of latencies between sending of state packets by the server and their arrival at the client
 	bool active; // Flag if client is active
 	bool streaming; // Flag if client is in streaming mode
 	Threads::Thread streamReceiveThread; // Packet receiving thread in stream mode
@@ -68,6 +82,9 @@ class VRDeviceClient
 	void* packetNotificationCBData; // Pointer passed to packet notification callback function
 	
 	/* Private methods: */
+	void readState(void); // Reads a state packet from the server and updates latency statistics; state must be locked
+	void sendTimeStampRequest(void); // Sends a time stamp request to the server; pipe must be locked for writing in streaming mode
+	void readTimeStampReply(void); // Reads a time stamp reply from the server and updates the current clock offset estimation
 	void* streamReceiveThreadMethod(void); // Stream packet receiving thread method
 	void initClient(void); // Initializes communication between device server and client
 	
@@ -90,6 +107,29 @@ class VRDeviceClient
 		{
 		return state;
 		}
+	bool hasTimeStamps(void) const // Returns true if the server sends tracker time stamps
+		{
+		return serverProtocolVersion>=2U;
+		}
+	void synchronizeClocks(int numRounds =8); // Estimates the offset between the server's and client's clocks by exchanging time stamps; must not be called in streaming mode
+	void setClockSyncInterval(double newClockSyncInterval); // Sets the interval in seconds at which getPacket re-estimates the clock offset to follow clock drift; zero disables re-estimation
+	VRDeviceState::TimeStamp getClockOffset(void) const // Returns the current estimated clock offset from server to client time
+		{
+		return clockOffset;
+		}
+	VRDeviceState::TimeStamp getPacketTimeStamp(void) const // Returns the client time at which the current state arrived (state must be locked while being used)
+		{
+		return packetTimeStamp;
+		}
+	const LatencyHistogram& getDriverServerLatency(void) const // Returns the histogram of driver-to-server latencies (state must be locked while being used)
+		{
+		return driverServerLatency;
+		}
+	const LatencyHistogram& getServerClientLatency(void) const // Returns the histogram of server-to-client latencies (state must be locked while being used)
+		{
+		return serverClientLatency;
+		}
+	void resetLatencyHistograms(void); // Removes all accumulated latency samples
 	void activate(void); // Prepares the server for sending state packets
 	void deactivate(void); // Deactivates server
 	void getPacket(void); // Requests state packet from server; blocks until arrival
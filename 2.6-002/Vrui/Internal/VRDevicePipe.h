@@ -46,7 +46,9 @@ class VRDevicePipe:public Comm::TCPPipe
 		PACKET_REPLY, // Sends a device state packet
 		STARTSTREAM_REQUEST, // Requests entering stream mode (server sends packets automatically)
 		STOPSTREAM_REQUEST, // Requests leaving stream mode
-		STOPSTREAM_REPLY // Server's reply after last stream packet has been sent
+		STOPSTREAM_REPLY, // Server's reply after last stream packet has been sent
+		TIMESTAMP_REQUEST, // Requests the server's current time stamp to estimate clock offsets (protocol version 2)
+		TIMESTAMP_REPLY // Sends the client's request time stamp and the server's current time stamp
 		};
 	
 	/* Constructors and destructors: */
@@ -24,6 +24,9 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INTERNAL_VRDEVICESTATE_INCLUDED
 #define VRUI_INTERNAL_VRDEVICESTATE_INCLUDED
 
+#include <string.h>
+#include <time.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/ArrayMarshallers.h>
 #include <IO/File.h>
 #include <Geometry/OrthonormalTransformation.h>
@@ -49,19 +52,27 @@ class VRDeviceState
 		AngularVelocity angularVelocity; // Current angular velocity in radians/s
 		};
 	
+	typedef Misc::SInt64 TimeStamp; // Type for time stamps in microseconds on a monotonic clock
 	typedef bool ButtonState; // Type for button states
 	typedef float ValuatorState; // Type for valuator states
 	
-	/* Elements: */
 	private:
+	static const size_t streamHeaderSize=30; // Size of the header of recorded device state stream files
+	
+	/* Elements: */
 	int numTrackers; // Number of represented trackers
 	TrackerState* trackerStates; // Array of current tracker states
+	TimeStamp* trackerTimeStamps; // Array of time stamps at which the current tracker states were sampled
 	int numButtons; // Number of represented buttons
 	ButtonState* buttonStates; // Array of current button states
 	int numValuators; // Number of represented valuators
 	ValuatorState* valuatorStates; // Array of current valuator states
 	
 	/* Private methods: */
+	static const char* getStreamHeader(void) // Returns the header identifying recorded device state stream files
+		{
+		return "Vrui Device State Stream v1.0\n";
+		}
 	void initState(void)
 		{
 		for(int i=0;i<numTrackers;++i)
@@ -69,6 +80,7 @@ class VRDeviceState
 			trackerStates[i].positionOrientation=TrackerState::PositionOrientation::identity;
 			trackerStates[i].linearVelocity=TrackerState::LinearVelocity::zero;
 			trackerStates[i].angularVelocity=TrackerState::AngularVelocity::zero;
+			trackerTimeStamps[i]=TimeStamp(0);
 			}
 		for(int i=0;i<numButtons;++i)
 			buttonStates[i]=false;
@@ -79,13 +91,13 @@ class VRDeviceState
 	/* Constructors and destructors: */
 	public:
 	VRDeviceState(void) // Creates empty device state
-		:numTrackers(0),trackerStates(0),
+		:numTrackers(0),trackerStates(0),trackerTimeStamps(0),
 		 numButtons(0),buttonStates(0),
 		 numValuators(0),valuatorStates(0)
 		{
 		}
 	VRDeviceState(int sNumTrackers,int sNumButtons,int sNumValuators) // Creates device state of given layout
-		:numTrackers(sNumTrackers),trackerStates(new TrackerState[numTrackers]),
+		:numTrackers(sNumTrackers),trackerStates(new TrackerState[numTrackers]),trackerTimeStamps(new TimeStamp[numTrackers]),
 		 numButtons(sNumButtons),buttonStates(new ButtonState[numButtons]),
 		 numValuators(sNumValuators),valuatorStates(new ValuatorState[numValuators])
 		{
@@ -95,19 +107,28 @@ class VRDeviceState
 	~VRDeviceState(void)
 		{
 		delete[] trackerStates;
+		delete[] trackerTimeStamps;
 		delete[] buttonStates;
 		delete[] valuatorStates;
 		}
 	
 	/* Methods: */
+	static TimeStamp getCurrentTimeStamp(void) // Returns the current time on the local monotonic clock
+		{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC,&now);
+		return TimeStamp(now.tv_sec)*TimeStamp(1000000)+TimeStamp(now.tv_nsec/1000);
+		}
 	void setLayout(int newNumTrackers,int newNumButtons,int newNumValuators) // Sets the number of represented trackers, buttons and valuators
 		{
 		/* Re-allocate state arrays: */
 		if(numTrackers!=newNumTrackers)
 			{
 			delete[] trackerStates;
+			delete[] trackerTimeStamps;
 			numTrackers=newNumTrackers;
 			trackerStates=new TrackerState[numTrackers];
+			trackerTimeStamps=new TimeStamp[numTrackers];
 			}
 		if(numButtons!=newNumButtons)
 			{
@@ -145,6 +166,14 @@ class VRDeviceState
 		{
 		trackerStates[trackerIndex]=newTrackerState;
 		}
+	TimeStamp getTrackerTimeStamp(int trackerIndex) const // Returns time stamp of single tracker's current state
+		{
+		return trackerTimeStamps[trackerIndex];
+		}
+	void setTrackerTimeStamp(int trackerIndex,TimeStamp newTrackerTimeStamp) // Updates time stamp of single tracker's current state
+		{
+		trackerTimeStamps[trackerIndex]=newTrackerTimeStamp;
+		}
 	ButtonState getButtonState(int buttonIndex) const // Returns state of single button
 		{
 		return buttonStates[buttonIndex];
@@ -169,6 +198,14 @@ class VRDeviceState
 		{
 		return trackerStates;
 		}
+	const TimeStamp* getTrackerTimeStamps(void) const // Returns array of tracker time stamps
+		{
+		return trackerTimeStamps;
+		}
+	TimeStamp* getTrackerTimeStamps(void) // Ditto
+		{
+		return trackerTimeStamps;
+		}
 	const ButtonState* getButtonStates(void) const // Returns array of button states
 		{
 		return buttonStates;
@@ -198,17 +235,31 @@ class VRDeviceState
 		int newNumValuators=source.read<int>();
 		setLayout(newNumTrackers,newNumButtons,newNumValuators);
 		}
-	void write(IO::File& sink) const // Writes device state to given data sink
+	static void writeStreamHeader(IO::File& sink) // Writes the header identifying a recorded device state stream file
+		{
+		sink.write<char>(getStreamHeader(),streamHeaderSize);
+		}
+	static bool readStreamHeader(IO::File& source) // Reads the header of a recorded device state stream file; returns false if the file is not a device state stream
+		{
+		char header[streamHeaderSize];
+		source.read<char>(header,streamHeaderSize);
+		return memcmp(header,getStreamHeader(),streamHeaderSize)==0;
+		}
+	void write(IO::File& sink,bool writeTimeStamps =false) const // Writes device state to given data sink; optionally appends tracker time stamps
 		{
 		Misc::FixedArrayMarshaller<TrackerState>::write(trackerStates,numTrackers,sink);
 		Misc::FixedArrayMarshaller<ButtonState>::write(buttonStates,numButtons,sink);
 		Misc::FixedArrayMarshaller<ValuatorState>::write(valuatorStates,numValuators,sink);
+		if(writeTimeStamps)
+			sink.write<TimeStamp>(trackerTimeStamps,numTrackers);
 		}
-	void read(IO::File& source) const // Reads device state from given data source
+	void read(IO::File& source,bool readTimeStamps =false) const // Reads device state from given data source; optionally reads tracker time stamps
 		{
 		Misc::FixedArrayMarshaller<TrackerState>::read(trackerStates,numTrackers,source);
 		Misc::FixedArrayMarshaller<ButtonState>::read(buttonStates,numButtons,source);
 		Misc::FixedArrayMarshaller<ValuatorState>::read(valuatorStates,numValuators,source);
+		if(readTimeStamps)
+			source.read<TimeStamp>(trackerTimeStamps,numTrackers);
 		}
 	};
 
@@ -1,6 +1,6 @@
 /***********************************************************************
 Environment-dependent part of Vrui virtual reality development toolkit.
-Copyright (c) 2000-2012 Oliver Kreylos
+Copyright (c) 2000-2013 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -44,9 +44,12 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/Thread.h>
 #include <Threads/Mutex.h>
 #include <Threads/Barrier.h>
+#include <Threads/SpinBarrier.h>
+#include <Threads/PlacementPolicy.h>
 #include <Cluster/Multiplexer.h>
 #include <Cluster/MulticastPipe.h>
 #include <Cluster/ThreadSynchronizer.h>
+#include <IO/FileStatistics.h>
 #include <Math/Constants.h>
 #include <Geometry/Point.h>
 #include <Geometry/Plane.h>
@@ -94,6 +97,7 @@ VRWindow** vruiTotalWindows=0;
 bool vruiWindowsMultithreaded=false;
 Threads::Thread* vruiRenderingThreads=0;
 Threads::Barrier vruiRenderingBarrier;
+Threads::SpinBarrier* vruiRenderingSpinBarrier=0;
 int vruiNumSoundContexts=0;
 SoundContext** vruiSoundContexts=0;
 Cluster::Multiplexer* vruiMultiplexer=0;
@@ -104,6 +108,7 @@ int vruiSlaveArgc=0;
 char** vruiSlaveArgv=0;
 char** vruiSlaveArgvShadow=0;
 volatile bool vruiAsynchronousShutdown=false;
+bool vruiPrintFileStatistics=false;
 
 /*****************************************
 Workbench-specific private Vrui functions:
@@ -143,6 +148,7 @@ void vruiErrorShutdown(bool signalError)
 			vruiRenderingThreads[i].join();
 			}
 		delete[] vruiRenderingThreads;
+		delete vruiRenderingSpinBarrier;
 		}
 	if(vruiWindows!=0)
 		{
@@ -206,8 +212,40 @@ void vruiErrorShutdown(bool signalError)
 		}
 	}
 
+std::string vruiGetCompiledConfigurationFileName(void)
+	{
+	/* Use the compiled configuration file named in the environment, if any: */
+	const char* compiledFileName=getenv("VRUI_CONFIGCACHE");
+	if(compiledFileName!=0)
+		return compiledFileName; // An empty name disables the compiled configuration file
+	
+	/* Use a compiled configuration file in the user's home directory: */
+	const char* home=getenv("HOME");
+	if(home==0||home[0]=='\0')
+		return std::string();
+	std::string result=home;
+	result.append("/.VruiConfig.cache");
+	return result;
+	}
+
 void vruiOpenConfigurationFile(const char* userConfigurationFileName)
 	{
+	/* Try loading a compiled version of the merged system-wide and user configuration files: */
+	const char* sourceFileNames[2]={SYSVRUICONFIGFILE,userConfigurationFileName};
+	std::string compiledFileName=vruiGetCompiledConfigurationFileName();
+	if(!compiledFileName.empty())
+		{
+		Misc::ConfigurationFile* compiledConfigFile=new Misc::ConfigurationFile;
+		if(compiledConfigFile->loadCompiled(compiledFileName.c_str(),2,sourceFileNames))
+			{
+			if(vruiVerbose)
+				std::cout<<"Vrui: Read compiled configuration file "<<compiledFileName<<std::endl;
+			vruiConfigFile=compiledConfigFile;
+			return;
+			}
+		delete compiledConfigFile;
+		}
+	
 	try
 		{
 		/* Open the system-wide configuration file: */
@@ -245,6 +283,21 @@ void vruiOpenConfigurationFile(const char* userConfigurationFileName)
 		std::cerr<<"Caught exception "<<error.what()<<" while reading user configuration file"<<std::endl;
 		vruiErrorShutdown(true);
 		}
+	
+	if(!compiledFileName.empty())
+		{
+		try
+			{
+			/* Save the merged configuration for the next start: */
+			vruiConfigFile->saveCompiled(compiledFileName.c_str(),2,sourceFileNames);
+			}
+		catch(std::runtime_error error)
+			{
+			/* Ignore the error; the configuration files will be parsed again next time: */
+			if(vruiVerbose)
+				std::cout<<"Vrui: Unable to write compiled configuration file "<<compiledFileName<<" due to exception "<<error.what()<<std::endl;
+			}
+		}
 	}
 
 void vruiGoToRootSection(const char*& rootSectionName)
@@ -283,6 +336,15 @@ void vruiGoToRootSection(const char*& rootSectionName)
 	vruiConfigFile->setCurrentSection(rootSectionName);
 	}
 
+inline void vruiSynchronizeRendering(void)
+	{
+	/* Synchronize the main thread and the rendering threads using the selected barrier: */
+	if(vruiRenderingSpinBarrier!=0)
+		vruiRenderingSpinBarrier->synchronize();
+	else
+		vruiRenderingBarrier.synchronize();
+	}
+
 struct VruiRenderingThreadArg
 	{
 	/* Elements: */
@@ -297,6 +359,9 @@ void* vruiRenderingThreadFunction(VruiRenderingThreadArg threadArg)
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
 	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
 	
+	/* Place the thread according to its role: */
+	Threads::PlacementPolicy::placeThread("Rendering");
+	
 	/* Get this thread's parameters: */
 	int windowIndex=threadArg.windowIndex;
 	
@@ -324,7 +389,7 @@ void* vruiRenderingThreadFunction(VruiRenderingThreadArg threadArg)
 	window->getContextData().updateThings();
 	
 	/* Synchronize with the other rendering threads: */
-	vruiRenderingBarrier.synchronize();
+	vruiSynchronizeRendering();
 	
 	/* Terminate early if there was a problem creating the rendering window: */
 	if(window==0)
@@ -334,19 +399,19 @@ void* vruiRenderingThreadFunction(VruiRenderingThreadArg threadArg)
 	while(true)
 		{
 		/* Wait for the start of the rendering cycle: */
-		vruiRenderingBarrier.synchronize();
+		vruiSynchronizeRendering();
 		
 		/* Draw the window's contents: */
 		window->draw();
 		
 		/* Wait until all threads are done rendering: */
 		glFinish();
-		vruiRenderingBarrier.synchronize();
+		vruiSynchronizeRendering();
 		
 		if(vruiState->multiplexer)
 			{
 			/* Wait until all other nodes are done rendering: */
-			vruiRenderingBarrier.synchronize();
+			vruiSynchronizeRendering();
 			}
 		
 		/* Swap buffers: */
@@ -711,6 +776,22 @@ void init(int& argc,char**& argv,char**&)
 			}
 		}
 	
+	/* Enable file I/O statistics collection if requested: */
+	vruiPrintFileStatistics=vruiConfigFile->retrieveValue<bool>("./printFileStatistics",false);
+	if(vruiPrintFileStatistics)
+		{
+		IO::FileStatistics::setSlowOperationTime(vruiConfigFile->retrieveValue<double>("./slowFileOperationTime",0.1));
+		IO::FileStatistics::setEnabled(true);
+		}
+	
+	/* Configure the placement of the toolkit's threads if requested: */
+	std::string threadPlacementSectionName=vruiConfigFile->retrieveString("./threadPlacement","");
+	if(!threadPlacementSectionName.empty())
+		{
+		Threads::PlacementPolicy::configure(vruiConfigFile->getSection(threadPlacementSectionName.c_str()));
+		Threads::PlacementPolicy::placeThread("Main");
+		}
+	
 	/* Synchronize threads between here and end of function body: */
 	Cluster::ThreadSynchronizer threadSynchronizer(vruiPipe);
 	
@@ -996,7 +1077,10 @@ void startDisplay(void)
 		if(vruiWindowsMultithreaded)
 			{
 			/* Initialize the rendering barrier: */
-			vruiRenderingBarrier.setNumSynchronizingThreads(vruiNumWindows+1);
+			if(vruiConfigFile->retrieveValue<bool>("./windowsSpinningBarrier",false))
+				vruiRenderingSpinBarrier=new Threads::SpinBarrier(vruiNumWindows+1);
+			else
+				vruiRenderingBarrier.setNumSynchronizingThreads(vruiNumWindows+1);
 			
 			/* Create one rendering thread for each window (which will in turn create the windows themselves): */
 			vruiRenderingThreads=new Threads::Thread[vruiNumWindows];
@@ -1010,7 +1094,7 @@ void startDisplay(void)
 				}
 			
 			/* Wait until all threads have created their windows: */
-			vruiRenderingBarrier.synchronize();
+			vruiSynchronizeRendering();
 			
 			/* Check if all windows have been properly created: */
 			bool windowsOk=true;
@@ -1086,6 +1170,13 @@ void startDisplay(void)
 		vruiTotalWindows[localWindowsStart+i]=vruiWindows[i];
 	for(int i=localWindowsStart+vruiNumWindows;i<vruiTotalNumWindows;++i)
 		vruiTotalWindows[i]=0;
+	
+	if(Threads::PlacementPolicy::isConfigured())
+		{
+		/* Report the effective placement of all threads created so far: */
+		std::cout<<"Vrui: Thread placement:"<<std::endl;
+		Threads::PlacementPolicy::printPlacement(std::cout);
+		}
 	}
 
 void startSound(void)
@@ -1363,10 +1454,10 @@ void vruiInnerLoopMultiWindow(void)
 		if(vruiWindowsMultithreaded)
 			{
 			/* Start the rendering cycle by synchronizing with the render threads: */
-			vruiRenderingBarrier.synchronize();
+			vruiSynchronizeRendering();
 			
 			/* Wait until all threads are done rendering: */
-			vruiRenderingBarrier.synchronize();
+			vruiSynchronizeRendering();
 			
 			if(vruiState->multiplexer!=0)
 				{
@@ -1374,7 +1465,7 @@ void vruiInnerLoopMultiWindow(void)
 				vruiState->pipe->barrier();
 				
 				/* Notify the render threads to swap buffers: */
-				vruiRenderingBarrier.synchronize();
+				vruiSynchronizeRendering();
 				}
 			}
 		else
@@ -1550,6 +1641,7 @@ void mainLoop(void)
 			vruiRenderingThreads[i].join();
 			}
 		delete[] vruiRenderingThreads;
+		delete vruiRenderingSpinBarrier;
 		}
 	if(vruiWindows!=0)
 		{
@@ -1629,6 +1721,13 @@ void deinit(void)
 			}
 		}
 	
+	if(vruiPrintFileStatistics)
+		{
+		/* Print the file I/O statistics of the entire run: */
+		std::cout<<"Vrui: File I/O statistics:"<<std::endl;
+		IO::FileStatistics::printSummary(std::cout);
+		}
+	
 	/* Close the configuration file: */
 	delete vruiConfigFile;
 	
@@ -0,0 +1,299 @@
+/***********************************************************************
+DeviceLoadTest - Program to connect multiple streaming clients to a Vrui
+VR Device Daemon and measure received packet rates, inter-arrival jitter,
+and CPU usage, and to record device state streams for later replay.
+Copyright (c) 2013 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <vector>
+#include <stdexcept>
+#include <Math/Math.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Vrui/Internal/VRDeviceClient.h>
+#include <Vrui/Internal/LatencyHistogram.h>
+
+struct ClientStatistics // Structure to accumulate packet statistics for a single device client
+	{
+	/* Elements: */
+	public:
+	Vrui::VRDeviceState::TimeStamp lastArrival; // Arrival time of the most recent packet
+	unsigned int numPackets; // Number of packets received during the measurement interval
+	double intervalSum,intervalSqrSum; // Sums of packet inter-arrival intervals and their squares in microseconds
+	Vrui::LatencyHistogram intervals; // Histogram of packet inter-arrival intervals
+	IO::FilePtr recordFile; // File to record the received device state stream, or null
+	
+	/* Constructors and destructors: */
+	ClientStatistics(void)
+		:lastArrival(0),numPackets(0),intervalSum(0.0),intervalSqrSum(0.0),
+		 intervals(10,1000)
+		{
+		}
+	
+	/* Methods: */
+	void reset(void) // Discards all accumulated statistics; client's state must be locked
+		{
+		lastArrival=0;
+		numPackets=0;
+		intervalSum=0.0;
+		intervalSqrSum=0.0;
+		intervals.reset();
+		}
+	};
+
+struct ClientSlot // Structure associating a device client with its statistics
+	{
+	/* Elements: */
+	public:
+	Vrui::VRDeviceClient* client; // The device client
+	ClientStatistics* stats; // The client's packet statistics
+	};
+
+void packetNotificationCallback(Vrui::VRDeviceClient* client,void* userData)
+	{
+	ClientStatistics* stats=static_cast<ClientStatistics*>(userData);
+	
+	/* Update the inter-arrival statistics: */
+	client->lockState();
+	Vrui::VRDeviceState::TimeStamp arrival=client->getPacketTimeStamp();
+	if(stats->numPackets>0)
+		{
+		Vrui::VRDeviceState::TimeStamp interval=arrival-stats->lastArrival;
+		stats->intervalSum+=double(interval);
+		stats->intervalSqrSum+=double(interval)*double(interval);
+		stats->intervals.addSample(interval);
+		}
+	stats->lastArrival=arrival;
+	++stats->numPackets;
+	
+	/* Append the received state to the record file: */
+	if(stats->recordFile!=0)
+		{
+		stats->recordFile->write<Vrui::VRDeviceState::TimeStamp>(arrival);
+		client->getState().write(*stats->recordFile,true);
+		}
+	client->unlockState();
+	}
+
+double getCpuTime(void) // Returns the CPU time used by this process in seconds
+	{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return double(usage.ru_utime.tv_sec)+double(usage.ru_utime.tv_usec)*1.0e-6+double(usage.ru_stime.tv_sec)+double(usage.ru_stime.tv_usec)*1.0e-6;
+	}
+
+double getProcessCpuTime(int pid) // Returns the CPU time used by the local process of the given ID in seconds, or a negative number if the process can not be inspected
+	{
+	char statFileName[64];
+	snprintf(statFileName,sizeof(statFileName),"/proc/%d/stat",pid);
+	FILE* statFile=fopen(statFileName,"rt");
+	if(statFile==0)
+		return -1.0;
+	char line[1024];
+	bool haveLine=fgets(line,sizeof(line),statFile)!=0;
+	fclose(statFile);
+	if(!haveLine)
+		return -1.0;
+	
+	/* Skip the process name, which may contain spaces, and the eleven fields between it and the user and system times: */
+	const char* fPtr=strrchr(line,')');
+	if(fPtr==0)
+		return -1.0;
+	++fPtr;
+	for(int field=0;field<11&&*fPtr!='\0';++field)
+		{
+		while(*fPtr==' ')
+			++fPtr;
+		while(*fPtr!=' '&&*fPtr!='\0')
+			++fPtr;
+		}
+	unsigned long userTicks,systemTicks;
+	if(sscanf(fPtr,"%lu %lu",&userTicks,&systemTicks)!=2)
+		return -1.0;
+	return double(userTicks+systemTicks)/double(sysconf(_SC_CLK_TCK));
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse command line: */
+	char* serverName=0;
+	int numClients=1;
+	double duration=10.0;
+	const char* recordFileName=0;
+	bool printHistograms=false;
+	int daemonPid=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i],"-clients")==0)
+				{
+				++i;
+				numClients=atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i],"-duration")==0)
+				{
+				++i;
+				duration=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i],"-record")==0)
+				{
+				++i;
+				recordFileName=argv[i];
+				}
+			else if(strcasecmp(argv[i],"-histogram")==0)
+				printHistograms=true;
+			else if(strcasecmp(argv[i],"-pid")==0)
+				{
+				++i;
+				daemonPid=atoi(argv[i]);
+				}
+			}
+		else
+			serverName=argv[i];
+		}
+	
+	if(serverName==0||numClients<1)
+		{
+		fprintf(stderr,"Usage: %s [-clients <numClients>] [-duration <seconds>] [-record <stream file name>] [-histogram] [-pid <daemon process ID>] <serverName:serverPort>\n",argv[0]);
+		fprintf(stderr,"  -pid <daemon process ID> Measures the CPU usage of the VR device daemon running on the local host under the given process ID\n");
+		return 1;
+		}
+	
+	/* Split the server name into hostname:port: */
+	char* colonPtr=0;
+	for(char* cPtr=serverName;*cPtr!='\0';++cPtr)
+		if(*cPtr==':')
+			colonPtr=cPtr;
+	int portNumber=0;
+	if(colonPtr!=0)
+		{
+		portNumber=atoi(colonPtr+1);
+		*colonPtr='\0';
+		}
+	
+	/* Connect all device clients: */
+	std::vector<ClientSlot> clients;
+	try
+		{
+		for(int i=0;i<numClients;++i)
+			{
+			ClientSlot slot;
+			slot.client=new Vrui::VRDeviceClient(serverName,portNumber);
+			slot.stats=new ClientStatistics;
+			clients.push_back(slot);
+			}
+		}
+	catch(std::runtime_error error)
+		{
+		fprintf(stderr,"Caught exception %s while initializing VR device clients\n",error.what());
+		return 1;
+		}
+	
+	/* Open the record file for the first client: */
+	if(recordFileName!=0)
+		{
+		ClientStatistics* stats=clients[0].stats;
+		stats->recordFile=IO::openFile(recordFileName,IO::File::WriteOnly);
+		stats->recordFile->setEndianness(Misc::LittleEndian);
+		Vrui::VRDeviceState::writeStreamHeader(*stats->recordFile);
+		clients[0].client->lockState();
+		clients[0].client->getState().writeLayout(*stats->recordFile);
+		clients[0].client->unlockState();
+		}
+	
+	/* Start streaming on all clients: */
+	for(std::vector<ClientSlot>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		{
+		cIt->client->enablePacketNotificationCB(packetNotificationCallback,cIt->stats);
+		cIt->client->activate();
+		cIt->client->startStream();
+		}
+	
+	/* Discard the statistics of packets received while the clients were starting up: */
+	for(std::vector<ClientSlot>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		{
+		cIt->client->lockState();
+		cIt->stats->reset();
+		cIt->client->unlockState();
+		}
+	
+	/* Measure for the requested duration: */
+	double cpuStart=getCpuTime();
+	double daemonCpuStart=daemonPid>0?getProcessCpuTime(daemonPid):-1.0;
+	Vrui::VRDeviceState::TimeStamp start=Vrui::VRDeviceState::getCurrentTimeStamp();
+	usleep((useconds_t)(duration*1.0e6));
+	Vrui::VRDeviceState::TimeStamp end=Vrui::VRDeviceState::getCurrentTimeStamp();
+	double cpuEnd=getCpuTime();
+	double daemonCpuEnd=daemonPid>0?getProcessCpuTime(daemonPid):-1.0;
+	
+	/* Stop streaming and disconnect all clients: */
+	for(std::vector<ClientSlot>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		{
+		cIt->client->stopStream();
+		cIt->client->disablePacketNotificationCB();
+		cIt->client->deactivate();
+		}
+	
+	/* Print the per-client statistics: */
+	double elapsed=double(end-start)*1.0e-6;
+	unsigned int totalPackets=0;
+	for(size_t i=0;i<clients.size();++i)
+		{
+		ClientStatistics* stats=clients[i].stats;
+		totalPackets+=stats->numPackets;
+		double rate=double(stats->numPackets)/elapsed;
+		double mean=0.0,stddev=0.0;
+		if(stats->numPackets>1)
+			{
+			double n=double(stats->numPackets-1);
+			mean=stats->intervalSum/n;
+			stddev=Math::sqrt(Math::max(stats->intervalSqrSum/n-mean*mean,0.0));
+			}
+		printf("Client %u: %u packets, %.1f packets/s, inter-arrival mean %.3f ms, jitter %.3f ms\n",(unsigned int)i,stats->numPackets,rate,mean*1.0e-3,stddev*1.0e-3);
+		if(printHistograms)
+			{
+			char label[64];
+			snprintf(label,sizeof(label),"Client %u inter-arrival",(unsigned int)i);
+			stats->intervals.printHistogram(stdout,label);
+			}
+		}
+	printf("Total: %u packets, %.1f packets/s, %.1f%% client CPU",totalPackets,double(totalPackets)/elapsed,(cpuEnd-cpuStart)*100.0/elapsed);
+	if(daemonCpuStart>=0.0&&daemonCpuEnd>=0.0)
+		printf(", %.1f%% daemon CPU",(daemonCpuEnd-daemonCpuStart)*100.0/elapsed);
+	else if(daemonPid>0)
+		printf(", daemon CPU unavailable for process %d",daemonPid);
+	printf("\n");
+	
+	/* Clean up: */
+	for(std::vector<ClientSlot>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		{
+		delete cIt->client;
+		delete cIt->stats;
+		}
+	
+	return 0;
+	}
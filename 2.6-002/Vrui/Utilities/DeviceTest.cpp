@@ -110,6 +110,7 @@ int main(int argc,char* argv[])
 	int printMode=0;
 	bool printButtonStates=false;
 	bool printNewlines=false;
+	bool printLatency=false;
 	bool savePositions=false;
 	std::string saveFileName;
 	int triggerIndex=0;
@@ -136,6 +137,8 @@ int main(int argc,char* argv[])
 				printButtonStates=true;
 			else if(strcasecmp(argv[i],"-n")==0)
 				printNewlines=true;
+			else if(strcasecmp(argv[i],"-latency")==0)
+				printLatency=true;
 			else if(strcasecmp(argv[i],"-save")==0)
 				{
 				savePositions=true;
@@ -154,7 +157,7 @@ int main(int argc,char* argv[])
 	
 	if(serverName==0)
 		{
-		std::cerr<<"Usage: "<<argv[0]<<" [(-t | --trackerIndex) <trackerIndex>] [-p | -o | -f | -v] [-b] <serverName:serverPort>"<<std::endl;
+		std::cerr<<"Usage: "<<argv[0]<<" [(-t | --trackerIndex) <trackerIndex>] [-p | -o | -f | -v] [-b] [-latency] <serverName:serverPort>"<<std::endl;
 		return 1;
 		}
 	
@@ -215,6 +218,7 @@ int main(int argc,char* argv[])
 	Misc::Timer t;
 	int numPackets=0;
 	bool oldTriggerState=false;
+	Vrui::LatencyHistogram clientProcessingLatency;
 	while(loop)
 		{
 		/* Print new device state: */
@@ -223,6 +227,9 @@ int main(int argc,char* argv[])
 		deviceClient->lockState();
 		const Vrui::VRDeviceState& state=deviceClient->getState();
 		
+		/* Measure the age of the current state packet: */
+		clientProcessingLatency.addSample(Vrui::VRDeviceState::getCurrentTimeStamp()-deviceClient->getPacketTimeStamp());
+		
 		if(savePositions&&saveFile!=0)
 			{
 			if(oldTriggerState==false&&state.getButtonState(triggerIndex))
@@ -311,6 +318,18 @@ int main(int argc,char* argv[])
 	std::cout<<std::endl;
 	t.elapse();
 	std::cout<<"Received "<<numPackets<<" device data packets in "<<t.getTime()*1000.0<<" ms ("<<double(numPackets)/t.getTime()<<" packets/s)"<<std::endl;
+	if(printLatency)
+		{
+		/* Print the tracking latency histograms: */
+		if(!deviceClient->hasTimeStamps())
+			std::cout<<"Device server does not send tracker time stamps"<<std::endl;
+		deviceClient->lockState();
+		deviceClient->getDriverServerLatency().printHistogram(stdout,"Driver to server");
+		deviceClient->getServerClientLatency().printHistogram(stdout,"Server to client");
+		deviceClient->unlockState();
+		clientProcessingLatency.printHistogram(stdout,"Client to processing");
+		fflush(stdout);
+		}
 	deviceClient->stopStream();
 	deviceClient->deactivate();
 	